@@ -0,0 +1,1523 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/xon_api.h"
+#include "../src/lexer.h"
+#include "../src/number.h"
+#include "../src/scan.h"
+#include "../src/structural.h"
+
+// Micro-benchmarks for the Xon parser. Run all cases with `make bench`, or a
+// subset with `/tmp/xon_bench <case> [<case> ...]`.
+
+typedef struct {
+    const char* name;
+    const char* summary;
+    void (*run)(void);
+} BenchCase;
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void bench_report(const char* label, size_t iterations, size_t bytes_per_op, double seconds) {
+    double us_per_op = iterations ? (seconds * 1e6) / (double)iterations : 0.0;
+    double mb_per_s = seconds > 0.0 ? ((double)bytes_per_op * (double)iterations) / seconds / 1e6 : 0.0;
+    printf("  %-40s %12.3f us/op %10.1f MB/s\n", label, us_per_op, mb_per_s);
+}
+
+static const char* bench_small_document(void) {
+    return
+        "{\n"
+        "  // service settings\n"
+        "  name: \"edge-proxy\",\n"
+        "  region: \"eu-west-1\",\n"
+        "  port: 8443,\n"
+        "  tls: true,\n"
+        "  timeouts: { connect: 250, read: 1500, idle: 60000 },\n"
+        "  upstreams: [\"10.0.0.1:80\", \"10.0.0.2:80\", \"10.0.0.3:80\"],\n"
+        "  retries: 3,\n"
+        "  fallback: null,\n"
+        "}\n";
+}
+
+// Generated config shaped like our large machine-written inputs: indented,
+// commented records with strings, integers, floats and booleans.
+static char* bench_generate_document(size_t records, size_t* out_len) {
+    size_t cap = records * 256 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "{\n    // generated\n    records: [\n");
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "        {\n"
+            "            # record %zu\n"
+            "            id: %zu,\n"
+            "            name: \"service-%zu\",\n"
+            "            weight: %zu.%03zu,\n"
+            "            enabled: %s,\n"
+            "        },\n",
+            i, i, i, i % 97, (i * 7) % 1000, (i % 3) ? "true" : "false");
+    }
+    len += (size_t)snprintf(out + len, cap - len, "    ],\n}\n");
+    *out_len = len;
+    return out;
+}
+
+static int bench_write_file(const char* path, const char* data, size_t len) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    if (fwrite(data, 1, len, f) != len) {
+        fclose(f);
+        return 0;
+    }
+    return fclose(f) == 0;
+}
+
+// Cost of the tmpfile() round trip xonify_string() used to pay before lexing.
+static size_t tmpfile_round_trip(const char* input) {
+    FILE* tmp = tmpfile();
+    size_t seen = 0;
+    if (!tmp) return 0;
+    fputs(input, tmp);
+    rewind(tmp);
+    while (fgetc(tmp) != EOF) seen++;
+    fclose(tmp);
+    return seen;
+}
+
+static void bench_string_parse(void) {
+    const char* doc = bench_small_document();
+    size_t len = strlen(doc);
+    size_t iterations = 20000;
+    size_t i;
+    size_t checksum = 0;
+    double start;
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        checksum += root != NULL;
+        xon_free(root);
+    }
+    bench_report("xonify_buffer (in-memory lexer)", iterations, len, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        checksum += tmpfile_round_trip(doc);
+    }
+    bench_report("tmpfile write + fgetc re-read (removed)", iterations, len, bench_now() - start);
+
+    if (checksum == 0) fprintf(stderr, "unexpected checksum\n");
+}
+
+static void bench_large_file(void) {
+    const char* path = "/tmp/xon_bench_large.xon";
+    size_t len = 0;
+    size_t iterations = 5;
+    size_t i;
+    size_t checksum = 0;
+    char* doc = bench_generate_document(100000, &len);
+    double start;
+
+    if (!doc || !bench_write_file(path, doc, len)) {
+        fprintf(stderr, "failed to generate %s\n", path);
+        free(doc);
+        return;
+    }
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify(path);
+        checksum += root != NULL;
+        xon_free(root);
+    }
+    bench_report("xonify (mmap input)", iterations, len, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        checksum += root != NULL;
+        xon_free(root);
+    }
+    bench_report("xonify_buffer (already in memory)", iterations, len, bench_now() - start);
+
+    if (checksum != iterations * 2) fprintf(stderr, "unexpected parse failure\n");
+    free(doc);
+    remove(path);
+}
+
+// Indentation- and comment-heavy input, so most lexer time is spent skipping.
+static char* bench_generate_commented(size_t blocks, size_t* out_len) {
+    size_t cap = blocks * 512 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "[\n");
+    for (i = 0; i < blocks; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "                /*\n"
+            "                 * Block %zu: documentation that is carried along with the\n"
+            "                 * generated data and ignored by the parser.\n"
+            "                 */\n"
+            "                // trailing notes for block %zu, also ignored entirely\n"
+            "                # legacy hash comment kept for compatibility\n"
+            "                %zu,\n",
+            i, i, i);
+    }
+    len += (size_t)snprintf(out + len, cap - len, "]\n");
+    *out_len = len;
+    return out;
+}
+
+// Parses doc once per supported scan level (see src/scan.h).
+static void bench_parse_at_levels(const char* doc, size_t len, size_t iterations) {
+    static const char* labels[] = {"scalar", "sse2", "avx2"};
+    size_t i;
+    int level;
+
+    for (level = XON_SCAN_SCALAR; level <= XON_SCAN_AVX2; level++) {
+        char label[64];
+        size_t checksum = 0;
+        double start;
+
+        if (xon_scan_set_level((XonScanLevel)level) != (XonScanLevel)level) {
+            printf("  %-40s (not supported on this CPU)\n", labels[level]);
+            continue;
+        }
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonValue* root = xonify_buffer(doc, len);
+            checksum += root != NULL;
+            xon_free(root);
+        }
+        snprintf(label, sizeof(label), "xonify_buffer, %s scan kernels", labels[level]);
+        bench_report(label, iterations, len, bench_now() - start);
+        if (checksum != iterations) fprintf(stderr, "unexpected parse failure\n");
+    }
+    xon_scan_set_level(XON_SCAN_AVX2);
+}
+
+static void bench_comment_skip(void) {
+    size_t len = 0;
+    char* doc = bench_generate_commented(100, &len);
+
+    if (!doc) return;
+    bench_parse_at_levels(doc, len, 2000);
+    free(doc);
+}
+
+// Long string values, one in eight carrying escapes.
+static char* bench_generate_strings(size_t records, size_t* out_len) {
+    size_t cap = records * 256 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "{\n");
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "    \"description_%zu\": \"%s\",\n", i,
+            (i % 8) ? "Upstream pool serving the public API; drained nightly for maintenance windows"
+                    : "Line one\\nLine two with a \\\"quoted\\\" word and a tab\\tbefore the end");
+    }
+    len += (size_t)snprintf(out + len, cap - len, "}\n");
+    *out_len = len;
+    return out;
+}
+
+static void bench_string_scan(void) {
+    size_t len = 0;
+    char* doc = bench_generate_strings(100, &len);
+
+    if (!doc) return;
+    bench_parse_at_levels(doc, len, 2000);
+    free(doc);
+}
+
+// The lexer's number path before number.c: copy into a 128-byte buffer, then strtod.
+static double legacy_strtod_number(const char* p, size_t len) {
+    char buffer[128];
+    if (len > sizeof(buffer) - 1) len = sizeof(buffer) - 1;
+    memcpy(buffer, p, len);
+    buffer[len] = '\0';
+    return strtod(buffer, NULL);
+}
+
+// Metric/feature-vector style literals: integers, short decimals, full
+// precision doubles and exponents.
+static char* bench_generate_numbers(size_t count, size_t* out_len) {
+    size_t cap = count * 32 + 64;
+    size_t len = 0;
+    size_t i;
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "[");
+    for (i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        switch (i % 4) {
+            case 0: len += (size_t)snprintf(out + len, cap - len, "%llu", state % 100000); break;
+            case 1: len += (size_t)snprintf(out + len, cap - len, "%.3f", (double)(state % 1000000) / 997.0); break;
+            case 2: len += (size_t)snprintf(out + len, cap - len, "%.17g", (double)(state >> 11) / 9007199254740992.0); break;
+            default: len += (size_t)snprintf(out + len, cap - len, "%.6e", (double)(state % 1000003) * 1e-9); break;
+        }
+        if (i + 1 < count) out[len++] = ',';
+    }
+    len += (size_t)snprintf(out + len, cap - len, "]");
+    *out_len = len;
+    return out;
+}
+
+static void bench_number_parse(void) {
+    size_t len = 0;
+    size_t iterations = 200;
+    size_t i;
+    double sum_fast = 0.0;
+    double sum_legacy = 0.0;
+    double start;
+    char* doc = bench_generate_numbers(10000, &len);
+
+    if (!doc) return;
+
+    // Conversion only: the same token spans through both paths.
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        const char* p = doc + 1;
+        const char* end = doc + len - 1;
+        while (p < end) {
+            const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+            const char* stop = comma ? comma : end;
+            double value = 0.0;
+            xon_parse_decimal(p, stop, &value);
+            sum_fast += value;
+            p = stop + 1;
+        }
+    }
+    bench_report("xon_parse_decimal (span, Eisel-Lemire)", iterations, len, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        const char* p = doc + 1;
+        const char* end = doc + len - 1;
+        while (p < end) {
+            const char* comma = (const char*)memchr(p, ',', (size_t)(end - p));
+            const char* stop = comma ? comma : end;
+            sum_legacy += legacy_strtod_number(p, (size_t)(stop - p));
+            p = stop + 1;
+        }
+    }
+    bench_report("128-byte copy + strtod (removed)", iterations, len, bench_now() - start);
+
+    if (sum_fast != sum_legacy) fprintf(stderr, "number parse mismatch\n");
+    free(doc);
+}
+
+// Expression-heavy config: declarations, member access and calls, so most
+// tokens are identifiers or keywords.
+static char* bench_generate_expressions(size_t records, size_t* out_len) {
+    size_t cap = records * 192 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "{\n    const base = { timeout: 30, retries: 3, enabled: true },\n");
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "    let service_%zu = if (base.enabled && base.retries > 2) base.timeout * %zu else null,\n"
+            "    check_%zu: service_%zu ?? base.timeout,\n",
+            i, i % 7, i, i);
+    }
+    len += (size_t)snprintf(out + len, cap - len, "}\n");
+    *out_len = len;
+    return out;
+}
+
+static void bench_identifier_lex(void) {
+    size_t len = 0;
+    size_t iterations = 200;
+    size_t tokens = 0;
+    size_t i;
+    double start;
+    double elapsed;
+    char* doc = bench_generate_expressions(1000, &len);
+
+    if (!doc) return;
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonLexer lexer;
+        XonTokenData data;
+        char* err = NULL;
+        int token;
+        xon_lexer_init(&lexer, doc, len);
+        while ((token = xon_lexer_next(&lexer, &data, &err)) > 0) {
+            free(data.sVal);
+            tokens++;
+        }
+        free(err);
+    }
+    elapsed = bench_now() - start;
+    bench_report("xon_lexer_next (token stream only)", iterations, len, elapsed);
+    printf("  %-40s %12.1f Mtok/s\n", "", (double)tokens / elapsed / 1e6);
+
+    start = bench_now();
+    for (i = 0; i < iterations / 20; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+        xon_free(root);
+    }
+    bench_report("xonify_buffer (lex + parse)", iterations / 20, len, bench_now() - start);
+    free(doc);
+}
+
+static char* bench_generate_flat(size_t count, int as_object, size_t* out_len) {
+    size_t cap = count * 24 + 16;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    out[len++] = as_object ? '{' : '[';
+    for (i = 0; i < count; i++) {
+        if (as_object) {
+            len += (size_t)snprintf(out + len, cap - len, "k%zu:%zu,", i, i);
+        } else {
+            len += (size_t)snprintf(out + len, cap - len, "%zu,", i);
+        }
+    }
+    out[len++] = as_object ? '}' : ']';
+    out[len] = '\0';
+    *out_len = len;
+    return out;
+}
+
+// Per-element cost should stay flat as N grows if construction is O(N).
+static void bench_list_scaling(void) {
+    static const size_t sizes[] = {1000, 10000, 100000, 1000000};
+    size_t s;
+    int as_object;
+
+    for (as_object = 0; as_object <= 1; as_object++) {
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            char label[64];
+            size_t len = 0;
+            size_t iterations = sizes[s] >= 1000000 ? 1 : 1000000 / sizes[s] / 10 + 1;
+            size_t i;
+            double start;
+            double elapsed;
+            char* doc = bench_generate_flat(sizes[s], as_object, &len);
+
+            if (!doc) return;
+            start = bench_now();
+            for (i = 0; i < iterations; i++) {
+                XonValue* root = xonify_buffer(doc, len);
+                if (!root) fprintf(stderr, "unexpected parse failure\n");
+                xon_free(root);
+            }
+            elapsed = bench_now() - start;
+            snprintf(label, sizeof(label), "%s of %zu elements", as_object ? "object" : "list", sizes[s]);
+            bench_report(label, iterations, len, elapsed);
+            printf("  %-40s %12.1f ns/element\n", "", elapsed * 1e9 / (double)iterations / (double)sizes[s]);
+            free(doc);
+        }
+    }
+}
+
+static long bench_max_rss_kb(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+enum { BENCH_PARSE_HEAP, BENCH_PARSE_ARENA, BENCH_PARSE_EVENTS };
+
+// Peak RSS is a high-water mark, so each mode is measured in a fresh child:
+// the growth of ru_maxrss across one parse is sent back over a pipe.
+static long bench_parse_peak_rss_kb(const char* doc, size_t len, int mode) {
+    int fds[2];
+    long growth = -1;
+    pid_t pid;
+
+    if (pipe(fds) != 0) return -1;
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        long before;
+        XonValue* root;
+        close(fds[0]);
+        xon_enable_arena(mode == BENCH_PARSE_ARENA);
+        before = bench_max_rss_kb();
+        if (mode == BENCH_PARSE_EVENTS) {
+            growth = xon_sax_parse_buffer(doc, len, NULL, NULL) == 1 ? bench_max_rss_kb() - before : -1;
+        } else {
+            root = xonify_buffer(doc, len);
+            growth = root ? bench_max_rss_kb() - before : -1;
+            xon_free(root);
+        }
+        if (write(fds[1], &growth, sizeof(growth)) != (ssize_t)sizeof(growth)) _exit(1);
+        _exit(0);
+    }
+    close(fds[1]);
+    if (read(fds[0], &growth, sizeof(growth)) != (ssize_t)sizeof(growth)) growth = -1;
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+    return growth;
+}
+
+static void bench_arena(void) {
+    size_t len = 0;
+    size_t iterations = 5;
+    int use_arena;
+    char* doc = bench_generate_document(100000, &len);
+
+    if (!doc) return;
+    // Measured before the timing loops so freed heap pages are not reused.
+    for (use_arena = 0; use_arena <= 1; use_arena++) {
+        char label[64];
+        long rss_kb = bench_parse_peak_rss_kb(doc, len, use_arena ? BENCH_PARSE_ARENA : BENCH_PARSE_HEAP);
+        snprintf(label, sizeof(label), "%s: peak RSS growth", use_arena ? "arena" : "heap");
+        printf("  %-40s %12ld KiB (input %zu KiB)\n", label, rss_kb, len / 1024);
+    }
+
+    for (use_arena = 0; use_arena <= 1; use_arena++) {
+        const char* mode = use_arena ? "arena" : "heap";
+        char label[64];
+        double parse_time = 0.0;
+        double free_time = 0.0;
+        double start;
+        size_t i;
+
+        xon_enable_arena(use_arena);
+        for (i = 0; i < iterations; i++) {
+            XonValue* root;
+            start = bench_now();
+            root = xonify_buffer(doc, len);
+            parse_time += bench_now() - start;
+            if (!root) fprintf(stderr, "unexpected parse failure\n");
+            start = bench_now();
+            xon_free(root);
+            free_time += bench_now() - start;
+        }
+        snprintf(label, sizeof(label), "%s: parse", mode);
+        bench_report(label, iterations, len, parse_time);
+        snprintf(label, sizeof(label), "%s: xon_free", mode);
+        bench_report(label, iterations, len, free_time);
+    }
+    xon_enable_arena(0);
+    free(doc);
+}
+
+static int bench_compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_report_latency(const char* label, double* samples, size_t count) {
+    qsort(samples, count, sizeof(double), bench_compare_double);
+    printf("  %-40s p50 %8.2f us   p99 %8.2f us   max %8.2f us\n", label,
+           samples[count / 2] * 1e6, samples[count * 99 / 100] * 1e6, samples[count - 1] * 1e6);
+}
+
+// Per-parse latency of a small request-sized document: one-shot parses pay
+// parser allocation and setup every time; a reused context does not.
+static void bench_small_latency(void) {
+    const char* doc = bench_small_document();
+    size_t len = strlen(doc);
+    size_t iterations = 20000;
+    size_t i;
+    double* samples = (double*)malloc(iterations * sizeof(double));
+    XonParser* parser = xon_parser_new();
+
+    if (!samples || !parser) {
+        free(samples);
+        xon_parser_free(parser);
+        return;
+    }
+
+    for (i = 0; i < iterations; i++) {
+        double start = bench_now();
+        XonValue* root = xonify_buffer(doc, len);
+        xon_free(root);
+        samples[i] = bench_now() - start;
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+    }
+    bench_report_latency("xonify_buffer + xon_free", samples, iterations);
+
+    for (i = 0; i < iterations; i++) {
+        double start = bench_now();
+        XonValue* root = xon_parser_parse(parser, doc, len);
+        xon_parser_reset(parser);
+        samples[i] = bench_now() - start;
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+    }
+    bench_report_latency("xon_parser_parse + xon_parser_reset", samples, iterations);
+
+    xon_parser_free(parser);
+    free(samples);
+}
+
+static int bench_count_event(void* user_data) {
+    (*(size_t*)user_data)++;
+    return 1;
+}
+
+static int bench_count_text(void* user_data, const char* text, size_t len) {
+    (void)text;
+    (void)len;
+    return bench_count_event(user_data);
+}
+
+static int bench_count_number(void* user_data, double value) {
+    (void)value;
+    return bench_count_event(user_data);
+}
+
+static int bench_count_bool(void* user_data, int value) {
+    (void)value;
+    return bench_count_event(user_data);
+}
+
+// Event parsing against building (and freeing) the tree, both for time and
+// for peak memory on the same large config.
+static void bench_sax(void) {
+    size_t len = 0;
+    size_t iterations = 5;
+    size_t events = 0;
+    size_t i;
+    double start;
+    double elapsed;
+    XonSaxHandler handler;
+    char* doc = bench_generate_document(100000, &len);
+
+    if (!doc) return;
+    printf("  %-40s %12ld KiB (input %zu KiB)\n", "tree (arena): peak RSS growth",
+           bench_parse_peak_rss_kb(doc, len, BENCH_PARSE_ARENA), len / 1024);
+    printf("  %-40s %12ld KiB (input %zu KiB)\n", "events: peak RSS growth",
+           bench_parse_peak_rss_kb(doc, len, BENCH_PARSE_EVENTS), len / 1024);
+
+    xon_enable_arena(1);
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+        xon_free(root);
+    }
+    bench_report("tree (arena): parse + free", iterations, len, bench_now() - start);
+    xon_enable_arena(0);
+
+    memset(&handler, 0, sizeof(handler));
+    handler.on_object_start = bench_count_event;
+    handler.on_object_end = bench_count_event;
+    handler.on_list_start = bench_count_event;
+    handler.on_list_end = bench_count_event;
+    handler.on_key = bench_count_text;
+    handler.on_string = bench_count_text;
+    handler.on_number = bench_count_number;
+    handler.on_bool = bench_count_bool;
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        if (xon_sax_parse_buffer(doc, len, &handler, &events) != 1) fprintf(stderr, "unexpected parse failure\n");
+    }
+    elapsed = bench_now() - start;
+    bench_report("events: xon_sax_parse_buffer", iterations, len, elapsed);
+    printf("  %-40s %12zu per document\n", "events delivered", events / iterations);
+    free(doc);
+}
+
+// Sparse reads from a large config: a handful of records out of 100k. The tree
+// path parses and frees everything; cursors skip unvisited records by bracket
+// matching. More lookups per document move the balance back towards the tree.
+static void bench_cursor(void) {
+    static const size_t lookup_counts[] = {1, 5, 50};
+    size_t records = 100000;
+    size_t len = 0;
+    size_t iterations = 5;
+    size_t c;
+    char* doc = bench_generate_document(records, &len);
+
+    if (!doc) return;
+    xon_enable_arena(1);
+    for (c = 0; c < sizeof(lookup_counts) / sizeof(lookup_counts[0]); c++) {
+        size_t lookups = lookup_counts[c];
+        double tree_sum = 0.0;
+        double cursor_sum = 0.0;
+        char label[64];
+        double start;
+        size_t i;
+        size_t k;
+
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonValue* root = xonify_buffer(doc, len);
+            XonValue* list = xon_object_get(root, "records");
+            for (k = 0; k < lookups; k++) {
+                XonValue* record = xon_list_get(list, (k + 1) * records / (lookups + 1));
+                tree_sum += xon_get_number(xon_object_get(record, "weight"));
+            }
+            xon_free(root);
+        }
+        snprintf(label, sizeof(label), "tree: %zu lookups", lookups);
+        bench_report(label, iterations, len, bench_now() - start);
+
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonDoc* xd = xon_doc_open(doc, len);
+            XonCursor root;
+            XonCursor list;
+            xon_doc_root(xd, &root);
+            xon_cursor_find_field(&root, "records", &list);
+            for (k = 0; k < lookups; k++) {
+                XonCursor record;
+                XonCursor weight;
+                double value = 0.0;
+                if (xon_cursor_at(&list, (k + 1) * records / (lookups + 1), &record) &&
+                    xon_cursor_find_field(&record, "weight", &weight)) {
+                    xon_cursor_get_number(&weight, &value);
+                }
+                cursor_sum += value;
+            }
+            xon_doc_close(xd);
+        }
+        snprintf(label, sizeof(label), "cursor: %zu lookups", lookups);
+        bench_report(label, iterations, len, bench_now() - start);
+        if (tree_sum != cursor_sum) fprintf(stderr, "cursor and tree disagree\n");
+    }
+    xon_enable_arena(0);
+    free(doc);
+}
+
+// Plain-data documents through the grammar and through the tape parser, both
+// into an arena. Stage 1 (the structural index) and the tape without a tree
+// are also timed on their own.
+static void bench_tape_one(const char* name, const char* doc, size_t len, size_t iterations) {
+    char label[64];
+    double start;
+    size_t i;
+    int use_tape;
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonStructuralIndex index;
+        if (!xon_structural_index(doc, len, &index)) fprintf(stderr, "unexpected index failure\n");
+        xon_structural_free(&index);
+    }
+    snprintf(label, sizeof(label), "%s: structural index", name);
+    bench_report(label, iterations, len, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonTape* tape = xon_tape_parse(doc, len);
+        if (!tape) fprintf(stderr, "unexpected tape failure\n");
+        xon_tape_free(tape);
+    }
+    snprintf(label, sizeof(label), "%s: xon_tape_parse + free", name);
+    bench_report(label, iterations, len, bench_now() - start);
+
+    for (use_tape = 0; use_tape <= 1; use_tape++) {
+        xon_enable_tape(use_tape);
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonValue* root = xonify_buffer(doc, len);
+            if (!root) fprintf(stderr, "unexpected parse failure\n");
+            xon_free(root);
+        }
+        snprintf(label, sizeof(label), "%s: %s parse + free", name, use_tape ? "tape" : "grammar");
+        bench_report(label, iterations, len, bench_now() - start);
+    }
+    xon_enable_tape(0);
+}
+
+static void bench_tape(void) {
+    size_t len = 0;
+    char* doc = bench_generate_document(100000, &len);
+
+    xon_enable_arena(1);
+    if (doc) bench_tape_one("config", doc, len, 5);
+    free(doc);
+    doc = bench_generate_strings(20000, &len);
+    if (doc) bench_tape_one("strings", doc, len, 10);
+    free(doc);
+    doc = bench_generate_numbers(200000, &len);
+    if (doc) bench_tape_one("numbers", doc, len, 10);
+    free(doc);
+    xon_enable_arena(0);
+}
+
+// Pretty-printed JSON: a list of records with strings, escapes, integers,
+// negative floats, booleans, nulls and nested lists.
+static char* bench_generate_json(size_t records, size_t* out_len) {
+    size_t cap = records * 256 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "[\n");
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "  {\n"
+            "    \"id\": %zu,\n"
+            "    \"name\": \"service-%zu\",\n"
+            "    \"path\": \"\\/srv\\/%zu\\n\",\n"
+            "    \"offset\": -%zu.%02zu,\n"
+            "    \"enabled\": %s,\n"
+            "    \"owner\": null,\n"
+            "    \"ports\": [%zu, %zu]\n"
+            "  }%s\n",
+            i, i, i % 100, i % 97, i % 100, (i % 3) ? "true" : "false", 8000 + i % 1000, 9000 + i % 1000,
+            i + 1 < records ? "," : "");
+    }
+    len += (size_t)snprintf(out + len, cap - len, "]\n");
+    *out_len = len;
+    return out;
+}
+
+static void bench_json_parse(const char* doc, size_t len, XonJsonMode mode, int tape, const char* label) {
+    size_t iterations = 5;
+    size_t i;
+    double start;
+
+    xon_set_json_mode(mode);
+    xon_enable_tape(tape);
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+        xon_free(root);
+    }
+    bench_report(label, iterations, len, bench_now() - start);
+    xon_enable_tape(0);
+    xon_set_json_mode(XON_JSON_DETECT);
+}
+
+// JSON ingestion and JSON -> XON conversion: the general lexer and grammar
+// (and the tape parser) against the dedicated JSON parser.
+static void bench_json(void) {
+    const char* path = "/tmp/xon_bench_json.json";
+    size_t len = 0;
+    double start;
+    char* doc = bench_generate_json(100000, &len);
+    FILE* out;
+    XonJsonMode mode;
+
+    if (!doc) return;
+    xon_enable_arena(1);
+    bench_json_parse(doc, len, XON_JSON_OFF, 0, "grammar parse + free (arena)");
+    bench_json_parse(doc, len, XON_JSON_OFF, 1, "tape parse + free");
+    bench_json_parse(doc, len, XON_JSON_ALWAYS, 0, "json parse + free");
+    xon_enable_arena(0);
+
+    for (mode = XON_JSON_OFF; mode <= XON_JSON_DETECT; mode++) {
+        xon_set_json_mode(mode == XON_JSON_OFF ? XON_JSON_OFF : XON_JSON_ALWAYS);
+        start = bench_now();
+        if (!xon_validate_buffer(doc, len)) fprintf(stderr, "unexpected validation failure\n");
+        bench_report(mode == XON_JSON_OFF ? "validate: event parser" : "validate: json events", 1, len,
+                     bench_now() - start);
+    }
+
+    if (!bench_write_file(path, doc, len)) {
+        free(doc);
+        return;
+    }
+    for (mode = XON_JSON_OFF; mode <= XON_JSON_DETECT; mode++) {
+        xon_set_json_mode(mode);
+        out = fopen("/dev/null", "w");
+        start = bench_now();
+        if (!out || !xon_convert_file(path, out, 0, 1)) fprintf(stderr, "unexpected conversion failure\n");
+        bench_report(mode == XON_JSON_OFF ? "convert to xon: event parser" : "convert to xon: json events", 1, len,
+                     bench_now() - start);
+        if (out) fclose(out);
+    }
+    xon_set_json_mode(XON_JSON_DETECT);
+    remove(path);
+    free(doc);
+}
+
+// Millions-of-records shape: a top-level list of small objects.
+static char* bench_generate_record_list(size_t records, size_t* out_len) {
+    size_t cap = records * 128 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    if (!out) return NULL;
+    len += (size_t)snprintf(out + len, cap - len, "[\n");
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(out + len, cap - len,
+            "  { id: %zu, name: \"service-%zu\", weight: %zu.%03zu, enabled: %s, tags: [\"a\", \"b\"] },\n",
+            i, i, i % 97, (i * 7) % 1000, (i % 3) ? "true" : "false");
+    }
+    len += (size_t)snprintf(out + len, cap - len, "]\n");
+    *out_len = len;
+    return out;
+}
+
+// Parallel parse of a large top-level list from 1 thread up to one per CPU.
+static void bench_parallel(void) {
+    size_t len = 0;
+    size_t iterations = 3;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    // Always include 2 threads, to show the split/join overhead on one CPU.
+    long max_threads = cpus < 2 ? 2 : cpus;
+    long threads;
+    double serial = 0.0;
+    char* doc = bench_generate_record_list(1000000, &len);
+
+    if (!doc) return;
+    printf("  %-40s %12ld\n", "online CPUs", cpus);
+    xon_enable_arena(1);
+    for (threads = 1; threads <= max_threads;
+         threads = threads * 2 > max_threads && threads < max_threads ? max_threads : threads * 2) {
+        char label[64];
+        double start;
+        double elapsed;
+        size_t i;
+
+        xon_set_parse_threads((int)threads);
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonValue* root = xonify_buffer(doc, len);
+            if (!root) fprintf(stderr, "unexpected parse failure\n");
+            xon_free(root);
+        }
+        elapsed = bench_now() - start;
+        if (threads == 1) serial = elapsed;
+        snprintf(label, sizeof(label), "%ld thread%s: parse + free", threads, threads == 1 ? "" : "s");
+        bench_report(label, iterations, len, elapsed);
+        printf("  %-40s %12.2fx\n", "speedup", serial / elapsed);
+    }
+    xon_set_parse_threads(1);
+    xon_enable_arena(0);
+    free(doc);
+}
+
+// Large config fed in network-sized chunks vs. parsed from one buffer.
+static void bench_stream(void) {
+    static const size_t chunk_sizes[] = {64, 1500, 65536};
+    size_t len = 0;
+    size_t iterations = 5;
+    size_t c;
+    size_t i;
+    double start;
+    char* doc = bench_generate_document(100000, &len);
+
+    if (!doc) return;
+    xon_enable_arena(1);
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        XonValue* root = xonify_buffer(doc, len);
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+        xon_free(root);
+    }
+    bench_report("xonify_buffer: whole document", iterations, len, bench_now() - start);
+
+    for (c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        char label[64];
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonStream* stream = xon_stream_new();
+            XonValue* root;
+            size_t at;
+            for (at = 0; at < len; at += chunk_sizes[c]) {
+                xon_stream_feed(stream, doc + at, len - at < chunk_sizes[c] ? len - at : chunk_sizes[c]);
+            }
+            root = xon_stream_finish(stream);
+            if (!root) fprintf(stderr, "unexpected parse failure\n");
+            xon_free(root);
+        }
+        snprintf(label, sizeof(label), "xon_stream_feed: %zu-byte chunks", chunk_sizes[c]);
+        bench_report(label, iterations, len, bench_now() - start);
+    }
+    xon_enable_arena(0);
+    free(doc);
+}
+
+static int bench_count_record(void* user_data, size_t index, const XonValue* value) {
+    (void)index;
+    if (value) (*(size_t*)user_data)++;
+    return 1;
+}
+
+// 200k XON-lines records parsed and evaluated from 1 thread up to one per CPU.
+static void bench_records(void) {
+    size_t records = 200000;
+    size_t cap = records * 128;
+    size_t len = 0;
+    size_t i;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    long max_threads = cpus < 2 ? 2 : cpus;
+    long threads;
+    char* doc = (char*)malloc(cap);
+
+    if (!doc) return;
+    for (i = 0; i < records; i++) {
+        len += (size_t)snprintf(doc + len, cap - len,
+            "{ id: %zu, name: \"service-%zu\", weight: %zu.5, limit: %zu * 2, tags: [\"a\", \"b\"] }\n",
+            i, i, i % 97, i);
+    }
+    for (threads = 1; threads <= max_threads;
+         threads = threads * 2 > max_threads && threads < max_threads ? max_threads : threads * 2) {
+        XonRecordOptions options;
+        char label[64];
+        size_t delivered = 0;
+        double start;
+        FILE* in = fmemopen(doc, len, "r");
+
+        if (!in) break;
+        memset(&options, 0, sizeof(options));
+        options.threads = (int)threads;
+        options.evaluate = 1;
+        start = bench_now();
+        if (xon_records_parse(in, &options, bench_count_record, &delivered) != 1 || delivered != records) {
+            fprintf(stderr, "unexpected record failure\n");
+        }
+        snprintf(label, sizeof(label), "%ld thread%s: parse + eval", threads, threads == 1 ? "" : "s");
+        bench_report(label, 1, len, bench_now() - start);
+        fclose(in);
+    }
+    free(doc);
+}
+
+static void bench_validate_one(const char* name, const char* doc, size_t len, size_t iterations) {
+    char label[64];
+    size_t i;
+    double start;
+    int arena;
+
+    for (arena = 0; arena <= 1; arena++) {
+        xon_enable_arena(arena);
+        start = bench_now();
+        for (i = 0; i < iterations; i++) {
+            XonValue* root = xonify_buffer(doc, len);
+            if (!root) fprintf(stderr, "unexpected parse failure\n");
+            xon_free(root);
+        }
+        snprintf(label, sizeof(label), "%s: xonify + free (%s)", name, arena ? "arena" : "heap");
+        bench_report(label, iterations, len, bench_now() - start);
+    }
+    xon_enable_arena(0);
+
+    start = bench_now();
+    for (i = 0; i < iterations; i++) {
+        if (xon_validate_buffer(doc, len) != 1) fprintf(stderr, "unexpected parse failure\n");
+    }
+    snprintf(label, sizeof(label), "%s: xon_validate_buffer", name);
+    bench_report(label, iterations, len, bench_now() - start);
+}
+
+// CI-style validation of many small configs: building and freeing the tree
+// (what `xon validate` used to do) against the allocation-free check.
+static void bench_validate(void) {
+    size_t len = 0;
+    char* doc = bench_generate_document(100, &len);
+
+    if (doc) bench_validate_one("data", doc, len, 5000);
+    free(doc);
+    doc = bench_generate_expressions(100, &len);
+    if (doc) bench_validate_one("expressions", doc, len, 5000);
+    free(doc);
+}
+
+// A large config with ten broken records: one recovering pass that lists all
+// of them, against the fix-and-rerun loop where each validation stops at the
+// first remaining error.
+static void bench_diagnose(void) {
+    enum { ERRORS = 10 };
+    char* broken[ERRORS];
+    size_t len = 0;
+    size_t count = 0;
+    size_t i;
+    double start;
+    char* doc = bench_generate_document(100000, &len);
+
+    if (!doc) return;
+    // Drop the comma after "id: N" in records spread through the document.
+    for (i = 0; i < ERRORS; i++) {
+        broken[i] = strstr(doc + len / ERRORS * i, "id: ");
+        if (broken[i]) broken[i] = strchr(broken[i], ',');
+        if (broken[i]) *broken[i] = ' ';
+    }
+
+    start = bench_now();
+    xon_diagnose_buffer(doc, len, NULL, &count);
+    bench_report("one pass: xon_diagnose_buffer", 1, len, bench_now() - start);
+    printf("  %-40s %12zu\n", "errors found", count);
+
+    start = bench_now();
+    for (i = 0; i <= ERRORS; i++) {
+        xon_validate_buffer(doc, len);
+        if (i < ERRORS && broken[i]) *broken[i] = ',';
+    }
+    bench_report("fix and rerun: xon_validate_buffer", 1, len, bench_now() - start);
+    free(doc);
+}
+
+// Keystrokes in a 50k-line config: each edit types or deletes one digit of
+// a record's weight. The incremental document reparses the record around the
+// edit; the baseline reparses the whole text, as a full validate would.
+static void bench_incremental(void) {
+    enum { EDITS = 2000, FULL = 20 };
+    size_t len = 0;
+    size_t lines = 0;
+    size_t i;
+    double* samples = (double*)malloc(EDITS * sizeof(double));
+    char* doc = bench_generate_document(7200, &len);
+    XonIncremental* inc = doc ? xon_incremental_new(doc, len) : NULL;
+
+    if (!samples || !inc) {
+        free(samples);
+        free(doc);
+        xon_incremental_free(inc);
+        return;
+    }
+    for (i = 0; i < len; i++) lines += doc[i] == '\n';
+    printf("  %-40s %12zu\n", "lines", lines);
+
+    for (i = 0; i < EDITS; i++) {
+        size_t text_len;
+        const char* text = xon_incremental_text(inc, &text_len);
+        const char* at = strstr(text + text_len / EDITS * (i / 2 * 2), "weight: ");
+        size_t offset = at ? (size_t)(at - text) + 8 : 0;
+        double start = bench_now();
+        int ok = (i % 2 == 0) ? xon_incremental_edit(inc, offset, 0, "7", 1)
+                              : xon_incremental_edit(inc, offset, 1, NULL, 0);
+        samples[i] = bench_now() - start;
+        if (!at || !ok) fprintf(stderr, "unexpected incremental failure\n");
+    }
+    bench_report_latency("xon_incremental_edit", samples, EDITS);
+
+    for (i = 0; i < FULL; i++) {
+        double start = bench_now();
+        XonValue* root = xonify_buffer(doc, len);
+        xon_free(root);
+        samples[i] = bench_now() - start;
+        if (!root) fprintf(stderr, "unexpected parse failure\n");
+    }
+    bench_report_latency("full reparse: xonify_buffer + xon_free", samples, FULL);
+
+    xon_incremental_free(inc);
+    free(samples);
+    free(doc);
+}
+
+// xon_object_get latency by object size, spread over all keys of a parsed
+// object and of its evaluated copy (member access in expressions takes the
+// same path). Objects below the index threshold are scanned linearly.
+static void bench_object_lookup(void) {
+    static const size_t sizes[] = {8, 16, 64, 1000, 100000};
+    enum { LOOKUPS = 200000 };
+    size_t s;
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        char label[64];
+        size_t len = 0;
+        size_t i;
+        size_t found = 0;
+        double start;
+        double elapsed;
+        char* doc = bench_generate_flat(sizes[s], 1, &len);
+        XonValue* root = doc ? xonify_buffer(doc, len) : NULL;
+        XonValue* evaluated = root ? xon_eval(root) : NULL;
+        char (*keys)[24] = (char (*)[24])malloc(sizes[s] * sizeof(*keys));
+
+        if (!evaluated || !keys) {
+            fprintf(stderr, "unexpected parse failure\n");
+            free(keys);
+            xon_free(evaluated);
+            xon_free(root);
+            free(doc);
+            return;
+        }
+        for (i = 0; i < sizes[s]; i++) snprintf(keys[i], sizeof(keys[i]), "k%zu", i);
+        start = bench_now();
+        for (i = 0; i < LOOKUPS; i++) {
+            found += xon_object_get(i % 2 ? evaluated : root, keys[i * 7919 % sizes[s]]) != NULL;
+        }
+        elapsed = bench_now() - start;
+        if (found != LOOKUPS) fprintf(stderr, "unexpected lookup failure\n");
+        snprintf(label, sizeof(label), "object of %zu keys", sizes[s]);
+        printf("  %-40s %12.1f ns/lookup\n", label, elapsed * 1e9 / LOOKUPS);
+        free(keys);
+        xon_free(evaluated);
+        xon_free(root);
+        free(doc);
+    }
+}
+
+// Index-based iteration, as the Node and Python bindings do it: per-element
+// cost of xon_list_get and xon_object_key_at/value_at over whole containers.
+static void bench_indexed_access(void) {
+    static const size_t sizes[] = {1000, 10000, 100000};
+    size_t s;
+    int as_object;
+
+    for (as_object = 0; as_object <= 1; as_object++) {
+        for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            char label[64];
+            size_t len = 0;
+            size_t i;
+            size_t seen = 0;
+            double start;
+            double elapsed;
+            char* doc = bench_generate_flat(sizes[s], as_object, &len);
+            XonValue* root = doc ? xonify_buffer(doc, len) : NULL;
+
+            if (!root) {
+                fprintf(stderr, "unexpected parse failure\n");
+                free(doc);
+                return;
+            }
+            start = bench_now();
+            if (as_object) {
+                size_t size = xon_object_size(root);
+                for (i = 0; i < size; i++) {
+                    seen += xon_object_key_at(root, i) != NULL && xon_object_value_at(root, i) != NULL;
+                }
+            } else {
+                size_t size = xon_list_size(root);
+                for (i = 0; i < size; i++) seen += xon_list_get(root, i) != NULL;
+            }
+            elapsed = bench_now() - start;
+            if (seen != sizes[s]) fprintf(stderr, "unexpected access failure\n");
+            snprintf(label, sizeof(label), "%s of %zu elements", as_object ? "object" : "list", sizes[s]);
+            printf("  %-40s %12.1f ns/element\n", label, elapsed * 1e9 / (double)sizes[s]);
+            xon_free(root);
+            free(doc);
+        }
+    }
+}
+
+// Whole-container walks of a 100k-element list and object: index-based loops
+// (what the bindings used) against xon_iter.
+static void bench_iterate(void) {
+    enum { COUNT = 100000, ROUNDS = 20 };
+    int as_object;
+
+    for (as_object = 0; as_object <= 1; as_object++) {
+        char label[64];
+        size_t len = 0;
+        size_t seen = 0;
+        size_t round;
+        size_t i;
+        double start;
+        char* doc = bench_generate_flat(COUNT, as_object, &len);
+        XonValue* root = doc ? xonify_buffer(doc, len) : NULL;
+        const char* kind = as_object ? "object" : "list";
+
+        if (!root) {
+            fprintf(stderr, "unexpected parse failure\n");
+            free(doc);
+            return;
+        }
+        start = bench_now();
+        for (round = 0; round < ROUNDS; round++) {
+            if (as_object) {
+                size_t size = xon_object_size(root);
+                for (i = 0; i < size; i++) {
+                    seen += xon_object_key_at(root, i) != NULL && xon_object_value_at(root, i) != NULL;
+                }
+            } else {
+                size_t size = xon_list_size(root);
+                for (i = 0; i < size; i++) seen += xon_list_get(root, i) != NULL;
+            }
+        }
+        snprintf(label, sizeof(label), "%s: by index", kind);
+        printf("  %-40s %12.2f ns/element\n", label, (bench_now() - start) * 1e9 / ROUNDS / COUNT);
+
+        start = bench_now();
+        for (round = 0; round < ROUNDS; round++) {
+            XonIter it;
+            const char* key;
+            XonValue* value;
+            xon_iter_begin(root, &it);
+            while (xon_iter_next(&it, &key, &value)) seen += value != NULL;
+        }
+        snprintf(label, sizeof(label), "%s: xon_iter", kind);
+        printf("  %-40s %12.2f ns/element\n", label, (bench_now() - start) * 1e9 / ROUNDS / COUNT);
+
+        if (seen != 2 * ROUNDS * COUNT) fprintf(stderr, "unexpected iteration count\n");
+        xon_free(root);
+        free(doc);
+    }
+}
+
+// Repeated deep reads from a config with 1000 services: hand-chained
+// xon_object_get/xon_list_get calls against one compiled path, and against
+// compiling the path on every read.
+static void bench_path_query(void) {
+    enum { SERVICES = 1000, READS = 200000 };
+    size_t cap = SERVICES * 160 + 64;
+    size_t len = 0;
+    size_t i;
+    double sum = 0.0;
+    double start;
+    char* doc = (char*)malloc(cap);
+    XonValue* root;
+    XonPath* path;
+
+    if (!doc) return;
+    len += (size_t)snprintf(doc + len, cap - len, "{ services: {");
+    for (i = 0; i < SERVICES; i++) {
+        len += (size_t)snprintf(doc + len, cap - len,
+                                " svc%zu: { port: %zu, limits: [{burst: 1}, {burst: 2}, {burst: 3}, {burst: %zu}] },",
+                                i, 8000 + i, i);
+    }
+    len += (size_t)snprintf(doc + len, cap - len, " } }");
+    root = xonify_buffer(doc, len);
+    path = xon_path_compile("services.svc500.limits[3].burst");
+    if (!root || !path) {
+        fprintf(stderr, "unexpected parse failure\n");
+        xon_path_free(path);
+        xon_free(root);
+        free(doc);
+        return;
+    }
+
+    start = bench_now();
+    for (i = 0; i < READS; i++) {
+        XonValue* services = xon_object_get(root, "services");
+        XonValue* service = xon_object_get(services, "svc500");
+        XonValue* limits = xon_object_get(service, "limits");
+        sum += xon_get_number(xon_object_get(xon_list_get(limits, 3), "burst"));
+    }
+    printf("  %-40s %12.1f ns/read\n", "hand-chained lookups", (bench_now() - start) * 1e9 / READS);
+
+    start = bench_now();
+    for (i = 0; i < READS; i++) sum += xon_get_number(xon_path_eval(path, root));
+    printf("  %-40s %12.1f ns/read\n", "xon_path_eval (compiled once)", (bench_now() - start) * 1e9 / READS);
+
+    start = bench_now();
+    for (i = 0; i < READS; i++) {
+        XonPath* once = xon_path_compile("services.svc500.limits[3].burst");
+        sum += xon_get_number(xon_path_eval(once, root));
+        xon_path_free(once);
+    }
+    printf("  %-40s %12.1f ns/read\n", "xon_path_compile + eval per read", (bench_now() - start) * 1e9 / READS);
+
+    if (sum != 3.0 * READS * 500) fprintf(stderr, "unexpected query result\n");
+    xon_path_free(path);
+    xon_free(root);
+    free(doc);
+}
+
+typedef struct {
+    const char* name;
+    const char* region;
+    int id;
+    int port;
+    int replicas;
+    double weight;
+    double timeout;
+    int enabled;
+} BenchRecord;
+
+// One 64-field (indexed) object read 20k times: a hashed xon_object_get per
+// field, against xon_extract matching members in order.
+static void bench_extract_wide(void) {
+    enum { FIELDS = 64, READS = 20000 };
+    XonFieldDesc fields[FIELDS];
+    char keys[FIELDS][8];
+    int values[FIELDS];
+    char doc[FIELDS * 16 + 4];
+    size_t len = 0;
+    size_t i;
+    size_t j;
+    long checksum = 0;
+    double start;
+    XonValue* root;
+
+    memset(fields, 0, sizeof(fields));
+    doc[len++] = '{';
+    for (i = 0; i < FIELDS; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "f%zu", i);
+        fields[i].key = keys[i];
+        fields[i].type = XON_FIELD_INT;
+        fields[i].offset = i * sizeof(int);
+        len += (size_t)snprintf(doc + len, sizeof(doc) - len, "%s: %zu,", keys[i], i);
+    }
+    doc[len++] = '}';
+    root = xonify_buffer(doc, len);
+    if (!root) {
+        fprintf(stderr, "unexpected parse failure\n");
+        return;
+    }
+
+    start = bench_now();
+    for (i = 0; i < READS; i++) {
+        for (j = 0; j < FIELDS; j++) values[j] = (int)xon_get_number(xon_object_get(root, keys[j]));
+        checksum += values[FIELDS - 1];
+    }
+    bench_report("64 fields, xon_object_get per field", READS, len, bench_now() - start);
+
+    start = bench_now();
+    for (i = 0; i < READS; i++) {
+        if (!xon_extract(root, fields, FIELDS, values)) break;
+        checksum -= values[FIELDS - 1];
+    }
+    bench_report("64 fields, xon_extract", READS, len, bench_now() - start);
+
+    if (checksum != 0) fprintf(stderr, "unexpected checksum\n");
+    xon_free(root);
+}
+
+// 100k eight-field records loaded into structs: one xon_object_get and getter
+// per field, against xon_extract_list's single pass over each record.
+static void bench_extract(void) {
+    static const XonFieldDesc fields[] = {
+        XON_FIELD(BenchRecord, name, "name", XON_FIELD_STRING),
+        XON_FIELD(BenchRecord, region, "region", XON_FIELD_STRING),
+        XON_FIELD(BenchRecord, id, "id", XON_FIELD_INT),
+        XON_FIELD(BenchRecord, port, "port", XON_FIELD_INT),
+        XON_FIELD(BenchRecord, replicas, "replicas", XON_FIELD_INT),
+        XON_FIELD(BenchRecord, weight, "weight", XON_FIELD_DOUBLE),
+        XON_FIELD(BenchRecord, timeout, "timeout", XON_FIELD_DOUBLE),
+        XON_FIELD(BenchRecord, enabled, "enabled", XON_FIELD_BOOL),
+    };
+    enum { RECORDS = 100000 };
+    size_t cap = (size_t)RECORDS * 160 + 16;
+    size_t len = 0;
+    size_t count = 0;
+    size_t i;
+    long checksum = 0;
+    double start;
+    char* doc = (char*)malloc(cap);
+    BenchRecord* records = (BenchRecord*)malloc(RECORDS * sizeof(BenchRecord));
+    XonValue* root = NULL;
+    XonIter it;
+    XonValue* item;
+
+    if (doc && records) {
+        doc[len++] = '[';
+        for (i = 0; i < RECORDS; i++) {
+            len += (size_t)snprintf(doc + len, cap - len,
+                                    "{name: \"svc-%zu\", region: \"eu\", id: %zu, port: %zu, replicas: 3,"
+                                    " weight: 0.5, timeout: 1.5, enabled: true},",
+                                    i, i, 8000 + i % 1000);
+        }
+        doc[len++] = ']';
+        root = xonify_buffer(doc, len);
+    }
+    if (!root) {
+        fprintf(stderr, "unexpected parse failure\n");
+        free(records);
+        free(doc);
+        return;
+    }
+
+    start = bench_now();
+    xon_iter_begin(root, &it);
+    for (i = 0; xon_iter_next(&it, NULL, &item); i++) {
+        BenchRecord* r = &records[i];
+        r->name = xon_get_string(xon_object_get(item, "name"));
+        r->region = xon_get_string(xon_object_get(item, "region"));
+        r->id = (int)xon_get_number(xon_object_get(item, "id"));
+        r->port = (int)xon_get_number(xon_object_get(item, "port"));
+        r->replicas = (int)xon_get_number(xon_object_get(item, "replicas"));
+        r->weight = xon_get_number(xon_object_get(item, "weight"));
+        r->timeout = xon_get_number(xon_object_get(item, "timeout"));
+        r->enabled = xon_get_bool(xon_object_get(item, "enabled"));
+        checksum += r->port;
+    }
+    bench_report("xon_object_get per field", RECORDS, len / RECORDS, bench_now() - start);
+
+    start = bench_now();
+    if (!xon_extract_list(root, fields, sizeof(fields) / sizeof(fields[0]), records, sizeof(BenchRecord), RECORDS,
+                          &count) || count != RECORDS) {
+        fprintf(stderr, "unexpected extract failure\n");
+    }
+    bench_report("xon_extract_list", RECORDS, len / RECORDS, bench_now() - start);
+    for (i = 0; i < RECORDS; i++) checksum -= records[i].port;
+
+    if (checksum != 0) fprintf(stderr, "unexpected checksum\n");
+    xon_free(root);
+    free(records);
+    free(doc);
+    bench_extract_wide();
+}
+
+static const BenchCase BENCH_CASES[] = {
+    {"string_parse", "small document parse vs. legacy tmpfile() round trip", bench_string_parse},
+    {"large_file", "generated config parsed from disk and from memory", bench_large_file},
+    {"comment_skip", "comment-heavy input across whitespace/comment skip kernels", bench_comment_skip},
+    {"string_scan", "string-heavy input across string scan kernels", bench_string_scan},
+    {"number_parse", "numeric array literals: span parser vs. legacy strtod path", bench_number_parse},
+    {"identifier_lex", "identifier/keyword-heavy expression config", bench_identifier_lex},
+    {"list_scaling", "flat list/object construction from 1k to 1M elements", bench_list_scaling},
+    {"arena", "large config: heap vs. per-document arena parse, free and peak RSS", bench_arena},
+    {"small_latency", "small-document parse latency: one-shot vs. reusable parser context", bench_small_latency},
+    {"sax", "large config: event parsing vs. building the tree, time and peak RSS", bench_sax},
+    {"cursor", "sparse field reads from a large config: full tree vs. on-demand cursor", bench_cursor},
+    {"tape", "plain-data documents: grammar vs. two-stage structural-index parser", bench_tape},
+    {"json", "large JSON document: general parsers vs. the dedicated JSON parser", bench_json},
+    {"parallel", "1M-record top-level list: parse scaling from 1 thread to one per CPU", bench_parallel},
+    {"stream", "large config pushed in 64 B to 64 KiB chunks vs. one buffer", bench_stream},
+    {"records", "XON-lines record stream, parse + eval from 1 thread up to one per CPU", bench_records},
+    {"validate", "many small configs: parse + free vs. allocation-free validation", bench_validate},
+    {"diagnose", "large config with 10 errors: all diagnostics in one pass vs. fix and rerun", bench_diagnose},
+    {"incremental", "single-character edits in a 50k-line config: incremental vs. full reparse", bench_incremental},
+    {"object_lookup", "xon_object_get latency by object size", bench_object_lookup},
+    {"indexed_access", "whole-container iteration by index: xon_list_get, xon_object_key_at/value_at", bench_indexed_access},
+    {"iterate", "100k-element list and object: index-based loops vs. xon_iter", bench_iterate},
+    {"path_query", "deep reads: hand-chained lookups vs. compiled xon_path", bench_path_query},
+    {"extract", "100k records into structs: per-field lookups vs. xon_extract_list", bench_extract},
+};
+
+int main(int argc, char** argv) {
+    size_t case_count = sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]);
+    size_t i;
+    int j;
+    int ran = 0;
+
+    xon_set_log_level(XON_LOG_ERROR);
+
+    for (i = 0; i < case_count; i++) {
+        int selected = argc < 2;
+        for (j = 1; j < argc; j++) {
+            if (strcmp(argv[j], BENCH_CASES[i].name) == 0) selected = 1;
+        }
+        if (!selected) continue;
+        printf("%s: %s\n", BENCH_CASES[i].name, BENCH_CASES[i].summary);
+        BENCH_CASES[i].run();
+        ran++;
+    }
+
+    if (!ran) {
+        fprintf(stderr, "Unknown benchmark. Available:");
+        for (i = 0; i < case_count; i++) fprintf(stderr, " %s", BENCH_CASES[i].name);
+        fprintf(stderr, "\n");
+        return 1;
+    }
+
+    xon_shutdown_logging();
+    return 0;
+}
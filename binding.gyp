@@ -6,14 +6,23 @@
         "bindings/xon_node.cpp", 
         "src/xon_api.c", 
         "src/lexer.c",
-        "src/logger.c"
+        "src/logger.c",
+        "src/input.c",
+        "src/scan.c",
+        "src/number.c",
+        "src/arena.c",
+        "src/intern.c",
+        "src/structural.c"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
         "include",
         "build"
       ],
-      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS", "_GNU_SOURCE" ],
+      "conditions": [
+        [ "OS!='win'", { "libraries": [ "-lpthread", "-lm" ] } ]
+      ],
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
       "xcode_settings": {
@@ -5,7 +5,7 @@ import json
 import os
 import sys
 from pathlib import Path
-from typing import Any, Dict, Optional
+from typing import Any, Dict, Iterator, Optional, Tuple
 
 XON_TYPE_NULL = 0
 XON_TYPE_BOOL = 1
@@ -15,6 +15,10 @@ XON_TYPE_OBJECT = 4
 XON_TYPE_LIST = 5
 
 
+class _XonIter(ctypes.Structure):
+    _fields_ = [("next", ctypes.c_void_p), ("is_object", ctypes.c_int)]
+
+
 def _is_identifier(key: str) -> bool:
     if not key:
         return False
@@ -96,6 +100,9 @@ class XonParser:
         self._lib.xonify_string.argtypes = [ctypes.c_char_p]
         self._lib.xonify_string.restype = ctypes.c_void_p
 
+        self._lib.xonify_buffer.argtypes = [ctypes.c_char_p, ctypes.c_size_t]
+        self._lib.xonify_buffer.restype = ctypes.c_void_p
+
         self._lib.xon_free.argtypes = [ctypes.c_void_p]
         self._lib.xon_free.restype = None
 
@@ -109,7 +116,10 @@ class XonParser:
         self._lib.xon_get_number.restype = ctypes.c_double
 
         self._lib.xon_get_string.argtypes = [ctypes.c_void_p]
-        self._lib.xon_get_string.restype = ctypes.c_char_p
+        self._lib.xon_get_string.restype = ctypes.c_void_p
+
+        self._lib.xon_get_string_length.argtypes = [ctypes.c_void_p]
+        self._lib.xon_get_string_length.restype = ctypes.c_size_t
 
         self._lib.xon_object_size.argtypes = [ctypes.c_void_p]
         self._lib.xon_object_size.restype = ctypes.c_size_t
@@ -126,6 +136,25 @@ class XonParser:
         self._lib.xon_list_get.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
         self._lib.xon_list_get.restype = ctypes.c_void_p
 
+        self._lib.xon_iter_begin.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+        self._lib.xon_iter_begin.restype = ctypes.c_int
+
+        # Plain addresses: ctypes converts them faster than byref() objects.
+        self._lib.xon_iter_next.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+        self._lib.xon_iter_next.restype = ctypes.c_int
+
+    def _iterate(self, node_ptr: int, with_keys: bool) -> Iterator[Tuple[Optional[bytes], Optional[int]]]:
+        it = _XonIter()
+        key = ctypes.c_char_p()
+        value = ctypes.c_void_p()
+        it_ref = ctypes.addressof(it)
+        key_ref = ctypes.addressof(key) if with_keys else None
+        value_ref = ctypes.addressof(value)
+        step = self._lib.xon_iter_next
+        self._lib.xon_iter_begin(node_ptr, it_ref)
+        while step(it_ref, key_ref, value_ref):
+            yield key.value, value.value
+
     def _to_python(self, node_ptr: int) -> Any:
         if not node_ptr:
             return None
@@ -143,19 +172,17 @@ class XonParser:
             return float(num)
         if value_type == XON_TYPE_STRING:
             raw = self._lib.xon_get_string(node_ptr)
-            return raw.decode("utf-8") if raw else ""
+            if not raw:
+                return ""
+            return ctypes.string_at(raw, self._lib.xon_get_string_length(node_ptr)).decode("utf-8")
         if value_type == XON_TYPE_OBJECT:
-            size = self._lib.xon_object_size(node_ptr)
             out: Dict[str, Any] = {}
-            for idx in range(size):
-                raw_key = self._lib.xon_object_key_at(node_ptr, idx)
-                value_ptr = self._lib.xon_object_value_at(node_ptr, idx)
+            for raw_key, value_ptr in self._iterate(node_ptr, True):
                 if raw_key:
                     out[raw_key.decode("utf-8")] = self._to_python(value_ptr)
             return out
         if value_type == XON_TYPE_LIST:
-            size = self._lib.xon_list_size(node_ptr)
-            return [self._to_python(self._lib.xon_list_get(node_ptr, idx)) for idx in range(size)]
+            return [self._to_python(value_ptr) for _, value_ptr in self._iterate(node_ptr, False)]
 
         return None
 
@@ -169,7 +196,8 @@ class XonParser:
             self._lib.xon_free(node)
 
     def parse_string(self, content: str) -> Any:
-        node = self._lib.xonify_string(content.encode("utf-8"))
+        encoded = content.encode("utf-8")
+        node = self._lib.xonify_buffer(encoded, len(encoded))
         if not node:
             raise ValueError("Failed to parse Xon string content")
         try:
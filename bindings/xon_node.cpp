@@ -22,16 +22,17 @@ Napi::Value ConvertToJS(Napi::Env env, const XonValue* value) {
         
         case XON_TYPE_STRING: {
             const char* str = xon_get_string(value);
-            return str ? Napi::String::New(env, str) : env.Null();
+            return str ? Napi::String::New(env, str, xon_get_string_length(value)) : env.Null();
         }
         
         case XON_TYPE_OBJECT: {
             Napi::Object obj = Napi::Object::New(env);
-            size_t size = xon_object_size(value);
+            XonIter it;
+            const char* key;
+            XonValue* item;
 
-            for (size_t i = 0; i < size; i++) {
-                const char* key = xon_object_key_at(value, i);
-                XonValue* item = xon_object_value_at(value, i);
+            xon_iter_begin(value, &it);
+            while (xon_iter_next(&it, &key, &item)) {
                 if (key) {
                     obj.Set(key, ConvertToJS(env, item));
                 }
@@ -43,10 +44,13 @@ Napi::Value ConvertToJS(Napi::Env env, const XonValue* value) {
         case XON_TYPE_LIST: {
             size_t size = xon_list_size(value);
             Napi::Array arr = Napi::Array::New(env, size);
-            
-            for (size_t i = 0; i < size; i++) {
-                XonValue* item = xon_list_get(value, i);
-                arr[i] = ConvertToJS(env, item);
+            XonIter it;
+            XonValue* item;
+            uint32_t i = 0;
+
+            xon_iter_begin(value, &it);
+            while (xon_iter_next(&it, NULL, &item)) {
+                arr[i++] = ConvertToJS(env, item);
             }
             return arr;
         }
@@ -102,7 +106,7 @@ Napi::Value XonifyString(const Napi::CallbackInfo& info) {
     }
 
     std::string content = info[0].As<Napi::String>();
-    XonValue* result = xonify_string(content.c_str());
+    XonValue* result = xonify_buffer(content.data(), content.size());
     
     if (!result) {
         Napi::Error::New(env, "Failed to parse string").ThrowAsJavaScriptException();
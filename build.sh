@@ -55,15 +55,15 @@ fi
 
 # Build shared library
 echo "📚 Building libxon.${LIB_EXT}..."
-gcc $LIB_FLAGS -Wall -Wextra -std=c99 -Iinclude \
+gcc $LIB_FLAGS -Wall -Wextra -std=c99 -D_GNU_SOURCE -Iinclude \
     -o libxon.${LIB_EXT} \
-    src/xon_api.c src/lexer.c src/logger.c
+    src/xon_api.c src/lexer.c src/logger.c src/input.c src/scan.c src/number.c src/arena.c src/intern.c src/structural.c -lpthread -lm
 
 # Build CLI tool
 echo "🔧 Building xon CLI..."
-gcc -Wall -Wextra -std=c99 -Iinclude \
+gcc -Wall -Wextra -std=c99 -D_GNU_SOURCE -Iinclude \
     -o xon \
-    src/main.c src/xon_api.c src/lexer.c src/logger.c
+    src/main.c src/xon_api.c src/lexer.c src/logger.c src/input.c src/scan.c src/number.c src/arena.c src/intern.c src/structural.c -lpthread -lm
 
 # Build example program
 echo "📝 Building example program..."
@@ -37,6 +37,17 @@ XonValue* xonify(const char* filename);
 // Parse .xon from a string (Brand: xonify_string)
 XonValue* xonify_string(const char* xon_string);
 
+// Parse .xon from an in-memory buffer of len bytes (need not be NUL-terminated).
+// The buffer is lexed in place; no temporary files or copies are made.
+XonValue* xonify_buffer(const char* data, size_t len);
+
+// Check syntax without building a tree. Data is checked by the event parser
+// without copying strings, and expressions by the grammar with no-op actions,
+// so no nodes or strings are allocated. Accepts exactly what xonify() accepts.
+// Returns 1 if valid, 0 otherwise (errors are reported).
+int xon_validate_buffer(const char* data, size_t len);
+int xon_validate_file(const char* filename);
+
 // Evaluate parsed XON expression/object with runtime semantics (variables, functions, built-ins).
 // Caller must free the returned XonValue with xon_free().
 XonValue* xon_eval(const XonValue* value);
@@ -44,6 +55,184 @@ XonValue* xon_eval(const XonValue* value);
 // Free memory
 void xon_free(XonValue* value);
 
+// Parse subsequent documents into a per-document arena (default: off).
+// Nodes and strings are bump-allocated in large chunks, and xon_free() on the
+// root releases the whole document at once. Values from xon_eval() are
+// unaffected and remain separately owned.
+void xon_enable_arena(int enabled);
+
+// Parse plain-data documents with the two-stage tape parser (default: off).
+// A SIMD pass indexes the structural bytes, one walk over the index writes
+// the tape (see xon_tape_parse()), and the tree is built from the tape in a
+// single arena block. Documents with declarations or expressions (other than
+// negative numbers), and documents with syntax errors, fall back to the
+// regular parser, so results are the same.
+void xon_enable_tape(int enabled);
+
+// Dedicated parser for plain JSON. It reads values by their first byte in a
+// single pass, with no lexer or grammar, and builds the same tree as xonify()
+// (always an arena document) or, for the event parser, the same events.
+// Input that is not plain JSON (comments, identifiers, \b, \f or \u
+// escapes, ...) falls back to the general parser, so results and errors are
+// unchanged. DETECT (the default) uses it for files whose name ends in
+// ".json"; ALWAYS also for buffers and other files.
+typedef enum {
+    XON_JSON_OFF,
+    XON_JSON_DETECT,
+    XON_JSON_ALWAYS
+} XonJsonMode;
+
+void xon_set_json_mode(XonJsonMode mode);
+
+// Parse documents of 1 MiB or more whose root is a list on up to threads
+// threads (default 1: serial; 0: one per online CPU). The input is cut at
+// root-level commas and the pieces are parsed concurrently, each into its own
+// arena, then joined; the tree is the same as a serial parse. Such documents
+// are always arena documents. Errors are reported by a serial reparse.
+void xon_set_parse_threads(int threads);
+
+// Reusable parser context for parsing many documents in a row. It keeps the
+// parser stack, a document arena and an identifier intern table between
+// calls, so repeated parses skip most per-parse setup and allocation.
+// Documents returned by xon_parser_parse() belong to the context: they stay
+// valid until xon_parser_reset() or xon_parser_free(), and xon_free() on them
+// is a no-op. Use xon_eval() to obtain an independent copy. A context must not
+// be used from more than one thread at a time.
+typedef struct XonParser XonParser;
+
+XonParser* xon_parser_new(void);
+XonValue* xon_parser_parse(XonParser* parser, const char* data, size_t len);
+void xon_parser_reset(XonParser* parser);
+void xon_parser_free(XonParser* parser);
+
+// ============ Push Parsing ============
+
+// Incremental parser for input that arrives in pieces, e.g. from a socket.
+// Chunks may split the document anywhere, including inside strings, numbers
+// and comments; each chunk is lexed and parsed as it is fed, and only an
+// unfinished token is held back, not the document. The tree follows
+// xon_enable_arena() like xonify().
+typedef struct XonStream XonStream;
+
+XonStream* xon_stream_new(void);
+
+// Returns 1 while the input is valid so far, 0 after an error. Errors are
+// reported when they are found; later feeds then return 0 too.
+int xon_stream_feed(XonStream* stream, const char* chunk, size_t len);
+
+// Ends the input and returns the document (free with xon_free()), or NULL on
+// error. The stream is freed either way.
+XonValue* xon_stream_finish(XonStream* stream);
+
+// Discards a stream without finishing it.
+void xon_stream_free(XonStream* stream);
+
+// ============ Record Streams ============
+
+// Streams of independent documents: XON lines, where records end at the
+// bracket that closes each top-level object or list (they may span lines),
+// or NDJSON, one record per line.
+typedef struct {
+    int threads;      // worker threads; 0 uses one per online CPU
+    int evaluate;     // hand xon_eval() results to the callback, not parse trees
+    int one_per_line; // NDJSON: every non-blank line is one record
+    size_t window;    // records in flight at most; 0 picks 4 per thread
+} XonRecordOptions;
+
+// Called on the calling thread, in input order. value is NULL for a record
+// that failed; its errors have been reported by then. value is only valid
+// during the call. Return 0 to stop.
+typedef int (*XonRecordCallback)(void* user_data, size_t index, const XonValue* value);
+
+// Reads records from in until EOF and parses them on a thread pool. Memory is
+// bounded by the window and the largest record, not by the stream. options
+// may be NULL for the defaults. Returns 1 if every record succeeded, 0 if any
+// failed or reading failed, and -1 when the callback stopped.
+int xon_records_parse(FILE* in, const XonRecordOptions* options, XonRecordCallback callback, void* user_data);
+
+// ============ Diagnostics ============
+
+typedef struct {
+    int line;      // 1-based
+    int column;    // 1-based, in bytes
+    char* message;
+} XonDiagnostic;
+
+// Check a document and collect every syntax error in one pass instead of
+// stopping at the first: after an error the parser skips to the next `,`,
+// `}` or `]` it can resume from. Nothing is printed. Returns 1 if valid,
+// 0 otherwise; *out (may be NULL) receives *count diagnostics in input order,
+// to be released with xon_diagnostics_free().
+int xon_diagnose_buffer(const char* data, size_t len, XonDiagnostic** out, size_t* count);
+int xon_diagnose_file(const char* filename, XonDiagnostic** out, size_t* count);
+void xon_diagnostics_free(XonDiagnostic* diagnostics, size_t count);
+
+// ============ Incremental Parsing ============
+
+// A document kept parsed under small edits, e.g. in an editor. It owns a copy
+// of the text and a heap tree in which the span of every object and list is
+// known. An edit reparses only the smallest object or list around everything
+// that changed since the tree was last valid and splices the result in; only
+// when that part no longer parses on its own is the whole text parsed again.
+// Nothing is printed; use xon_diagnose_buffer() on the text for the errors.
+typedef struct XonIncremental XonIncremental;
+
+XonIncremental* xon_incremental_new(const char* data, size_t len);
+
+// Replaces removed bytes at offset with text[0, len). Returns 1 if the
+// document is valid afterwards, 0 otherwise.
+int xon_incremental_edit(XonIncremental* doc, size_t offset, size_t removed, const char* text, size_t len);
+
+// The tree, or NULL while the document is invalid. It belongs to doc (do not
+// xon_free() it) and changes with each edit; nodes outside the reparsed
+// container keep their addresses.
+const XonValue* xon_incremental_root(const XonIncremental* doc);
+
+// The current text, not NUL-terminated.
+const char* xon_incremental_text(const XonIncremental* doc, size_t* len);
+void xon_incremental_free(XonIncremental* doc);
+
+// ============ Event Parsing ============
+
+// Callbacks for xon_sax_parse_*(), which report a document as a sequence of
+// events without building a tree. Any callback may be NULL; returning 0 from
+// one stops the parse. Strings are only valid during the call and are not
+// necessarily NUL-terminated, so use len.
+typedef struct {
+    int (*on_object_start)(void* user_data);
+    int (*on_object_end)(void* user_data);
+    int (*on_list_start)(void* user_data);
+    int (*on_list_end)(void* user_data);
+    int (*on_key)(void* user_data, const char* key, size_t len);
+    int (*on_string)(void* user_data, const char* value, size_t len);
+    int (*on_number)(void* user_data, double value);
+    int (*on_bool)(void* user_data, int value);
+    int (*on_null)(void* user_data);
+    // A `let`/`const` member; its initializer follows as the next value.
+    int (*on_declaration)(void* user_data, const char* name, size_t len, int is_const);
+    // A value that needs evaluation (operators, references, calls, functions),
+    // reported as its source text. It is syntax-checked but not evaluated.
+    int (*on_expression)(void* user_data, const char* text, size_t len);
+} XonSaxHandler;
+
+// Returns 1 when the whole document was parsed, 0 on error, and -1 when a
+// callback stopped the parse. Memory use depends on nesting depth and the
+// largest single value, not on document size. The handler may be NULL to
+// only check syntax.
+int xon_sax_parse_buffer(const char* data, size_t len, const XonSaxHandler* handler, void* user_data);
+int xon_sax_parse_file(const char* filename, const XonSaxHandler* handler, void* user_data);
+
+// Stream a .xon/.json file to out as JSON (as_json != 0) or Xon, using the
+// event parser. The layout matches xon_to_json()/xon_to_xon() on the parsed
+// document; expressions keep their source text in Xon output. Bare negative
+// numbers such as -5 are written as numbers (they used to become null in
+// JSON). A document with an operator after a container literal, such as
+// { a: {b: 1}.b } or [1] + [2], is converted through a parse tree instead,
+// exactly as xon_to_json()/xon_to_xon() would; out is then rewound over what
+// was already written, so it must be seekable if more than 64 KiB went out.
+// Returns 1 on success, 0 on failure (out may then hold partial output).
+int xon_convert_file(const char* input_path, FILE* out, int as_json, int pretty);
+
 // ============ Type Checking ============
 
 XonType xon_get_type(const XonValue* value);
@@ -60,6 +249,8 @@ int xon_is_list(const XonValue* value);
 int xon_get_bool(const XonValue* value);
 double xon_get_number(const XonValue* value);
 const char* xon_get_string(const XonValue* value);
+// Byte length of a string value (0 for non-strings); avoids strlen().
+size_t xon_get_string_length(const XonValue* value);
 
 // ============ Object Operations ============
 
@@ -86,6 +277,203 @@ XonValue* xon_list_get(const XonValue* list, size_t index);
 // Get list length
 size_t xon_list_size(const XonValue* list);
 
+// ============ Iteration ============
+
+// Visits the items of a list or the members of an object in order, O(1) per
+// step, without indexing. Declarations in an unevaluated object are skipped.
+// A small value type; fields are internal.
+typedef struct {
+    const XonValue* next;
+    int is_object;
+} XonIter;
+
+// Returns 1 for a list or object, 0 otherwise (the iterator is then empty).
+int xon_iter_begin(const XonValue* container, XonIter* it);
+
+// Stores the next key (NULL for list items) and value; either pointer may be
+// NULL. Returns 1, or 0 once every item has been visited.
+int xon_iter_next(XonIter* it, const char** key, XonValue** value);
+
+// ============ Path Queries ============
+
+// Compiled queries for deep values, e.g. "services.api.limits[3].burst".
+// Steps: .name or a leading name, ["quoted name"], [index] (negative counts
+// from the end), .* or [*] or a leading * (every member or item), and filters
+// over members or items: [?field], true unless missing, null or false, and
+// [?field op literal] with op one of == != < <= > >= and a string, number,
+// true, false or null literal. field is a dotted name or @ (the item itself).
+// A path starting with '/' is a JSON Pointer (RFC 6901). Names are decoded
+// and hashed once at compile time, and evaluation allocates nothing.
+typedef struct XonPath XonPath;
+
+// Returns NULL and reports the offset on a syntax error.
+XonPath* xon_path_compile(const char* expr);
+void xon_path_free(XonPath* path);
+
+// First match in document order, or NULL.
+XonValue* xon_path_eval(const XonPath* path, const XonValue* root);
+
+// Calls on_match for each match in document order until it returns 0.
+// Returns the number of matches visited. on_match may be NULL to count them.
+typedef int (*XonPathCallback)(void* user_data, const XonValue* value);
+size_t xon_path_each(const XonPath* path, const XonValue* root, XonPathCallback on_match, void* user_data);
+
+// ============ Struct Extraction ============
+
+// Fills a C struct from an object in one pass over its members: each member
+// is matched to the next descriptor, or else to one found by key hash, then
+// converted and stored at the descriptor's offset. Keys must be distinct. A
+// missing or null member stores the default, or fails if the field is
+// required. Numbers written as -N are read as numbers even in unevaluated
+// documents; other expressions are type errors, so evaluate documents that
+// use them first.
+typedef enum {
+    XON_FIELD_BOOL,   // int, 0 or 1
+    XON_FIELD_INT,    // int; the number must be a whole number in range
+    XON_FIELD_DOUBLE, // double
+    XON_FIELD_STRING, // const char*, owned by the tree
+    XON_FIELD_VALUE   // const XonValue*, any type, owned by the tree
+} XonFieldType;
+
+typedef struct {
+    const char* key;
+    XonFieldType type;
+    size_t offset;
+    int required;
+    double default_number;      // BOOL, INT and DOUBLE fields
+    const char* default_string; // STRING fields
+} XonFieldDesc;
+
+// Optional field with a zero/NULL default, e.g.
+// XON_FIELD(Service, port, "port", XON_FIELD_INT).
+#define XON_FIELD(struct_type, member, key, type) {(key), (type), offsetof(struct_type, member), 0, 0.0, NULL}
+
+// Returns 1 on success; 0 if value is not an object, a required field is
+// missing or a member has the wrong type (reported; the struct may then be
+// partly written).
+int xon_extract(const XonValue* value, const XonFieldDesc* fields, size_t n, void* out_struct);
+
+// Fills out_array[i] (stride bytes apart) from item i of a list of objects,
+// hashing the descriptors at most once for the whole list. Stores the number
+// of structs written in *count. Returns 1 if every item was extracted, 0 if
+// value is not a list, an item fails, or the list has more than capacity
+// items.
+int xon_extract_list(const XonValue* value, const XonFieldDesc* fields, size_t n, void* out_array, size_t stride,
+                     size_t capacity, size_t* count);
+
+// ============ On-Demand Access ============
+
+// Lazy, read-only access to a document in place. Nothing is parsed until it is
+// asked for: looking up a field or index reads the keys on the way and skips
+// every other value by bracket matching. The buffer must outlive the XonDoc,
+// and only the values that are read are checked for syntax.
+typedef struct XonDoc XonDoc;
+
+// A position in an XonDoc: a small value type that may be copied freely.
+// Fields are internal.
+typedef struct {
+    XonDoc* doc;
+    const char* pos;
+} XonCursor;
+
+XonDoc* xon_doc_open(const char* data, size_t len);
+void xon_doc_close(XonDoc* doc);
+
+// Cursor at the root object or list. Returns 1 on success, 0 otherwise.
+int xon_doc_root(XonDoc* doc, XonCursor* out);
+
+// Expressions and declarations are not evaluated; their type is
+// XON_TYPE_NULL, as with xon_get_type() on an unevaluated document. The
+// exception is a negative number literal (-N): it is an expression in the
+// tree, but the cursor reads it as XON_TYPE_NUMBER, as xon_extract() does.
+XonType xon_cursor_type(const XonCursor* cursor);
+
+// Moves to a field of an object or an item of a list. Returns 1 if found.
+int xon_cursor_find_field(const XonCursor* object, const char* key, XonCursor* out);
+int xon_cursor_at(const XonCursor* list, size_t index, XonCursor* out);
+
+// Number of members or items; each one is skipped over, not parsed.
+size_t xon_cursor_size(const XonCursor* cursor);
+
+// Getters return 1 and store the value if it is a literal of that type.
+// Strings are NUL-terminated and stay valid until xon_doc_close().
+int xon_cursor_is_null(const XonCursor* cursor);
+int xon_cursor_get_bool(const XonCursor* cursor, int* out);
+int xon_cursor_get_number(const XonCursor* cursor, double* out);
+int xon_cursor_get_string(const XonCursor* cursor, const char** out, size_t* len);
+
+// ============ Tape Documents ============
+
+// A plain-data document (no declarations or expressions other than negative
+// numbers) parsed by the two-stage parser into a flat, read-only tape: one
+// entry per value in document order, with decoded strings in one buffer. A
+// container's entry records its size and where its subtree ends, so sizes,
+// iteration steps and skipping a subtree are O(1) each. The input buffer may
+// be freed once the tape is built.
+//
+// The XonValue accessors do not read the tape. XonValue is the DataNode tree
+// itself: callers keep pointers to its nodes, and evaluation, path queries
+// and serialization all walk and build it, so a tape-backed XonValue would
+// change the type under every existing caller. The tape instead has its own
+// accessors below, with the same shape as the XonValue ones, and
+// xon_tape_to_value() builds a tree from a tape value in one linear pass.
+// With xon_enable_tape(1), xonify() builds its tree from a tape that way.
+typedef struct XonTape XonTape;
+
+// A value in an XonTape: a small value type that may be copied freely.
+// Fields are internal.
+typedef struct {
+    const XonTape* tape;
+    size_t index;
+} XonTapeValue;
+
+// Returns NULL if the document is not plain data, has a syntax error or is
+// larger than 4 GiB; xonify_buffer() parses those and reports any errors.
+XonTape* xon_tape_parse(const char* data, size_t len);
+void xon_tape_free(XonTape* tape);
+
+// Value at the root object or list. Returns 1 on success, 0 otherwise.
+int xon_tape_root(const XonTape* tape, XonTapeValue* out);
+
+// Negative numbers are numbers here.
+XonType xon_tape_type(const XonTapeValue* value);
+
+// Moves to a field of an object or an item of a list. Returns 1 if found.
+// Each member or item passed over is skipped in O(1); with duplicate keys
+// the first one wins.
+int xon_tape_find_field(const XonTapeValue* object, const char* key, XonTapeValue* out);
+int xon_tape_at(const XonTapeValue* list, size_t index, XonTapeValue* out);
+
+// Number of members or items, O(1).
+size_t xon_tape_size(const XonTapeValue* value);
+
+// Getters return 1 and store the value if it has that type. Strings are
+// NUL-terminated and stay valid until xon_tape_free().
+int xon_tape_is_null(const XonTapeValue* value);
+int xon_tape_get_bool(const XonTapeValue* value, int* out);
+int xon_tape_get_number(const XonTapeValue* value, double* out);
+int xon_tape_get_string(const XonTapeValue* value, const char** out, size_t* len);
+
+// Visits the items of a list or the members of an object in order.
+// A small value type; fields are internal.
+typedef struct {
+    const XonTape* tape;
+    size_t next;
+    size_t end;
+} XonTapeIter;
+
+// Returns 1 for a list or object, 0 otherwise (the iterator is then empty).
+int xon_tape_iter_begin(const XonTapeValue* container, XonTapeIter* it);
+
+// Stores the next key (NULL for list items) and value; either pointer may be
+// NULL. Returns 1, or 0 once every item has been visited.
+int xon_tape_iter_next(XonTapeIter* it, const char** key, XonTapeValue* value);
+
+// Builds the regular tree of a value, for the XonValue accessors,
+// evaluation and serialization. It is the tree xonify() builds for that
+// text, owns its strings and outlives the tape. Free with xon_free().
+XonValue* xon_tape_to_value(const XonTapeValue* value);
+
 // ============ Serialization ============
 
 // Convert a parsed value to JSON string. Caller must free with xon_string_free().
@@ -35,16 +35,16 @@ echo "📝 Generating parser..."
 # Compile to WebAssembly
 echo "🔨 Compiling to WASM..."
 cd "$SCRIPT_DIR"
-emcc "$ROOT_DIR/src/xon_api.c" "$ROOT_DIR/src/lexer.c" "$ROOT_DIR/src/logger.c" \
+emcc "$ROOT_DIR/src/xon_api.c" "$ROOT_DIR/src/lexer.c" "$ROOT_DIR/src/logger.c" "$ROOT_DIR/src/input.c" "$ROOT_DIR/src/scan.c" "$ROOT_DIR/src/number.c" "$ROOT_DIR/src/arena.c" "$ROOT_DIR/src/intern.c" "$ROOT_DIR/src/structural.c" \
     -o xon.js \
     -s WASM=1 \
-    -s EXPORTED_FUNCTIONS='["_malloc","_free","_xonify_string","_xon_eval","_xon_to_json","_xon_to_xon","_xon_free","_xon_string_free","_xon_get_last_error","_xon_get_last_error_stack"]' \
-    -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","FS","UTF8ToString","stringToUTF8"]' \
+    -s EXPORTED_FUNCTIONS='["_malloc","_free","_xonify_string","_xonify_buffer","_xon_eval","_xon_to_json","_xon_to_xon","_xon_free","_xon_string_free","_xon_get_last_error","_xon_get_last_error_stack"]' \
+    -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap","FS","UTF8ToString","stringToUTF8","lengthBytesUTF8"]' \
     -s ALLOW_MEMORY_GROWTH=1 \
     -s MODULARIZE=1 \
     -s EXPORT_NAME="XonModule" \
     -s INVOKE_RUN=0 \
-    -I"$ROOT_DIR/include" -I"$ROOT_DIR/src" \
+    -D_GNU_SOURCE -I"$ROOT_DIR/include" -I"$ROOT_DIR/src" \
     -O3 \
     --no-entry
 
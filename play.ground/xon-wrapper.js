@@ -3,6 +3,7 @@ class XonParser {
         this.module = module;
         this.api = {
             xonifyString: module.cwrap("xonify_string", "number", ["string"]),
+            xonifyBuffer: module._xonify_buffer ? module.cwrap("xonify_buffer", "number", ["number", "number"]) : null,
             xonEval: module.cwrap("xon_eval", "number", ["number"]),
             xonToJson: module.cwrap("xon_to_json", "number", ["number", "number"]),
             xonToXon: module.cwrap("xon_to_xon", "number", ["number", "number"]),
@@ -26,8 +27,23 @@ class XonParser {
         return stack ? `${msg}\n${stack}` : msg;
     }
 
+    _parseBuffer(code) {
+        const len = this.module.lengthBytesUTF8(code);
+        const buf = this.module._malloc(len + 1);
+        if (!buf) return 0;
+        try {
+            this.module.stringToUTF8(code, buf, len + 1);
+            return this.api.xonifyBuffer(buf, len);
+        } finally {
+            this.module._free(buf);
+        }
+    }
+
     _parsePointer(code) {
-        const ptr = this.api.xonifyString(code);
+        // Older xon.wasm builds only export xonify_string.
+        const ptr = this.api.xonifyBuffer && this.module.lengthBytesUTF8
+            ? this._parseBuffer(code)
+            : this.api.xonifyString(code);
         if (!ptr) {
             throw new Error(this._runtimeError("Failed to parse Xon input."));
         }
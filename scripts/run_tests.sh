@@ -7,9 +7,9 @@ cd "$ROOT_DIR"
 
 "$ROOT_DIR/build.sh" >/dev/null
 
-gcc -Wall -Wextra -std=c99 -I"$ROOT_DIR/include" \
+gcc -Wall -Wextra -std=c99 -D_GNU_SOURCE -I"$ROOT_DIR/include" \
     -o /tmp/xon_test_suite \
-    "$ROOT_DIR/tests/test_suite.c" "$ROOT_DIR/src/xon_api.c" "$ROOT_DIR/src/lexer.c" "$ROOT_DIR/src/logger.c"
+    "$ROOT_DIR/tests/test_suite.c" "$ROOT_DIR/src/xon_api.c" "$ROOT_DIR/src/lexer.c" "$ROOT_DIR/src/logger.c" "$ROOT_DIR/src/input.c" "$ROOT_DIR/src/scan.c" "$ROOT_DIR/src/number.c" "$ROOT_DIR/src/arena.c" "$ROOT_DIR/src/intern.c" "$ROOT_DIR/src/structural.c" -lpthread -lm
 /tmp/xon_test_suite
 
 python3 "$ROOT_DIR/tests/test_python.py"
@@ -0,0 +1,104 @@
+#include "arena.h"
+
+#include <stdlib.h>
+
+#define ARENA_ALIGN 8
+#define ARENA_MIN_CHUNK (4 * 1024)
+#define ARENA_MAX_CHUNK (8 * 1024 * 1024)
+
+struct XonArenaChunk {
+    struct XonArenaChunk* next;
+    size_t size;
+    size_t used;
+};
+
+// Chunk payload starts after the header, rounded up to ARENA_ALIGN.
+#define CHUNK_HEADER ((sizeof(XonArenaChunk) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static XonArenaChunk* arena_add_chunk(XonArena* arena, size_t payload) {
+    XonArenaChunk* chunk = (XonArenaChunk*)malloc(CHUNK_HEADER + payload);
+    if (!chunk) return NULL;
+    chunk->size = payload;
+    chunk->used = 0;
+    chunk->next = arena->head;
+    arena->head = chunk;
+    arena->reserved += CHUNK_HEADER + payload;
+    return chunk;
+}
+
+XonArena* xon_arena_create(size_t size_hint) {
+    XonArena* arena = (XonArena*)malloc(sizeof(XonArena));
+    size_t first = size_hint;
+
+    if (!arena) return NULL;
+    if (first < ARENA_MIN_CHUNK) first = ARENA_MIN_CHUNK;
+    if (first > ARENA_MAX_CHUNK) first = ARENA_MAX_CHUNK;
+    arena->head = NULL;
+    arena->reserved = 0;
+    arena->next_chunk_size = first;
+    return arena;
+}
+
+void* xon_arena_alloc(XonArena* arena, size_t size) {
+    XonArenaChunk* chunk = arena->head;
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t payload = arena->next_chunk_size;
+        if (payload < size) payload = size;
+        chunk = arena_add_chunk(arena, payload);
+        if (!chunk) return NULL;
+        // Geometric growth keeps the chunk count logarithmic in document size.
+        if (arena->next_chunk_size < ARENA_MAX_CHUNK) arena->next_chunk_size *= 2;
+    }
+
+    chunk->used += size;
+    return (char*)chunk + CHUNK_HEADER + chunk->used - size;
+}
+
+void xon_arena_destroy(XonArena* arena) {
+    XonArenaChunk* chunk;
+    if (!arena) return;
+    chunk = arena->head;
+    while (chunk) {
+        XonArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+void xon_arena_reset(XonArena* arena) {
+    XonArenaChunk* chunk;
+    if (!arena || !arena->head) return;
+    chunk = arena->head->next;
+    while (chunk) {
+        XonArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->reserved = CHUNK_HEADER + arena->head->size;
+}
+
+void xon_arena_adopt(XonArena* arena, XonArena* other) {
+    XonArenaChunk* tail;
+    if (!other) return;
+    if (other->head) {
+        tail = other->head;
+        while (tail->next) tail = tail->next;
+        if (arena->head) {
+            tail->next = arena->head->next;
+            arena->head->next = other->head;
+        } else {
+            arena->head = other->head;
+        }
+        arena->reserved += other->reserved;
+    }
+    free(other);
+}
+
+size_t xon_arena_reserved(const XonArena* arena) {
+    return arena ? arena->reserved : 0;
+}
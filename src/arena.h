@@ -0,0 +1,33 @@
+#ifndef XON_ARENA_H
+#define XON_ARENA_H
+
+#include <stddef.h>
+
+// Bump allocator for one parsed document. Allocations are never freed
+// individually; xon_arena_destroy() releases every chunk at once.
+typedef struct XonArenaChunk XonArenaChunk;
+
+typedef struct XonArena {
+    XonArenaChunk *head;
+    size_t next_chunk_size;
+    size_t reserved;
+} XonArena;
+
+// size_hint sizes the first chunk (e.g. from the input length); 0 picks a default.
+XonArena *xon_arena_create(size_t size_hint);
+void *xon_arena_alloc(XonArena *arena, size_t size);
+void xon_arena_destroy(XonArena *arena);
+
+// Invalidates every allocation but keeps the most recent (largest) chunk for
+// reuse, so a long-lived arena settles at the size of its biggest document.
+void xon_arena_reset(XonArena *arena);
+
+// Moves every chunk of other into arena and frees other. Allocations from
+// both stay valid until arena is destroyed; arena keeps allocating from its
+// own current chunk.
+void xon_arena_adopt(XonArena *arena, XonArena *other);
+
+// Total bytes reserved from malloc for chunks.
+size_t xon_arena_reserved(const XonArena *arena);
+
+#endif // XON_ARENA_H
@@ -0,0 +1,158 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "input.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define XON_INPUT_HAVE_MMAP 1
+#endif
+
+static void input_reset(XonInput* input) {
+    input->data = NULL;
+    input->len = 0;
+    input->mapping = NULL;
+    input->mapping_len = 0;
+    input->owned = NULL;
+}
+
+static int input_adopt_buffer(XonInput* input, char* buffer, size_t len) {
+    input->owned = buffer;
+    input->data = buffer ? buffer : "";
+    input->len = len;
+    return 1;
+}
+
+#if defined(XON_INPUT_HAVE_MMAP)
+
+static int input_read_fd(XonInput* input, int fd, size_t size_hint) {
+    size_t cap = size_hint > 0 ? size_hint + 1 : 64 * 1024;
+    size_t len = 0;
+    char* buffer = (char*)malloc(cap);
+
+    if (!buffer) return 0;
+
+    for (;;) {
+        ssize_t n;
+        if (len == cap) {
+            char* grown = (char*)realloc(buffer, cap * 2);
+            if (!grown) {
+                free(buffer);
+                return 0;
+            }
+            buffer = grown;
+            cap *= 2;
+        }
+        n = read(fd, buffer + len, cap - len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(buffer);
+            return 0;
+        }
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+
+    return input_adopt_buffer(input, buffer, len);
+}
+
+int xon_input_open(XonInput* input, const char* path) {
+    struct stat st;
+    int fd;
+    int ok;
+
+    input_reset(input);
+    if (!path) return 0;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return 0;
+    }
+
+    if (S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            posix_madvise(mapping, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            close(fd);
+            input->mapping = mapping;
+            input->mapping_len = (size_t)st.st_size;
+            input->data = (const char*)mapping;
+            input->len = (size_t)st.st_size;
+            return 1;
+        }
+    }
+
+    ok = input_read_fd(input, fd, S_ISREG(st.st_mode) ? (size_t)st.st_size : 0);
+    close(fd);
+    return ok;
+}
+
+void xon_input_close(XonInput* input) {
+    if (!input) return;
+    if (input->mapping) munmap(input->mapping, input->mapping_len);
+    free(input->owned);
+    input_reset(input);
+}
+
+#else
+
+int xon_input_open(XonInput* input, const char* path) {
+    FILE* f;
+    char* buffer = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+
+    input_reset(input);
+    if (!path) return 0;
+
+    f = fopen(path, "rb");
+    if (!f) return 0;
+
+    for (;;) {
+        size_t n;
+        if (len == cap) {
+            size_t new_cap = cap ? cap * 2 : 64 * 1024;
+            char* grown = (char*)realloc(buffer, new_cap);
+            if (!grown) {
+                free(buffer);
+                fclose(f);
+                return 0;
+            }
+            buffer = grown;
+            cap = new_cap;
+        }
+        n = fread(buffer + len, 1, cap - len, f);
+        len += n;
+        if (n == 0) break;
+    }
+
+    if (ferror(f)) {
+        free(buffer);
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    return input_adopt_buffer(input, buffer, len);
+}
+
+void xon_input_close(XonInput* input) {
+    if (!input) return;
+    free(input->owned);
+    input_reset(input);
+}
+
+#endif
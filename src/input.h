@@ -0,0 +1,21 @@
+#ifndef XON_INPUT_H
+#define XON_INPUT_H
+
+#include <stddef.h>
+
+// Read-only view of a whole input file. Regular files are memory-mapped;
+// pipes, character devices and platforms without mmap are read() into a heap
+// buffer instead. Either way the lexer sees one contiguous span.
+typedef struct XonInput {
+    const char *data;
+    size_t len;
+    void *mapping;
+    size_t mapping_len;
+    char *owned;
+} XonInput;
+
+// Returns 1 on success, 0 on failure (errno is preserved from the failing call).
+int xon_input_open(XonInput *input, const char *path);
+void xon_input_close(XonInput *input);
+
+#endif // XON_INPUT_H
@@ -0,0 +1,81 @@
+#include "intern.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+// Bounded so that a stream of unique identifiers cannot grow the table
+// without limit; past this point strings are simply not interned.
+#define INTERN_MAX_LEN 64
+#define INTERN_MAX_ENTRIES 4096
+#define INTERN_SLOTS (INTERN_MAX_ENTRIES * 2) // load factor <= 0.5
+
+typedef struct {
+    const char* str;
+    uint32_t hash;
+    uint32_t len;
+} InternSlot;
+
+struct XonIntern {
+    XonArena* strings;
+    size_t count;
+    InternSlot slots[INTERN_SLOTS];
+};
+
+// FNV-1a; identifiers are short, so this is cheaper than anything wider.
+static uint32_t intern_hash(const char* s, size_t len) {
+    uint32_t h = 2166136261u;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+XonIntern* xon_intern_create(void) {
+    XonIntern* table = (XonIntern*)calloc(1, sizeof(XonIntern));
+    if (!table) return NULL;
+    table->strings = xon_arena_create(0);
+    if (!table->strings) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void xon_intern_destroy(XonIntern* table) {
+    if (!table) return;
+    xon_arena_destroy(table->strings);
+    free(table);
+}
+
+const char* xon_intern(XonIntern* table, const char* s, size_t len) {
+    uint32_t hash;
+    size_t i;
+    char* copy;
+
+    if (!table || len > INTERN_MAX_LEN) return NULL;
+    hash = intern_hash(s, len);
+    i = hash & (INTERN_SLOTS - 1);
+    while (table->slots[i].str) {
+        InternSlot* slot = &table->slots[i];
+        if (slot->hash == hash && slot->len == len && memcmp(slot->str, s, len) == 0) {
+            return slot->str;
+        }
+        i = (i + 1) & (INTERN_SLOTS - 1);
+    }
+    if (table->count >= INTERN_MAX_ENTRIES) return NULL;
+
+    copy = (char*)xon_arena_alloc(table->strings, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    table->slots[i].str = copy;
+    table->slots[i].hash = hash;
+    table->slots[i].len = (uint32_t)len;
+    table->count++;
+    return copy;
+}
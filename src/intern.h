@@ -0,0 +1,19 @@
+#ifndef XON_INTERN_H
+#define XON_INTERN_H
+
+#include <stddef.h>
+
+// Identifier intern table kept by a reusable parser context. Keys and names
+// that repeat across documents are stored once and shared by every parse tree
+// built with the same context. Strings live until xon_intern_destroy().
+typedef struct XonIntern XonIntern;
+
+XonIntern *xon_intern_create(void);
+void xon_intern_destroy(XonIntern *table);
+
+// Returns a NUL-terminated copy of s[0..len) owned by the table, or NULL if
+// the string is too long to intern or the table is full. Callers fall back to
+// their own copy in that case.
+const char *xon_intern(XonIntern *table, const char *s, size_t len);
+
+#endif // XON_INTERN_H
@@ -1,9 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h>
 #include <string.h>
-#include <errno.h>
+#include "arena.h"
 #include "lexer.h"
+#include "number.h"
+#include "scan.h"
 #include "xon.h" // Required for token IDs
 
 static char* xon_strdup(const char* src) {
@@ -14,324 +15,297 @@ static char* xon_strdup(const char* src) {
     return out;
 }
 
-static int read_non_ws(FILE* pFile, int* pLine, char** ppzErrMsg) {
-    int c;
+// Character classes for the token dispatch. One lookup per byte replaces
+// the ctype.h calls; only ASCII letters, digits, '_' and '$' are classified.
+#define CC_DIGIT 0x01
+#define CC_HEX 0x02
+#define CC_IDENT_START 0x04
+#define CC_IDENT 0x08
+#define CC_NUMBER 0x10 // digits, '.', 'e', 'E'
 
-    if (ppzErrMsg) *ppzErrMsg = NULL;
+static const unsigned char CHAR_CLASS[256] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x1b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x0e, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c,
+    0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x0c,
+    0x00, 0x0e, 0x0e, 0x0e, 0x0e, 0x1e, 0x0e, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c,
+    0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
 
-    while ((c = fgetc(pFile)) != EOF) {
-        if (c == '\n') {
-            (*pLine)++;
-            continue;
-        }
-        if (isspace((unsigned char)c)) {
-            continue;
+// Tokens that are always exactly one character.
+static const unsigned char SINGLE_CHAR_TOKEN[256] = {
+    ['{'] = LBRACE, ['}'] = RBRACE, ['['] = LBRACKET, [']'] = RBRACKET,
+    ['('] = LPAREN, [')'] = RPAREN, [','] = COMMA, [':'] = COLON,
+    ['.'] = DOT, ['+'] = PLUS, ['-'] = MINUS, ['*'] = STAR,
+    ['/'] = SLASH, ['%'] = PERCENT
+};
+
+// Minimal perfect hash over the seven keywords: collision-free for this set
+// and only ever applied to identifiers of length 2..5.
+#define KEYWORD_HASH(s, len) ((((unsigned)(len) << 2) + (unsigned char)(s)[0] + ((unsigned)(unsigned char)(s)[1] << 3)) & 7u)
+
+typedef struct {
+    const char* text;
+    unsigned char len;
+    int token;
+} Keyword;
+
+static const Keyword KEYWORDS[8] = {
+    {"let", 3, LET},
+    {"if", 2, IF},
+    {"false", 5, FALSE},
+    {NULL, 0, 0},
+    {"true", 4, TRUE},
+    {"else", 4, ELSE},
+    {"null", 4, NULL_VAL},
+    {"const", 5, CONST}
+};
+
+int xon_lexer_keyword(const char* start, size_t len) {
+    const Keyword* kw;
+    if (len < 2 || len > 5) return 0;
+    kw = &KEYWORDS[KEYWORD_HASH(start, len)];
+    return (kw->len == len && memcmp(kw->text, start, len) == 0) ? kw->token : 0;
+}
+
+void xon_lexer_init(XonLexer* lexer, const char* data, size_t len) {
+    lexer->cursor = data;
+    lexer->end = data + len;
+    lexer->token_start = data;
+    lexer->line = 1;
+    lexer->arena = NULL;
+    lexer->raw_strings = 0;
+}
+
+static int span_peek(const XonLexer* lexer) {
+    return lexer->cursor < lexer->end ? (unsigned char)*lexer->cursor : EOF;
+}
+
+static int span_match(XonLexer* lexer, int expected) {
+    if (lexer->cursor < lexer->end && (unsigned char)*lexer->cursor == expected) {
+        lexer->cursor++;
+        return 1;
+    }
+    return 0;
+}
+
+// Returns the next significant byte, EOF at end of input, or READ_ERROR.
+#define READ_ERROR (-2)
+
+static int read_non_ws(XonLexer* lexer, char** ppzErrMsg) {
+    for (;;) {
+        const char* p = xon_scan_skip_ws(lexer->cursor, lexer->end, &lexer->line);
+
+        if (p >= lexer->end) {
+            lexer->cursor = p;
+            lexer->token_start = p;
+            return EOF;
         }
 
-        if (c == '/') {
-            int next = fgetc(pFile);
-            if (next == '/') {
-                while ((c = fgetc(pFile)) != EOF && c != '\n') {
-                    // skip line comment
-                }
-                if (c == '\n') (*pLine)++;
-                continue;
-            }
-            if (next == '*') {
-                int prev = 0;
-                while ((c = fgetc(pFile)) != EOF) {
-                    if (c == '\n') (*pLine)++;
-                    if (prev == '*' && c == '/') break;
-                    prev = c;
-                }
-                if (c == EOF) {
-                    if (ppzErrMsg) {
-                        *ppzErrMsg = xon_strdup("Unterminated block comment");
-                    }
-                    return -1;
-                }
-                continue;
-            }
-            if (next == EOF) {
-                return '/';
-            }
-            ungetc(next, pFile);
-            return '/';
+        if (*p == '#' || (*p == '/' && p + 1 < lexer->end && p[1] == '/')) {
+            // Stop on the newline so the next skip counts it.
+            lexer->cursor = xon_scan_find_byte(p + 1, lexer->end, '\n');
+            continue;
         }
 
-        if (c == '#') {
-            while ((c = fgetc(pFile)) != EOF && c != '\n') {
-                // skip comment line
+        if (*p == '/' && p + 1 < lexer->end && p[1] == '*') {
+            const char* after = xon_scan_block_comment(p + 2, lexer->end, &lexer->line);
+            if (!after) {
+                lexer->token_start = p;
+                lexer->cursor = lexer->end;
+                if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unterminated block comment");
+                return READ_ERROR;
             }
-            if (c == '\n') (*pLine)++;
+            lexer->cursor = after;
             continue;
         }
 
-        return c;
+        lexer->cursor = p + 1;
+        return (unsigned char)*p;
     }
-    return EOF;
 }
 
-static int append_char(char** buffer, size_t* cap, size_t* len, char c) {
-    if (*len + 1 >= *cap) {
-        size_t new_cap = (*cap == 0) ? 64 : (*cap * 2);
-        char* new_buf = (char*)realloc(*buffer, new_cap);
-        if (!new_buf) return 0;
-        *buffer = new_buf;
-        *cap = new_cap;
+char xon_lexer_decode_escape(char esc) {
+    switch (esc) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        default: return esc;
     }
-    (*buffer)[(*len)++] = c;
-    return 1;
 }
 
-static int parse_string_token(FILE* pFile, XonTokenData* pData, char** ppzErrMsg, int* pLine) {
-    char* buffer = NULL;
-    size_t len = 0;
-    size_t cap = 0;
-    int c;
+// Strings are scanned in place for the closing quote. Escape-free literals are
+// copied once into an exact-size buffer; escaped ones are measured first and
+// then decoded into an exact-size buffer.
+static int parse_string_token(XonLexer* lexer, XonTokenData* pData, char** ppzErrMsg) {
+    const char* start = lexer->cursor;
+    const char* p = start;
+    size_t escapes = 0;
+    size_t len;
+    char* out;
 
-    while ((c = fgetc(pFile)) != EOF) {
-        if (c == '"') {
-            if (!append_char(&buffer, &cap, &len, '\0')) {
-                free(buffer);
-                if (ppzErrMsg) *ppzErrMsg = xon_strdup("Out of memory while parsing string");
-                return -1;
-            }
-            pData->sVal = buffer;
-            return STRING;
-        }
-        if (c == '\n') (*pLine)++;
-        if (c == '\\') {
-            int esc = fgetc(pFile);
-            if (esc == EOF) {
-                free(buffer);
-                if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unterminated escape sequence");
-                return -1;
-            }
-            if (esc == '\n') (*pLine)++;
-            switch (esc) {
-                case 'n': c = '\n'; break;
-                case 't': c = '\t'; break;
-                case 'r': c = '\r'; break;
-                case '"': c = '"'; break;
-                case '\\': c = '\\'; break;
-                default: c = esc; break;
-            }
+    for (;;) {
+        p = xon_scan_string(p, lexer->end, &lexer->line);
+        if (p >= lexer->end) {
+            lexer->cursor = lexer->end;
+            if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unterminated string literal");
+            return -1;
         }
-        if (!append_char(&buffer, &cap, &len, (char)c)) {
-            free(buffer);
-            if (ppzErrMsg) *ppzErrMsg = xon_strdup("Out of memory while parsing string");
+        if (*p == '"') break;
+        if (p + 1 >= lexer->end) {
+            lexer->cursor = lexer->end;
+            if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unterminated escape sequence");
             return -1;
         }
+        if (p[1] == '\n') lexer->line++;
+        escapes++;
+        p += 2;
     }
 
-    free(buffer);
-    if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unterminated string literal");
-    return -1;
-}
-
-static int parse_number_token(FILE* pFile, int first_char, XonTokenData* pData, char** ppzErrMsg) {
-    char buffer[128];
-    size_t i = 0;
-    int c = first_char;
-    int is_hex = 0;
-
-    buffer[i++] = (char)c;
-
-    if (c == '-') {
-        int next = fgetc(pFile);
-        if (next == EOF || !isdigit((unsigned char)next)) {
-            if (next != EOF) ungetc(next, pFile);
-            if (ppzErrMsg) *ppzErrMsg = xon_strdup("Invalid number literal");
-            return -1;
-        }
-        if (i < sizeof(buffer) - 1) buffer[i++] = (char)next;
-        c = next;
+    if (lexer->raw_strings) {
+        lexer->cursor = p + 1;
+        pData->sVal = NULL;
+        pData->span = start;
+        pData->sLen = (size_t)(p - start);
+        return STRING;
     }
 
-    if (c == '0' || (i >= 2 && buffer[0] == '-' && buffer[1] == '0')) {
-        int next = fgetc(pFile);
-        if (next == 'x' || next == 'X') {
-            if (i < sizeof(buffer) - 1) buffer[i++] = (char)next;
-            is_hex = 1;
-            int has_digits = 0;
-            while ((c = fgetc(pFile)) != EOF && isxdigit((unsigned char)c)) {
-                has_digits = 1;
-                if (i < sizeof(buffer) - 1) buffer[i++] = (char)c;
-            }
-            if (c != EOF) ungetc(c, pFile);
-            if (!has_digits) {
-                if (ppzErrMsg) *ppzErrMsg = xon_strdup("Invalid hexadecimal number");
-                return -1;
-            }
-        } else {
-            if (next != EOF) ungetc(next, pFile);
-        }
+    len = (size_t)(p - start) - escapes;
+    out = lexer->arena ? (char*)xon_arena_alloc(lexer->arena, len + 1) : (char*)malloc(len + 1);
+    if (!out) {
+        if (ppzErrMsg) *ppzErrMsg = xon_strdup("Out of memory while parsing string");
+        return -1;
     }
 
-    if (!is_hex) {
-        int prev = c;
-        while ((c = fgetc(pFile)) != EOF) {
-            if (isdigit((unsigned char)c) || c == '.' || c == 'e' || c == 'E') {
-                prev = c;
-                if (i < sizeof(buffer) - 1) buffer[i++] = (char)c;
-                continue;
-            }
-            if ((c == '+' || c == '-') && (prev == 'e' || prev == 'E')) {
-                prev = c;
-                if (i < sizeof(buffer) - 1) buffer[i++] = (char)c;
-                continue;
-            }
-            break;
+    if (escapes == 0) {
+        memcpy(out, start, len);
+    } else {
+        const char* src = start;
+        char* dst = out;
+        while (src < p) {
+            const char* slash = xon_scan_find_byte(src, p, '\\');
+            memcpy(dst, src, (size_t)(slash - src));
+            dst += slash - src;
+            if (slash >= p) break;
+            *dst++ = xon_lexer_decode_escape(slash[1]);
+            src = slash + 2;
         }
-        if (c != EOF) ungetc(c, pFile);
     }
+    out[len] = '\0';
 
-    buffer[i] = '\0';
+    lexer->cursor = p + 1;
+    pData->sVal = out;
+    pData->sLen = len;
+    return STRING;
+}
+
+static int is_number_char(int c, int prev) {
+    return (CHAR_CLASS[c] & CC_NUMBER) || ((c == '+' || c == '-') && (prev == 'e' || prev == 'E'));
+}
+
+// Numbers are converted straight from the input span (see number.c).
+static int parse_number_token(XonLexer* lexer, int first_char, XonTokenData* pData, char** ppzErrMsg) {
+    const char* start = lexer->cursor - 1;
+    int prev = first_char;
+    int c;
 
-    if (is_hex) {
-        char* parse_start = buffer;
-        int negative = 0;
-        char* endptr = NULL;
-        unsigned long long raw;
-        if (buffer[0] == '-') {
-            negative = 1;
-            parse_start++;
+    if (first_char == '0' && (span_match(lexer, 'x') || span_match(lexer, 'X'))) {
+        const char* digits = lexer->cursor;
+        while ((c = span_peek(lexer)) != EOF && (CHAR_CLASS[c] & CC_HEX)) {
+            lexer->cursor++;
         }
-        raw = strtoull(parse_start + 2, &endptr, 16);
-        if (*endptr != '\0') {
+        if (!xon_parse_hex(digits, lexer->cursor, &pData->nVal)) {
             if (ppzErrMsg) *ppzErrMsg = xon_strdup("Invalid hexadecimal number");
             return -1;
         }
-        pData->nVal = negative ? -(double)raw : (double)raw;
         return NUMBER;
     }
 
-    errno = 0;
-    char* endptr = NULL;
-    pData->nVal = strtod(buffer, &endptr);
-    if (errno != 0 || !endptr || *endptr != '\0') {
+    while ((c = span_peek(lexer)) != EOF && is_number_char(c, prev)) {
+        prev = c;
+        lexer->cursor++;
+    }
+
+    if (!xon_parse_decimal(start, lexer->cursor, &pData->nVal)) {
         if (ppzErrMsg) *ppzErrMsg = xon_strdup("Invalid number literal");
         return -1;
     }
     return NUMBER;
 }
 
-int xon_get_token(FILE *pFile, XonTokenData *pData, char **ppzErrMsg, int *pLine) {
+int xon_lexer_next(XonLexer* lexer, XonTokenData* pData, char** ppzErrMsg) {
     int c;
+    int token;
 
     if (ppzErrMsg) *ppzErrMsg = NULL;
     if (pData) {
         pData->sVal = NULL;
+        pData->span = NULL;
+        pData->sLen = 0;
         pData->nVal = 0.0;
     }
 
-    c = read_non_ws(pFile, pLine, ppzErrMsg);
-    if (c == -1) return -1;
+    c = read_non_ws(lexer, ppzErrMsg);
+    if (c == READ_ERROR) return -1;
     if (c == EOF) return 0;
+    lexer->token_start = lexer->cursor - 1;
 
-    switch (c) {
-        case '{': return LBRACE;
-        case '}': return RBRACE;
-        case '[': return LBRACKET;
-        case ']': return RBRACKET;
-        case '(': return LPAREN;
-        case ')': return RPAREN;
-        case ',': return COMMA;
-        case ':': return COLON;
-        case '.': return DOT;
-        case '+': return PLUS;
-        case '-': return MINUS;
-        case '*': return STAR;
-        case '/': return SLASH;
-        case '%': return PERCENT;
-        case '?': {
-            int next = fgetc(pFile);
-            if (next == '?') return NULLCOALESCE;
-            if (next != EOF) ungetc(next, pFile);
-            return QUESTION;
-        }
-        case '!': {
-            int next = fgetc(pFile);
-            if (next == '=') return NOTEQ;
-            if (next != EOF) ungetc(next, pFile);
-            return NOT;
+    token = SINGLE_CHAR_TOKEN[c];
+    if (token) return token;
+
+    if (CHAR_CLASS[c] & CC_IDENT_START) {
+        const char* start = lexer->cursor - 1;
+        size_t len;
+        while (lexer->cursor < lexer->end && (CHAR_CLASS[(unsigned char)*lexer->cursor] & CC_IDENT)) {
+            lexer->cursor++;
         }
-        case '=': {
-            int next = fgetc(pFile);
-            if (next == '=') return EQEQ;
-            if (next == '>') return ARROW;
-            if (next != EOF) ungetc(next, pFile);
+        len = (size_t)(lexer->cursor - start);
+
+        token = xon_lexer_keyword(start, len);
+        if (token) return token;
+
+        // Identifiers are returned as spans; the parser copies the ones it keeps.
+        pData->span = start;
+        pData->sLen = len;
+        return IDENTIFIER;
+    }
+
+    if (CHAR_CLASS[c] & CC_DIGIT) {
+        return parse_number_token(lexer, c, pData, ppzErrMsg);
+    }
+
+    switch (c) {
+        case '"': return parse_string_token(lexer, pData, ppzErrMsg);
+        case '?': return span_match(lexer, '?') ? NULLCOALESCE : QUESTION;
+        case '!': return span_match(lexer, '=') ? NOTEQ : NOT;
+        case '=':
+            if (span_match(lexer, '=')) return EQEQ;
+            if (span_match(lexer, '>')) return ARROW;
             return ASSIGN;
-        }
-        case '<': {
-            int next = fgetc(pFile);
-            if (next == '=') return LTE;
-            if (next != EOF) ungetc(next, pFile);
-            return LT;
-        }
-        case '>': {
-            int next = fgetc(pFile);
-            if (next == '=') return GTE;
-            if (next != EOF) ungetc(next, pFile);
-            return GT;
-        }
-        case '&': {
-            int next = fgetc(pFile);
-            if (next == '&') return AND;
+        case '<': return span_match(lexer, '=') ? LTE : LT;
+        case '>': return span_match(lexer, '=') ? GTE : GT;
+        case '&':
+            if (span_match(lexer, '&')) return AND;
             if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unexpected '&' operator");
-            if (next != EOF) {
-                ungetc(next, pFile);
-            }
             return -1;
-        }
-        case '|': {
-            int next = fgetc(pFile);
-            if (next == '|') return OR;
+        case '|':
+            if (span_match(lexer, '|')) return OR;
             if (ppzErrMsg) *ppzErrMsg = xon_strdup("Unexpected '|' operator");
-            if (next != EOF) {
-                ungetc(next, pFile);
-            }
             return -1;
-        }
         default:
             break;
     }
 
-    if (c == '"') {
-        return parse_string_token(pFile, pData, ppzErrMsg, pLine);
-    }
-
-    if (isdigit((unsigned char)c) || c == '-') {
-        return parse_number_token(pFile, c, pData, ppzErrMsg);
-    }
-
-    if (isalpha((unsigned char)c) || c == '_' || c == '$') {
-        char buffer[128];
-        size_t i = 0;
-        buffer[i++] = (char)c;
-        while ((c = fgetc(pFile)) != EOF && (isalnum((unsigned char)c) || c == '_' || c == '$')) {
-            if (i < sizeof(buffer) - 1) buffer[i++] = (char)c;
-        }
-        buffer[i] = '\0';
-        if (c != EOF) ungetc(c, pFile);
-
-        if (strcmp(buffer, "let") == 0) return LET;
-        if (strcmp(buffer, "const") == 0) return CONST;
-        if (strcmp(buffer, "if") == 0) return IF;
-        if (strcmp(buffer, "else") == 0) return ELSE;
-        if (strcmp(buffer, "true") == 0) return TRUE;
-        if (strcmp(buffer, "false") == 0) return FALSE;
-        if (strcmp(buffer, "null") == 0) return NULL_VAL;
-
-        pData->sVal = xon_strdup(buffer);
-        if (!pData->sVal) {
-            if (ppzErrMsg) *ppzErrMsg = xon_strdup("Out of memory while parsing identifier");
-            return -1;
-        }
-        return IDENTIFIER;
-    }
-
     if (ppzErrMsg) {
         char err[64];
         snprintf(err, sizeof(err), "Unexpected character '%c'", (char)c);
@@ -1,14 +1,41 @@
 #ifndef XON_LEXER_H
 #define XON_LEXER_H
 
-#include <stdio.h>
+#include <stddef.h>
 
-typedef union {
+// STRING tokens own sVal (decoded, NUL-terminated), unless the lexer has
+// raw_strings set. IDENTIFIER tokens leave sVal NULL and point span into the
+// input instead. sLen is set for both.
+typedef struct {
     char *sVal;
+    const char *span;
+    size_t sLen;
     double nVal;
 } XonTokenData;
 
-// NEW: Added int *pLine to track line numbers
-int xon_get_token(FILE *pFile, XonTokenData *pData, char **ppzErrMsg, int *pLine);
+struct XonArena;
 
-#endif // XON_LEXER_H
\ No newline at end of file
+// Cursor over an in-memory input span. The buffer must outlive the lexer.
+// When arena is set, STRING token text is allocated from it instead of malloc.
+// When raw_strings is set, STRING tokens are spans of their undecoded text
+// instead, so nothing is allocated. token_start points at the first byte of
+// the most recent token (or of the error, or the end of input).
+typedef struct XonLexer {
+    const char *cursor;
+    const char *end;
+    const char *token_start;
+    int line;
+    struct XonArena *arena;
+    int raw_strings;
+} XonLexer;
+
+void xon_lexer_init(XonLexer *lexer, const char *data, size_t len);
+int xon_lexer_next(XonLexer *lexer, XonTokenData *pData, char **ppzErrMsg);
+
+// Decoded byte for a backslash escape; esc is the character after the backslash.
+char xon_lexer_decode_escape(char esc);
+
+// Token id of a keyword spelled by start[0..len), or 0 for other identifiers.
+int xon_lexer_keyword(const char *start, size_t len);
+
+#endif // XON_LEXER_H
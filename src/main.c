@@ -36,10 +36,13 @@ static void print_usage(const char* program) {
             "  %s <file.xon>\n"
             "  %s parse <file.xon>\n"
             "  %s validate <file.xon>\n"
+            "  %s check <file.xon>\n"
             "  %s format <input.xon> [-o output.xon]\n"
             "  %s convert <input.(xon|json)> <output.(json|xon)>\n"
-            "  %s eval <file.xon>\n",
-            program, program, program, program, program, program);
+            "  %s eval <file.xon>\n"
+            "  %s query <file.xon> <path>\n"
+            "  %s stream [--format xonl|ndjson] [--eval] [file|-]\n",
+            program, program, program, program, program, program, program, program, program);
     xon_log_warn("cli", "Invalid CLI usage invoked");
 }
 
@@ -58,19 +61,39 @@ static int cmd_parse(const char* input_path) {
     return 0;
 }
 
+// Validation only needs the event parser: no tree is built.
 static int cmd_validate(const char* input_path) {
-    XonValue* root = xonify(input_path);
-    if (!root) {
+    if (!xon_validate_file(input_path)) {
         fprintf(stderr, "Invalid Xon: %s\n", input_path);
         xon_log_error("cli", "Validation failed for %s", input_path);
         return 1;
     }
     printf("Valid Xon: %s\n", input_path);
     xon_log_info("cli", "Validation succeeded for %s", input_path);
-    xon_free(root);
     return 0;
 }
 
+// Lists every syntax error, one "file:line:column: message" line each.
+static int cmd_check(const char* input_path) {
+    XonDiagnostic* diagnostics = NULL;
+    size_t count = 0;
+    size_t i;
+
+    if (xon_diagnose_file(input_path, &diagnostics, &count)) {
+        printf("Valid Xon: %s\n", input_path);
+        xon_log_info("cli", "Check succeeded for %s", input_path);
+        return 0;
+    }
+    for (i = 0; i < count; i++) {
+        fprintf(stderr, "%s:%d:%d: %s\n", input_path, diagnostics[i].line, diagnostics[i].column,
+                diagnostics[i].message);
+    }
+    if (count == 0) fprintf(stderr, "Invalid Xon: %s\n", input_path);
+    xon_log_error("cli", "Check found %zu errors in %s", count, input_path);
+    xon_diagnostics_free(diagnostics, count);
+    return 1;
+}
+
 static int cmd_format(const char* input_path, const char* output_path) {
     XonValue* root = xonify(input_path);
     char* formatted;
@@ -106,44 +129,51 @@ static int cmd_format(const char* input_path, const char* output_path) {
     return rc;
 }
 
+// Streams events straight into the output format. Output goes to a temporary
+// file that only replaces output_path once the whole input has parsed.
 static int cmd_convert(const char* input_path, const char* output_path) {
-    XonValue* root = xonify(input_path);
-    char* serialized = NULL;
-    int rc;
-
-    if (!root) {
-        fprintf(stderr, "Parse failed for %s\n", input_path);
-        xon_log_error("cli", "Convert parse failed for %s", input_path);
-        return 1;
-    }
+    char* tmp_path;
+    FILE* out;
+    int as_json;
+    int ok;
 
     if (ends_with(output_path, ".json")) {
-        serialized = xon_to_json(root, 1);
+        as_json = 1;
     } else if (ends_with(output_path, ".xon")) {
-        serialized = xon_to_xon(root, 1);
+        as_json = 0;
     } else {
         fprintf(stderr, "Unsupported output extension: %s\n", output_path);
         xon_log_warn("cli", "Unsupported output extension: %s", output_path);
-        xon_free(root);
         return 1;
     }
 
-    if (!serialized) {
+    tmp_path = (char*)malloc(strlen(output_path) + 5);
+    if (!tmp_path) {
         fprintf(stderr, "Failed to convert %s\n", input_path);
-        xon_log_error("cli", "Conversion failed for %s", input_path);
-        xon_free(root);
+        return 1;
+    }
+    sprintf(tmp_path, "%s.tmp", output_path);
+    out = fopen(tmp_path, "w");
+    if (!out) {
+        perror("Failed to open output file");
+        free(tmp_path);
         return 1;
     }
 
-    rc = write_text_file(output_path, serialized);
-    if (!rc) {
-        printf("Converted %s -> %s\n", input_path, output_path);
-        xon_log_info("cli", "Converted %s -> %s", input_path, output_path);
+    ok = xon_convert_file(input_path, out, as_json, 1);
+    if (fclose(out) != 0) ok = 0;
+    if (!ok || rename(tmp_path, output_path) != 0) {
+        remove(tmp_path);
+        free(tmp_path);
+        fprintf(stderr, "Failed to convert %s\n", input_path);
+        xon_log_error("cli", "Conversion failed for %s", input_path);
+        return 1;
     }
+    free(tmp_path);
 
-    xon_string_free(serialized);
-    xon_free(root);
-    return rc;
+    printf("Converted %s -> %s\n", input_path, output_path);
+    xon_log_info("cli", "Converted %s -> %s", input_path, output_path);
+    return 0;
 }
 
 static int cmd_eval(const char* input_path) {
@@ -182,6 +212,139 @@ static int cmd_eval(const char* input_path) {
     return rc;
 }
 
+typedef struct {
+    int as_json;
+    size_t failed;
+} QueryOutput;
+
+static int write_match(void* user_data, const XonValue* value) {
+    QueryOutput* output = (QueryOutput*)user_data;
+    char* text = output->as_json ? xon_to_json(value, 0) : xon_to_xon(value, 0);
+
+    if (!text) {
+        output->failed++;
+        return 1;
+    }
+    puts(text);
+    xon_string_free(text);
+    return 1;
+}
+
+// Prints each match of path in the evaluated document, one per line: JSON for
+// .json input, compact Xon otherwise. Exits 1 if nothing matches.
+static int cmd_query(const char* input_path, const char* expr) {
+    XonPath* path = xon_path_compile(expr);
+    XonValue* root;
+    XonValue* evaluated;
+    QueryOutput output;
+    size_t matches;
+
+    if (!path) {
+        xon_log_error("cli", "Invalid query path: %s", expr);
+        return 1;
+    }
+    root = xonify(input_path);
+    if (!root) {
+        fprintf(stderr, "Parse failed for %s\n", input_path);
+        xon_log_error("cli", "Query parse failed for %s", input_path);
+        xon_path_free(path);
+        return 1;
+    }
+    evaluated = xon_eval(root);
+    if (!evaluated) {
+        fprintf(stderr, "Evaluation failed for %s\n", input_path);
+        xon_log_error("cli", "Query evaluation failed for %s", input_path);
+        xon_free(root);
+        xon_path_free(path);
+        return 1;
+    }
+
+    memset(&output, 0, sizeof(output));
+    output.as_json = ends_with(input_path, ".json");
+    matches = xon_path_each(path, evaluated, write_match, &output);
+    if (output.failed > 0) fprintf(stderr, "Failed to serialize %zu matches\n", output.failed);
+    xon_log_info("cli", "Query matched %zu values in %s", matches, input_path);
+
+    xon_free(evaluated);
+    xon_free(root);
+    xon_path_free(path);
+    return matches > 0 && output.failed == 0 ? 0 : 1;
+}
+
+typedef struct {
+    int as_json;
+    size_t failed;
+} StreamOutput;
+
+static int write_record(void* user_data, size_t index, const XonValue* value) {
+    StreamOutput* output = (StreamOutput*)user_data;
+    char* text;
+
+    if (!value) {
+        fprintf(stderr, "Record %zu failed\n", index + 1);
+        output->failed++;
+        return 1;
+    }
+    text = output->as_json ? xon_to_json(value, 0) : xon_to_xon(value, 0);
+    if (!text) {
+        fprintf(stderr, "Failed to serialize record %zu\n", index + 1);
+        output->failed++;
+        return 1;
+    }
+    puts(text);
+    xon_string_free(text);
+    return 1;
+}
+
+// One document per record in, one line per record out (JSON for NDJSON
+// input, compact Xon for XON lines), in input order.
+static int cmd_stream(int argc, char** argv) {
+    XonRecordOptions options;
+    StreamOutput output;
+    const char* input_path = NULL;
+    FILE* in = stdin;
+    int i;
+    int ok;
+
+    memset(&options, 0, sizeof(options));
+    memset(&output, 0, sizeof(output));
+    for (i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            const char* format = argv[++i];
+            if (strcmp(format, "ndjson") == 0) {
+                options.one_per_line = 1;
+                output.as_json = 1;
+            } else if (strcmp(format, "xonl") != 0) {
+                fprintf(stderr, "Unsupported stream format: %s\n", format);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--eval") == 0) {
+            options.evaluate = 1;
+        } else if (!input_path && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            input_path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (input_path && strcmp(input_path, "-") != 0) {
+        in = fopen(input_path, "rb");
+        if (!in) {
+            perror("Failed to open input file");
+            return 1;
+        }
+    }
+    ok = xon_records_parse(in, &options, write_record, &output);
+    if (in != stdin) fclose(in);
+    if (ok != 1 || output.failed > 0) {
+        xon_log_error("cli", "Stream finished with %zu failed records", output.failed);
+        return 1;
+    }
+    xon_log_info("cli", "Stream finished");
+    return 0;
+}
+
 int main(int argc, char** argv) {
     const char* command;
     int rc = 1;
@@ -189,6 +352,16 @@ int main(int argc, char** argv) {
     xon_logger_init("xon-cli");
     xon_logger_set_directory("logs");
     xon_log_info("cli", "CLI invocation started");
+    // Each command parses one document and frees it whole.
+    xon_enable_arena(1);
+    xon_enable_tape(1);
+    xon_set_parse_threads(0);
+
+    if (argc >= 2 && strcmp(argv[1], "stream") == 0) {
+        rc = cmd_stream(argc, argv);
+        xon_shutdown_logging();
+        return rc;
+    }
 
     if (argc == 2) {
         rc = cmd_parse(argv[1]);
@@ -216,6 +389,12 @@ int main(int argc, char** argv) {
         return rc;
     }
 
+    if (strcmp(command, "check") == 0) {
+        rc = cmd_check(argv[2]);
+        xon_shutdown_logging();
+        return rc;
+    }
+
     if (strcmp(command, "format") == 0) {
         if (argc == 3) {
             rc = cmd_format(argv[2], NULL);
@@ -243,6 +422,17 @@ int main(int argc, char** argv) {
         return rc;
     }
 
+    if (strcmp(command, "query") == 0) {
+        if (argc != 4) {
+            print_usage(argv[0]);
+            xon_shutdown_logging();
+            return 1;
+        }
+        rc = cmd_query(argv[2], argv[3]);
+        xon_shutdown_logging();
+        return rc;
+    }
+
     if (strcmp(command, "eval") == 0) {
         if (argc != 3) {
             print_usage(argv[0]);
@@ -0,0 +1,19 @@
+#ifndef XON_NUMBER_H
+#define XON_NUMBER_H
+
+#include <stddef.h>
+
+// Locale-independent number parsing over an input span. Decimal literals are
+// converted with an integer fast path, Clinger's exact fast path, then the
+// Eisel-Lemire algorithm; results are correctly rounded (round-to-nearest-even).
+
+// Parses digits [ '.' digits ] [ (e|E) [+|-] digits ] spanning exactly [p, end).
+// Returns 0 if the span is malformed or the value overflows to infinity or
+// underflows to zero.
+int xon_parse_decimal(const char *p, const char *end, double *out);
+
+// Parses hex digits (no "0x" prefix) spanning exactly [p, end). Values above
+// UINT64_MAX saturate, matching strtoull().
+int xon_parse_hex(const char *p, const char *end, double *out);
+
+#endif // XON_NUMBER_H
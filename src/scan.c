@@ -0,0 +1,391 @@
+#include "scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define XON_SCAN_X86 1
+#include <immintrin.h>
+#define XON_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+typedef struct {
+    const char* (*skip_ws)(const char* p, const char* end, int* lines);
+    const char* (*find_byte)(const char* p, const char* end, char c);
+    const char* (*block_comment)(const char* p, const char* end, int* lines);
+    const char* (*string)(const char* p, const char* end, int* lines);
+    void (*classify64)(const char* p, XonBlockClasses* out);
+} ScanKernels;
+
+// Matches isspace() in the C locale: ' ', '\t', '\n', '\v', '\f', '\r'.
+static int is_ws(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= 4;
+}
+
+// ---- scalar ---------------------------------------------------------------
+
+static const char* scalar_skip_ws(const char* p, const char* end, int* lines) {
+    while (p < end && is_ws((unsigned char)*p)) {
+        if (*p == '\n') (*lines)++;
+        p++;
+    }
+    return p;
+}
+
+static const char* scalar_find_byte(const char* p, const char* end, char c) {
+    const char* hit = p < end ? (const char*)memchr(p, c, (size_t)(end - p)) : NULL;
+    return hit ? hit : end;
+}
+
+static const char* scalar_block_comment(const char* p, const char* end, int* lines) {
+    while (p < end) {
+        if (*p == '\n') {
+            (*lines)++;
+        } else if (*p == '*' && p + 1 < end && p[1] == '/') {
+            return p + 2;
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static const char* scalar_string(const char* p, const char* end, int* lines) {
+    while (p < end && *p != '"' && *p != '\\') {
+        if (*p == '\n') (*lines)++;
+        p++;
+    }
+    return p;
+}
+
+static void scalar_classify64(const char* p, XonBlockClasses* out) {
+    int i;
+    memset(out, 0, sizeof(*out));
+    for (i = 0; i < 64; i++) {
+        unsigned char c = (unsigned char)p[i];
+        uint64_t bit = (uint64_t)1 << i;
+        switch (c) {
+            case '"': out->quote |= bit; break;
+            case '\\': out->backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': out->op |= bit; break;
+            case '/': case '#': out->comment |= bit; break;
+            default:
+                if (is_ws(c)) out->ws |= bit;
+                break;
+        }
+    }
+}
+
+static const ScanKernels SCALAR_KERNELS = {
+    scalar_skip_ws, scalar_find_byte, scalar_block_comment, scalar_string, scalar_classify64
+};
+
+#if defined(XON_SCAN_X86)
+
+// ---- SSE2 (16-byte blocks) ------------------------------------------------
+
+XON_TARGET("sse2")
+static unsigned sse2_ws_mask(__m128i b) {
+    __m128i t = _mm_sub_epi8(b, _mm_set1_epi8('\t'));
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t);
+    __m128i ws = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')), ctl);
+    return (unsigned)_mm_movemask_epi8(ws);
+}
+
+XON_TARGET("sse2")
+static const char* sse2_skip_ws(const char* p, const char* end, int* lines) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)p);
+        unsigned ws = sse2_ws_mask(b);
+        unsigned nls = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, nl));
+        if (ws != 0xFFFFu) {
+            unsigned stop = (unsigned)__builtin_ctz(~ws);
+            *lines += __builtin_popcount(nls & ((1u << stop) - 1u));
+            return p + stop;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 16;
+    }
+    return scalar_skip_ws(p, end, lines);
+}
+
+XON_TARGET("sse2")
+static const char* sse2_find_byte(const char* p, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)p);
+        unsigned hits = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, needle));
+        if (hits) return p + __builtin_ctz(hits);
+        p += 16;
+    }
+    return scalar_find_byte(p, end, c);
+}
+
+XON_TARGET("sse2")
+static const char* sse2_block_comment(const char* p, const char* end, int* lines) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i nl = _mm_set1_epi8('\n');
+    // Keep one byte of lookahead so p[i + 1] is always in bounds.
+    while (end - p > 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)p);
+        unsigned stars = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, star));
+        unsigned nls = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, nl));
+        while (stars) {
+            unsigned i = (unsigned)__builtin_ctz(stars);
+            if (p[i + 1] == '/') {
+                *lines += __builtin_popcount(nls & ((1u << i) - 1u));
+                return p + i + 2;
+            }
+            stars &= stars - 1u;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 16;
+    }
+    return scalar_block_comment(p, end, lines);
+}
+
+XON_TARGET("sse2")
+static const char* sse2_string(const char* p, const char* end, int* lines) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i b = _mm_loadu_si128((const __m128i*)p);
+        __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(b, quote), _mm_cmpeq_epi8(b, backslash));
+        unsigned stops = (unsigned)_mm_movemask_epi8(stop);
+        unsigned nls = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, nl));
+        if (stops) {
+            unsigned i = (unsigned)__builtin_ctz(stops);
+            *lines += __builtin_popcount(nls & ((1u << i) - 1u));
+            return p + i;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 16;
+    }
+    return scalar_string(p, end, lines);
+}
+
+XON_TARGET("sse2")
+static uint64_t sse2_eq(__m128i b, char c) {
+    return (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_set1_epi8(c)));
+}
+
+XON_TARGET("sse2")
+static void sse2_classify64(const char* p, XonBlockClasses* out) {
+    int i;
+    memset(out, 0, sizeof(*out));
+    for (i = 0; i < 4; i++) {
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + 16 * i));
+        int shift = 16 * i;
+        out->quote |= sse2_eq(b, '"') << shift;
+        out->backslash |= sse2_eq(b, '\\') << shift;
+        out->op |= (sse2_eq(b, '{') | sse2_eq(b, '}') | sse2_eq(b, '[') | sse2_eq(b, ']') |
+                    sse2_eq(b, ':') | sse2_eq(b, ',')) << shift;
+        out->ws |= (uint64_t)sse2_ws_mask(b) << shift;
+        out->comment |= (sse2_eq(b, '/') | sse2_eq(b, '#')) << shift;
+    }
+}
+
+static const ScanKernels SSE2_KERNELS = {
+    sse2_skip_ws, sse2_find_byte, sse2_block_comment, sse2_string, sse2_classify64
+};
+
+// ---- AVX2 (32-byte blocks) ------------------------------------------------
+
+XON_TARGET("avx2")
+static unsigned avx2_ws_mask(__m256i b) {
+    __m256i t = _mm256_sub_epi8(b, _mm256_set1_epi8('\t'));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t);
+    __m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(' ')), ctl);
+    return (unsigned)_mm256_movemask_epi8(ws);
+}
+
+XON_TARGET("avx2")
+static const char* avx2_skip_ws(const char* p, const char* end, int* lines) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i*)p);
+        unsigned ws = avx2_ws_mask(b);
+        unsigned nls = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl));
+        if (ws != 0xFFFFFFFFu) {
+            unsigned stop = (unsigned)__builtin_ctz(~ws);
+            *lines += __builtin_popcount(nls & ((1u << stop) - 1u));
+            return p + stop;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 32;
+    }
+    return sse2_skip_ws(p, end, lines);
+}
+
+XON_TARGET("avx2")
+static const char* avx2_find_byte(const char* p, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i*)p);
+        unsigned hits = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, needle));
+        if (hits) return p + __builtin_ctz(hits);
+        p += 32;
+    }
+    return sse2_find_byte(p, end, c);
+}
+
+XON_TARGET("avx2")
+static const char* avx2_block_comment(const char* p, const char* end, int* lines) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i nl = _mm256_set1_epi8('\n');
+    while (end - p > 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i*)p);
+        unsigned stars = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, star));
+        unsigned nls = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl));
+        while (stars) {
+            unsigned i = (unsigned)__builtin_ctz(stars);
+            if (p[i + 1] == '/') {
+                *lines += __builtin_popcount(nls & ((1u << i) - 1u));
+                return p + i + 2;
+            }
+            stars &= stars - 1u;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 32;
+    }
+    return sse2_block_comment(p, end, lines);
+}
+
+XON_TARGET("avx2")
+static const char* avx2_string(const char* p, const char* end, int* lines) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i nl = _mm256_set1_epi8('\n');
+    while (end - p >= 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i*)p);
+        __m256i stop = _mm256_or_si256(_mm256_cmpeq_epi8(b, quote), _mm256_cmpeq_epi8(b, backslash));
+        unsigned stops = (unsigned)_mm256_movemask_epi8(stop);
+        unsigned nls = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl));
+        if (stops) {
+            unsigned i = (unsigned)__builtin_ctz(stops);
+            *lines += __builtin_popcount(nls & ((1u << i) - 1u));
+            return p + i;
+        }
+        *lines += __builtin_popcount(nls);
+        p += 32;
+    }
+    return sse2_string(p, end, lines);
+}
+
+XON_TARGET("avx2")
+static uint64_t avx2_eq(__m256i b, char c) {
+    return (uint64_t)(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(c)));
+}
+
+XON_TARGET("avx2")
+static void avx2_classify64(const char* p, XonBlockClasses* out) {
+    __m256i lo = _mm256_loadu_si256((const __m256i*)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)(p + 32));
+    out->quote = avx2_eq(lo, '"') | avx2_eq(hi, '"') << 32;
+    out->backslash = avx2_eq(lo, '\\') | avx2_eq(hi, '\\') << 32;
+    out->op = avx2_eq(lo, '{') | avx2_eq(lo, '}') | avx2_eq(lo, '[') | avx2_eq(lo, ']') |
+              avx2_eq(lo, ':') | avx2_eq(lo, ',') |
+              (avx2_eq(hi, '{') | avx2_eq(hi, '}') | avx2_eq(hi, '[') | avx2_eq(hi, ']') |
+               avx2_eq(hi, ':') | avx2_eq(hi, ',')) << 32;
+    out->ws = (uint64_t)avx2_ws_mask(lo) | (uint64_t)avx2_ws_mask(hi) << 32;
+    out->comment = avx2_eq(lo, '/') | avx2_eq(lo, '#') | (avx2_eq(hi, '/') | avx2_eq(hi, '#')) << 32;
+}
+
+static const ScanKernels AVX2_KERNELS = {
+    avx2_skip_ws, avx2_find_byte, avx2_block_comment, avx2_string, avx2_classify64
+};
+
+#endif // XON_SCAN_X86
+
+// ---- dispatch -------------------------------------------------------------
+
+static const ScanKernels* g_kernels = NULL;
+static XonScanLevel g_level = XON_SCAN_SCALAR;
+
+static XonScanLevel cpu_level(void) {
+#if defined(XON_SCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return XON_SCAN_AVX2;
+    if (__builtin_cpu_supports("sse2")) return XON_SCAN_SSE2;
+#endif
+    return XON_SCAN_SCALAR;
+}
+
+static XonScanLevel env_level_cap(void) {
+    const char* value = getenv("XON_SIMD");
+    if (!value) return XON_SCAN_AVX2;
+    if (strcmp(value, "scalar") == 0) return XON_SCAN_SCALAR;
+    if (strcmp(value, "sse2") == 0) return XON_SCAN_SSE2;
+    return XON_SCAN_AVX2;
+}
+
+static const ScanKernels* kernels_for(XonScanLevel level) {
+#if defined(XON_SCAN_X86)
+    if (level == XON_SCAN_AVX2) return &AVX2_KERNELS;
+    if (level == XON_SCAN_SSE2) return &SSE2_KERNELS;
+#endif
+    (void)level;
+    return &SCALAR_KERNELS;
+}
+
+XonScanLevel xon_scan_set_level(XonScanLevel level) {
+    XonScanLevel supported = cpu_level();
+    g_level = level < supported ? level : supported;
+    g_kernels = kernels_for(g_level);
+    return g_level;
+}
+
+static void resolve_kernels(void) {
+    if (!g_kernels) xon_scan_set_level(env_level_cap());
+}
+
+// Parse workers and record-stream threads all scan, so the first use must
+// not race: pthread_once picks the kernels once and publishes them.
+#if !defined(_WIN32)
+static pthread_once_t g_kernels_once = PTHREAD_ONCE_INIT;
+#endif
+
+static const ScanKernels* active_kernels(void) {
+#if !defined(_WIN32)
+    pthread_once(&g_kernels_once, resolve_kernels);
+#else
+    resolve_kernels();
+#endif
+    return g_kernels;
+}
+
+XonScanLevel xon_scan_level(void) {
+    active_kernels();
+    return g_level;
+}
+
+const char* xon_scan_skip_ws(const char* p, const char* end, int* lines) {
+    // Most gaps between tokens are a single space; skip the vector setup then.
+    if (p < end && !is_ws((unsigned char)*p)) return p;
+    if (p + 1 < end && !is_ws((unsigned char)p[1])) {
+        if (*p == '\n') (*lines)++;
+        return p + 1;
+    }
+    return active_kernels()->skip_ws(p, end, lines);
+}
+
+const char* xon_scan_find_byte(const char* p, const char* end, char c) {
+    return active_kernels()->find_byte(p, end, c);
+}
+
+const char* xon_scan_block_comment(const char* p, const char* end, int* lines) {
+    return active_kernels()->block_comment(p, end, lines);
+}
+
+const char* xon_scan_string(const char* p, const char* end, int* lines) {
+    return active_kernels()->string(p, end, lines);
+}
+
+void xon_scan_classify64(const char* p, XonBlockClasses* out) {
+    active_kernels()->classify64(p, out);
+}
@@ -0,0 +1,50 @@
+#ifndef XON_SCAN_H
+#define XON_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Byte-scanning kernels used by the lexer. Each has a scalar implementation
+// and, on x86, SSE2 and AVX2 variants selected at runtime from CPUID. Setting
+// XON_SIMD=scalar|sse2|avx2 in the environment caps the level that is used.
+
+typedef enum {
+    XON_SCAN_SCALAR = 0,
+    XON_SCAN_SSE2 = 1,
+    XON_SCAN_AVX2 = 2
+} XonScanLevel;
+
+// Returns the first byte at or after p that is not whitespace (or end).
+// Adds the number of '\n' bytes skipped to *lines.
+const char *xon_scan_skip_ws(const char *p, const char *end, int *lines);
+
+// Returns the first occurrence of c at or after p, or end if there is none.
+const char *xon_scan_find_byte(const char *p, const char *end, char c);
+
+// p points just past an opening "/*". Returns the byte after the closing "*/",
+// or NULL if the comment is unterminated. Adds newlines inside it to *lines.
+const char *xon_scan_block_comment(const char *p, const char *end, int *lines);
+
+// Returns the first '"' or '\\' at or after p, or end if there is none.
+// Adds the number of '\n' bytes before it to *lines.
+const char *xon_scan_string(const char *p, const char *end, int *lines);
+
+// Byte classes of one 64-byte block, one bit per byte (bit i is p[i]).
+typedef struct {
+    uint64_t quote;     // '"'
+    uint64_t backslash; // '\\'
+    uint64_t op;        // { } [ ] : ,
+    uint64_t ws;        // whitespace
+    uint64_t comment;   // '/' or '#', which may start a comment
+} XonBlockClasses;
+
+// Classifies exactly 64 bytes starting at p.
+void xon_scan_classify64(const char *p, XonBlockClasses *out);
+
+// Active kernel level, and an override used by tests and benchmarks.
+// Requests above what the CPU supports are clamped. The override is not
+// synchronised: set it before any thread parses.
+XonScanLevel xon_scan_level(void);
+XonScanLevel xon_scan_set_level(XonScanLevel level);
+
+#endif // XON_SCAN_H
@@ -0,0 +1,255 @@
+#include "structural.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan.h"
+
+enum { COMMENT_NONE, COMMENT_LINE, COMMENT_BLOCK };
+
+// Scanner state between blocks, valid at the first byte not yet scanned.
+typedef struct {
+    int in_string;
+    int escaped;     // that byte is escaped by a preceding backslash
+    int prev_scalar; // the byte before it continues a scalar run
+    int comment;
+} IndexState;
+
+typedef struct {
+    uint32_t* pos;
+    size_t count;
+    size_t cap;
+} IndexBuffer;
+
+static int reserve(IndexBuffer* buf, size_t extra) {
+    uint32_t* pos;
+    size_t cap;
+    if (buf->count + extra <= buf->cap) return 1;
+    cap = buf->cap * 2;
+    if (cap < buf->count + extra) cap = buf->count + extra;
+    pos = (uint32_t*)realloc(buf->pos, cap * sizeof(uint32_t));
+    if (!pos) return 0;
+    buf->pos = pos;
+    buf->cap = cap;
+    return 1;
+}
+
+static int is_op(unsigned char c) {
+    return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+}
+
+static int is_ws(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= 4;
+}
+
+// Byte-at-a-time scan of [i, stop). A two-byte comment delimiter that starts
+// just before stop is consumed whole, so the return value may be stop + 1.
+static size_t scan_bytes(const char* data, size_t len, size_t i, size_t stop, IndexState* st, IndexBuffer* buf) {
+    while (i < stop) {
+        unsigned char c = (unsigned char)data[i];
+        if (st->comment == COMMENT_LINE) {
+            if (c == '\n') st->comment = COMMENT_NONE;
+        } else if (st->comment == COMMENT_BLOCK) {
+            if (c == '*' && i + 1 < len && data[i + 1] == '/') {
+                st->comment = COMMENT_NONE;
+                i++;
+            }
+        } else if (st->in_string) {
+            if (st->escaped) {
+                st->escaped = 0;
+            } else if (c == '\\') {
+                st->escaped = 1;
+            } else if (c == '"') {
+                st->in_string = 0;
+                buf->pos[buf->count++] = (uint32_t)i;
+            }
+        } else if (c == '"') {
+            st->in_string = 1;
+            st->escaped = 0;
+            st->prev_scalar = 0;
+            buf->pos[buf->count++] = (uint32_t)i;
+        } else if (c == '#' || (c == '/' && i + 1 < len && (data[i + 1] == '/' || data[i + 1] == '*'))) {
+            st->comment = (c == '/' && data[i + 1] == '*') ? COMMENT_BLOCK : COMMENT_LINE;
+            st->prev_scalar = 0;
+            if (c == '/') i++;
+        } else if (is_op(c)) {
+            st->prev_scalar = 0;
+            buf->pos[buf->count++] = (uint32_t)i;
+        } else if (is_ws(c)) {
+            st->prev_scalar = 0;
+        } else {
+            if (!st->prev_scalar) buf->pos[buf->count++] = (uint32_t)i;
+            st->prev_scalar = 1;
+        }
+        i++;
+    }
+    return i;
+}
+
+// Backslashes that escape the byte after them: the ends of odd-length runs.
+static uint64_t escaped_bytes(uint64_t backslash, int* escaped) {
+    const uint64_t even = 0x5555555555555555ULL;
+    uint64_t carry = (uint64_t)*escaped;
+    uint64_t follows, odd_starts, sum, invert;
+
+    backslash &= ~carry;
+    follows = (backslash << 1) | carry;
+    odd_starts = backslash & ~even & ~follows;
+    sum = odd_starts + backslash;
+    *escaped = sum < odd_starts;
+    invert = sum << 1;
+    return (even ^ invert) & follows;
+}
+
+// Bit i set iff an odd number of bits at or below i are set in x.
+static uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Classifies the 64 bytes at data + i. Returns 0 without touching the state
+// when a comment may start outside a string; the caller then scans bytes.
+static int scan_block(const char* data, size_t i, IndexState* st, IndexBuffer* buf) {
+    XonBlockClasses cls;
+    uint64_t quotes, in_string, scalar, starts, structural;
+    int escaped = st->escaped;
+
+    xon_scan_classify64(data + i, &cls);
+    quotes = cls.quote & ~escaped_bytes(cls.backslash, &escaped);
+    in_string = prefix_xor(quotes) ^ (st->in_string ? ~(uint64_t)0 : 0);
+    if (cls.comment & ~in_string) return 0;
+
+    // in_string covers an opening quote and the bytes after it, but not the
+    // closing quote.
+    scalar = ~(cls.op | cls.ws | cls.quote | in_string);
+    starts = scalar & ~((scalar << 1) | (uint64_t)st->prev_scalar);
+    structural = (cls.op & ~in_string) | quotes | starts;
+
+    st->in_string = (int)(in_string >> 63);
+    st->escaped = escaped;
+    st->prev_scalar = (int)(scalar >> 63);
+    while (structural) {
+        buf->pos[buf->count++] = (uint32_t)(i + (size_t)__builtin_ctzll(structural));
+        structural &= structural - 1;
+    }
+    return 1;
+}
+
+// Runs the scan over data, handing each batch of entries to visit() before the
+// buffer is reused when keep is 0. Returns 0 on a scan error, OOM or when
+// visit() returns 0.
+static int scan_document(const char* data, size_t len, IndexBuffer* buf, int keep,
+                         int (*visit)(const char*, const uint32_t*, size_t, void*), void* ctx) {
+    IndexState st;
+    size_t i = 0;
+
+    if (len > UINT32_MAX) return 0;
+    memset(&st, 0, sizeof(st));
+    while (i < len) {
+        size_t block = len - i < 64 ? len - i : 64;
+        // A block adds at most one entry per byte.
+        if (!reserve(buf, 65)) return 0;
+        if (block == 64 && st.comment == COMMENT_NONE && scan_block(data, i, &st, buf)) {
+            i += 64;
+        } else {
+            i = scan_bytes(data, len, i, i + block, &st, buf);
+        }
+        if (!keep) {
+            if (visit && !visit(data, buf->pos, buf->count, ctx)) return 0;
+            buf->count = 0;
+        }
+    }
+    return !st.in_string && st.comment != COMMENT_BLOCK;
+}
+
+int xon_structural_index(const char* data, size_t len, XonStructuralIndex* out) {
+    IndexBuffer buf;
+
+    out->pos = NULL;
+    out->count = 0;
+    if (len > UINT32_MAX) return 0;
+
+    buf.count = 0;
+    buf.cap = len / 4 + 64;
+    buf.pos = (uint32_t*)malloc(buf.cap * sizeof(uint32_t));
+    if (!buf.pos) return 0;
+    if (!scan_document(data, len, &buf, 1, NULL, NULL)) {
+        free(buf.pos);
+        return 0;
+    }
+    out->pos = buf.pos;
+    out->count = buf.count;
+    return 1;
+}
+
+typedef struct {
+    size_t depth;
+    size_t parts;
+    size_t len;
+    size_t next_part; // k of the next split wanted
+    size_t* splits;
+    size_t count;
+    int started;
+} SplitState;
+
+static int visit_split(const char* data, const uint32_t* pos, size_t n, void* ctx) {
+    SplitState* sp = (SplitState*)ctx;
+    size_t j;
+
+    for (j = 0; j < n; j++) {
+        char c = data[pos[j]];
+        if (!sp->started) {
+            if (c != '[') return 0;
+            sp->started = 1;
+        }
+        if (c == '[' || c == '{') {
+            sp->depth++;
+        } else if (c == ']' || c == '}') {
+            if (sp->depth > 0) sp->depth--;
+        } else if (c == ',' && sp->depth == 1 && sp->next_part < sp->parts) {
+            size_t at = pos[j];
+            if (at >= sp->next_part * sp->len / sp->parts) {
+                sp->splits[sp->count++] = at;
+                // Parts that are already behind this comma get no split of their own.
+                while (sp->next_part < sp->parts && sp->next_part * sp->len / sp->parts <= at) sp->next_part++;
+            }
+        }
+    }
+    return 1;
+}
+
+int xon_structural_split(const char* data, size_t len, size_t parts, size_t* splits, size_t* count) {
+    IndexBuffer buf;
+    SplitState sp;
+    int ok;
+
+    *count = 0;
+    if (parts == 0) return 0;
+    memset(&sp, 0, sizeof(sp));
+    sp.parts = parts;
+    sp.len = len;
+    sp.next_part = 1;
+    sp.splits = splits;
+
+    buf.count = 0;
+    buf.cap = 128;
+    buf.pos = (uint32_t*)malloc(buf.cap * sizeof(uint32_t));
+    if (!buf.pos) return 0;
+    ok = scan_document(data, len, &buf, 0, visit_split, &sp) && sp.started;
+    free(buf.pos);
+    if (!ok) return 0;
+    *count = sp.count;
+    return 1;
+}
+
+void xon_structural_free(XonStructuralIndex* index) {
+    if (!index) return;
+    free(index->pos);
+    index->pos = NULL;
+    index->count = 0;
+}
@@ -0,0 +1,31 @@
+#ifndef XON_STRUCTURAL_H
+#define XON_STRUCTURAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Stage 1 of the tape parser: the offsets of every structural byte in a
+// document, in order. These are the brackets, ':' and ',' outside strings,
+// both quotes of every string, and the first byte of every other run of
+// non-whitespace (numbers, keywords, identifiers, operators). Comments and
+// whitespace produce no entries. 64-byte blocks are classified with the SIMD
+// kernels in scan.h; blocks that contain a comment are walked byte by byte.
+typedef struct {
+    uint32_t *pos;
+    size_t count;
+} XonStructuralIndex;
+
+// Returns 1 on success. Returns 0 if the input is larger than 4 GiB, a string
+// or block comment is unterminated, or memory runs out.
+int xon_structural_index(const char *data, size_t len, XonStructuralIndex *out);
+void xon_structural_free(XonStructuralIndex *index);
+
+// Split points for parsing a top-level list in parts: for each k in
+// 1..parts-1, the offset of the first comma between root-level items at or
+// after k * len / parts, skipping offsets already taken. Uses the same scan as
+// xon_structural_index() but keeps no index, so memory use is constant. Stores
+// up to parts - 1 offsets in splits and their number in *count. Returns 0 if
+// the document does not start with '[', or on the same errors as above.
+int xon_structural_split(const char *data, size_t len, size_t parts, size_t *splits, size_t *count);
+
+#endif // XON_STRUCTURAL_H
@@ -26,12 +26,15 @@
 ** input grammar file:
 */
 /************ Begin %include sections from the grammar ************************/
-#line 46 "src/xon.lemon"
+#line 70 "src/xon.lemon"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
+#include "intern.h"
+
 typedef struct XonExpr XonExpr;
 
 typedef enum {
@@ -117,16 +120,32 @@ typedef enum {
     TYPE_FUNCTION
 } DataType;
 
+// DataNode.flags
+#define XON_NODE_ARENA 0x01      // allocated in a document arena; never freed alone
+#define XON_NODE_ARENA_ROOT 0x02 // document root shell; xon_free() drops the arena
+#define XON_NODE_LITERAL 0x04    // subtree holds no expressions or declarations
+
 typedef struct DataNode {
     DataType type;
+    unsigned char flags;
     struct DataNode* next;
     union {
-        char* s_val;
+        // Strings carry their byte length so consumers never need strlen().
+        struct {
+            char* s_val;
+            size_t s_len;
+        } str;
         double n_val;
         int b_val;
         struct {
             struct DataNode* key;
             struct DataNode* value;
+            // Containers: child index of large ones, or NULL (see xon_api.c).
+            // Pairs: hash of the key, filled in by the index; 0 until then.
+            union {
+                struct XonChildIndex* index;
+                size_t key_hash;
+            } cache;
         } aggregate;
 
         struct {
@@ -140,69 +159,161 @@ typedef struct DataNode {
     } data;
 } DataNode;
 
+// STRING tokens own s_val. IDENTIFIER tokens are spans into the input
+// (span, s_len); rules that keep the name copy it with token_text().
 typedef struct Token {
     char* s_val;
+    const char* span;
+    size_t s_len;
     double n_val;
     int line;
+    const char* pos; // first byte of the token in the input
 } Token;
 
+// Defined in xon_api.c, which includes this parser; used by the destructors
+// and by new_container_node().
+static void free_xon_ast(DataNode* root);
+static void child_index_build(XonArena* arena, DataNode* container, size_t children);
+
+// Validation passes XON_NO_NODES as its arena: every allocation fails on
+// purpose, so the actions yield NULL and only the grammar itself runs.
+static char xon_no_nodes;
+#define XON_NO_NODES ((XonArena*)&xon_no_nodes)
+
+// Parse-tree allocations come from the document arena when one is active,
+// otherwise from the heap. Evaluation and cloning always pass NULL.
+static void* node_alloc(XonArena* arena, size_t size) {
+    if (arena == XON_NO_NODES) return NULL;
+    return arena ? xon_arena_alloc(arena, size) : malloc(size);
+}
+
+static char* token_copy(XonArena* arena, Token token) {
+    char* out = (char*)node_alloc(arena, token.s_len + 1);
+    if (!out) return NULL;
+    memcpy(out, token.span, token.s_len);
+    out[token.s_len] = '\0';
+    return out;
+}
+
 typedef void (*XonSyntaxErrorHandler)(int line, const char* token, void* user_data);
 
 typedef struct ParserState {
     struct DataNode** result;
+    XonArena* arena;
+    XonIntern* intern; // reusable parser contexts only; implies arena
     int had_error;
     XonSyntaxErrorHandler on_syntax_error;
+    XonSyntaxErrorHandler on_lexer_error; // recovering parses; gets the message
+    // Incremental parsing: the source span of each object and list, from its
+    // opening bracket to just past its closing one.
+    void (*on_container)(struct DataNode* node, const char* start, const char* end, int line, void* user_data);
     void* user_data;
 } ParserState;
 
-DataNode* new_node(DataType type) {
-    DataNode* n = (DataNode*)malloc(sizeof(DataNode));
+// Identifier text for the tree: shared from the context's intern table when
+// there is one, otherwise a fresh copy.
+static char* token_text(ParserState* state, Token token) {
+    if (state->intern) {
+        const char* interned = xon_intern(state->intern, token.span, token.s_len);
+        if (interned) return (char*)interned;
+    }
+    return token_copy(state->arena, token);
+}
+
+DataNode* new_node_in(XonArena* arena, DataType type) {
+    DataNode* n = (DataNode*)node_alloc(arena, sizeof(DataNode));
     if (n) {
         memset(n, 0, sizeof(DataNode));
         n->type = type;
+        if (arena) n->flags = XON_NODE_ARENA;
     }
     return n;
 }
 
-DataNode* link_node(DataNode* head, DataNode* item) {
-    if (!head) return item;
-    DataNode* current = head;
-    while (current->next) {
-        current = current->next;
+DataNode* new_node(DataType type) {
+    return new_node_in(NULL, type);
+}
+
+// Sibling chain under construction. Carrying the tail through the list rules
+// makes each append O(1) instead of walking the chain built so far.
+typedef struct NodeChain {
+    DataNode* head;
+    DataNode* tail;
+} NodeChain;
+
+static NodeChain chain_start(DataNode* item) {
+    NodeChain chain;
+    chain.head = item;
+    chain.tail = item;
+    while (chain.tail && chain.tail->next) chain.tail = chain.tail->next;
+    return chain;
+}
+
+static NodeChain chain_append(NodeChain chain, DataNode* item) {
+    if (!item) return chain;
+    if (!chain.head) return chain_start(item);
+    chain.tail->next = item;
+    chain.tail = item;
+    while (chain.tail->next) chain.tail = chain.tail->next;
+    return chain;
+}
+
+static DataNode* new_literal_node(XonArena* arena, DataType type) {
+    DataNode* n = new_node_in(arena, type);
+    if (n) n->flags |= XON_NODE_LITERAL;
+    return n;
+}
+
+// Containers whose items are all literals are flagged so that evaluation can
+// copy them as-is instead of walking them through the evaluator.
+static DataNode* new_container_node(XonArena* arena, DataType type, DataNode* items) {
+    DataNode* n = new_node_in(arena, type);
+    DataNode* item;
+    size_t count = 0;
+    int literal = 1;
+
+    if (!n) return NULL;
+    n->data.aggregate.value = items;
+    for (item = items; item; item = item->next) {
+        if (!(item->flags & XON_NODE_LITERAL)) literal = 0;
+        count++;
     }
-    current->next = item;
-    return head;
+    if (literal) n->flags |= XON_NODE_LITERAL;
+    child_index_build(arena, n, count);
+    return n;
 }
 
-static DataNode* new_pair_node(const char* key, DataNode* value) {
-    DataNode* node = new_node(TYPE_OBJECT);
+static DataNode* new_pair_node(XonArena* arena, const char* key, size_t key_len, DataNode* value) {
+    DataNode* node = new_node_in(arena, TYPE_OBJECT);
     if (!node) return NULL;
-    node->data.aggregate.key = new_node(TYPE_STRING);
+    node->data.aggregate.key = new_node_in(arena, TYPE_STRING);
     if (!node->data.aggregate.key) {
-        free(node);
+        if (!arena) free(node);
         return NULL;
     }
-    node->data.aggregate.key->data.s_val = (char*)key;
+    if (value && (value->flags & XON_NODE_LITERAL)) node->flags |= XON_NODE_LITERAL;
+    node->data.aggregate.key->data.str.s_val = (char*)key;
+    node->data.aggregate.key->data.str.s_len = key_len;
     node->data.aggregate.value = value;
     return node;
 }
 
-DataNode* new_list_node(DataNode* first_item) {
-    DataNode* list = new_node(TYPE_LIST);
+DataNode* new_list_node(XonArena* arena, DataNode* first_item) {
+    DataNode* list = new_node_in(arena, TYPE_LIST);
     if (!list) return NULL;
     list->data.aggregate.value = first_item;
     return list;
 }
 
-DataNode* new_expr_node(XonExpr* expr) {
-    DataNode* n = new_node(TYPE_EXPR);
+DataNode* new_expr_node(XonArena* arena, XonExpr* expr) {
+    DataNode* n = new_node_in(arena, TYPE_EXPR);
     if (!n) return NULL;
     n->data.expr = expr;
     return n;
 }
 
-XonExpr* xon_expr_identifier(const char* name, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_identifier(XonArena* arena, const char* name, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_IDENTIFIER;
     expr->line = line;
@@ -210,8 +321,8 @@ XonExpr* xon_expr_identifier(const char* name, int line) {
     return expr;
 }
 
-XonExpr* xon_expr_binary(XonExprOp op, DataNode* left, DataNode* right, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_binary(XonArena* arena, XonExprOp op, DataNode* left, DataNode* right, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_BINARY;
     expr->line = line;
@@ -221,8 +332,8 @@ XonExpr* xon_expr_binary(XonExprOp op, DataNode* left, DataNode* right, int line
     return expr;
 }
 
-XonExpr* xon_expr_unary(XonExprOp op, DataNode* operand, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_unary(XonArena* arena, XonExprOp op, DataNode* operand, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_UNARY;
     expr->line = line;
@@ -231,8 +342,8 @@ XonExpr* xon_expr_unary(XonExprOp op, DataNode* operand, int line) {
     return expr;
 }
 
-XonExpr* xon_expr_member(DataNode* object, const char* member, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_member(XonArena* arena, DataNode* object, const char* member, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_MEMBER;
     expr->line = line;
@@ -241,8 +352,8 @@ XonExpr* xon_expr_member(DataNode* object, const char* member, int line) {
     return expr;
 }
 
-XonExpr* xon_expr_ternary(DataNode* cond, DataNode* then_expr, DataNode* else_expr, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_ternary(XonArena* arena, DataNode* cond, DataNode* then_expr, DataNode* else_expr, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_TERNARY;
     expr->line = line;
@@ -252,8 +363,8 @@ XonExpr* xon_expr_ternary(DataNode* cond, DataNode* then_expr, DataNode* else_ex
     return expr;
 }
 
-XonExpr* xon_expr_if(DataNode* cond, DataNode* then_expr, DataNode* else_expr, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_if(XonArena* arena, DataNode* cond, DataNode* then_expr, DataNode* else_expr, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_IF;
     expr->line = line;
@@ -263,8 +374,8 @@ XonExpr* xon_expr_if(DataNode* cond, DataNode* then_expr, DataNode* else_expr, i
     return expr;
 }
 
-XonExpr* xon_expr_call(DataNode* callee, DataNode* args, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_call(XonArena* arena, DataNode* callee, DataNode* args, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_CALL;
     expr->line = line;
@@ -273,8 +384,8 @@ XonExpr* xon_expr_call(DataNode* callee, DataNode* args, int line) {
     return expr;
 }
 
-XonExpr* xon_expr_function(DataNode* params, DataNode* body, int line) {
-    XonExpr* expr = (XonExpr*)malloc(sizeof(XonExpr));
+XonExpr* xon_expr_function(XonArena* arena, DataNode* params, DataNode* body, int line) {
+    XonExpr* expr = (XonExpr*)node_alloc(arena, sizeof(XonExpr));
     if (!expr) return NULL;
     expr->kind = XON_EXPR_FUNCTION;
     expr->line = line;
@@ -283,8 +394,8 @@ XonExpr* xon_expr_function(DataNode* params, DataNode* body, int line) {
     return expr;
 }
 
-DataNode* new_decl_node(int is_const, const char* name, DataNode* init_expr) {
-    DataNode* n = new_node(TYPE_DECL);
+DataNode* new_decl_node(XonArena* arena, int is_const, const char* name, DataNode* init_expr) {
+    DataNode* n = new_node_in(arena, TYPE_DECL);
     if (!n) return NULL;
     n->data.declaration.is_const = is_const;
     n->data.declaration.name = (char*)name;
@@ -292,15 +403,23 @@ DataNode* new_decl_node(int is_const, const char* name, DataNode* init_expr) {
     return n;
 }
 
-DataNode* new_param_node(const char* name) {
-    DataNode* node = new_node(TYPE_STRING);
+static DataNode* container_span(ParserState* state, DataNode* node, Token open, Token close) {
+    if (state->on_container && node && open.pos && close.pos) {
+        state->on_container(node, open.pos, close.pos + 1, open.line, state->user_data);
+    }
+    return node;
+}
+
+DataNode* new_param_node(XonArena* arena, const char* name, size_t name_len) {
+    DataNode* node = new_node_in(arena, TYPE_STRING);
     if (!node) return NULL;
-    node->data.s_val = (char*)name;
+    node->data.str.s_val = (char*)name;
+    node->data.str.s_len = name_len;
     return node;
 }
 
  
-#line 304 "src/xon.c"
+#line 423 "src/xon.c"
 /**************** End of %include directives **********************************/
 /* These constants specify the various numeric values for terminal symbols.
 ***************** Begin token definitions *************************************/
@@ -406,13 +525,15 @@ DataNode* new_param_node(const char* name) {
 #endif
 /************* Begin control #defines *****************************************/
 #define YYCODETYPE unsigned char
-#define YYNOCODE 60
-#define YYACTIONTYPE unsigned char
+#define YYNOCODE 61
+#define YYACTIONTYPE unsigned short int
 #define xonParserTOKENTYPE Token
 typedef union {
   int yyinit;
   xonParserTOKENTYPE yy0;
-  DataNode* yy19;
+  NodeChain yy56;
+  DataNode* yy73;
+  int yy123;
 } YYMINORTYPE;
 #ifndef YYSTACKDEPTH
 #define YYSTACKDEPTH 100
@@ -424,26 +545,28 @@ typedef union {
 #define xonParserARG_STORE yypParser->pState =pState ;
 #define YYREALLOC realloc
 #define YYFREE free
-#define YYDYNSTACK 0
+#define YYDYNSTACK 1
 #define xonParserCTX_SDECL
 #define xonParserCTX_PDECL
 #define xonParserCTX_PARAM
 #define xonParserCTX_FETCH
 #define xonParserCTX_STORE
+#define YYERRORSYMBOL 60
+#define YYERRSYMDT yy123
 #define YYNSTATE             77
-#define YYNRULE              66
-#define YYNRULE_WITH_ACTION  63
+#define YYNRULE              69
+#define YYNRULE_WITH_ACTION  68
 #define YYNTOKEN             38
 #define YY_MAX_SHIFT         76
-#define YY_MIN_SHIFTREDUCE   117
-#define YY_MAX_SHIFTREDUCE   182
-#define YY_ERROR_ACTION      183
-#define YY_ACCEPT_ACTION     184
-#define YY_NO_ACTION         185
-#define YY_MIN_REDUCE        186
-#define YY_MAX_REDUCE        251
+#define YY_MIN_SHIFTREDUCE   120
+#define YY_MAX_SHIFTREDUCE   188
+#define YY_ERROR_ACTION      189
+#define YY_ACCEPT_ACTION     190
+#define YY_NO_ACTION         191
+#define YY_MIN_REDUCE        192
+#define YY_MAX_REDUCE        260
 #define YY_MIN_DSTRCTR       0
-#define YY_MAX_DSTRCTR       0
+#define YY_MAX_DSTRCTR       60
 /************* End control #defines *******************************************/
 #define YY_NLOOKAHEAD ((int)(sizeof(yy_lookahead)/sizeof(yy_lookahead[0])))
 
@@ -526,175 +649,174 @@ typedef union {
 **  yy_default[]       Default action for each state.
 **
 *********** Begin parsing tables **********************************************/
-#define YY_ACTTAB_COUNT (641)
+#define YY_ACTTAB_COUNT (638)
 static const YYACTIONTYPE yy_action[] = {
- /*     0 */   239,  192,  187,  240,    8,   64,   64,   73,   49,   66,
- /*    10 */    45,   35,   41,   38,  225,   46,  232,    5,  239,   61,
- /*    20 */    63,  240,   52,  244,  244,   73,   49,   66,   45,   35,
- /*    30 */    41,   38,  225,   46,  232,   58,   59,  239,   26,   25,
- /*    40 */   240,   50,  200,  200,   73,   49,   66,   45,   35,   41,
- /*    50 */    38,  225,   46,  232,   33,   51,  191,  165,    6,  164,
- /*    60 */    32,   28,   27,    3,  130,   33,   71,    1,  165,   54,
- /*    70 */   164,    7,  184,   76,    3,  129,   75,   71,    1,   30,
- /*    80 */    29,   20,   19,  162,   31,  161,  166,  167,  168,  169,
- /*    90 */    30,   29,  179,   33,   60,   31,    9,  166,  167,  168,
- /*   100 */   169,  121,    3,   74,  239,   56,   55,  240,   53,  201,
- /*   110 */   201,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   120 */   232,  120,   62,   74,  239,   56,   55,  240,   53,  196,
- /*   130 */   196,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   140 */   232,   16,   17,    2,  239,  119,   34,  240,  172,  195,
- /*   150 */   195,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   160 */   232,   57,  247,   18,  239,   17,   12,  240,   13,  194,
- /*   170 */   194,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   180 */   232,   10,   14,   15,  239,   11,  186,  240,  185,  245,
- /*   190 */   245,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   200 */   232,  185,  185,  185,  239,  185,  185,  240,  185,  242,
- /*   210 */   242,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   220 */   232,  185,  185,  185,  239,  185,  185,  240,  185,   70,
- /*   230 */    70,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   240 */   232,  185,  185,  185,  239,  185,  185,  240,  185,  193,
- /*   250 */   193,   73,   49,   66,   45,   35,   41,   38,  225,   46,
- /*   260 */   232,   33,  185,  185,  165,  185,   65,  185,    4,  185,
- /*   270 */     3,  185,   33,   71,    1,  165,  128,  164,  185,  185,
- /*   280 */   185,    3,  185,  185,   71,    1,   30,   29,  185,  185,
- /*   290 */   185,   31,  185,  166,  167,  168,  169,   30,   29,  185,
- /*   300 */   185,  185,   31,  185,  166,  167,  168,  169,   24,   23,
- /*   310 */    22,   21,  239,  185,  185,  240,  185,  185,  203,   73,
- /*   320 */    49,   66,   45,   35,   41,   38,  225,   46,  232,  185,
- /*   330 */   185,  239,  185,  185,  240,  185,  185,   69,   73,   49,
- /*   340 */    66,   45,   35,   41,   38,  225,   46,  232,  185,  185,
- /*   350 */   185,  185,  239,  185,  185,  240,  185,  185,  202,   73,
- /*   360 */    49,   66,   45,   35,   41,   38,  225,   46,  232,  185,
- /*   370 */   185,  239,  185,  185,  240,  185,  185,   72,   73,   49,
- /*   380 */    66,   45,   35,   41,   38,  225,   46,  232,   33,  185,
- /*   390 */   185,  165,  185,  164,  185,  239,  185,    3,  240,  185,
- /*   400 */   185,    1,  185,   68,   66,   45,   35,   41,   38,  225,
- /*   410 */    46,  232,  185,   30,   29,  185,  185,  185,   31,  185,
- /*   420 */   166,  167,  168,  169,  239,  185,  185,  240,  185,  185,
- /*   430 */   185,  185,  185,   67,   45,   35,   41,   38,  225,   46,
- /*   440 */   232,  239,  185,  185,  240,  185,  185,  239,  185,  185,
- /*   450 */   240,   48,   35,   41,   38,  225,   46,  232,   36,   41,
- /*   460 */    38,  225,   46,  232,  239,  185,  185,  240,  185,  185,
- /*   470 */   185,  185,  185,  185,  185,   37,   41,   38,  225,   46,
- /*   480 */   232,  239,  185,  185,  240,  185,  185,  239,  185,  185,
- /*   490 */   240,  185,  185,   42,   38,  225,   46,  232,  185,   43,
- /*   500 */    38,  225,   46,  232,  239,  185,  185,  240,  185,  185,
- /*   510 */   185,  185,  185,  185,  185,  185,   44,   38,  225,   46,
- /*   520 */   232,  239,  185,  185,  240,  185,  185,  239,  185,  185,
- /*   530 */   240,  185,  185,   47,   38,  225,   46,  232,  185,  185,
- /*   540 */    39,  225,   46,  232,  239,  185,  185,  240,  185,  185,
- /*   550 */   185,  185,  185,  185,  185,  185,  185,   40,  225,   46,
- /*   560 */   232,  239,  185,  185,  240,  185,  185,  239,  185,  185,
- /*   570 */   240,  185,  185,  185,  185,  224,   46,  232,  185,  185,
- /*   580 */   185,  223,   46,  232,  239,  185,  185,  240,  185,  185,
- /*   590 */   185,  185,  185,  185,  185,  185,  185,  185,  228,   46,
- /*   600 */   232,  239,  185,  185,  240,  185,  185,  239,  185,  185,
- /*   610 */   240,  185,  185,  185,  185,  227,   46,  232,  185,  185,
- /*   620 */   185,  226,   46,  232,  239,  185,  185,  240,  185,  185,
- /*   630 */   185,  185,  185,  185,  185,  185,  185,  185,  222,   46,
- /*   640 */   232,
+ /*     0 */   248,  191,  191,  249,   50,  207,  207,   73,   49,   66,
+ /*    10 */    45,   35,   41,   38,  234,   46,  241,  248,   16,   17,
+ /*    20 */   249,  137,   64,   64,   73,   49,   66,   45,   35,   41,
+ /*    30 */    38,  234,   46,  241,    5,  248,   61,   63,  249,  198,
+ /*    40 */   254,  254,   73,   49,   66,   45,   35,   41,   38,  234,
+ /*    50 */    46,  241,   58,   59,  248,   26,   25,  249,  127,  208,
+ /*    60 */   208,   73,   49,   66,   45,   35,   41,   38,  234,   46,
+ /*    70 */   241,   33,   20,   19,  171,  138,  170,   33,   51,  197,
+ /*    80 */     1,  134,   33,   71,    2,  171,    1,  170,    6,  190,
+ /*    90 */    76,    1,  133,   75,   71,    2,   30,   29,  127,  122,
+ /*   100 */    34,   31,    4,  172,  173,  174,  175,   30,   29,   52,
+ /*   110 */   132,   54,   31,    7,  172,  173,  174,  175,  124,  168,
+ /*   120 */    74,  248,   56,   55,  249,   53,  203,  203,   73,   49,
+ /*   130 */    66,   45,   35,   41,   38,  234,   46,  241,  123,  167,
+ /*   140 */    74,  248,   56,   55,  249,   53,  202,  202,   73,   49,
+ /*   150 */    66,   45,   35,   41,   38,  234,   46,  241,   32,   28,
+ /*   160 */    27,  248,    3,    8,  249,  187,  201,  201,   73,   49,
+ /*   170 */    66,   45,   35,   41,   38,  234,   46,  241,   60,   62,
+ /*   180 */    57,  248,    9,  178,  249,   18,  255,  255,   73,   49,
+ /*   190 */    66,   45,   35,   41,   38,  234,   46,  241,  258,   17,
+ /*   200 */    12,  248,   13,   10,  249,   14,  251,  251,   73,   49,
+ /*   210 */    66,   45,   35,   41,   38,  234,   46,  241,   15,   11,
+ /*   220 */   193,  248,  192,  191,  249,  191,   70,   70,   73,   49,
+ /*   230 */    66,   45,   35,   41,   38,  234,   46,  241,  191,  191,
+ /*   240 */   191,  248,  191,  191,  249,  191,  200,  200,   73,   49,
+ /*   250 */    66,   45,   35,   41,   38,  234,   46,  241,   33,  191,
+ /*   260 */   191,  171,  191,   65,  191,  191,  191,    1,  191,   33,
+ /*   270 */    71,    2,  171,  191,  170,  191,  191,  191,    1,  191,
+ /*   280 */   191,   71,    2,   30,   29,  191,  191,  191,   31,  191,
+ /*   290 */   172,  173,  174,  175,   30,   29,  191,  191,  191,   31,
+ /*   300 */   191,  172,  173,  174,  175,   24,   23,   22,   21,  248,
+ /*   310 */   191,  191,  249,  191,  191,  212,   73,   49,   66,   45,
+ /*   320 */    35,   41,   38,  234,   46,  241,  191,  191,  248,  191,
+ /*   330 */   191,  249,  191,  191,   69,   73,   49,   66,   45,   35,
+ /*   340 */    41,   38,  234,   46,  241,  191,  191,  191,  191,  248,
+ /*   350 */   191,  191,  249,  191,  191,  211,   73,   49,   66,   45,
+ /*   360 */    35,   41,   38,  234,   46,  241,  191,  191,  248,  191,
+ /*   370 */   191,  249,  191,  191,   72,   73,   49,   66,   45,   35,
+ /*   380 */    41,   38,  234,   46,  241,   33,  191,  191,  171,  191,
+ /*   390 */   170,  191,  248,  191,    1,  249,  191,  191,    2,  191,
+ /*   400 */    68,   66,   45,   35,   41,   38,  234,   46,  241,  191,
+ /*   410 */    30,   29,  191,  191,  191,   31,  191,  172,  173,  174,
+ /*   420 */   175,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   430 */    67,   45,   35,   41,   38,  234,   46,  241,  248,  191,
+ /*   440 */   191,  249,  191,  191,  248,  191,  191,  249,   48,   35,
+ /*   450 */    41,   38,  234,   46,  241,   36,   41,   38,  234,   46,
+ /*   460 */   241,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   470 */   191,  191,   37,   41,   38,  234,   46,  241,  248,  191,
+ /*   480 */   191,  249,  191,  191,  248,  191,  191,  249,  191,  191,
+ /*   490 */    42,   38,  234,   46,  241,  191,   43,   38,  234,   46,
+ /*   500 */   241,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   510 */   191,  191,  191,   44,   38,  234,   46,  241,  248,  191,
+ /*   520 */   191,  249,  191,  191,  248,  191,  191,  249,  191,  191,
+ /*   530 */    47,   38,  234,   46,  241,  191,  191,   39,  234,   46,
+ /*   540 */   241,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   550 */   191,  191,  191,  191,   40,  234,   46,  241,  248,  191,
+ /*   560 */   191,  249,  191,  191,  248,  191,  191,  249,  191,  191,
+ /*   570 */   191,  191,  233,   46,  241,  191,  191,  191,  232,   46,
+ /*   580 */   241,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   590 */   191,  191,  191,  191,  191,  237,   46,  241,  248,  191,
+ /*   600 */   191,  249,  191,  191,  248,  191,  191,  249,  191,  191,
+ /*   610 */   191,  191,  236,   46,  241,  191,  191,  191,  235,   46,
+ /*   620 */   241,  248,  191,  191,  249,  191,  191,  191,  191,  191,
+ /*   630 */   191,  191,  191,  191,  191,  231,   46,  241,
 };
 static const YYCODETYPE yy_lookahead[] = {
- /*     0 */    39,   41,    0,   42,    3,   44,   45,   46,   47,   48,
- /*    10 */    49,   50,   51,   52,   53,   54,   55,    8,   39,   58,
- /*    20 */    59,   42,    6,   44,   45,   46,   47,   48,   49,   50,
- /*    30 */    51,   52,   53,   54,   55,   56,   57,   39,   26,   27,
- /*    40 */    42,   43,   44,   45,   46,   47,   48,   49,   50,   51,
- /*    50 */    52,   53,   54,   55,    1,   40,   41,    4,    8,    6,
- /*    60 */    28,   29,   30,   10,   11,    1,   13,   14,    4,    6,
- /*    70 */     6,    5,   38,   39,   10,   11,   42,   13,   14,   26,
- /*    80 */    27,   20,   21,    6,   31,   15,   33,   34,   35,   36,
- /*    90 */    26,   27,    6,    1,    3,   31,   37,   33,   34,   35,
- /*   100 */    36,    2,   10,    4,   39,    6,    7,   42,    9,   44,
- /*   110 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   120 */    55,    2,   15,    4,   39,    6,    7,   42,    9,   44,
- /*   130 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   140 */    55,   17,   18,   14,   39,    2,    3,   42,   15,   44,
- /*   150 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   160 */    55,   32,    3,   19,   39,   18,   16,   42,   15,   44,
- /*   170 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   180 */    55,   14,    5,   12,   39,    5,    0,   42,   60,   44,
- /*   190 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   200 */    55,   60,   60,   60,   39,   60,   60,   42,   60,   44,
- /*   210 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   220 */    55,   60,   60,   60,   39,   60,   60,   42,   60,   44,
- /*   230 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   240 */    55,   60,   60,   60,   39,   60,   60,   42,   60,   44,
- /*   250 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
- /*   260 */    55,    1,   60,   60,    4,   60,    6,   60,    3,   60,
- /*   270 */    10,   60,    1,   13,   14,    4,   11,    6,   60,   60,
- /*   280 */    60,   10,   60,   60,   13,   14,   26,   27,   60,   60,
- /*   290 */    60,   31,   60,   33,   34,   35,   36,   26,   27,   60,
- /*   300 */    60,   60,   31,   60,   33,   34,   35,   36,   22,   23,
- /*   310 */    24,   25,   39,   60,   60,   42,   60,   60,   45,   46,
- /*   320 */    47,   48,   49,   50,   51,   52,   53,   54,   55,   60,
- /*   330 */    60,   39,   60,   60,   42,   60,   60,   45,   46,   47,
- /*   340 */    48,   49,   50,   51,   52,   53,   54,   55,   60,   60,
- /*   350 */    60,   60,   39,   60,   60,   42,   60,   60,   45,   46,
- /*   360 */    47,   48,   49,   50,   51,   52,   53,   54,   55,   60,
- /*   370 */    60,   39,   60,   60,   42,   60,   60,   45,   46,   47,
- /*   380 */    48,   49,   50,   51,   52,   53,   54,   55,    1,   60,
- /*   390 */    60,    4,   60,    6,   60,   39,   60,   10,   42,   60,
- /*   400 */    60,   14,   60,   47,   48,   49,   50,   51,   52,   53,
- /*   410 */    54,   55,   60,   26,   27,   60,   60,   60,   31,   60,
- /*   420 */    33,   34,   35,   36,   39,   60,   60,   42,   60,   60,
- /*   430 */    60,   60,   60,   48,   49,   50,   51,   52,   53,   54,
- /*   440 */    55,   39,   60,   60,   42,   60,   60,   39,   60,   60,
- /*   450 */    42,   49,   50,   51,   52,   53,   54,   55,   50,   51,
- /*   460 */    52,   53,   54,   55,   39,   60,   60,   42,   60,   60,
- /*   470 */    60,   60,   60,   60,   60,   50,   51,   52,   53,   54,
- /*   480 */    55,   39,   60,   60,   42,   60,   60,   39,   60,   60,
- /*   490 */    42,   60,   60,   51,   52,   53,   54,   55,   60,   51,
- /*   500 */    52,   53,   54,   55,   39,   60,   60,   42,   60,   60,
- /*   510 */    60,   60,   60,   60,   60,   60,   51,   52,   53,   54,
- /*   520 */    55,   39,   60,   60,   42,   60,   60,   39,   60,   60,
- /*   530 */    42,   60,   60,   51,   52,   53,   54,   55,   60,   60,
- /*   540 */    52,   53,   54,   55,   39,   60,   60,   42,   60,   60,
- /*   550 */    60,   60,   60,   60,   60,   60,   60,   52,   53,   54,
- /*   560 */    55,   39,   60,   60,   42,   60,   60,   39,   60,   60,
- /*   570 */    42,   60,   60,   60,   60,   53,   54,   55,   60,   60,
- /*   580 */    60,   53,   54,   55,   39,   60,   60,   42,   60,   60,
- /*   590 */    60,   60,   60,   60,   60,   60,   60,   60,   53,   54,
- /*   600 */    55,   39,   60,   60,   42,   60,   60,   39,   60,   60,
- /*   610 */    42,   60,   60,   60,   60,   53,   54,   55,   60,   60,
- /*   620 */    60,   53,   54,   55,   39,   60,   60,   42,   60,   60,
- /*   630 */    60,   60,   60,   60,   60,   60,   60,   60,   53,   54,
- /*   640 */    55,   38,   38,   38,   38,   38,   38,   38,   38,   38,
+ /*     0 */    39,   61,   61,   42,   43,   44,   45,   46,   47,   48,
+ /*    10 */    49,   50,   51,   52,   53,   54,   55,   39,   17,   18,
+ /*    20 */    42,   60,   44,   45,   46,   47,   48,   49,   50,   51,
+ /*    30 */    52,   53,   54,   55,    8,   39,   58,   59,   42,   41,
+ /*    40 */    44,   45,   46,   47,   48,   49,   50,   51,   52,   53,
+ /*    50 */    54,   55,   56,   57,   39,   26,   27,   42,   60,   44,
+ /*    60 */    45,   46,   47,   48,   49,   50,   51,   52,   53,   54,
+ /*    70 */    55,    1,   20,   21,    4,   60,    6,    1,   40,   41,
+ /*    80 */    10,   11,    1,   13,   14,    4,   10,    6,    8,   38,
+ /*    90 */    39,   10,   11,   42,   13,   14,   26,   27,   60,    2,
+ /*   100 */     3,   31,    3,   33,   34,   35,   36,   26,   27,    6,
+ /*   110 */    11,    6,   31,    5,   33,   34,   35,   36,    2,    6,
+ /*   120 */     4,   39,    6,    7,   42,    9,   44,   45,   46,   47,
+ /*   130 */    48,   49,   50,   51,   52,   53,   54,   55,    2,   15,
+ /*   140 */     4,   39,    6,    7,   42,    9,   44,   45,   46,   47,
+ /*   150 */    48,   49,   50,   51,   52,   53,   54,   55,   28,   29,
+ /*   160 */    30,   39,   14,    3,   42,    6,   44,   45,   46,   47,
+ /*   170 */    48,   49,   50,   51,   52,   53,   54,   55,    3,   15,
+ /*   180 */    32,   39,   37,   15,   42,   19,   44,   45,   46,   47,
+ /*   190 */    48,   49,   50,   51,   52,   53,   54,   55,    3,   18,
+ /*   200 */    16,   39,   15,   14,   42,    5,   44,   45,   46,   47,
+ /*   210 */    48,   49,   50,   51,   52,   53,   54,   55,   12,    5,
+ /*   220 */     0,   39,    0,   61,   42,   61,   44,   45,   46,   47,
+ /*   230 */    48,   49,   50,   51,   52,   53,   54,   55,   61,   61,
+ /*   240 */    61,   39,   61,   61,   42,   61,   44,   45,   46,   47,
+ /*   250 */    48,   49,   50,   51,   52,   53,   54,   55,    1,   61,
+ /*   260 */    61,    4,   61,    6,   61,   61,   61,   10,   61,    1,
+ /*   270 */    13,   14,    4,   61,    6,   61,   61,   61,   10,   61,
+ /*   280 */    61,   13,   14,   26,   27,   61,   61,   61,   31,   61,
+ /*   290 */    33,   34,   35,   36,   26,   27,   61,   61,   61,   31,
+ /*   300 */    61,   33,   34,   35,   36,   22,   23,   24,   25,   39,
+ /*   310 */    61,   61,   42,   61,   61,   45,   46,   47,   48,   49,
+ /*   320 */    50,   51,   52,   53,   54,   55,   61,   61,   39,   61,
+ /*   330 */    61,   42,   61,   61,   45,   46,   47,   48,   49,   50,
+ /*   340 */    51,   52,   53,   54,   55,   61,   61,   61,   61,   39,
+ /*   350 */    61,   61,   42,   61,   61,   45,   46,   47,   48,   49,
+ /*   360 */    50,   51,   52,   53,   54,   55,   61,   61,   39,   61,
+ /*   370 */    61,   42,   61,   61,   45,   46,   47,   48,   49,   50,
+ /*   380 */    51,   52,   53,   54,   55,    1,   61,   61,    4,   61,
+ /*   390 */     6,   61,   39,   61,   10,   42,   61,   61,   14,   61,
+ /*   400 */    47,   48,   49,   50,   51,   52,   53,   54,   55,   61,
+ /*   410 */    26,   27,   61,   61,   61,   31,   61,   33,   34,   35,
+ /*   420 */    36,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   430 */    48,   49,   50,   51,   52,   53,   54,   55,   39,   61,
+ /*   440 */    61,   42,   61,   61,   39,   61,   61,   42,   49,   50,
+ /*   450 */    51,   52,   53,   54,   55,   50,   51,   52,   53,   54,
+ /*   460 */    55,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   470 */    61,   61,   50,   51,   52,   53,   54,   55,   39,   61,
+ /*   480 */    61,   42,   61,   61,   39,   61,   61,   42,   61,   61,
+ /*   490 */    51,   52,   53,   54,   55,   61,   51,   52,   53,   54,
+ /*   500 */    55,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   510 */    61,   61,   61,   51,   52,   53,   54,   55,   39,   61,
+ /*   520 */    61,   42,   61,   61,   39,   61,   61,   42,   61,   61,
+ /*   530 */    51,   52,   53,   54,   55,   61,   61,   52,   53,   54,
+ /*   540 */    55,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   550 */    61,   61,   61,   61,   52,   53,   54,   55,   39,   61,
+ /*   560 */    61,   42,   61,   61,   39,   61,   61,   42,   61,   61,
+ /*   570 */    61,   61,   53,   54,   55,   61,   61,   61,   53,   54,
+ /*   580 */    55,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   590 */    61,   61,   61,   61,   61,   53,   54,   55,   39,   61,
+ /*   600 */    61,   42,   61,   61,   39,   61,   61,   42,   61,   61,
+ /*   610 */    61,   61,   53,   54,   55,   61,   61,   61,   53,   54,
+ /*   620 */    55,   39,   61,   61,   42,   61,   61,   61,   61,   61,
+ /*   630 */    61,   61,   61,   61,   61,   53,   54,   55,   38,   38,
+ /*   640 */    38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
  /*   650 */    38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
  /*   660 */    38,   38,   38,   38,   38,   38,   38,   38,   38,   38,
- /*   670 */    38,   38,   38,   38,   38,   38,   38,   38,   38,
+ /*   670 */    38,   38,   38,   38,   38,   38,
 };
 #define YY_SHIFT_COUNT    (76)
 #define YY_SHIFT_MIN      (0)
-#define YY_SHIFT_MAX      (387)
+#define YY_SHIFT_MAX      (384)
 static const unsigned short int yy_shift_ofst[] = {
- /*     0 */    92,  260,  271,   53,   64,  271,  271,  271,  271,  271,
- /*    10 */   271,  271,  271,  271,  271,  271,  387,  387,  387,  387,
- /*    20 */   387,  387,  387,  387,  387,  387,  387,  387,  387,  387,
- /*    30 */   387,  387,  387,   99,  119,  286,  286,  286,   32,   32,
- /*    40 */    32,   12,   12,   12,   12,   61,  129,   12,   61,  124,
- /*    50 */   265,  143,    9,   16,   50,   63,   66,   77,    1,   70,
- /*    60 */    86,   91,   59,  107,  133,  159,  144,  144,  147,  150,
- /*    70 */   153,  167,  177,  171,  180,    2,  186,
+ /*     0 */    76,   70,  257,  268,   81,  268,  268,  268,  268,  268,
+ /*    10 */   268,  268,  268,  268,  268,  268,  384,  384,  384,  384,
+ /*    20 */   384,  384,  384,  384,  384,  384,  384,  384,  384,  384,
+ /*    30 */   384,  384,  384,  116,  136,  283,  283,  283,  130,  130,
+ /*    40 */   130,   29,   29,   29,   29,   52,  148,   29,   52,    1,
+ /*    50 */    99,   97,   26,  103,   80,  105,  108,  113,  160,  124,
+ /*    60 */   159,  175,  145,  164,  168,  195,  166,  166,  181,  184,
+ /*    70 */   187,  189,  200,  206,  214,  220,  222,
 };
 #define YY_REDUCE_COUNT (34)
-#define YY_REDUCE_MIN   (-40)
-#define YY_REDUCE_MAX   (585)
+#define YY_REDUCE_MIN   (-39)
+#define YY_REDUCE_MAX   (582)
 static const short yy_reduce_ofst[] = {
- /*     0 */    34,  -39,  -21,   -2,   65,   85,  105,  125,  145,  165,
- /*    10 */   185,  205,  273,  292,  313,  332,  356,  385,  402,  408,
- /*    20 */   425,  442,  448,  465,  482,  488,  505,  522,  528,  545,
- /*    30 */   562,  568,  585,   15,  -40,
+ /*     0 */    51,  -39,  -22,   -4,   15,   82,  102,  122,  142,  162,
+ /*    10 */   182,  202,  270,  289,  310,  329,  353,  382,  399,  405,
+ /*    20 */   422,  439,  445,  462,  479,  485,  502,  519,  525,  542,
+ /*    30 */   559,  565,  582,   38,   -2,
 };
 static const YYACTIONTYPE yy_default[] = {
- /*     0 */   183,  246,  243,  183,  183,  183,  183,  183,  183,  183,
- /*    10 */   183,  183,  183,  183,  183,  183,  183,  183,  183,  183,
- /*    20 */   183,  183,  183,  183,  183,  183,  183,  183,  183,  183,
- /*    30 */   183,  183,  183,  183,  183,  213,  212,  211,  221,  220,
- /*    40 */   219,  218,  217,  216,  215,  210,  229,  214,  209,  205,
- /*    50 */   183,  183,  183,  183,  183,  183,  183,  183,  250,  183,
- /*    60 */   183,  251,  183,  183,  183,  233,  208,  207,  206,  183,
- /*    70 */   183,  183,  183,  204,  183,  183,  183,
+ /*     0 */   189,  189,  256,  252,  189,  189,  189,  189,  189,  189,
+ /*    10 */   189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
+ /*    20 */   189,  189,  189,  189,  189,  189,  189,  189,  189,  189,
+ /*    30 */   189,  189,  189,  189,  189,  222,  221,  220,  230,  229,
+ /*    40 */   228,  227,  226,  225,  224,  219,  238,  223,  218,  214,
+ /*    50 */   189,  189,  189,  189,  189,  189,  189,  189,  253,  189,
+ /*    60 */   189,  257,  189,  189,  189,  242,  217,  216,  215,  189,
+ /*    70 */   189,  189,  189,  213,  189,  189,  189,
 };
 /********** End of lemon-generated parsing tables *****************************/
 
@@ -857,6 +979,7 @@ static const char *const yyTokenName[] = {
   /*   57 */ "arg_list_opt",
   /*   58 */ "param_list",
   /*   59 */ "param_list_opt",
+  /*   60 */ "error",
 };
 #endif /* defined(YYCOVERAGE) || !defined(NDEBUG) */
 
@@ -871,65 +994,68 @@ static const char *const yyRuleName[] = {
  /*   4 */ "object ::= LBRACE RBRACE",
  /*   5 */ "pair_list ::= pair",
  /*   6 */ "pair_list ::= pair_list COMMA pair",
- /*   7 */ "pair ::= STRING COLON expr",
- /*   8 */ "pair ::= IDENTIFIER COLON expr",
- /*   9 */ "pair ::= LET IDENTIFIER ASSIGN expr",
- /*  10 */ "pair ::= CONST IDENTIFIER ASSIGN expr",
- /*  11 */ "list ::= LBRACKET value_list RBRACKET",
- /*  12 */ "list ::= LBRACKET value_list COMMA RBRACKET",
- /*  13 */ "list ::= LBRACKET RBRACKET",
- /*  14 */ "value_list ::= expr",
- /*  15 */ "value_list ::= value_list COMMA expr",
- /*  16 */ "ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr",
- /*  17 */ "ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr",
- /*  18 */ "ternary_expr ::= nullish_expr",
- /*  19 */ "nullish_expr ::= or_expr",
- /*  20 */ "nullish_expr ::= or_expr NULLCOALESCE or_expr",
- /*  21 */ "or_expr ::= or_expr OR and_expr",
- /*  22 */ "or_expr ::= and_expr",
- /*  23 */ "and_expr ::= and_expr AND eq_expr",
- /*  24 */ "and_expr ::= eq_expr",
- /*  25 */ "eq_expr ::= eq_expr EQEQ rel_expr",
- /*  26 */ "eq_expr ::= eq_expr NOTEQ rel_expr",
- /*  27 */ "eq_expr ::= rel_expr",
- /*  28 */ "rel_expr ::= rel_expr LT add_expr",
- /*  29 */ "rel_expr ::= rel_expr LTE add_expr",
- /*  30 */ "rel_expr ::= rel_expr GT add_expr",
- /*  31 */ "rel_expr ::= rel_expr GTE add_expr",
- /*  32 */ "rel_expr ::= add_expr",
- /*  33 */ "add_expr ::= add_expr PLUS mul_expr",
- /*  34 */ "add_expr ::= add_expr MINUS mul_expr",
- /*  35 */ "add_expr ::= mul_expr",
- /*  36 */ "mul_expr ::= mul_expr STAR unary_expr",
- /*  37 */ "mul_expr ::= mul_expr SLASH unary_expr",
- /*  38 */ "mul_expr ::= mul_expr PERCENT unary_expr",
- /*  39 */ "mul_expr ::= unary_expr",
- /*  40 */ "unary_expr ::= NOT unary_expr",
- /*  41 */ "unary_expr ::= PLUS unary_expr",
- /*  42 */ "unary_expr ::= MINUS unary_expr",
- /*  43 */ "unary_expr ::= postfix_expr",
- /*  44 */ "postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN",
- /*  45 */ "postfix_expr ::= postfix_expr DOT IDENTIFIER",
- /*  46 */ "postfix_expr ::= primary_expr",
- /*  47 */ "primary_expr ::= IDENTIFIER",
- /*  48 */ "primary_expr ::= STRING",
- /*  49 */ "primary_expr ::= NUMBER",
- /*  50 */ "primary_expr ::= TRUE",
- /*  51 */ "primary_expr ::= FALSE",
- /*  52 */ "primary_expr ::= NULL_VAL",
- /*  53 */ "primary_expr ::= object",
- /*  54 */ "primary_expr ::= list",
- /*  55 */ "primary_expr ::= LPAREN expr RPAREN",
- /*  56 */ "primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr",
- /*  57 */ "arg_list_opt ::=",
- /*  58 */ "arg_list ::= expr",
- /*  59 */ "arg_list ::= arg_list COMMA expr",
- /*  60 */ "param_list_opt ::=",
- /*  61 */ "param_list ::= IDENTIFIER",
- /*  62 */ "param_list ::= param_list COMMA IDENTIFIER",
- /*  63 */ "expr ::= ternary_expr",
- /*  64 */ "arg_list_opt ::= arg_list",
+ /*   7 */ "pair ::= error",
+ /*   8 */ "pair ::= STRING COLON expr",
+ /*   9 */ "pair ::= IDENTIFIER COLON expr",
+ /*  10 */ "pair ::= LET IDENTIFIER ASSIGN expr",
+ /*  11 */ "pair ::= CONST IDENTIFIER ASSIGN expr",
+ /*  12 */ "list ::= LBRACKET value_list RBRACKET",
+ /*  13 */ "list ::= LBRACKET value_list COMMA RBRACKET",
+ /*  14 */ "list ::= LBRACKET RBRACKET",
+ /*  15 */ "value_list ::= expr",
+ /*  16 */ "value_list ::= value_list COMMA expr",
+ /*  17 */ "value_list ::= error",
+ /*  18 */ "value_list ::= value_list COMMA error",
+ /*  19 */ "ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr",
+ /*  20 */ "ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr",
+ /*  21 */ "ternary_expr ::= nullish_expr",
+ /*  22 */ "nullish_expr ::= or_expr",
+ /*  23 */ "nullish_expr ::= or_expr NULLCOALESCE or_expr",
+ /*  24 */ "or_expr ::= or_expr OR and_expr",
+ /*  25 */ "or_expr ::= and_expr",
+ /*  26 */ "and_expr ::= and_expr AND eq_expr",
+ /*  27 */ "and_expr ::= eq_expr",
+ /*  28 */ "eq_expr ::= eq_expr EQEQ rel_expr",
+ /*  29 */ "eq_expr ::= eq_expr NOTEQ rel_expr",
+ /*  30 */ "eq_expr ::= rel_expr",
+ /*  31 */ "rel_expr ::= rel_expr LT add_expr",
+ /*  32 */ "rel_expr ::= rel_expr LTE add_expr",
+ /*  33 */ "rel_expr ::= rel_expr GT add_expr",
+ /*  34 */ "rel_expr ::= rel_expr GTE add_expr",
+ /*  35 */ "rel_expr ::= add_expr",
+ /*  36 */ "add_expr ::= add_expr PLUS mul_expr",
+ /*  37 */ "add_expr ::= add_expr MINUS mul_expr",
+ /*  38 */ "add_expr ::= mul_expr",
+ /*  39 */ "mul_expr ::= mul_expr STAR unary_expr",
+ /*  40 */ "mul_expr ::= mul_expr SLASH unary_expr",
+ /*  41 */ "mul_expr ::= mul_expr PERCENT unary_expr",
+ /*  42 */ "mul_expr ::= unary_expr",
+ /*  43 */ "unary_expr ::= NOT unary_expr",
+ /*  44 */ "unary_expr ::= PLUS unary_expr",
+ /*  45 */ "unary_expr ::= MINUS unary_expr",
+ /*  46 */ "unary_expr ::= postfix_expr",
+ /*  47 */ "postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN",
+ /*  48 */ "postfix_expr ::= postfix_expr DOT IDENTIFIER",
+ /*  49 */ "postfix_expr ::= primary_expr",
+ /*  50 */ "primary_expr ::= IDENTIFIER",
+ /*  51 */ "primary_expr ::= STRING",
+ /*  52 */ "primary_expr ::= NUMBER",
+ /*  53 */ "primary_expr ::= TRUE",
+ /*  54 */ "primary_expr ::= FALSE",
+ /*  55 */ "primary_expr ::= NULL_VAL",
+ /*  56 */ "primary_expr ::= object",
+ /*  57 */ "primary_expr ::= list",
+ /*  58 */ "primary_expr ::= LPAREN expr RPAREN",
+ /*  59 */ "primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr",
+ /*  60 */ "arg_list_opt ::=",
+ /*  61 */ "arg_list_opt ::= arg_list",
+ /*  62 */ "arg_list ::= expr",
+ /*  63 */ "arg_list ::= arg_list COMMA expr",
+ /*  64 */ "param_list_opt ::=",
  /*  65 */ "param_list_opt ::= param_list",
+ /*  66 */ "param_list ::= IDENTIFIER",
+ /*  67 */ "param_list ::= param_list COMMA IDENTIFIER",
+ /*  68 */ "expr ::= ternary_expr",
 };
 #endif /* NDEBUG */
 
@@ -1053,6 +1179,92 @@ static void yy_destructor(
     ** inside the C code.
     */
 /********* Begin destructor definitions ***************************************/
+      /* TERMINAL Destructor */
+    case 1: /* LBRACE */
+    case 2: /* RBRACE */
+    case 3: /* COMMA */
+    case 4: /* STRING */
+    case 5: /* COLON */
+    case 6: /* IDENTIFIER */
+    case 7: /* LET */
+    case 8: /* ASSIGN */
+    case 9: /* CONST */
+    case 10: /* LBRACKET */
+    case 11: /* RBRACKET */
+    case 12: /* QUESTION */
+    case 13: /* IF */
+    case 14: /* LPAREN */
+    case 15: /* RPAREN */
+    case 16: /* ELSE */
+    case 17: /* NULLCOALESCE */
+    case 18: /* OR */
+    case 19: /* AND */
+    case 20: /* EQEQ */
+    case 21: /* NOTEQ */
+    case 22: /* LT */
+    case 23: /* LTE */
+    case 24: /* GT */
+    case 25: /* GTE */
+    case 26: /* PLUS */
+    case 27: /* MINUS */
+    case 28: /* STAR */
+    case 29: /* SLASH */
+    case 30: /* PERCENT */
+    case 31: /* NOT */
+    case 32: /* DOT */
+    case 33: /* NUMBER */
+    case 34: /* TRUE */
+    case 35: /* FALSE */
+    case 36: /* NULL_VAL */
+    case 37: /* ARROW */
+{
+#line 62 "src/xon.lemon"
+ if (!pState->arena) free((yypminor->yy0).s_val); 
+#line 1223 "src/xon.c"
+}
+      break;
+      /* Default NON-TERMINAL Destructor */
+    case 38: /* root */
+    case 39: /* object */
+    case 41: /* pair */
+    case 42: /* list */
+    case 44: /* expr */
+    case 45: /* ternary_expr */
+    case 46: /* nullish_expr */
+    case 47: /* or_expr */
+    case 48: /* and_expr */
+    case 49: /* eq_expr */
+    case 50: /* rel_expr */
+    case 51: /* add_expr */
+    case 52: /* mul_expr */
+    case 53: /* unary_expr */
+    case 54: /* postfix_expr */
+    case 55: /* primary_expr */
+    case 57: /* arg_list_opt */
+    case 59: /* param_list_opt */
+{
+#line 63 "src/xon.lemon"
+ if (!pState->arena) free_xon_ast((yypminor->yy73)); 
+#line 1248 "src/xon.c"
+}
+      break;
+    case 40: /* pair_list */
+    case 43: /* value_list */
+    case 56: /* arg_list */
+    case 58: /* param_list */
+{
+#line 64 "src/xon.lemon"
+ if (!pState->arena) free_xon_ast((yypminor->yy56).head); 
+#line 1258 "src/xon.c"
+}
+      break;
+    case 60: /* error */
+{
+#line 68 "src/xon.lemon"
+ (void)(yypminor->yy123); 
+#line 1265 "src/xon.c"
+}
+      break;
 /********* End destructor definitions *****************************************/
     default:  break;   /* If no destructor action specified: do nothing */
   }
@@ -1285,6 +1497,11 @@ static void yyStackOverflow(yyParser *yypParser){
    /* Here code is inserted which will execute if the parser
    ** stack every overflows */
 /******** Begin %stack_overflow code ******************************************/
+#line 31 "src/xon.lemon"
+
+    pState->had_error = 1;
+    fprintf(stderr, "Parser stack overflow: out of memory for nesting depth\n");
+#line 1504 "src/xon.c"
 /******** End %stack_overflow code ********************************************/
    xonParserARG_STORE /* Suppress warning about unused %extra_argument var */
    xonParserCTX_STORE
@@ -1357,65 +1574,68 @@ static const YYCODETYPE yyRuleInfoLhs[] = {
     39,  /* (4) object ::= LBRACE RBRACE */
     40,  /* (5) pair_list ::= pair */
     40,  /* (6) pair_list ::= pair_list COMMA pair */
-    41,  /* (7) pair ::= STRING COLON expr */
-    41,  /* (8) pair ::= IDENTIFIER COLON expr */
-    41,  /* (9) pair ::= LET IDENTIFIER ASSIGN expr */
-    41,  /* (10) pair ::= CONST IDENTIFIER ASSIGN expr */
-    42,  /* (11) list ::= LBRACKET value_list RBRACKET */
-    42,  /* (12) list ::= LBRACKET value_list COMMA RBRACKET */
-    42,  /* (13) list ::= LBRACKET RBRACKET */
-    43,  /* (14) value_list ::= expr */
-    43,  /* (15) value_list ::= value_list COMMA expr */
-    45,  /* (16) ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
-    45,  /* (17) ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
-    45,  /* (18) ternary_expr ::= nullish_expr */
-    46,  /* (19) nullish_expr ::= or_expr */
-    46,  /* (20) nullish_expr ::= or_expr NULLCOALESCE or_expr */
-    47,  /* (21) or_expr ::= or_expr OR and_expr */
-    47,  /* (22) or_expr ::= and_expr */
-    48,  /* (23) and_expr ::= and_expr AND eq_expr */
-    48,  /* (24) and_expr ::= eq_expr */
-    49,  /* (25) eq_expr ::= eq_expr EQEQ rel_expr */
-    49,  /* (26) eq_expr ::= eq_expr NOTEQ rel_expr */
-    49,  /* (27) eq_expr ::= rel_expr */
-    50,  /* (28) rel_expr ::= rel_expr LT add_expr */
-    50,  /* (29) rel_expr ::= rel_expr LTE add_expr */
-    50,  /* (30) rel_expr ::= rel_expr GT add_expr */
-    50,  /* (31) rel_expr ::= rel_expr GTE add_expr */
-    50,  /* (32) rel_expr ::= add_expr */
-    51,  /* (33) add_expr ::= add_expr PLUS mul_expr */
-    51,  /* (34) add_expr ::= add_expr MINUS mul_expr */
-    51,  /* (35) add_expr ::= mul_expr */
-    52,  /* (36) mul_expr ::= mul_expr STAR unary_expr */
-    52,  /* (37) mul_expr ::= mul_expr SLASH unary_expr */
-    52,  /* (38) mul_expr ::= mul_expr PERCENT unary_expr */
-    52,  /* (39) mul_expr ::= unary_expr */
-    53,  /* (40) unary_expr ::= NOT unary_expr */
-    53,  /* (41) unary_expr ::= PLUS unary_expr */
-    53,  /* (42) unary_expr ::= MINUS unary_expr */
-    53,  /* (43) unary_expr ::= postfix_expr */
-    54,  /* (44) postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
-    54,  /* (45) postfix_expr ::= postfix_expr DOT IDENTIFIER */
-    54,  /* (46) postfix_expr ::= primary_expr */
-    55,  /* (47) primary_expr ::= IDENTIFIER */
-    55,  /* (48) primary_expr ::= STRING */
-    55,  /* (49) primary_expr ::= NUMBER */
-    55,  /* (50) primary_expr ::= TRUE */
-    55,  /* (51) primary_expr ::= FALSE */
-    55,  /* (52) primary_expr ::= NULL_VAL */
-    55,  /* (53) primary_expr ::= object */
-    55,  /* (54) primary_expr ::= list */
-    55,  /* (55) primary_expr ::= LPAREN expr RPAREN */
-    55,  /* (56) primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
-    57,  /* (57) arg_list_opt ::= */
-    56,  /* (58) arg_list ::= expr */
-    56,  /* (59) arg_list ::= arg_list COMMA expr */
-    59,  /* (60) param_list_opt ::= */
-    58,  /* (61) param_list ::= IDENTIFIER */
-    58,  /* (62) param_list ::= param_list COMMA IDENTIFIER */
-    44,  /* (63) expr ::= ternary_expr */
-    57,  /* (64) arg_list_opt ::= arg_list */
+    41,  /* (7) pair ::= error */
+    41,  /* (8) pair ::= STRING COLON expr */
+    41,  /* (9) pair ::= IDENTIFIER COLON expr */
+    41,  /* (10) pair ::= LET IDENTIFIER ASSIGN expr */
+    41,  /* (11) pair ::= CONST IDENTIFIER ASSIGN expr */
+    42,  /* (12) list ::= LBRACKET value_list RBRACKET */
+    42,  /* (13) list ::= LBRACKET value_list COMMA RBRACKET */
+    42,  /* (14) list ::= LBRACKET RBRACKET */
+    43,  /* (15) value_list ::= expr */
+    43,  /* (16) value_list ::= value_list COMMA expr */
+    43,  /* (17) value_list ::= error */
+    43,  /* (18) value_list ::= value_list COMMA error */
+    45,  /* (19) ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
+    45,  /* (20) ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
+    45,  /* (21) ternary_expr ::= nullish_expr */
+    46,  /* (22) nullish_expr ::= or_expr */
+    46,  /* (23) nullish_expr ::= or_expr NULLCOALESCE or_expr */
+    47,  /* (24) or_expr ::= or_expr OR and_expr */
+    47,  /* (25) or_expr ::= and_expr */
+    48,  /* (26) and_expr ::= and_expr AND eq_expr */
+    48,  /* (27) and_expr ::= eq_expr */
+    49,  /* (28) eq_expr ::= eq_expr EQEQ rel_expr */
+    49,  /* (29) eq_expr ::= eq_expr NOTEQ rel_expr */
+    49,  /* (30) eq_expr ::= rel_expr */
+    50,  /* (31) rel_expr ::= rel_expr LT add_expr */
+    50,  /* (32) rel_expr ::= rel_expr LTE add_expr */
+    50,  /* (33) rel_expr ::= rel_expr GT add_expr */
+    50,  /* (34) rel_expr ::= rel_expr GTE add_expr */
+    50,  /* (35) rel_expr ::= add_expr */
+    51,  /* (36) add_expr ::= add_expr PLUS mul_expr */
+    51,  /* (37) add_expr ::= add_expr MINUS mul_expr */
+    51,  /* (38) add_expr ::= mul_expr */
+    52,  /* (39) mul_expr ::= mul_expr STAR unary_expr */
+    52,  /* (40) mul_expr ::= mul_expr SLASH unary_expr */
+    52,  /* (41) mul_expr ::= mul_expr PERCENT unary_expr */
+    52,  /* (42) mul_expr ::= unary_expr */
+    53,  /* (43) unary_expr ::= NOT unary_expr */
+    53,  /* (44) unary_expr ::= PLUS unary_expr */
+    53,  /* (45) unary_expr ::= MINUS unary_expr */
+    53,  /* (46) unary_expr ::= postfix_expr */
+    54,  /* (47) postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
+    54,  /* (48) postfix_expr ::= postfix_expr DOT IDENTIFIER */
+    54,  /* (49) postfix_expr ::= primary_expr */
+    55,  /* (50) primary_expr ::= IDENTIFIER */
+    55,  /* (51) primary_expr ::= STRING */
+    55,  /* (52) primary_expr ::= NUMBER */
+    55,  /* (53) primary_expr ::= TRUE */
+    55,  /* (54) primary_expr ::= FALSE */
+    55,  /* (55) primary_expr ::= NULL_VAL */
+    55,  /* (56) primary_expr ::= object */
+    55,  /* (57) primary_expr ::= list */
+    55,  /* (58) primary_expr ::= LPAREN expr RPAREN */
+    55,  /* (59) primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
+    57,  /* (60) arg_list_opt ::= */
+    57,  /* (61) arg_list_opt ::= arg_list */
+    56,  /* (62) arg_list ::= expr */
+    56,  /* (63) arg_list ::= arg_list COMMA expr */
+    59,  /* (64) param_list_opt ::= */
     59,  /* (65) param_list_opt ::= param_list */
+    58,  /* (66) param_list ::= IDENTIFIER */
+    58,  /* (67) param_list ::= param_list COMMA IDENTIFIER */
+    44,  /* (68) expr ::= ternary_expr */
 };
 
 /* For rule J, yyRuleInfoNRhs[J] contains the negative of the number
@@ -1428,65 +1648,68 @@ static const signed char yyRuleInfoNRhs[] = {
    -2,  /* (4) object ::= LBRACE RBRACE */
    -1,  /* (5) pair_list ::= pair */
    -3,  /* (6) pair_list ::= pair_list COMMA pair */
-   -3,  /* (7) pair ::= STRING COLON expr */
-   -3,  /* (8) pair ::= IDENTIFIER COLON expr */
-   -4,  /* (9) pair ::= LET IDENTIFIER ASSIGN expr */
-   -4,  /* (10) pair ::= CONST IDENTIFIER ASSIGN expr */
-   -3,  /* (11) list ::= LBRACKET value_list RBRACKET */
-   -4,  /* (12) list ::= LBRACKET value_list COMMA RBRACKET */
-   -2,  /* (13) list ::= LBRACKET RBRACKET */
-   -1,  /* (14) value_list ::= expr */
-   -3,  /* (15) value_list ::= value_list COMMA expr */
-   -5,  /* (16) ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
-   -7,  /* (17) ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
-   -1,  /* (18) ternary_expr ::= nullish_expr */
-   -1,  /* (19) nullish_expr ::= or_expr */
-   -3,  /* (20) nullish_expr ::= or_expr NULLCOALESCE or_expr */
-   -3,  /* (21) or_expr ::= or_expr OR and_expr */
-   -1,  /* (22) or_expr ::= and_expr */
-   -3,  /* (23) and_expr ::= and_expr AND eq_expr */
-   -1,  /* (24) and_expr ::= eq_expr */
-   -3,  /* (25) eq_expr ::= eq_expr EQEQ rel_expr */
-   -3,  /* (26) eq_expr ::= eq_expr NOTEQ rel_expr */
-   -1,  /* (27) eq_expr ::= rel_expr */
-   -3,  /* (28) rel_expr ::= rel_expr LT add_expr */
-   -3,  /* (29) rel_expr ::= rel_expr LTE add_expr */
-   -3,  /* (30) rel_expr ::= rel_expr GT add_expr */
-   -3,  /* (31) rel_expr ::= rel_expr GTE add_expr */
-   -1,  /* (32) rel_expr ::= add_expr */
-   -3,  /* (33) add_expr ::= add_expr PLUS mul_expr */
-   -3,  /* (34) add_expr ::= add_expr MINUS mul_expr */
-   -1,  /* (35) add_expr ::= mul_expr */
-   -3,  /* (36) mul_expr ::= mul_expr STAR unary_expr */
-   -3,  /* (37) mul_expr ::= mul_expr SLASH unary_expr */
-   -3,  /* (38) mul_expr ::= mul_expr PERCENT unary_expr */
-   -1,  /* (39) mul_expr ::= unary_expr */
-   -2,  /* (40) unary_expr ::= NOT unary_expr */
-   -2,  /* (41) unary_expr ::= PLUS unary_expr */
-   -2,  /* (42) unary_expr ::= MINUS unary_expr */
-   -1,  /* (43) unary_expr ::= postfix_expr */
-   -4,  /* (44) postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
-   -3,  /* (45) postfix_expr ::= postfix_expr DOT IDENTIFIER */
-   -1,  /* (46) postfix_expr ::= primary_expr */
-   -1,  /* (47) primary_expr ::= IDENTIFIER */
-   -1,  /* (48) primary_expr ::= STRING */
-   -1,  /* (49) primary_expr ::= NUMBER */
-   -1,  /* (50) primary_expr ::= TRUE */
-   -1,  /* (51) primary_expr ::= FALSE */
-   -1,  /* (52) primary_expr ::= NULL_VAL */
-   -1,  /* (53) primary_expr ::= object */
-   -1,  /* (54) primary_expr ::= list */
-   -3,  /* (55) primary_expr ::= LPAREN expr RPAREN */
-   -5,  /* (56) primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
-    0,  /* (57) arg_list_opt ::= */
-   -1,  /* (58) arg_list ::= expr */
-   -3,  /* (59) arg_list ::= arg_list COMMA expr */
-    0,  /* (60) param_list_opt ::= */
-   -1,  /* (61) param_list ::= IDENTIFIER */
-   -3,  /* (62) param_list ::= param_list COMMA IDENTIFIER */
-   -1,  /* (63) expr ::= ternary_expr */
-   -1,  /* (64) arg_list_opt ::= arg_list */
+   -1,  /* (7) pair ::= error */
+   -3,  /* (8) pair ::= STRING COLON expr */
+   -3,  /* (9) pair ::= IDENTIFIER COLON expr */
+   -4,  /* (10) pair ::= LET IDENTIFIER ASSIGN expr */
+   -4,  /* (11) pair ::= CONST IDENTIFIER ASSIGN expr */
+   -3,  /* (12) list ::= LBRACKET value_list RBRACKET */
+   -4,  /* (13) list ::= LBRACKET value_list COMMA RBRACKET */
+   -2,  /* (14) list ::= LBRACKET RBRACKET */
+   -1,  /* (15) value_list ::= expr */
+   -3,  /* (16) value_list ::= value_list COMMA expr */
+   -1,  /* (17) value_list ::= error */
+   -3,  /* (18) value_list ::= value_list COMMA error */
+   -5,  /* (19) ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
+   -7,  /* (20) ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
+   -1,  /* (21) ternary_expr ::= nullish_expr */
+   -1,  /* (22) nullish_expr ::= or_expr */
+   -3,  /* (23) nullish_expr ::= or_expr NULLCOALESCE or_expr */
+   -3,  /* (24) or_expr ::= or_expr OR and_expr */
+   -1,  /* (25) or_expr ::= and_expr */
+   -3,  /* (26) and_expr ::= and_expr AND eq_expr */
+   -1,  /* (27) and_expr ::= eq_expr */
+   -3,  /* (28) eq_expr ::= eq_expr EQEQ rel_expr */
+   -3,  /* (29) eq_expr ::= eq_expr NOTEQ rel_expr */
+   -1,  /* (30) eq_expr ::= rel_expr */
+   -3,  /* (31) rel_expr ::= rel_expr LT add_expr */
+   -3,  /* (32) rel_expr ::= rel_expr LTE add_expr */
+   -3,  /* (33) rel_expr ::= rel_expr GT add_expr */
+   -3,  /* (34) rel_expr ::= rel_expr GTE add_expr */
+   -1,  /* (35) rel_expr ::= add_expr */
+   -3,  /* (36) add_expr ::= add_expr PLUS mul_expr */
+   -3,  /* (37) add_expr ::= add_expr MINUS mul_expr */
+   -1,  /* (38) add_expr ::= mul_expr */
+   -3,  /* (39) mul_expr ::= mul_expr STAR unary_expr */
+   -3,  /* (40) mul_expr ::= mul_expr SLASH unary_expr */
+   -3,  /* (41) mul_expr ::= mul_expr PERCENT unary_expr */
+   -1,  /* (42) mul_expr ::= unary_expr */
+   -2,  /* (43) unary_expr ::= NOT unary_expr */
+   -2,  /* (44) unary_expr ::= PLUS unary_expr */
+   -2,  /* (45) unary_expr ::= MINUS unary_expr */
+   -1,  /* (46) unary_expr ::= postfix_expr */
+   -4,  /* (47) postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
+   -3,  /* (48) postfix_expr ::= postfix_expr DOT IDENTIFIER */
+   -1,  /* (49) postfix_expr ::= primary_expr */
+   -1,  /* (50) primary_expr ::= IDENTIFIER */
+   -1,  /* (51) primary_expr ::= STRING */
+   -1,  /* (52) primary_expr ::= NUMBER */
+   -1,  /* (53) primary_expr ::= TRUE */
+   -1,  /* (54) primary_expr ::= FALSE */
+   -1,  /* (55) primary_expr ::= NULL_VAL */
+   -1,  /* (56) primary_expr ::= object */
+   -1,  /* (57) primary_expr ::= list */
+   -3,  /* (58) primary_expr ::= LPAREN expr RPAREN */
+   -5,  /* (59) primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
+    0,  /* (60) arg_list_opt ::= */
+   -1,  /* (61) arg_list_opt ::= arg_list */
+   -1,  /* (62) arg_list ::= expr */
+   -3,  /* (63) arg_list ::= arg_list COMMA expr */
+    0,  /* (64) param_list_opt ::= */
    -1,  /* (65) param_list_opt ::= param_list */
+   -1,  /* (66) param_list ::= IDENTIFIER */
+   -3,  /* (67) param_list ::= param_list COMMA IDENTIFIER */
+   -1,  /* (68) expr ::= ternary_expr */
 };
 
 static void yy_accept(yyParser*);  /* Forward Declaration */
@@ -1530,361 +1753,462 @@ static YYACTIONTYPE yy_reduce(
         YYMINORTYPE yylhsminor;
       case 0: /* root ::= object */
       case 1: /* root ::= list */ yytestcase(yyruleno==1);
-#line 323 "src/xon.lemon"
-{ *pState->result = yymsp[0].minor.yy19; }
-#line 1535 "src/xon.c"
+#line 466 "src/xon.lemon"
+{ *pState->result = yymsp[0].minor.yy73; }
+#line 1758 "src/xon.c"
         break;
       case 2: /* object ::= LBRACE pair_list RBRACE */
-      case 55: /* primary_expr ::= LPAREN expr RPAREN */ yytestcase(yyruleno==55);
-#line 327 "src/xon.lemon"
-{ yymsp[-2].minor.yy19 = yymsp[-1].minor.yy19; }
-#line 1541 "src/xon.c"
+#line 470 "src/xon.lemon"
+{
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_OBJECT, yymsp[-1].minor.yy56.head), yymsp[-2].minor.yy0, yymsp[0].minor.yy0);
+}
+#line 1765 "src/xon.c"
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
       case 3: /* object ::= LBRACE pair_list COMMA RBRACE */
-#line 328 "src/xon.lemon"
-{ yymsp[-3].minor.yy19 = yymsp[-2].minor.yy19; }
-#line 1546 "src/xon.c"
+#line 473 "src/xon.lemon"
+{
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_OBJECT, yymsp[-2].minor.yy56.head), yymsp[-3].minor.yy0, yymsp[0].minor.yy0);
+}
+#line 1773 "src/xon.c"
+  yy_destructor(yypParser,3,&yymsp[-1].minor);
+  yymsp[-3].minor.yy73 = yylhsminor.yy73;
         break;
       case 4: /* object ::= LBRACE RBRACE */
-#line 329 "src/xon.lemon"
-{ yymsp[-1].minor.yy19 = new_node(TYPE_OBJECT); }
-#line 1551 "src/xon.c"
-        break;
-      case 5: /* pair_list ::= pair */
-#line 331 "src/xon.lemon"
+#line 476 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_node(TYPE_OBJECT);
-    if (yylhsminor.yy19) yylhsminor.yy19->data.aggregate.value = yymsp[0].minor.yy19;
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_OBJECT, NULL), yymsp[-1].minor.yy0, yymsp[0].minor.yy0);
 }
-#line 1559 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+#line 1782 "src/xon.c"
+  yymsp[-1].minor.yy73 = yylhsminor.yy73;
+        break;
+      case 5: /* pair_list ::= pair */
+      case 15: /* value_list ::= expr */ yytestcase(yyruleno==15);
+      case 62: /* arg_list ::= expr */ yytestcase(yyruleno==62);
+#line 480 "src/xon.lemon"
+{ yylhsminor.yy56 = chain_start(yymsp[0].minor.yy73); }
+#line 1790 "src/xon.c"
+  yymsp[0].minor.yy56 = yylhsminor.yy56;
         break;
       case 6: /* pair_list ::= pair_list COMMA pair */
-#line 335 "src/xon.lemon"
+      case 16: /* value_list ::= value_list COMMA expr */ yytestcase(yyruleno==16);
+      case 63: /* arg_list ::= arg_list COMMA expr */ yytestcase(yyruleno==63);
+#line 481 "src/xon.lemon"
+{ yylhsminor.yy56 = chain_append(yymsp[-2].minor.yy56, yymsp[0].minor.yy73); }
+#line 1798 "src/xon.c"
+  yy_destructor(yypParser,3,&yymsp[-1].minor);
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
+        break;
+      case 7: /* pair ::= error */
+{  yy_destructor(yypParser,60,&yymsp[0].minor);
+#line 485 "src/xon.lemon"
+{ yymsp[0].minor.yy73 = NULL; }
+#line 1806 "src/xon.c"
+}
+        break;
+      case 8: /* pair ::= STRING COLON expr */
+#line 487 "src/xon.lemon"
 {
-    yylhsminor.yy19 = yymsp[-2].minor.yy19;
-    link_node(yylhsminor.yy19->data.aggregate.value, yymsp[0].minor.yy19);
+    yylhsminor.yy73 = new_pair_node(pState->arena, yymsp[-2].minor.yy0.s_val, yymsp[-2].minor.yy0.s_len, yymsp[0].minor.yy73);
 }
-#line 1568 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1814 "src/xon.c"
+  yy_destructor(yypParser,5,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 7: /* pair ::= STRING COLON expr */
-      case 8: /* pair ::= IDENTIFIER COLON expr */ yytestcase(yyruleno==8);
-#line 340 "src/xon.lemon"
+      case 9: /* pair ::= IDENTIFIER COLON expr */
+#line 490 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_pair_node(yymsp[-2].minor.yy0.s_val, yymsp[0].minor.yy19);
+    yylhsminor.yy73 = new_pair_node(pState->arena, token_text(pState, yymsp[-2].minor.yy0), yymsp[-2].minor.yy0.s_len, yymsp[0].minor.yy73);
 }
-#line 1577 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1823 "src/xon.c"
+  yy_destructor(yypParser,5,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 9: /* pair ::= LET IDENTIFIER ASSIGN expr */
-#line 346 "src/xon.lemon"
+      case 10: /* pair ::= LET IDENTIFIER ASSIGN expr */
+{  yy_destructor(yypParser,7,&yymsp[-3].minor);
+#line 493 "src/xon.lemon"
 {
-    yymsp[-3].minor.yy19 = new_decl_node(0, yymsp[-2].minor.yy0.s_val, yymsp[0].minor.yy19);
+    yymsp[-3].minor.yy73 = new_decl_node(pState->arena, 0, token_text(pState, yymsp[-2].minor.yy0), yymsp[0].minor.yy73);
+}
+#line 1833 "src/xon.c"
+  yy_destructor(yypParser,8,&yymsp[-1].minor);
 }
-#line 1585 "src/xon.c"
         break;
-      case 10: /* pair ::= CONST IDENTIFIER ASSIGN expr */
-#line 349 "src/xon.lemon"
+      case 11: /* pair ::= CONST IDENTIFIER ASSIGN expr */
+{  yy_destructor(yypParser,9,&yymsp[-3].minor);
+#line 496 "src/xon.lemon"
 {
-    yymsp[-3].minor.yy19 = new_decl_node(1, yymsp[-2].minor.yy0.s_val, yymsp[0].minor.yy19);
+    yymsp[-3].minor.yy73 = new_decl_node(pState->arena, 1, token_text(pState, yymsp[-2].minor.yy0), yymsp[0].minor.yy73);
+}
+#line 1843 "src/xon.c"
+  yy_destructor(yypParser,8,&yymsp[-1].minor);
 }
-#line 1592 "src/xon.c"
         break;
-      case 11: /* list ::= LBRACKET value_list RBRACKET */
-#line 354 "src/xon.lemon"
+      case 12: /* list ::= LBRACKET value_list RBRACKET */
+#line 501 "src/xon.lemon"
 {
-    yymsp[-2].minor.yy19 = new_node(TYPE_LIST);
-    if (yymsp[-2].minor.yy19) yymsp[-2].minor.yy19->data.aggregate.value = yymsp[-1].minor.yy19;
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_LIST, yymsp[-1].minor.yy56.head), yymsp[-2].minor.yy0, yymsp[0].minor.yy0);
 }
-#line 1600 "src/xon.c"
+#line 1852 "src/xon.c"
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 12: /* list ::= LBRACKET value_list COMMA RBRACKET */
-#line 358 "src/xon.lemon"
+      case 13: /* list ::= LBRACKET value_list COMMA RBRACKET */
+#line 504 "src/xon.lemon"
 {
-    yymsp[-3].minor.yy19 = new_node(TYPE_LIST);
-    if (yymsp[-3].minor.yy19) yymsp[-3].minor.yy19->data.aggregate.value = yymsp[-2].minor.yy19;
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_LIST, yymsp[-2].minor.yy56.head), yymsp[-3].minor.yy0, yymsp[0].minor.yy0);
 }
-#line 1608 "src/xon.c"
+#line 1860 "src/xon.c"
+  yy_destructor(yypParser,3,&yymsp[-1].minor);
+  yymsp[-3].minor.yy73 = yylhsminor.yy73;
         break;
-      case 13: /* list ::= LBRACKET RBRACKET */
-#line 362 "src/xon.lemon"
-{ yymsp[-1].minor.yy19 = new_node(TYPE_LIST); }
-#line 1613 "src/xon.c"
+      case 14: /* list ::= LBRACKET RBRACKET */
+#line 507 "src/xon.lemon"
+{
+    yylhsminor.yy73 = container_span(pState, new_container_node(pState->arena, TYPE_LIST, NULL), yymsp[-1].minor.yy0, yymsp[0].minor.yy0);
+}
+#line 1869 "src/xon.c"
+  yymsp[-1].minor.yy73 = yylhsminor.yy73;
         break;
-      case 14: /* value_list ::= expr */
-      case 18: /* ternary_expr ::= nullish_expr */ yytestcase(yyruleno==18);
-      case 19: /* nullish_expr ::= or_expr */ yytestcase(yyruleno==19);
-      case 22: /* or_expr ::= and_expr */ yytestcase(yyruleno==22);
-      case 24: /* and_expr ::= eq_expr */ yytestcase(yyruleno==24);
-      case 27: /* eq_expr ::= rel_expr */ yytestcase(yyruleno==27);
-      case 32: /* rel_expr ::= add_expr */ yytestcase(yyruleno==32);
-      case 35: /* add_expr ::= mul_expr */ yytestcase(yyruleno==35);
-      case 39: /* mul_expr ::= unary_expr */ yytestcase(yyruleno==39);
-      case 43: /* unary_expr ::= postfix_expr */ yytestcase(yyruleno==43);
-      case 46: /* postfix_expr ::= primary_expr */ yytestcase(yyruleno==46);
-      case 53: /* primary_expr ::= object */ yytestcase(yyruleno==53);
-      case 54: /* primary_expr ::= list */ yytestcase(yyruleno==54);
-      case 58: /* arg_list ::= expr */ yytestcase(yyruleno==58);
-#line 364 "src/xon.lemon"
-{ yylhsminor.yy19 = yymsp[0].minor.yy19; }
-#line 1631 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+      case 17: /* value_list ::= error */
+{  yy_destructor(yypParser,60,&yymsp[0].minor);
+#line 513 "src/xon.lemon"
+{ yymsp[0].minor.yy56 = chain_start(NULL); }
+#line 1876 "src/xon.c"
+}
         break;
-      case 15: /* value_list ::= value_list COMMA expr */
-      case 59: /* arg_list ::= arg_list COMMA expr */ yytestcase(yyruleno==59);
-#line 365 "src/xon.lemon"
-{ yylhsminor.yy19 = link_node(yymsp[-2].minor.yy19, yymsp[0].minor.yy19); }
-#line 1638 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+      case 18: /* value_list ::= value_list COMMA error */
+#line 514 "src/xon.lemon"
+{ yylhsminor.yy56 = yymsp[-2].minor.yy56; }
+#line 1882 "src/xon.c"
+  yy_destructor(yypParser,3,&yymsp[-1].minor);
+  yy_destructor(yypParser,60,&yymsp[0].minor);
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
-      case 16: /* ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
-#line 370 "src/xon.lemon"
+      case 19: /* ternary_expr ::= nullish_expr QUESTION ternary_expr COLON ternary_expr */
+#line 519 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_ternary(yymsp[-4].minor.yy19, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, yymsp[-4].minor.yy19 ? 0 : 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_ternary(pState->arena, yymsp[-4].minor.yy73, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, yymsp[-4].minor.yy73 ? 0 : 0));
 }
-#line 1646 "src/xon.c"
-  yymsp[-4].minor.yy19 = yylhsminor.yy19;
+#line 1892 "src/xon.c"
+  yy_destructor(yypParser,12,&yymsp[-3].minor);
+  yy_destructor(yypParser,5,&yymsp[-1].minor);
+  yymsp[-4].minor.yy73 = yylhsminor.yy73;
         break;
-      case 17: /* ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
-#line 373 "src/xon.lemon"
+      case 20: /* ternary_expr ::= IF LPAREN expr RPAREN ternary_expr ELSE ternary_expr */
+{  yy_destructor(yypParser,13,&yymsp[-6].minor);
+#line 522 "src/xon.lemon"
 {
-    yymsp[-6].minor.yy19 = new_expr_node(xon_expr_if(yymsp[-4].minor.yy19, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, yymsp[-4].minor.yy19 ? 0 : 0));
+    yymsp[-6].minor.yy73 = new_expr_node(pState->arena, xon_expr_if(pState->arena, yymsp[-4].minor.yy73, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, yymsp[-4].minor.yy73 ? 0 : 0));
+}
+#line 1903 "src/xon.c"
+  yy_destructor(yypParser,14,&yymsp[-5].minor);
+  yy_destructor(yypParser,15,&yymsp[-3].minor);
+  yy_destructor(yypParser,16,&yymsp[-1].minor);
 }
-#line 1654 "src/xon.c"
         break;
-      case 20: /* nullish_expr ::= or_expr NULLCOALESCE or_expr */
-#line 379 "src/xon.lemon"
+      case 21: /* ternary_expr ::= nullish_expr */
+      case 22: /* nullish_expr ::= or_expr */ yytestcase(yyruleno==22);
+      case 25: /* or_expr ::= and_expr */ yytestcase(yyruleno==25);
+      case 27: /* and_expr ::= eq_expr */ yytestcase(yyruleno==27);
+      case 30: /* eq_expr ::= rel_expr */ yytestcase(yyruleno==30);
+      case 35: /* rel_expr ::= add_expr */ yytestcase(yyruleno==35);
+      case 38: /* add_expr ::= mul_expr */ yytestcase(yyruleno==38);
+      case 42: /* mul_expr ::= unary_expr */ yytestcase(yyruleno==42);
+      case 46: /* unary_expr ::= postfix_expr */ yytestcase(yyruleno==46);
+      case 49: /* postfix_expr ::= primary_expr */ yytestcase(yyruleno==49);
+      case 56: /* primary_expr ::= object */ yytestcase(yyruleno==56);
+      case 57: /* primary_expr ::= list */ yytestcase(yyruleno==57);
+#line 525 "src/xon.lemon"
+{ yylhsminor.yy73 = yymsp[0].minor.yy73; }
+#line 1923 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
+        break;
+      case 23: /* nullish_expr ::= or_expr NULLCOALESCE or_expr */
+#line 528 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_NULLISH, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_NULLISH, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1661 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1931 "src/xon.c"
+  yy_destructor(yypParser,17,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 21: /* or_expr ::= or_expr OR and_expr */
-#line 383 "src/xon.lemon"
+      case 24: /* or_expr ::= or_expr OR and_expr */
+#line 532 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_OR, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_OR, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1669 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1940 "src/xon.c"
+  yy_destructor(yypParser,18,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 23: /* and_expr ::= and_expr AND eq_expr */
-#line 388 "src/xon.lemon"
+      case 26: /* and_expr ::= and_expr AND eq_expr */
+#line 537 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_AND, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_AND, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1677 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1949 "src/xon.c"
+  yy_destructor(yypParser,19,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 25: /* eq_expr ::= eq_expr EQEQ rel_expr */
-#line 393 "src/xon.lemon"
+      case 28: /* eq_expr ::= eq_expr EQEQ rel_expr */
+#line 542 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_EQ, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_EQ, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1685 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1958 "src/xon.c"
+  yy_destructor(yypParser,20,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 26: /* eq_expr ::= eq_expr NOTEQ rel_expr */
-#line 396 "src/xon.lemon"
+      case 29: /* eq_expr ::= eq_expr NOTEQ rel_expr */
+#line 545 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_NEQ, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_NEQ, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1693 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1967 "src/xon.c"
+  yy_destructor(yypParser,21,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 28: /* rel_expr ::= rel_expr LT add_expr */
-#line 401 "src/xon.lemon"
+      case 31: /* rel_expr ::= rel_expr LT add_expr */
+#line 550 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_LT, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_LT, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1701 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1976 "src/xon.c"
+  yy_destructor(yypParser,22,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 29: /* rel_expr ::= rel_expr LTE add_expr */
-#line 404 "src/xon.lemon"
+      case 32: /* rel_expr ::= rel_expr LTE add_expr */
+#line 553 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_LTE, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_LTE, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1709 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1985 "src/xon.c"
+  yy_destructor(yypParser,23,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 30: /* rel_expr ::= rel_expr GT add_expr */
-#line 407 "src/xon.lemon"
+      case 33: /* rel_expr ::= rel_expr GT add_expr */
+#line 556 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_GT, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_GT, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1717 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 1994 "src/xon.c"
+  yy_destructor(yypParser,24,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 31: /* rel_expr ::= rel_expr GTE add_expr */
-#line 410 "src/xon.lemon"
+      case 34: /* rel_expr ::= rel_expr GTE add_expr */
+#line 559 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_GTE, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_GTE, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1725 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2003 "src/xon.c"
+  yy_destructor(yypParser,25,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 33: /* add_expr ::= add_expr PLUS mul_expr */
-#line 415 "src/xon.lemon"
+      case 36: /* add_expr ::= add_expr PLUS mul_expr */
+#line 564 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_ADD, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_ADD, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1733 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2012 "src/xon.c"
+  yy_destructor(yypParser,26,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 34: /* add_expr ::= add_expr MINUS mul_expr */
-#line 418 "src/xon.lemon"
+      case 37: /* add_expr ::= add_expr MINUS mul_expr */
+#line 567 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_SUB, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_SUB, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1741 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2021 "src/xon.c"
+  yy_destructor(yypParser,27,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 36: /* mul_expr ::= mul_expr STAR unary_expr */
-#line 423 "src/xon.lemon"
+      case 39: /* mul_expr ::= mul_expr STAR unary_expr */
+#line 572 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_MUL, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_MUL, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1749 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2030 "src/xon.c"
+  yy_destructor(yypParser,28,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 37: /* mul_expr ::= mul_expr SLASH unary_expr */
-#line 426 "src/xon.lemon"
+      case 40: /* mul_expr ::= mul_expr SLASH unary_expr */
+#line 575 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_DIV, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_DIV, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1757 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2039 "src/xon.c"
+  yy_destructor(yypParser,29,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 38: /* mul_expr ::= mul_expr PERCENT unary_expr */
-#line 429 "src/xon.lemon"
+      case 41: /* mul_expr ::= mul_expr PERCENT unary_expr */
+#line 578 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_binary(XON_EXPR_OP_MOD, yymsp[-2].minor.yy19, yymsp[0].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_binary(pState->arena, XON_EXPR_OP_MOD, yymsp[-2].minor.yy73, yymsp[0].minor.yy73, 0));
 }
-#line 1765 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2048 "src/xon.c"
+  yy_destructor(yypParser,30,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 40: /* unary_expr ::= NOT unary_expr */
-#line 434 "src/xon.lemon"
+      case 43: /* unary_expr ::= NOT unary_expr */
+{  yy_destructor(yypParser,31,&yymsp[-1].minor);
+#line 583 "src/xon.lemon"
 {
-    yymsp[-1].minor.yy19 = new_expr_node(xon_expr_unary(XON_EXPR_OP_NOT, yymsp[0].minor.yy19, 0));
+    yymsp[-1].minor.yy73 = new_expr_node(pState->arena, xon_expr_unary(pState->arena, XON_EXPR_OP_NOT, yymsp[0].minor.yy73, 0));
+}
+#line 2058 "src/xon.c"
 }
-#line 1773 "src/xon.c"
         break;
-      case 41: /* unary_expr ::= PLUS unary_expr */
-#line 437 "src/xon.lemon"
+      case 44: /* unary_expr ::= PLUS unary_expr */
+{  yy_destructor(yypParser,26,&yymsp[-1].minor);
+#line 586 "src/xon.lemon"
 {
-    yymsp[-1].minor.yy19 = new_expr_node(xon_expr_unary(XON_EXPR_OP_UNARY_PLUS, yymsp[0].minor.yy19, 0));
+    yymsp[-1].minor.yy73 = new_expr_node(pState->arena, xon_expr_unary(pState->arena, XON_EXPR_OP_UNARY_PLUS, yymsp[0].minor.yy73, 0));
+}
+#line 2067 "src/xon.c"
 }
-#line 1780 "src/xon.c"
         break;
-      case 42: /* unary_expr ::= MINUS unary_expr */
-#line 440 "src/xon.lemon"
+      case 45: /* unary_expr ::= MINUS unary_expr */
+{  yy_destructor(yypParser,27,&yymsp[-1].minor);
+#line 589 "src/xon.lemon"
 {
-    yymsp[-1].minor.yy19 = new_expr_node(xon_expr_unary(XON_EXPR_OP_NEG, yymsp[0].minor.yy19, 0));
+    yymsp[-1].minor.yy73 = new_expr_node(pState->arena, xon_expr_unary(pState->arena, XON_EXPR_OP_NEG, yymsp[0].minor.yy73, 0));
+}
+#line 2076 "src/xon.c"
 }
-#line 1787 "src/xon.c"
         break;
-      case 44: /* postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
-#line 445 "src/xon.lemon"
+      case 47: /* postfix_expr ::= postfix_expr LPAREN arg_list_opt RPAREN */
+#line 594 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_call(yymsp[-3].minor.yy19, yymsp[-1].minor.yy19, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_call(pState->arena, yymsp[-3].minor.yy73, yymsp[-1].minor.yy73, 0));
 }
-#line 1794 "src/xon.c"
-  yymsp[-3].minor.yy19 = yylhsminor.yy19;
+#line 2084 "src/xon.c"
+  yy_destructor(yypParser,14,&yymsp[-2].minor);
+  yy_destructor(yypParser,15,&yymsp[0].minor);
+  yymsp[-3].minor.yy73 = yylhsminor.yy73;
         break;
-      case 45: /* postfix_expr ::= postfix_expr DOT IDENTIFIER */
-#line 448 "src/xon.lemon"
+      case 48: /* postfix_expr ::= postfix_expr DOT IDENTIFIER */
+#line 597 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_member(yymsp[-2].minor.yy19, yymsp[0].minor.yy0.s_val, 0));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_member(pState->arena, yymsp[-2].minor.yy73, token_text(pState, yymsp[0].minor.yy0), 0));
 }
-#line 1802 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2094 "src/xon.c"
+  yy_destructor(yypParser,32,&yymsp[-1].minor);
+  yymsp[-2].minor.yy73 = yylhsminor.yy73;
         break;
-      case 47: /* primary_expr ::= IDENTIFIER */
-#line 453 "src/xon.lemon"
+      case 50: /* primary_expr ::= IDENTIFIER */
+#line 602 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_expr_node(xon_expr_identifier(yymsp[0].minor.yy0.s_val, yymsp[0].minor.yy0.line));
+    yylhsminor.yy73 = new_expr_node(pState->arena, xon_expr_identifier(pState->arena, token_text(pState, yymsp[0].minor.yy0), yymsp[0].minor.yy0.line));
 }
-#line 1810 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+#line 2103 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
         break;
-      case 48: /* primary_expr ::= STRING */
-#line 456 "src/xon.lemon"
+      case 51: /* primary_expr ::= STRING */
+#line 605 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_node(TYPE_STRING);
-    if (yylhsminor.yy19) yylhsminor.yy19->data.s_val = yymsp[0].minor.yy0.s_val;
+    yylhsminor.yy73 = new_literal_node(pState->arena, TYPE_STRING);
+    if (yylhsminor.yy73) {
+        yylhsminor.yy73->data.str.s_val = yymsp[0].minor.yy0.s_val;
+        yylhsminor.yy73->data.str.s_len = yymsp[0].minor.yy0.s_len;
+    }
 }
-#line 1819 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+#line 2115 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
         break;
-      case 49: /* primary_expr ::= NUMBER */
-#line 460 "src/xon.lemon"
+      case 52: /* primary_expr ::= NUMBER */
+#line 612 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_node(TYPE_NUMBER);
-    if (yylhsminor.yy19) yylhsminor.yy19->data.n_val = yymsp[0].minor.yy0.n_val;
+    yylhsminor.yy73 = new_literal_node(pState->arena, TYPE_NUMBER);
+    if (yylhsminor.yy73) yylhsminor.yy73->data.n_val = yymsp[0].minor.yy0.n_val;
 }
-#line 1828 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+#line 2124 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
         break;
-      case 50: /* primary_expr ::= TRUE */
-#line 464 "src/xon.lemon"
+      case 53: /* primary_expr ::= TRUE */
+{  yy_destructor(yypParser,34,&yymsp[0].minor);
+#line 616 "src/xon.lemon"
 {
-    yymsp[0].minor.yy19 = new_node(TYPE_BOOL);
-    if (yymsp[0].minor.yy19) yymsp[0].minor.yy19->data.b_val = 1;
+    yymsp[0].minor.yy73 = new_literal_node(pState->arena, TYPE_BOOL);
+    if (yymsp[0].minor.yy73) yymsp[0].minor.yy73->data.b_val = 1;
+}
+#line 2134 "src/xon.c"
 }
-#line 1837 "src/xon.c"
         break;
-      case 51: /* primary_expr ::= FALSE */
-#line 468 "src/xon.lemon"
+      case 54: /* primary_expr ::= FALSE */
+{  yy_destructor(yypParser,35,&yymsp[0].minor);
+#line 620 "src/xon.lemon"
 {
-    yymsp[0].minor.yy19 = new_node(TYPE_BOOL);
-    if (yymsp[0].minor.yy19) yymsp[0].minor.yy19->data.b_val = 0;
+    yymsp[0].minor.yy73 = new_literal_node(pState->arena, TYPE_BOOL);
+    if (yymsp[0].minor.yy73) yymsp[0].minor.yy73->data.b_val = 0;
+}
+#line 2144 "src/xon.c"
 }
-#line 1845 "src/xon.c"
         break;
-      case 52: /* primary_expr ::= NULL_VAL */
-#line 472 "src/xon.lemon"
+      case 55: /* primary_expr ::= NULL_VAL */
+{  yy_destructor(yypParser,36,&yymsp[0].minor);
+#line 624 "src/xon.lemon"
 {
-    yymsp[0].minor.yy19 = new_node(TYPE_NULL);
+    yymsp[0].minor.yy73 = new_literal_node(pState->arena, TYPE_NULL);
+}
+#line 2153 "src/xon.c"
+}
+        break;
+      case 58: /* primary_expr ::= LPAREN expr RPAREN */
+{  yy_destructor(yypParser,14,&yymsp[-2].minor);
+#line 629 "src/xon.lemon"
+{ yymsp[-2].minor.yy73 = yymsp[-1].minor.yy73; }
+#line 2160 "src/xon.c"
+  yy_destructor(yypParser,15,&yymsp[0].minor);
 }
-#line 1852 "src/xon.c"
         break;
-      case 56: /* primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
-#line 478 "src/xon.lemon"
+      case 59: /* primary_expr ::= LPAREN param_list_opt RPAREN ARROW expr */
+{  yy_destructor(yypParser,14,&yymsp[-4].minor);
+#line 630 "src/xon.lemon"
 {
-    yymsp[-4].minor.yy19 = new_expr_node(xon_expr_function(yymsp[-3].minor.yy19, yymsp[0].minor.yy19, 0));
+    yymsp[-4].minor.yy73 = new_expr_node(pState->arena, xon_expr_function(pState->arena, yymsp[-3].minor.yy73, yymsp[0].minor.yy73, 0));
+}
+#line 2170 "src/xon.c"
+  yy_destructor(yypParser,15,&yymsp[-2].minor);
+  yy_destructor(yypParser,37,&yymsp[-1].minor);
 }
-#line 1859 "src/xon.c"
         break;
-      case 57: /* arg_list_opt ::= */
-      case 60: /* param_list_opt ::= */ yytestcase(yyruleno==60);
-#line 482 "src/xon.lemon"
-{ yymsp[1].minor.yy19 = NULL; }
-#line 1865 "src/xon.c"
+      case 60: /* arg_list_opt ::= */
+      case 64: /* param_list_opt ::= */ yytestcase(yyruleno==64);
+#line 634 "src/xon.lemon"
+{ yymsp[1].minor.yy73 = NULL; }
+#line 2179 "src/xon.c"
+        break;
+      case 61: /* arg_list_opt ::= arg_list */
+#line 635 "src/xon.lemon"
+{ yylhsminor.yy73 = yymsp[0].minor.yy56.head; }
+#line 2184 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
         break;
-      case 61: /* param_list ::= IDENTIFIER */
-#line 491 "src/xon.lemon"
+      case 65: /* param_list_opt ::= param_list */
+#line 641 "src/xon.lemon"
+{ yylhsminor.yy73 = new_list_node(pState->arena, yymsp[0].minor.yy56.head); }
+#line 2190 "src/xon.c"
+  yymsp[0].minor.yy73 = yylhsminor.yy73;
+        break;
+      case 66: /* param_list ::= IDENTIFIER */
+#line 643 "src/xon.lemon"
 {
-    yylhsminor.yy19 = new_list_node(new_param_node(yymsp[0].minor.yy0.s_val));
+    yylhsminor.yy56 = chain_start(new_param_node(pState->arena, token_text(pState, yymsp[0].minor.yy0), yymsp[0].minor.yy0.s_len));
 }
-#line 1872 "src/xon.c"
-  yymsp[0].minor.yy19 = yylhsminor.yy19;
+#line 2198 "src/xon.c"
+  yymsp[0].minor.yy56 = yylhsminor.yy56;
         break;
-      case 62: /* param_list ::= param_list COMMA IDENTIFIER */
-#line 494 "src/xon.lemon"
+      case 67: /* param_list ::= param_list COMMA IDENTIFIER */
+#line 646 "src/xon.lemon"
 {
-    yylhsminor.yy19 = yymsp[-2].minor.yy19;
-    link_node(yylhsminor.yy19->data.aggregate.value, new_param_node(yymsp[0].minor.yy0.s_val));
+    yylhsminor.yy56 = chain_append(yymsp[-2].minor.yy56, new_param_node(pState->arena, token_text(pState, yymsp[0].minor.yy0), yymsp[0].minor.yy0.s_len));
 }
-#line 1881 "src/xon.c"
-  yymsp[-2].minor.yy19 = yylhsminor.yy19;
+#line 2206 "src/xon.c"
+  yy_destructor(yypParser,3,&yymsp[-1].minor);
+  yymsp[-2].minor.yy56 = yylhsminor.yy56;
         break;
       default:
-      /* (63) expr ::= ternary_expr (OPTIMIZED OUT) */ assert(yyruleno!=63);
-      /* (64) arg_list_opt ::= arg_list */ yytestcase(yyruleno==64);
-      /* (65) param_list_opt ::= param_list */ yytestcase(yyruleno==65);
+      /* (68) expr ::= ternary_expr (OPTIMIZED OUT) */ assert(yyruleno!=68);
         break;
 /********** End reduce actions ************************************************/
   };
@@ -1926,11 +2250,10 @@ static void yy_parse_failed(
   /* Here code is inserted which will be executed whenever the
   ** parser fails */
 /************ Begin %parse_failure code ***************************************/
-#line 18 "src/xon.lemon"
+#line 27 "src/xon.lemon"
 
     pState->had_error = 1;
-    if (pState->result) *pState->result = NULL;
-#line 1933 "src/xon.c"
+#line 2256 "src/xon.c"
 /************ End %parse_failure code *****************************************/
   xonParserARG_STORE /* Suppress warning about unused %extra_argument variable */
   xonParserCTX_STORE
@@ -1949,17 +2272,21 @@ static void yy_syntax_error(
   xonParserCTX_FETCH
 #define TOKEN yyminor
 /************ Begin %syntax_error code ****************************************/
-#line 7 "src/xon.lemon"
+#line 12 "src/xon.lemon"
 
+    char span_text[64];
     const char* token_text = TOKEN.s_val ? TOKEN.s_val : "unknown";
+    if (!TOKEN.s_val && TOKEN.span) {
+        snprintf(span_text, sizeof(span_text), "%.*s", (int)(TOKEN.s_len < 63 ? TOKEN.s_len : 63), TOKEN.span);
+        token_text = span_text;
+    }
     pState->had_error = 1;
-    if (pState->result) *pState->result = NULL;
     if (pState->on_syntax_error) {
         pState->on_syntax_error(TOKEN.line, token_text, pState->user_data);
     } else {
         fprintf(stderr, "Syntax Error at line %d near token '%s'\n", TOKEN.line, token_text);
     }
-#line 1962 "src/xon.c"
+#line 2289 "src/xon.c"
 /************ End %syntax_error code ******************************************/
   xonParserARG_STORE /* Suppress warning about unused %extra_argument variable */
   xonParserCTX_STORE
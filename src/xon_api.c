@@ -1,6 +1,14 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "../include/xon_api.h"
+#include "input.h"
 #include "lexer.h"
 #include "logger.h"
+#include "number.h"
+#include "scan.h"
+#include "structural.h"
 
 #if defined(__clang__) || defined(__GNUC__)
 #pragma GCC diagnostic push
@@ -13,11 +21,38 @@
 #endif
 
 #include <ctype.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Off by default; see xon_enable_arena() and xon_enable_tape().
+static int g_use_arena = 0;
+static int g_use_tape = 0;
+
+// Reusable parser context: the Lemon parser (and its grown stack), the
+// document arena and the identifier intern table all survive across parses.
+struct XonParser {
+    void* lemon;
+    XonArena* arena;
+    XonIntern* intern;
+};
+
+// A document parsed into an arena returns the root copied into this shell so
+// that freeing the root can find and destroy the arena that owns the tree.
+typedef struct {
+    XonArena* arena;
+    DataNode root;
+} ArenaDocument;
+
 typedef struct EvalScope EvalScope;
 
 typedef struct EvalBinding EvalBinding;
@@ -76,7 +111,9 @@ static void eval_scope_release(EvalScope* scope);
 static int eval_is_identifier(const char* key);
 static size_t eval_list_size(const DataNode* list);
 static char* clone_c_string(const char* src);
+static char* clone_string_len(const char* src, size_t len);
 static DataNode* clone_data_node(const DataNode* src);
+static void free_xon_ast(DataNode* node);
 static DataNode* eval_lookup_identifier(const char* name, EvalScope* scope, EvalError* err);
 static DataNode* eval_object_node(const DataNode* node, EvalScope* scope, EvalError* err);
 static DataNode* eval_list_node(const DataNode* node, EvalScope* scope, EvalError* err);
@@ -98,9 +135,137 @@ typedef struct {
     size_t cap;
 } StringBuilder;
 
-static DataNode* xon_get_key_internal(DataNode* obj, const char* key) {
+// Child index of an object or list with CHILD_INDEX_MIN or more items, built
+// when the container is built (by the grammar, the tape and JSON parsers,
+// evaluation and cloning) and never changed afterwards, so reads stay
+// read-only. It lives in the container's arena, or on the heap for heap
+// containers. items gives positional access and the size in O(1); for
+// objects, slots hash the keys by open addressing (item positions + 1) and
+// each pair caches its key hash.
+#define CHILD_INDEX_MIN 16
+
+typedef struct XonChildIndex {
+    size_t count;     // items
+    size_t mask;      // slot count - 1
+    DataNode** items; // in document order
+    uint32_t* slots;  // objects only
+} XonChildIndex;
+
+// FNV-1a, never 0 (0 marks a pair whose hash is not cached).
+static size_t index_key_hash(const char* s, size_t len) {
+    uint64_t h = 14695981039346656037ull;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 1099511628211ull;
+    }
+    return h ? (size_t)h : 1;
+}
+
+static int pair_has_key(const DataNode* pair) {
+    return pair->type == TYPE_OBJECT && pair->data.aggregate.key && pair->data.aggregate.key->type == TYPE_STRING &&
+           pair->data.aggregate.key->data.str.s_val;
+}
+
+// children: length of the item chain.
+static void child_index_build(XonArena* arena, DataNode* container, size_t children) {
+    int is_object = container->type == TYPE_OBJECT;
+    XonChildIndex* index;
+    DataNode* item;
+    size_t slots = 1;
+    size_t count = 0;
+
+    if (children < CHILD_INDEX_MIN || children > UINT32_MAX / 2) return;
+    if (is_object) {
+        while (slots < children * 2) slots <<= 1;
+    } else {
+        slots = 0;
+    }
+    index = (XonChildIndex*)node_alloc(arena, sizeof(XonChildIndex) + children * sizeof(DataNode*) +
+                                                  slots * sizeof(uint32_t));
+    if (!index) return;
+    index->items = (DataNode**)(index + 1);
+    index->slots = is_object ? (uint32_t*)(index->items + children) : NULL;
+    index->mask = slots - 1;
+    if (is_object) memset(index->slots, 0, slots * sizeof(uint32_t));
+
+    for (item = container->data.aggregate.value; item && count < children; item = item->next) {
+        const DataNode* key;
+        size_t i;
+        uint32_t slot;
+
+        index->items[count++] = item;
+        if (!is_object || !pair_has_key(item)) continue;
+        key = item->data.aggregate.key;
+        item->data.aggregate.cache.key_hash = index_key_hash(key->data.str.s_val, key->data.str.s_len);
+        // The first of duplicate keys wins, as in a linear search.
+        for (i = item->data.aggregate.cache.key_hash & index->mask; (slot = index->slots[i]) != 0;
+             i = (i + 1) & index->mask) {
+            const DataNode* other = index->items[slot - 1];
+            if (other->data.aggregate.cache.key_hash == item->data.aggregate.cache.key_hash &&
+                other->data.aggregate.key->data.str.s_len == key->data.str.s_len &&
+                memcmp(other->data.aggregate.key->data.str.s_val, key->data.str.s_val, key->data.str.s_len) == 0) {
+                break;
+            }
+        }
+        if (!slot) index->slots[i] = (uint32_t)count;
+    }
+    index->count = count;
+    container->data.aggregate.cache.index = index;
+}
+
+// Indexes a container after its items are linked.
+static void child_index_attach(XonArena* arena, DataNode* container) {
+    const DataNode* item;
+    size_t children = 0;
+    for (item = container->data.aggregate.value; item; item = item->next) children++;
+    child_index_build(arena, container, children);
+}
+
+// hash: index_key_hash() of the key.
+static const DataNode* child_index_find(const XonChildIndex* index, const char* key, size_t len, size_t hash) {
+    size_t i;
+    uint32_t slot;
+
+    for (i = hash & index->mask; (slot = index->slots[i]) != 0; i = (i + 1) & index->mask) {
+        const DataNode* pair = index->items[slot - 1];
+        if (pair->data.aggregate.cache.key_hash == hash && pair->data.aggregate.key->data.str.s_len == len &&
+            memcmp(pair->data.aggregate.key->data.str.s_val, key, len) == 0) {
+            return pair;
+        }
+    }
+    return NULL;
+}
+
+// Item index of a list or object: O(1) with a child index, otherwise a walk.
+static DataNode* container_item_at(const DataNode* container, size_t index) {
+    const XonChildIndex* children = container->data.aggregate.cache.index;
+    DataNode* item;
+
+    if (children) return index < children->count ? children->items[index] : NULL;
+    for (item = container->data.aggregate.value; item && index > 0; item = item->next) index--;
+    return item;
+}
+
+static size_t container_size(const DataNode* container) {
+    const DataNode* item;
+    size_t count = 0;
+
+    if (container->data.aggregate.cache.index) return container->data.aggregate.cache.index->count;
+    for (item = container->data.aggregate.value; item; item = item->next) count++;
+    return count;
+}
+
+// Member of obj named by key. hash is index_key_hash() of the key, or 0 to
+// compute it only if the object has an index.
+static DataNode* object_member(const DataNode* obj, const char* key, size_t key_len, size_t hash) {
     DataNode* current;
-    if (!obj || obj->type != TYPE_OBJECT || !key) return NULL;
+
+    if (!obj->data.aggregate.key && obj->data.aggregate.cache.index) {
+        const DataNode* pair = child_index_find(obj->data.aggregate.cache.index, key, key_len,
+                                                hash ? hash : index_key_hash(key, key_len));
+        return pair ? pair->data.aggregate.value : NULL;
+    }
 
     current = obj->data.aggregate.value;
     while (current) {
@@ -111,8 +276,9 @@ static DataNode* xon_get_key_internal(DataNode* obj, const char* key) {
 
         if (current->data.aggregate.key &&
             current->data.aggregate.key->type == TYPE_STRING &&
-            current->data.aggregate.key->data.s_val &&
-            strcmp(current->data.aggregate.key->data.s_val, key) == 0) {
+            current->data.aggregate.key->data.str.s_val &&
+            current->data.aggregate.key->data.str.s_len == key_len &&
+            memcmp(current->data.aggregate.key->data.str.s_val, key, key_len) == 0) {
             return current->data.aggregate.value;
         }
         current = current->next;
@@ -120,133 +286,238 @@ static DataNode* xon_get_key_internal(DataNode* obj, const char* key) {
     return NULL;
 }
 
-static void print_ast(const DataNode* node, int depth) {
-    int i;
-    const DataNode* current;
-    const DataNode* item;
+static DataNode* xon_get_key_internal(DataNode* obj, const char* key) {
+    if (!obj || obj->type != TYPE_OBJECT || !key) return NULL;
+    return object_member(obj, key, strlen(key), 0);
+}
 
-    if (!node) return;
-    for (i = 0; i < depth; i++) printf("  ");
+// Explicit work stack for tree traversals. Free, clone and print walk
+// sibling chains in loops and push nesting here, on the heap, so neither list
+// length nor nesting depth is bounded by the C stack. Small trees stay on the
+// inline buffer and never allocate.
+typedef struct {
+    const DataNode* node;
+    DataNode** slot; // clone: where the copy is linked
+    int depth;       // print: indentation level
+    int kind;
+} WorkItem;
 
-    switch (node->type) {
-        case TYPE_OBJECT:
-            printf("OBJECT\n");
-            current = node->data.aggregate.value;
-            while (current) {
-                for (i = 0; i < depth + 1; i++) printf("  ");
-                if (current->data.aggregate.key && current->data.aggregate.key->data.s_val) {
-                    printf("Key: %s\n", current->data.aggregate.key->data.s_val);
-                } else {
-                    printf("Key: <invalid>\n");
-                }
-                print_ast(current->data.aggregate.value, depth + 2);
-                current = current->next;
-            }
-            break;
-        case TYPE_LIST:
-            printf("LIST\n");
-            item = node->data.aggregate.value;
-            while (item) {
-                print_ast(item, depth + 1);
-                item = item->next;
-            }
-            break;
-        case TYPE_STRING:
-            printf("STRING: \"%s\"\n", node->data.s_val ? node->data.s_val : "");
-            break;
-        case TYPE_NUMBER:
-            printf("NUMBER: %.17g\n", node->data.n_val);
-            break;
-        case TYPE_BOOL:
-            printf("BOOL: %s\n", node->data.b_val ? "true" : "false");
-            break;
-        case TYPE_NULL:
-            printf("NULL\n");
-            break;
-        case TYPE_EXPR:
-            printf("EXPR\n");
-            break;
-        case TYPE_DECL:
-            printf("%s\n", node->data.declaration.is_const ? "CONST DECL" : "LET DECL");
-            for (i = 0; i < depth + 1; i++) printf("  ");
-            printf("name=%s\n", node->data.declaration.name ? node->data.declaration.name : "<anon>");
-            break;
-        case TYPE_FUNCTION:
-            printf("FUNCTION\n");
-            break;
-    }
+typedef struct {
+    WorkItem* items;
+    size_t len;
+    size_t cap;
+    WorkItem inline_items[16];
+} WorkStack;
+
+static void work_init(WorkStack* stack) {
+    stack->items = stack->inline_items;
+    stack->len = 0;
+    stack->cap = sizeof(stack->inline_items) / sizeof(stack->inline_items[0]);
 }
 
-static void free_xon_ast(DataNode* node) {
-    if (!node) return;
+static void work_release(WorkStack* stack) {
+    if (stack->items != stack->inline_items) free(stack->items);
+}
 
-    if (node->next) {
-        free_xon_ast(node->next);
+static int work_push(WorkStack* stack, const DataNode* node, DataNode** slot, int depth, int kind) {
+    WorkItem* item;
+    if (stack->len == stack->cap) {
+        size_t cap = stack->cap * 2;
+        WorkItem* items = (WorkItem*)malloc(cap * sizeof(WorkItem));
+        if (!items) return 0;
+        memcpy(items, stack->items, stack->len * sizeof(WorkItem));
+        work_release(stack);
+        stack->items = items;
+        stack->cap = cap;
     }
+    item = &stack->items[stack->len++];
+    item->node = node;
+    item->slot = slot;
+    item->depth = depth;
+    item->kind = kind;
+    return 1;
+}
+
+enum { PRINT_NODE, PRINT_ITEMS, PRINT_PAIRS };
+
+static void print_indent(int depth) {
+    int i;
+    for (i = 0; i < depth; i++) printf("  ");
+}
+
+static void print_ast(const DataNode* root, int depth) {
+    WorkStack stack;
+
+    if (!root) return;
+    work_init(&stack);
+    if (!work_push(&stack, root, NULL, depth, PRINT_NODE)) return;
+
+    // PRINT_ITEMS and PRINT_PAIRS frames hold the next sibling still to print,
+    // so the stack grows with nesting depth only.
+    while (stack.len > 0) {
+        WorkItem item = stack.items[--stack.len];
+        const DataNode* node = item.node;
+
+        if (item.kind == PRINT_ITEMS || item.kind == PRINT_PAIRS) {
+            if (node->next && !work_push(&stack, node->next, NULL, item.depth, item.kind)) break;
+            if (item.kind == PRINT_ITEMS) {
+                if (!work_push(&stack, node, NULL, item.depth, PRINT_NODE)) break;
+                continue;
+            }
+            print_indent(item.depth);
+            if (node->data.aggregate.key && node->data.aggregate.key->data.str.s_val) {
+                printf("Key: %s\n", node->data.aggregate.key->data.str.s_val);
+            } else {
+                printf("Key: <invalid>\n");
+            }
+            if (node->data.aggregate.value &&
+                !work_push(&stack, node->data.aggregate.value, NULL, item.depth + 1, PRINT_NODE)) {
+                break;
+            }
+            continue;
+        }
 
-    if (node->type == TYPE_EXPR && node->data.expr) {
-        XonExpr* expr = node->data.expr;
-        switch (expr->kind) {
-            case XON_EXPR_IDENTIFIER:
-                free(expr->u.identifier_name);
+        print_indent(item.depth);
+        switch (node->type) {
+            case TYPE_OBJECT:
+                printf("OBJECT\n");
+                if (node->data.aggregate.value &&
+                    !work_push(&stack, node->data.aggregate.value, NULL, item.depth + 1, PRINT_PAIRS)) {
+                    stack.len = 0;
+                }
+                break;
+            case TYPE_LIST:
+                printf("LIST\n");
+                if (node->data.aggregate.value &&
+                    !work_push(&stack, node->data.aggregate.value, NULL, item.depth + 1, PRINT_ITEMS)) {
+                    stack.len = 0;
+                }
                 break;
-            case XON_EXPR_BINARY:
-                free_xon_ast(expr->u.binary.left);
-                free_xon_ast(expr->u.binary.right);
+            case TYPE_STRING:
+                printf("STRING: \"%s\"\n", node->data.str.s_val ? node->data.str.s_val : "");
                 break;
-            case XON_EXPR_UNARY:
-                free_xon_ast(expr->u.unary.operand);
+            case TYPE_NUMBER:
+                printf("NUMBER: %.17g\n", node->data.n_val);
                 break;
-            case XON_EXPR_CALL:
-                free_xon_ast(expr->u.call.callee);
-                free_xon_ast(expr->u.call.args);
+            case TYPE_BOOL:
+                printf("BOOL: %s\n", node->data.b_val ? "true" : "false");
                 break;
-            case XON_EXPR_MEMBER:
-                free_xon_ast(expr->u.member.object);
-                free(expr->u.member.member);
+            case TYPE_NULL:
+                printf("NULL\n");
                 break;
-            case XON_EXPR_TERNARY:
-            case XON_EXPR_IF:
-                free_xon_ast(expr->u.ternary.cond);
-                free_xon_ast(expr->u.ternary.then_expr);
-                free_xon_ast(expr->u.ternary.else_expr);
+            case TYPE_EXPR:
+                printf("EXPR\n");
                 break;
-            case XON_EXPR_FUNCTION:
-                free_xon_ast(expr->u.function.params);
-                free_xon_ast(expr->u.function.body);
+            case TYPE_DECL:
+                printf("%s\n", node->data.declaration.is_const ? "CONST DECL" : "LET DECL");
+                print_indent(item.depth + 1);
+                printf("name=%s\n", node->data.declaration.name ? node->data.declaration.name : "<anon>");
                 break;
-            default:
+            case TYPE_FUNCTION:
+                printf("FUNCTION\n");
                 break;
         }
-        free(expr);
-    } else if (node->type == TYPE_FUNCTION) {
-        RuntimeFunction* fn = (RuntimeFunction*)node->data.function_data;
-        if (fn) {
-            fn->ref_count--;
-            if (fn->ref_count <= 0) {
-                if (!fn->is_native) {
-                    eval_scope_release(fn->impl.user.closure);
-                    free_xon_ast(fn->impl.user.params);
-                    free_xon_ast(fn->impl.user.body);
+    }
+    work_release(&stack);
+}
+
+// Queue a subtree for release. If the work stack cannot grow, fall back to
+// releasing it recursively rather than leaking it.
+static void free_push(WorkStack* stack, DataNode* node) {
+    if (node && !work_push(stack, node, NULL, 0, 0)) free_xon_ast(node);
+}
+
+static void free_xon_ast(DataNode* root) {
+    WorkStack stack;
+
+    if (!root) return;
+    work_init(&stack);
+    free_push(&stack, root);
+
+    while (stack.len > 0) {
+        DataNode* node = (DataNode*)stack.items[--stack.len].node;
+
+        if (node->flags & XON_NODE_ARENA_ROOT) {
+            ArenaDocument* doc = (ArenaDocument*)((uintptr_t)node - offsetof(ArenaDocument, root));
+            xon_arena_destroy(doc->arena);
+            continue;
+        }
+        // Arena trees never point at heap nodes, so there is nothing to walk.
+        if (node->flags & XON_NODE_ARENA) continue;
+
+        // Siblings are released in this loop; only nested subtrees are queued.
+        while (node) {
+            DataNode* next = node->next;
+
+            if (node->type == TYPE_EXPR && node->data.expr) {
+                XonExpr* expr = node->data.expr;
+                switch (expr->kind) {
+                    case XON_EXPR_IDENTIFIER:
+                        free(expr->u.identifier_name);
+                        break;
+                    case XON_EXPR_BINARY:
+                        free_push(&stack, expr->u.binary.left);
+                        free_push(&stack, expr->u.binary.right);
+                        break;
+                    case XON_EXPR_UNARY:
+                        free_push(&stack, expr->u.unary.operand);
+                        break;
+                    case XON_EXPR_CALL:
+                        free_push(&stack, expr->u.call.callee);
+                        free_push(&stack, expr->u.call.args);
+                        break;
+                    case XON_EXPR_MEMBER:
+                        free_push(&stack, expr->u.member.object);
+                        free(expr->u.member.member);
+                        break;
+                    case XON_EXPR_TERNARY:
+                    case XON_EXPR_IF:
+                        free_push(&stack, expr->u.ternary.cond);
+                        free_push(&stack, expr->u.ternary.then_expr);
+                        free_push(&stack, expr->u.ternary.else_expr);
+                        break;
+                    case XON_EXPR_FUNCTION:
+                        free_push(&stack, expr->u.function.params);
+                        free_push(&stack, expr->u.function.body);
+                        break;
+                    default:
+                        break;
+                }
+                free(expr);
+            } else if (node->type == TYPE_FUNCTION) {
+                RuntimeFunction* fn = (RuntimeFunction*)node->data.function_data;
+                if (fn) {
+                    fn->ref_count--;
+                    if (fn->ref_count <= 0) {
+                        if (!fn->is_native) {
+                            eval_scope_release(fn->impl.user.closure);
+                            free_push(&stack, fn->impl.user.params);
+                            free_push(&stack, fn->impl.user.body);
+                        }
+                        free(fn);
+                    }
                 }
-                free(fn);
             }
-        }
-    }
 
-    if (node->type == TYPE_STRING) {
-        free(node->data.s_val);
-    } else if (node->type == TYPE_OBJECT) {
-        free_xon_ast(node->data.aggregate.key);
-        free_xon_ast(node->data.aggregate.value);
-    } else if (node->type == TYPE_LIST) {
-        free_xon_ast(node->data.aggregate.value);
-    } else if (node->type == TYPE_DECL) {
-        free(node->data.declaration.name);
-        free_xon_ast(node->data.declaration.init_expr);
-    }
+            if (node->type == TYPE_STRING) {
+                free(node->data.str.s_val);
+            } else if (node->type == TYPE_OBJECT) {
+                if (!node->data.aggregate.key) free(node->data.aggregate.cache.index);
+                free_push(&stack, node->data.aggregate.key);
+                free_push(&stack, node->data.aggregate.value);
+            } else if (node->type == TYPE_LIST) {
+                free(node->data.aggregate.cache.index);
+                free_push(&stack, node->data.aggregate.value);
+            } else if (node->type == TYPE_DECL) {
+                free(node->data.declaration.name);
+                free_push(&stack, node->data.declaration.init_expr);
+            }
 
-    free(node);
+            free(node);
+            node = next;
+        }
+    }
+    work_release(&stack);
 }
 static DataNode* make_null_node(void) {
     return new_node(TYPE_NULL);
@@ -264,23 +535,28 @@ static DataNode* make_number_node(double value) {
     return node;
 }
 
-static DataNode* make_string_node(const char* value) {
+static DataNode* make_string_node_len(const char* value, size_t len) {
     DataNode* node = new_node(TYPE_STRING);
     if (!node) return NULL;
 
     if (!value) {
-        node->data.s_val = NULL;
+        node->data.str.s_val = NULL;
         return node;
     }
 
-    node->data.s_val = clone_c_string(value);
-    if (!node->data.s_val) {
+    node->data.str.s_val = clone_string_len(value, len);
+    if (!node->data.str.s_val) {
         free(node);
         return NULL;
     }
+    node->data.str.s_len = len;
     return node;
 }
 
+static DataNode* make_string_node(const char* value) {
+    return make_string_node_len(value, value ? strlen(value) : 0);
+}
+
 static void eval_scope_retain(EvalScope* scope) {
     if (!scope) return;
     scope->ref_count++;
@@ -422,190 +698,205 @@ static void eval_set_binding_value(EvalScope* scope, const char* name, DataNode*
     binding->resolving = 0;
 }
 
-static DataNode* clone_data_node(const DataNode* src);
-
-static XonExpr* clone_expr(const XonExpr* expr) {
-    DataNode* left;
-    DataNode* right;
-    DataNode* callee;
-    DataNode* args;
-    DataNode* obj;
-    DataNode* body;
-    DataNode* params;
-
-    if (!expr) return NULL;
-
-    switch (expr->kind) {
-        case XON_EXPR_IDENTIFIER:
-            return xon_expr_identifier(clone_c_string(expr->u.identifier_name), expr->line);
-        case XON_EXPR_BINARY:
-            left = clone_data_node(expr->u.binary.left);
-            right = clone_data_node(expr->u.binary.right);
-            if (!left || !right) {
-                if (left) free_xon_ast(left);
-                if (right) free_xon_ast(right);
-                return NULL;
-            }
-            return xon_expr_binary(expr->u.binary.op, left, right, expr->line);
-        case XON_EXPR_UNARY:
-            left = clone_data_node(expr->u.unary.operand);
-            if (!left) return NULL;
-            return xon_expr_unary(expr->u.unary.op, left, expr->line);
-        case XON_EXPR_CALL:
-            callee = clone_data_node(expr->u.call.callee);
-            args = clone_data_node(expr->u.call.args);
-            if (!callee || (expr->u.call.args && !args)) {
-                if (callee) free_xon_ast(callee);
-                if (args) free_xon_ast(args);
-                return NULL;
-            }
-            return xon_expr_call(callee, args, expr->line);
-        case XON_EXPR_MEMBER:
-            obj = clone_data_node(expr->u.member.object);
-            if (!obj) return NULL;
-            return xon_expr_member(obj, clone_c_string(expr->u.member.member), expr->line);
-        case XON_EXPR_TERNARY:
-        case XON_EXPR_IF:
-            left = clone_data_node(expr->u.ternary.cond);
-            right = clone_data_node(expr->u.ternary.then_expr);
-            body = clone_data_node(expr->u.ternary.else_expr);
-            if (!left || !right || !body) {
-                if (left) free_xon_ast(left);
-                if (right) free_xon_ast(right);
-                if (body) free_xon_ast(body);
-                return NULL;
-            }
-            return xon_expr_ternary(left, right, body, expr->line);
-        case XON_EXPR_FUNCTION:
-            params = clone_data_node(expr->u.function.params);
-            body = clone_data_node(expr->u.function.body);
-            if (!params && expr->u.function.params) {
-                if (body) free_xon_ast(body);
-                return NULL;
-            }
-            if (!body) return NULL;
-            return xon_expr_function(params, body, expr->line);
-        default:
-            return NULL;
-    }
-}
+enum { CLONE_NODE, CLONE_CHAIN, CLONE_INDEX };
 
-static DataNode* clone_data_node(const DataNode* src) {
+// Copies one node into *slot and queues its children, each with the slot its
+// copy is linked into. A CLONE_CHAIN item also queues the next sibling; a
+// CLONE_INDEX item, queued under the items, indexes the copied container.
+// Returns 0 when out of memory; the partial copy stays linked and consistent.
+static int clone_one(WorkStack* stack, const WorkItem* item) {
+    const DataNode* src = item->node;
     DataNode* dst;
-    DataNode* current;
-    DataNode* cloned;
-    DataNode* tail;
+    XonExpr* expr;
 
-    if (!src) return make_null_node();
+    if (!src) {
+        *item->slot = make_null_node();
+        return *item->slot != NULL;
+    }
 
     dst = new_node(src->type);
-    if (!dst) return NULL;
+    if (!dst) return 0;
+    dst->flags = src->flags & XON_NODE_LITERAL;
 
     switch (src->type) {
         case TYPE_STRING:
-            dst->data.s_val = clone_c_string(src->data.s_val);
-            if (src->data.s_val && !dst->data.s_val) {
+            dst->data.str.s_val = clone_string_len(src->data.str.s_val, src->data.str.s_len);
+            if (src->data.str.s_val && !dst->data.str.s_val) {
                 free(dst);
-                return NULL;
+                return 0;
             }
-            return dst;
+            dst->data.str.s_len = src->data.str.s_len;
+            break;
         case TYPE_NUMBER:
             dst->data.n_val = src->data.n_val;
-            return dst;
+            break;
         case TYPE_BOOL:
             dst->data.b_val = src->data.b_val;
-            return dst;
+            break;
         case TYPE_NULL:
-            return dst;
-        case TYPE_EXPR:
-            dst->data.expr = clone_expr(src->data.expr);
-            if (!dst->data.expr) {
+            break;
+        case TYPE_FUNCTION: {
+            RuntimeFunction* fn = (RuntimeFunction*)src->data.function_data;
+            if (!fn) {
                 free(dst);
-                return NULL;
+                return 0;
             }
-            return dst;
+            fn->ref_count++;
+            dst->data.function_data = fn;
+            break;
+        }
         case TYPE_DECL:
             dst->data.declaration.is_const = src->data.declaration.is_const;
             dst->data.declaration.name = clone_c_string(src->data.declaration.name);
             if (src->data.declaration.name && !dst->data.declaration.name) {
                 free(dst);
-                return NULL;
+                return 0;
             }
-            if (src->data.declaration.init_expr) {
-                dst->data.declaration.init_expr = clone_data_node(src->data.declaration.init_expr);
-                if (!dst->data.declaration.init_expr) {
-                    free(dst->data.declaration.name);
+            break;
+        case TYPE_EXPR:
+            if (!src->data.expr) {
+                free(dst);
+                return 0;
+            }
+            expr = (XonExpr*)malloc(sizeof(XonExpr));
+            if (!expr) {
+                free(dst);
+                return 0;
+            }
+            // Copy kind, operator and line here; operands are queued below.
+            memset(expr, 0, sizeof(XonExpr));
+            expr->kind = src->data.expr->kind;
+            expr->line = src->data.expr->line;
+            if (expr->kind == XON_EXPR_BINARY) {
+                expr->u.binary.op = src->data.expr->u.binary.op;
+            } else if (expr->kind == XON_EXPR_UNARY) {
+                expr->u.unary.op = src->data.expr->u.unary.op;
+            } else if (expr->kind == XON_EXPR_IDENTIFIER) {
+                expr->u.identifier_name = clone_c_string(src->data.expr->u.identifier_name);
+                if (src->data.expr->u.identifier_name && !expr->u.identifier_name) {
+                    free(expr);
                     free(dst);
-                    return NULL;
+                    return 0;
+                }
+            } else if (expr->kind == XON_EXPR_MEMBER) {
+                expr->u.member.member = clone_c_string(src->data.expr->u.member.member);
+                if (src->data.expr->u.member.member && !expr->u.member.member) {
+                    free(expr);
+                    free(dst);
+                    return 0;
                 }
             }
-            return dst;
-        case TYPE_FUNCTION: {
-            RuntimeFunction* fn = (RuntimeFunction*)src->data.function_data;
-            if (!fn) {
-                free(dst);
-                return NULL;
+            dst->data.expr = expr;
+            break;
+        case TYPE_OBJECT:
+        case TYPE_LIST:
+            break;
+        default:
+            free(dst);
+            return 0;
+    }
+
+    *item->slot = dst;
+    if (item->kind == CLONE_CHAIN && src->next &&
+        !work_push(stack, src->next, &dst->next, 0, CLONE_CHAIN)) {
+        return 0;
+    }
+
+    switch (src->type) {
+        case TYPE_DECL:
+            if (src->data.declaration.init_expr) {
+                return work_push(stack, src->data.declaration.init_expr,
+                                 &dst->data.declaration.init_expr, 0, CLONE_NODE);
             }
-            fn->ref_count++;
-            dst->data.function_data = fn;
-            return dst;
-        }
+            return 1;
         case TYPE_OBJECT:
             if (src->data.aggregate.key) {
-                dst->data.aggregate.key = clone_data_node(src->data.aggregate.key);
-                if (!dst->data.aggregate.key) {
-                    free(dst);
-                    return NULL;
+                if (!work_push(stack, src->data.aggregate.key, &dst->data.aggregate.key, 0, CLONE_NODE)) {
+                    return 0;
                 }
                 if (src->data.aggregate.value) {
-                    dst->data.aggregate.value = clone_data_node(src->data.aggregate.value);
-                    if (!dst->data.aggregate.value) {
-                        free_xon_ast(dst);
-                        return NULL;
-                    }
+                    return work_push(stack, src->data.aggregate.value, &dst->data.aggregate.value, 0, CLONE_NODE);
                 }
-                return dst;
+                return 1;
             }
             /* fallthrough for object containers (pairs list) */
         case TYPE_LIST:
-            current = src->data.aggregate.value;
-            dst->data.aggregate.value = NULL;
-            tail = NULL;
-            while (current) {
-                cloned = clone_data_node(current);
-                if (!cloned) {
-                    free_xon_ast(dst);
-                    return NULL;
-                }
-                if (!tail) {
-                    dst->data.aggregate.value = cloned;
-                    tail = cloned;
-                } else {
-                    tail->next = cloned;
-                    tail = cloned;
-                }
-                current = current->next;
+            if (src->data.aggregate.cache.index && !work_push(stack, dst, NULL, 0, CLONE_INDEX)) {
+                return 0;
+            }
+            if (src->data.aggregate.value) {
+                return work_push(stack, src->data.aggregate.value, &dst->data.aggregate.value, 0, CLONE_CHAIN);
             }
-            return dst;
+            return 1;
+        case TYPE_EXPR:
+            break;
         default:
-            free(dst);
-            return NULL;
+            return 1;
     }
-}
 
-static int is_number_type(const DataNode* value) {
-    return value && value->type == TYPE_NUMBER;
+    // Missing expression operands are copied as null nodes.
+    expr = dst->data.expr;
+    switch (expr->kind) {
+        case XON_EXPR_BINARY:
+            return work_push(stack, src->data.expr->u.binary.left, &expr->u.binary.left, 0, CLONE_NODE) &&
+                   work_push(stack, src->data.expr->u.binary.right, &expr->u.binary.right, 0, CLONE_NODE);
+        case XON_EXPR_UNARY:
+            return work_push(stack, src->data.expr->u.unary.operand, &expr->u.unary.operand, 0, CLONE_NODE);
+        case XON_EXPR_CALL:
+            return work_push(stack, src->data.expr->u.call.callee, &expr->u.call.callee, 0, CLONE_NODE) &&
+                   work_push(stack, src->data.expr->u.call.args, &expr->u.call.args, 0, CLONE_NODE);
+        case XON_EXPR_MEMBER:
+            return work_push(stack, src->data.expr->u.member.object, &expr->u.member.object, 0, CLONE_NODE);
+        case XON_EXPR_TERNARY:
+        case XON_EXPR_IF:
+            return work_push(stack, src->data.expr->u.ternary.cond, &expr->u.ternary.cond, 0, CLONE_NODE) &&
+                   work_push(stack, src->data.expr->u.ternary.then_expr, &expr->u.ternary.then_expr, 0, CLONE_NODE) &&
+                   work_push(stack, src->data.expr->u.ternary.else_expr, &expr->u.ternary.else_expr, 0, CLONE_NODE);
+        case XON_EXPR_FUNCTION:
+            return work_push(stack, src->data.expr->u.function.params, &expr->u.function.params, 0, CLONE_NODE) &&
+                   work_push(stack, src->data.expr->u.function.body, &expr->u.function.body, 0, CLONE_NODE);
+        default:
+            return 1;
+    }
 }
 
-static int is_string_type(const DataNode* value) {
-    return value && value->type == TYPE_STRING;
-}
+static DataNode* clone_data_node(const DataNode* src) {
+    DataNode* root = NULL;
+    WorkStack stack;
+    int ok;
+
+    work_init(&stack);
+    ok = work_push(&stack, src, &root, 0, CLONE_NODE);
+    while (ok && stack.len > 0) {
+        WorkItem item = stack.items[--stack.len];
+        if (item.kind == CLONE_INDEX) {
+            child_index_attach(NULL, (DataNode*)item.node);
+        } else {
+            ok = clone_one(&stack, &item);
+        }
+    }
+    work_release(&stack);
+
+    if (!ok) {
+        free_xon_ast(root);
+        return NULL;
+    }
+    return root;
+}
+
+static int is_number_type(const DataNode* value) {
+    return value && value->type == TYPE_NUMBER;
+}
+
+static int is_string_type(const DataNode* value) {
+    return value && value->type == TYPE_STRING;
+}
 
 static int is_truthy(const DataNode* value) {
     if (!value || value->type == TYPE_NULL) return 0;
     if (value->type == TYPE_BOOL) return value->data.b_val != 0;
     if (value->type == TYPE_NUMBER) return value->data.n_val != 0.0;
-    if (value->type == TYPE_STRING) return value->data.s_val && value->data.s_val[0] != '\0';
+    if (value->type == TYPE_STRING) return value->data.str.s_val && value->data.str.s_len > 0;
     return 1;
 }
 
@@ -621,24 +912,29 @@ static int values_equal(const DataNode* left, const DataNode* right) {
         case TYPE_NUMBER:
             return left->data.n_val == right->data.n_val;
         case TYPE_STRING:
-            return (left->data.s_val && right->data.s_val && strcmp(left->data.s_val, right->data.s_val) == 0);
+            return left->data.str.s_val && right->data.str.s_val &&
+                   left->data.str.s_len == right->data.str.s_len &&
+                   memcmp(left->data.str.s_val, right->data.str.s_val, left->data.str.s_len) == 0;
         default:
             return left == right;
     }
 }
 
-static char* clone_c_string(const char* src) {
+static char* clone_string_len(const char* src, size_t len) {
     char* out;
-    size_t len;
 
     if (!src) return NULL;
-    len = strlen(src);
     out = (char*)malloc(len + 1);
     if (!out) return NULL;
-    memcpy(out, src, len + 1);
+    memcpy(out, src, len);
+    out[len] = '\0';
     return out;
 }
 
+static char* clone_c_string(const char* src) {
+    return src ? clone_string_len(src, strlen(src)) : NULL;
+}
+
 static DataNode* runtime_to_string_node(const DataNode* node, EvalError* err) {
     char* rendered = NULL;
     char buffer[128];
@@ -647,7 +943,7 @@ static DataNode* runtime_to_string_node(const DataNode* node, EvalError* err) {
 
     switch (node->type) {
         case TYPE_STRING:
-            return make_string_node(node->data.s_val ? node->data.s_val : "");
+            return make_string_node_len(node->data.str.s_val ? node->data.str.s_val : "", node->data.str.s_len);
         case TYPE_NUMBER:
             snprintf(buffer, sizeof(buffer), "%.17g", node->data.n_val);
             return make_string_node(buffer);
@@ -690,7 +986,7 @@ static DataNode* builtin_len(size_t argc, const DataNode* const* argv, void* use
 
     switch (argv[0]->type) {
         case TYPE_STRING: {
-            return make_number_node((double)(argv[0]->data.s_val ? strlen(argv[0]->data.s_val) : 0));
+            return make_number_node((double)argv[0]->data.str.s_len);
         }
         case TYPE_LIST:
         case TYPE_OBJECT:
@@ -766,53 +1062,45 @@ static DataNode* builtin_str(size_t argc, const DataNode* const* argv, void* use
 
 static DataNode* builtin_upper(size_t argc, const DataNode* const* argv, void* userdata) {
     EvalError* err = (EvalError*)userdata;
-    char* input;
-    char* cursor;
     DataNode* result;
+    size_t i;
 
     if (argc != 1 || !is_string_type(argv[0])) {
         eval_set_error(err, "upper() expects one string");
         return NULL;
     }
 
-    input = clone_c_string(argv[0]->data.s_val ? argv[0]->data.s_val : "");
-    if (!input) {
+    result = make_string_node_len(argv[0]->data.str.s_val ? argv[0]->data.str.s_val : "", argv[0]->data.str.s_len);
+    if (!result) {
         eval_set_error(err, "Uppercase failed due to memory error");
         return NULL;
     }
 
-    for (cursor = input; *cursor; cursor++) {
-        *cursor = (char)toupper((unsigned char)*cursor);
+    for (i = 0; i < result->data.str.s_len; i++) {
+        result->data.str.s_val[i] = (char)toupper((unsigned char)result->data.str.s_val[i]);
     }
-
-    result = make_string_node(input);
-    free(input);
     return result;
 }
 
 static DataNode* builtin_lower(size_t argc, const DataNode* const* argv, void* userdata) {
     EvalError* err = (EvalError*)userdata;
-    char* input;
-    char* cursor;
     DataNode* result;
+    size_t i;
 
     if (argc != 1 || !is_string_type(argv[0])) {
         eval_set_error(err, "lower() expects one string");
         return NULL;
     }
 
-    input = clone_c_string(argv[0]->data.s_val ? argv[0]->data.s_val : "");
-    if (!input) {
+    result = make_string_node_len(argv[0]->data.str.s_val ? argv[0]->data.str.s_val : "", argv[0]->data.str.s_len);
+    if (!result) {
         eval_set_error(err, "Lowercase failed due to memory error");
         return NULL;
     }
 
-    for (cursor = input; *cursor; cursor++) {
-        *cursor = (char)tolower((unsigned char)*cursor);
+    for (i = 0; i < result->data.str.s_len; i++) {
+        result->data.str.s_val[i] = (char)tolower((unsigned char)result->data.str.s_val[i]);
     }
-
-    result = make_string_node(input);
-    free(input);
     return result;
 }
 
@@ -836,12 +1124,13 @@ static DataNode* builtin_keys(size_t argc, const DataNode* const* argv, void* us
     pair = argv[0]->data.aggregate.value;
     while (pair) {
         DataNode* value;
-        if (!pair->data.aggregate.key || !pair->data.aggregate.key->data.s_val) {
+        if (!pair->data.aggregate.key || !pair->data.aggregate.key->data.str.s_val) {
             eval_set_error(err, "Object key missing while computing keys()");
             free_xon_ast(result);
             return NULL;
         }
-        value = make_string_node(pair->data.aggregate.key->data.s_val);
+        value = make_string_node_len(pair->data.aggregate.key->data.str.s_val,
+                                     pair->data.aggregate.key->data.str.s_len);
         if (!value) {
             free_xon_ast(result);
             eval_set_error(err, "Out of memory for keys()");
@@ -882,9 +1171,10 @@ static DataNode* builtin_has(size_t argc, const DataNode* const* argv, void* use
     while (current) {
         if (current->type == TYPE_OBJECT &&
             current->data.aggregate.key &&
-            current->data.aggregate.key->data.s_val &&
-            key->data.s_val &&
-            strcmp(current->data.aggregate.key->data.s_val, key->data.s_val) == 0) {
+            current->data.aggregate.key->data.str.s_val &&
+            key->data.str.s_val &&
+            current->data.aggregate.key->data.str.s_len == key->data.str.s_len &&
+            memcmp(current->data.aggregate.key->data.str.s_val, key->data.str.s_val, key->data.str.s_len) == 0) {
             return make_bool_node(1);
         }
         current = current->next;
@@ -902,7 +1192,7 @@ static DataNode* builtin_env(size_t argc, const DataNode* const* argv, void* use
         return NULL;
     }
 
-    value = getenv(argv[0]->data.s_val ? argv[0]->data.s_val : "");
+    value = getenv(argv[0]->data.str.s_val ? argv[0]->data.str.s_val : "");
     if (!value) return make_null_node();
     return make_string_node(value);
 }
@@ -926,9 +1216,7 @@ static size_t eval_list_size(const DataNode* list) {
 
     if (!list) return 0;
 
-    if (list->type == TYPE_LIST) {
-        item = list->data.aggregate.value;
-    }
+    if (list->type == TYPE_LIST) return container_size(list);
 
     while (item) {
         count++;
@@ -1060,20 +1348,22 @@ static DataNode* eval_expr_node(const XonExpr* expr, EvalScope* scope, EvalError
                     if (is_number_type(left) && is_number_type(right)) {
                         result = make_number_node(left->data.n_val + right->data.n_val);
                     } else if (is_string_type(left) && is_string_type(right)) {
-                        size_t len = (left->data.s_val ? strlen(left->data.s_val) : 0) +
-                                     (right->data.s_val ? strlen(right->data.s_val) : 0);
-                        char* out = (char*)malloc(len + 1);
-                        if (!out) {
+                        size_t left_len = left->data.str.s_val ? left->data.str.s_len : 0;
+                        size_t right_len = right->data.str.s_val ? right->data.str.s_len : 0;
+                        char* out = (char*)malloc(left_len + right_len + 1);
+                        result = out ? new_node(TYPE_STRING) : NULL;
+                        if (!result) {
+                            free(out);
                             eval_set_error(err, "Out of memory during string concat");
                             free_xon_ast(left);
                             free_xon_ast(right);
                             return NULL;
                         }
-                        out[0] = '\0';
-                        if (left->data.s_val) strcat(out, left->data.s_val);
-                        if (right->data.s_val) strcat(out, right->data.s_val);
-                        result = make_string_node(out);
-                        free(out);
+                        if (left_len) memcpy(out, left->data.str.s_val, left_len);
+                        if (right_len) memcpy(out + left_len, right->data.str.s_val, right_len);
+                        out[left_len + right_len] = '\0';
+                        result->data.str.s_val = out;
+                        result->data.str.s_len = left_len + right_len;
                     } else {
                         eval_set_error(err, "Invalid operands for '+'");
                         result = NULL;
@@ -1293,11 +1583,11 @@ static DataNode* eval_expr_node(const XonExpr* expr, EvalScope* scope, EvalError
 
             if (current) {
                 while (current) {
-                    if (current->type != TYPE_STRING || !current->data.s_val) {
+                    if (current->type != TYPE_STRING || !current->data.str.s_val) {
                         eval_set_error(err, "Function parameter must be identifier");
                         return NULL;
                     }
-                    if (!eval_is_identifier(current->data.s_val)) {
+                    if (!eval_is_identifier(current->data.str.s_val)) {
                         eval_set_error(err, "Invalid function parameter identifier");
                         return NULL;
                     }
@@ -1461,6 +1751,7 @@ static DataNode* eval_object_node(const DataNode* node, EvalScope* scope, EvalEr
     }
 
     if (!out) return new_node(TYPE_OBJECT);
+    child_index_attach(NULL, out);
     return out;
 }
 
@@ -1493,6 +1784,7 @@ static DataNode* eval_list_node(const DataNode* node, EvalScope* scope, EvalErro
         item = item->next;
     }
 
+    child_index_attach(NULL, out);
     return out;
 }
 
@@ -1530,7 +1822,7 @@ static DataNode* eval_call(RuntimeFunction* fn, size_t argc, DataNode* const* ar
         for (i = 0; i < argc; i++) {
             const char* param_name = NULL;
             if (param) {
-                param_name = param->data.s_val;
+                param_name = param->data.str.s_val;
             }
             if (!param_name) {
                 eval_set_error(err, "Too many arguments for function");
@@ -1605,9 +1897,15 @@ static DataNode* xon_eval_node(const DataNode* node, EvalScope* scope, EvalError
 
     switch (node->type) {
         case TYPE_OBJECT:
-            return eval_object_node(node, scope, err);
         case TYPE_LIST:
-            return eval_list_node(node, scope, err);
+            // Literal-only containers evaluate to themselves.
+            if ((node->flags & XON_NODE_LITERAL) && !node->data.aggregate.key) {
+                DataNode* copy = clone_data_node(node);
+                if (!copy) eval_set_error(err, "Out of memory copying literal value");
+                return copy;
+            }
+            return node->type == TYPE_OBJECT ? eval_object_node(node, scope, err)
+                                             : eval_list_node(node, scope, err);
         case TYPE_EXPR:
             return eval_expr_node(node->data.expr, scope, err);
         case TYPE_DECL:
@@ -1617,7 +1915,7 @@ static DataNode* xon_eval_node(const DataNode* node, EvalScope* scope, EvalError
             eval_set_error(err, "Invalid declaration without initializer");
             return NULL;
         case TYPE_STRING:
-            return make_string_node(node->data.s_val);
+            return make_string_node_len(node->data.str.s_val, node->data.str.s_len);
         case TYPE_NUMBER:
             return make_number_node(node->data.n_val);
         case TYPE_BOOL:
@@ -1657,427 +1955,3909 @@ static EvalScope* eval_create_global_scope(EvalError* err) {
     return scope;
 }
 
-XonValue* xon_eval(const XonValue* value) {
+// Evaluates a document without reporting anything; on failure returns NULL
+// with err set (err stays inactive if only memory ran out).
+static DataNode* eval_document(const DataNode* value, EvalError* err) {
     DataNode* output;
-    EvalScope* scope;
-    EvalError err = {0};
+    EvalScope* scope = eval_create_global_scope(err);
 
-    if (!value) return NULL;
-
-    scope = eval_create_global_scope(&err);
-    if (!scope) {
-        if (err.active) {
-            fprintf(stderr, "Xon Eval Error: %s\n", err.message);
-            xon_log_error("eval", "Xon evaluation initialization failed: %s", err.message);
-        }
+    if (!scope) return NULL;
+    output = xon_eval_node(value, scope, err);
+    eval_scope_release(scope);
+    if (err->active) {
+        if (output) free_xon_ast(output);
         return NULL;
     }
+    return output;
+}
 
-    output = xon_eval_node((const DataNode*)value, scope, &err);
-    eval_scope_release(scope);
+XonValue* xon_eval(const XonValue* value) {
+    DataNode* output;
+    EvalError err = {0};
+
+    if (!value) return NULL;
 
+    output = eval_document((const DataNode*)value, &err);
     if (err.active) {
-        if (output) free_xon_ast(output);
         fprintf(stderr, "Xon Eval Error: %s\n", err.message);
         xon_log_error("eval", "Xon evaluation failed: %s", err.message);
         return NULL;
     }
+    if (!output) return NULL;
 
     xon_log_info("eval", "Evaluation completed");
     return output;
 }
 
-static DataNode* parse_stream(FILE* stream) {
-    void* parser;
-    ParserState state;
-    DataNode* root = NULL;
+static void parse_begin(ParserState* state, DataNode** root, XonArena* arena, XonIntern* intern) {
+    state->result = root;
+    state->arena = arena;
+    state->intern = intern;
+    state->had_error = 0;
+    state->on_syntax_error = on_syntax_error;
+    state->on_lexer_error = NULL;
+    state->on_container = NULL;
+    state->user_data = NULL;
+}
+
+static void report_lexer_error(int line, char* err_msg) {
+    if (!err_msg) return;
+    fprintf(stderr, "Lexer Error at line %d: %s\n", line, err_msg);
+    xon_log_error("lexer", "Lexer Error at line %d: %s", line, err_msg);
+    free(err_msg);
+}
+
+static void quiet_syntax_error(int line, const char* token, void* user_data) {
+    (void)line;
+    (void)token;
+    (void)user_data;
+}
+
+// parse_token_stream() flags. WRAP: the buffer is a piece of a list, missing
+// its opening and/or closing bracket. QUIET: report nothing on errors; the
+// caller reparses to report them. RECOVER: keep going after errors, passing
+// lexer errors to state->on_lexer_error; otherwise the first error ends it.
+#define PARSE_WRAP_OPEN 0x01
+#define PARSE_WRAP_CLOSE 0x02
+#define PARSE_QUIET 0x04
+#define PARSE_RECOVER 0x08
+
+static void feed_token(void* parser, int token_id, Token token, ParserState* state, int quiet) {
+    XonSyntaxErrorHandler handler = state->on_syntax_error;
+    if (quiet) state->on_syntax_error = quiet_syntax_error;
+    xonParser(parser, token_id, token, state);
+    state->on_syntax_error = handler;
+}
+
+// Feeds every token of lexer's input to parser, between the edge tokens the
+// flags ask for. The end token is always sent, so after a successful parse
+// the parser is back in its start state. Returns 0 if there was an error; the
+// parser then still counts it (yyerrcnt) and must be reset with
+// xonParserFinalize()/xonParserInit() before it is reused.
+static int feed_tokens(void* parser, ParserState* state, XonLexer* lexer, int flags) {
     XonTokenData token_data;
+    Token edge_token;
     char* err_msg = NULL;
     int token_id;
-    int current_line = 1;
+    int last_token = 0;
+    int after_lexer_error = 0;
 
-    parser = xonParserAlloc(malloc);
-    if (!parser) return NULL;
-    xon_logger_init("xon");
-    state.result = &root;
-    state.had_error = 0;
-    state.on_syntax_error = on_syntax_error;
-    state.user_data = NULL;
+    memset(&edge_token, 0, sizeof(edge_token));
+    edge_token.line = lexer->line;
+    if (flags & PARSE_WRAP_OPEN) xonParser(parser, LBRACKET, edge_token, state);
 
-    while ((token_id = xon_get_token(stream, &token_data, &err_msg, &current_line)) != 0) {
+    while ((token_id = xon_lexer_next(lexer, &token_data, &err_msg)) != 0) {
         Token parser_token;
         memset(&parser_token, 0, sizeof(parser_token));
         parser_token.s_val = token_data.sVal;
+        parser_token.span = token_data.span;
+        parser_token.s_len = token_data.sLen;
         parser_token.n_val = token_data.nVal;
-        parser_token.line = current_line;
+        parser_token.line = lexer->line;
+        parser_token.pos = lexer->token_start;
 
         if (token_id == -1) {
-            if (err_msg) {
-                fprintf(stderr, "Lexer Error at line %d: %s\n", current_line, err_msg);
-                xon_log_error("lexer", "Lexer Error at line %d: %s", current_line, err_msg);
+            state->had_error = 1;
+            if (flags & PARSE_RECOVER) {
+                state->on_lexer_error(lexer->line, err_msg ? err_msg : "Invalid token", state->user_data);
                 free(err_msg);
                 err_msg = NULL;
+                // Skip the bad token. The gap it leaves usually upsets the
+                // parser too, which would only repeat the error.
+                if (lexer->cursor == lexer->token_start && lexer->cursor < lexer->end) lexer->cursor++;
+                after_lexer_error = 1;
+                continue;
             }
-            root = NULL;
+            if (flags & PARSE_QUIET) {
+                free(err_msg);
+            } else {
+                report_lexer_error(lexer->line, err_msg);
+            }
+            err_msg = NULL;
             break;
         }
 
-        xonParser(parser, token_id, parser_token, &state);
+        feed_token(parser, token_id, parser_token, state, after_lexer_error);
+        last_token = token_id;
+        after_lexer_error = 0;
+        if (state->had_error && !(flags & PARSE_RECOVER)) break;
     }
 
-    {
-        Token end_token;
-        memset(&end_token, 0, sizeof(end_token));
-        end_token.line = current_line;
-        xonParser(parser, 0, end_token, &state);
-    }
+    edge_token.line = lexer->line;
+    // Wrapped text is cut before a comma, so it has no trailing comma of its
+    // own; one here is an empty item ("1, , 2") the bracket would hide. Text
+    // wrapped on both sides holds at least one item, or the commas around it
+    // were neighbours ("1, , 2" again, with the cuts on both commas).
+    if ((flags & PARSE_WRAP_CLOSE) && last_token == COMMA) state->had_error = 1;
+    if ((flags & PARSE_WRAP_OPEN) && (flags & PARSE_WRAP_CLOSE) && last_token == 0) state->had_error = 1;
+    if ((flags & PARSE_WRAP_CLOSE) && !state->had_error) xonParser(parser, RBRACKET, edge_token, state);
+    feed_token(parser, 0, edge_token, state, after_lexer_error);
+    return !state->had_error;
+}
 
-    xonParserFree(parser, free);
-    if (state.had_error) {
+// Runs one buffer through the lexer and an allocated Lemon parser.
+// first_line numbers the buffer's first line in diagnostics.
+static DataNode* parse_token_stream(void* parser, const char* data, size_t len, XonArena* arena, XonIntern* intern,
+                                    int first_line, int flags) {
+    ParserState state;
+    DataNode* root = NULL;
+    XonLexer lexer;
+
+    parse_begin(&state, &root, arena, intern);
+    if (flags & PARSE_QUIET) state.on_syntax_error = quiet_syntax_error;
+    xon_lexer_init(&lexer, data, len);
+    lexer.line = first_line;
+    lexer.arena = arena;
+
+    if (!feed_tokens(parser, &state, &lexer, flags)) {
         if (root) free_xon_ast(root);
-        root = NULL;
-        xon_log_error("parser", "Parsing failed due to syntax errors");
-    } else {
-        xon_log_info("parser", "Parsing completed successfully");
+        if (!(flags & PARSE_QUIET)) xon_log_error("parser", "Parsing failed due to syntax errors");
+        return NULL;
     }
     return root;
 }
 
-static int sb_init(StringBuilder* sb) {
-    sb->cap = 256;
-    sb->len = 0;
-    sb->data = (char*)malloc(sb->cap);
-    if (!sb->data) return 0;
-    sb->data[0] = '\0';
-    return 1;
+static DataNode* parse_tokens(void* parser, const char* data, size_t len, XonArena* arena, XonIntern* intern,
+                              int first_line) {
+    return parse_token_stream(parser, data, len, arena, intern, first_line, 0);
 }
 
-static int sb_reserve(StringBuilder* sb, size_t add_len) {
-    size_t required = sb->len + add_len + 1;
-    if (required <= sb->cap) return 1;
+// Syntax check only: strings stay spans of the input and the grammar actions
+// get XON_NO_NODES (see xon.lemon), so nothing is built or allocated. Errors
+// are reported as by parse_token_stream(). Returns 1 if the input is valid.
+static int check_tokens(void* parser, const char* data, size_t len, int first_line, int flags) {
+    ParserState state;
+    DataNode* root = NULL;
+    XonLexer lexer;
 
-    while (sb->cap < required) {
-        sb->cap *= 2;
-    }
-    sb->data = (char*)realloc(sb->data, sb->cap);
-    return sb->data != NULL;
+    parse_begin(&state, &root, XON_NO_NODES, NULL);
+    xon_lexer_init(&lexer, data, len);
+    lexer.line = first_line;
+    lexer.raw_strings = 1;
+    return feed_tokens(parser, &state, &lexer, flags);
 }
 
-static int sb_append_char(StringBuilder* sb, char c) {
-    if (!sb_reserve(sb, 1)) return 0;
-    sb->data[sb->len++] = c;
-    sb->data[sb->len] = '\0';
-    return 1;
+// ============ Tape parsing ============
+
+// Plain-data documents (no declarations or expressions other than negative
+// numbers) can skip the grammar entirely. Stage 1 indexes structural bytes
+// (structural.c); stage 2 walks that index once and writes the tape: one
+// fixed-size entry per value in document order, each key as a string entry
+// just before its value, and every decoded string in one buffer. A
+// container's entry holds its item count and the index just past its
+// subtree, so readers skip it in O(1). Anything stage 2 does not recognise,
+// including every kind of syntax error, makes it give up, and the document
+// goes through Lemon.
+//
+// The xon_tape_* functions read the tape directly. xonify() with the tape
+// enabled turns it into an ordinary arena document in one more pass, laying
+// the nodes out in document order in one block.
+
+typedef struct {
+    unsigned char type;    // XonType
+    unsigned char is_key;  // object key, followed by its value
+    unsigned char negated; // number written as -N
+    uint32_t end;          // index just past this value and its subtree
+    union {
+        double number;
+        int boolean;
+        uint32_t count; // items of a list, members of an object
+        struct {
+            uint32_t offset; // into XonTape.strings
+            uint32_t len;
+        } str;
+    } u;
+} TapeEntry;
+
+struct XonTape {
+    TapeEntry* entries;
+    size_t count;
+    char* strings;
+    size_t keys;         // entries with is_key set
+    size_t negated;      // entries with negated set
+    int strings_on_heap; // 0 if strings lives in an arena
+};
+
+typedef struct {
+    DataNode* node; // container being filled
+    DataNode* last; // its last item so far
+    DataNode* pair; // member whose value this container is, if any
+    size_t count;   // items so far
+    int literal;
+} TapeFrame;
+
+typedef struct {
+    const char* data;
+    const char* end;
+    const uint32_t* pos;
+    size_t count;
+    size_t k; // next index entry
+    XonTape* tape;
+    size_t cap;
+    size_t strings_used;
+    size_t strings_cap;
+} TapeBuilder;
+
+static TapeEntry* tape_entry(TapeBuilder* b, XonType type) {
+    TapeEntry* e;
+    if (b->tape->count == b->cap) return NULL;
+    e = &b->tape->entries[b->tape->count++];
+    memset(e, 0, sizeof(TapeEntry));
+    e->type = (unsigned char)type;
+    e->end = (uint32_t)b->tape->count;
+    return e;
 }
 
-static int sb_append_str(StringBuilder* sb, const char* str) {
-    size_t len;
-    if (!str) return 1;
-    len = strlen(str);
-    if (!sb_reserve(sb, len)) return 0;
-    memcpy(sb->data + sb->len, str, len);
-    sb->len += len;
-    sb->data[sb->len] = '\0';
-    return 1;
+static char tape_byte(const TapeBuilder* b) {
+    return b->k < b->count ? b->data[b->pos[b->k]] : '\0';
 }
 
-static int sb_append_indent(StringBuilder* sb, int depth) {
-    int i;
-    for (i = 0; i < depth; i++) {
-        if (!sb_append_str(sb, "    ")) return 0;
-    }
-    return 1;
+static int tape_ident_start(unsigned char c) {
+    return isalpha(c) || c == '_' || c == '$';
 }
 
-static int sb_append_escaped_string(StringBuilder* sb, const char* str) {
-    const unsigned char* p = (const unsigned char*)str;
-    if (!sb_append_char(sb, '"')) return 0;
-    while (*p) {
-        switch (*p) {
-            case '\\': if (!sb_append_str(sb, "\\\\")) return 0; break;
-            case '"': if (!sb_append_str(sb, "\\\"")) return 0; break;
-            case '\n': if (!sb_append_str(sb, "\\n")) return 0; break;
-            case '\r': if (!sb_append_str(sb, "\\r")) return 0; break;
-            case '\t': if (!sb_append_str(sb, "\\t")) return 0; break;
-            default:
-                if (*p < 0x20) {
-                    char escaped[7];
-                    snprintf(escaped, sizeof(escaped), "\\u%04x", *p);
-                    if (!sb_append_str(sb, escaped)) return 0;
-                } else {
-                    if (!sb_append_char(sb, (char)*p)) return 0;
-                }
-                break;
+static int tape_ident_char(unsigned char c) {
+    return isalnum(c) || c == '_' || c == '$';
+}
+
+// End of the scalar run starting at p: the next whitespace, structural byte,
+// quote or comment.
+static const char* tape_run_end(const char* p, const char* end) {
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (isspace(c) || c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',' || c == '"' ||
+            c == '#') {
+            break;
         }
+        if (c == '/' && p + 1 < end && (p[1] == '/' || p[1] == '*')) break;
         p++;
     }
-    return sb_append_char(sb, '"');
+    return p;
 }
 
-static int is_identifier_key(const char* key) {
-    size_t i;
-    if (!key || !key[0]) return 0;
-    if (!(isalpha((unsigned char)key[0]) || key[0] == '_')) return 0;
-    for (i = 1; key[i]; i++) {
-        if (!(isalnum((unsigned char)key[i]) || key[i] == '_')) return 0;
+// Room for len bytes and a terminator in the string buffer, or NULL.
+static char* tape_text(TapeBuilder* b, TapeEntry* e, size_t len) {
+    if (len >= b->strings_cap - b->strings_used) return NULL;
+    e->u.str.offset = (uint32_t)b->strings_used;
+    return b->tape->strings + b->strings_used;
+}
+
+static void tape_text_done(TapeBuilder* b, TapeEntry* e, size_t len) {
+    b->tape->strings[b->strings_used + len] = '\0';
+    e->u.str.len = (uint32_t)len;
+    b->strings_used += len + 1;
+}
+
+// String text between the quotes at index entries k and k + 1, decoded the
+// same way as the lexer does it.
+static TapeEntry* tape_string(TapeBuilder* b, TapeEntry* e) {
+    const char* start;
+    const char* close;
+    const char* src;
+    char* out;
+    char* dst;
+
+    if (b->k + 1 >= b->count) return NULL;
+    start = b->data + b->pos[b->k] + 1;
+    close = b->data + b->pos[b->k + 1];
+    b->k += 2;
+
+    out = tape_text(b, e, (size_t)(close - start));
+    if (!out) return NULL;
+    dst = out;
+    for (src = start; src < close;) {
+        const char* slash = xon_scan_find_byte(src, close, '\\');
+        memcpy(dst, src, (size_t)(slash - src));
+        dst += slash - src;
+        if (slash >= close) break;
+        *dst++ = xon_lexer_decode_escape(slash[1]);
+        src = slash + 2;
     }
-    return 1;
+    tape_text_done(b, e, (size_t)(dst - out));
+    return e;
 }
 
-static int serialize_value(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json);
-static int serialize_expr(const XonExpr* expr, StringBuilder* sb, int pretty, int depth, int as_json);
-static int serialize_params(const DataNode* params, StringBuilder* sb) {
-    const DataNode* current = params ? params->data.aggregate.value : NULL;
-    if (!sb_append_char(sb, '(')) return 0;
-    while (current) {
-        if (current->type == TYPE_STRING) {
-            if (!sb_append_str(sb, current->data.s_val ? current->data.s_val : "")) return 0;
-        }
-            if (current->next && !sb_append_str(sb, ", ")) return 0;
-            current = current->next;
+static TapeEntry* tape_key(TapeBuilder* b) {
+    TapeEntry* key = tape_entry(b, XON_TYPE_STRING);
+    const char* p;
+    const char* q;
+    const char* end;
+    char* text;
+
+    if (!key) return NULL;
+    key->is_key = 1;
+    b->tape->keys++;
+    if (tape_byte(b) == '"') return tape_string(b, key);
+
+    p = b->data + b->pos[b->k++];
+    end = tape_run_end(p, b->end);
+    if (!tape_ident_start((unsigned char)*p)) return NULL;
+    for (q = p + 1; q < end; q++) {
+        if (!tape_ident_char((unsigned char)*q)) return NULL;
     }
-    return sb_append_char(sb, ')');
+    // Keywords (including let/const declarations) are not keys.
+    if (xon_lexer_keyword(p, (size_t)(end - p))) return NULL;
+
+    text = tape_text(b, key, (size_t)(end - p));
+    if (!text) return NULL;
+    memcpy(text, p, (size_t)(end - p));
+    tape_text_done(b, key, (size_t)(end - p));
+    return key;
 }
 
-static int serialize_expr(const XonExpr* expr, StringBuilder* sb, int pretty, int depth, int as_json) {
-    (void)pretty;
-    (void)depth;
-    if (!expr) return 0;
+static int tape_number(const char* p, const char* end, double* out) {
+    if (p >= end || !isdigit((unsigned char)*p)) return 0;
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) return xon_parse_hex(p + 2, end, out);
+    return xon_parse_decimal(p, end, out);
+}
 
-    switch (expr->kind) {
-        case XON_EXPR_IDENTIFIER:
-            return sb_append_str(sb, expr->u.identifier_name ? expr->u.identifier_name : "");
-        case XON_EXPR_BINARY: {
-            const char* op = "";
-            switch (expr->u.binary.op) {
-                case XON_EXPR_OP_OR: op = "||"; break;
-                case XON_EXPR_OP_AND: op = "&&"; break;
-                case XON_EXPR_OP_EQ: op = "=="; break;
-                case XON_EXPR_OP_NEQ: op = "!="; break;
-                case XON_EXPR_OP_LT: op = "<"; break;
-                case XON_EXPR_OP_LTE: op = "<="; break;
-                case XON_EXPR_OP_GT: op = ">"; break;
-                case XON_EXPR_OP_GTE: op = ">="; break;
-                case XON_EXPR_OP_ADD: op = "+"; break;
-                case XON_EXPR_OP_SUB: op = "-"; break;
-                case XON_EXPR_OP_MUL: op = "*"; break;
-                case XON_EXPR_OP_DIV: op = "/"; break;
-                case XON_EXPR_OP_MOD: op = "%"; break;
-                case XON_EXPR_OP_NULLISH: op = "??"; break;
-                default: op = "?"; break;
-            }
-            if (!serialize_value(expr->u.binary.left, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_char(sb, ' ')) return 0;
-            if (!sb_append_str(sb, op)) return 0;
-            if (!sb_append_char(sb, ' ')) return 0;
-            return serialize_value(expr->u.binary.right, sb, pretty, depth, as_json);
+// A string, number, keyword literal or "-NUMBER". NULL for anything else.
+static TapeEntry* tape_scalar(TapeBuilder* b) {
+    const char* p;
+    const char* end;
+    size_t len;
+    TapeEntry* e;
+    double value;
+
+    if (tape_byte(b) == '"') {
+        e = tape_entry(b, XON_TYPE_STRING);
+        return e ? tape_string(b, e) : NULL;
+    }
+
+    p = b->data + b->pos[b->k++];
+    end = tape_run_end(p, b->end);
+    len = (size_t)(end - p);
+    if (len == 4 && memcmp(p, "true", 4) == 0) {
+        if ((e = tape_entry(b, XON_TYPE_BOOL))) e->u.boolean = 1;
+    } else if (len == 5 && memcmp(p, "false", 5) == 0) {
+        e = tape_entry(b, XON_TYPE_BOOL);
+    } else if (len == 4 && memcmp(p, "null", 4) == 0) {
+        e = tape_entry(b, XON_TYPE_NULL);
+    } else if (*p == '-') {
+        if (!tape_number(p + 1, end, &value)) return NULL;
+        if ((e = tape_entry(b, XON_TYPE_NUMBER))) {
+            e->negated = 1;
+            e->u.number = -value;
+            b->tape->negated++;
         }
-        case XON_EXPR_UNARY: {
-            const char* op = expr->u.unary.op == XON_EXPR_OP_NOT ? "!" : (expr->u.unary.op == XON_EXPR_OP_NEG ? "-" : "+");
-            if (!sb_append_str(sb, op)) return 0;
-            return serialize_value(expr->u.unary.operand, sb, pretty, depth, as_json);
+    } else {
+        if (!tape_number(p, end, &value)) return NULL;
+        if ((e = tape_entry(b, XON_TYPE_NUMBER))) e->u.number = value;
+    }
+    return e;
+}
+
+static int tape_build(TapeBuilder* b) {
+    size_t* stack; // entry index of each open container
+    size_t depth = 0;
+    size_t cap = 64;
+    int after_item = 0;
+    char c = tape_byte(b);
+
+    if (c != '{' && c != '[') return 0;
+    stack = (size_t*)malloc(cap * sizeof(size_t));
+    if (!stack) return 0;
+    if (!tape_entry(b, c == '{' ? XON_TYPE_OBJECT : XON_TYPE_LIST)) goto fail;
+    b->k++;
+    stack[depth++] = 0;
+
+    while (depth > 0) {
+        TapeEntry* f = &b->tape->entries[stack[depth - 1]];
+        int is_object = f->type == XON_TYPE_OBJECT;
+
+        c = tape_byte(b);
+        if (c == (is_object ? '}' : ']')) {
+            b->k++;
+            f->end = (uint32_t)b->tape->count;
+            depth--;
+            after_item = 1;
+            continue;
         }
-        case XON_EXPR_MEMBER:
-            if (!serialize_value(expr->u.member.object, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_char(sb, '.')) return 0;
-            return sb_append_str(sb, expr->u.member.member ? expr->u.member.member : "");
-        case XON_EXPR_TERNARY:
-            if (!serialize_value(expr->u.ternary.cond, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_str(sb, " ? ")) return 0;
-            if (!serialize_value(expr->u.ternary.then_expr, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_str(sb, " : ")) return 0;
-            return serialize_value(expr->u.ternary.else_expr, sb, pretty, depth, as_json);
-        case XON_EXPR_IF:
-            if (!sb_append_str(sb, "if (")) return 0;
-            if (!serialize_value(expr->u.ternary.cond, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_str(sb, ") ")) return 0;
-            if (!serialize_value(expr->u.ternary.then_expr, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_str(sb, " else ")) return 0;
-            return serialize_value(expr->u.ternary.else_expr, sb, pretty, depth, as_json);
-        case XON_EXPR_CALL:
-            if (!serialize_value(expr->u.call.callee, sb, pretty, depth, as_json)) return 0;
-            if (!sb_append_char(sb, '(')) return 0;
-            if (expr->u.call.args) {
-                const DataNode* arg = expr->u.call.args;
-                while (arg) {
-                    if (!serialize_value(arg, sb, pretty, depth, as_json)) return 0;
-                    arg = arg->next;
-                    if (arg && !sb_append_str(sb, ", ")) return 0;
-                }
+        if (after_item) {
+            if (c != ',') goto fail;
+            b->k++;
+            after_item = 0;
+            continue;
+        }
+
+        f->u.count++;
+        if (is_object) {
+            if (!tape_key(b) || tape_byte(b) != ':') goto fail;
+            b->k++;
+            c = tape_byte(b);
+        }
+        if (c == '{' || c == '[') {
+            if (depth == cap) {
+                size_t* grown = (size_t*)realloc(stack, cap * 2 * sizeof(size_t));
+                if (!grown) goto fail;
+                stack = grown;
+                cap *= 2;
             }
-            return sb_append_char(sb, ')');
-        case XON_EXPR_FUNCTION:
-            if (!serialize_params(expr->u.function.params, sb)) return 0;
-            if (!sb_append_str(sb, " => ")) return 0;
-            return serialize_value(expr->u.function.body, sb, pretty, depth, as_json);
-        default:
-            return sb_append_str(sb, "<expr>");
+            stack[depth++] = b->tape->count;
+            if (!tape_entry(b, c == '{' ? XON_TYPE_OBJECT : XON_TYPE_LIST)) goto fail;
+            b->k++;
+        } else {
+            if (c == '\0' || c == ',' || c == '}' || c == ']' || c == ':') goto fail;
+            if (!tape_scalar(b)) goto fail;
+            after_item = 1;
+        }
     }
-}
 
-static int serialize_object(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
-    const DataNode* pair = node->data.aggregate.value;
-    if (!sb_append_char(sb, '{')) return 0;
+    free(stack);
+    return b->k == b->count;
 
-    if (pair) {
-        if (pretty && !sb_append_char(sb, '\n')) return 0;
-        while (pair) {
-            if (pair->type == TYPE_DECL) {
+fail:
+    free(stack);
+    return 0;
+}
+
+// Writes the tape of data into tape. Strings go into arena, or on the heap
+// if arena is NULL. Returns 0 if the document is not plain data.
+static int tape_write(XonTape* tape, const char* data, size_t len, XonArena* arena) {
+    XonStructuralIndex index;
+    TapeBuilder b;
+    int ok = 0;
+
+    memset(tape, 0, sizeof(XonTape));
+    if (!xon_structural_index(data, len, &index)) return 0;
+
+    memset(&b, 0, sizeof(b));
+    b.data = data;
+    b.end = data + len;
+    b.pos = index.pos;
+    b.count = index.count;
+    b.tape = tape;
+    // Every entry is introduced by an index entry of its own, and decoded
+    // strings with their terminators fit in the text they came from.
+    b.cap = index.count;
+    b.strings_cap = len + 1;
+    tape->strings_on_heap = arena == NULL;
+    if (b.cap > 0) {
+        tape->entries = (TapeEntry*)malloc(b.cap * sizeof(TapeEntry));
+        tape->strings = arena ? (char*)xon_arena_alloc(arena, b.strings_cap) : (char*)malloc(b.strings_cap);
+        if (tape->entries && tape->strings) ok = tape_build(&b);
+    }
+    xon_structural_free(&index);
+    if (!ok) {
+        free(tape->entries);
+        if (tape->strings_on_heap) free(tape->strings);
+        memset(tape, 0, sizeof(XonTape));
+    }
+    return ok;
+}
+
+static DataNode* tape_tree_node(const XonTape* tape, const TapeEntry* e, DataNode** nodes, XonArena* arena,
+                                int copy) {
+    DataNode* n = (*nodes)++;
+
+    memset(n, 0, sizeof(DataNode));
+    n->type = e->type == XON_TYPE_BOOL     ? TYPE_BOOL
+              : e->type == XON_TYPE_NUMBER ? TYPE_NUMBER
+              : e->type == XON_TYPE_STRING ? TYPE_STRING
+              : e->type == XON_TYPE_OBJECT ? TYPE_OBJECT
+              : e->type == XON_TYPE_LIST   ? TYPE_LIST
+                                           : TYPE_NULL;
+    n->flags = XON_NODE_ARENA;
+    if (e->type == XON_TYPE_OBJECT || e->type == XON_TYPE_LIST) return n;
+    n->flags |= XON_NODE_LITERAL;
+    if (e->type == XON_TYPE_BOOL) {
+        n->data.b_val = e->u.boolean;
+    } else if (e->type == XON_TYPE_STRING) {
+        const char* text = tape->strings + e->u.str.offset;
+        if (copy) {
+            char* owned = (char*)xon_arena_alloc(arena, e->u.str.len + 1);
+            if (!owned) return NULL;
+            memcpy(owned, text, e->u.str.len + 1);
+            text = owned;
+        }
+        n->data.str.s_val = (char*)text;
+        n->data.str.s_len = e->u.str.len;
+    } else if (e->type == XON_TYPE_NUMBER && e->negated) {
+        // As the grammar builds it.
+        DataNode* number = (*nodes)++;
+        XonExpr* neg;
+        *number = *n;
+        number->data.n_val = -e->u.number;
+        neg = xon_expr_unary(arena, XON_EXPR_OP_NEG, number, 0);
+        if (!neg) return NULL;
+        n->type = TYPE_EXPR;
+        n->flags = XON_NODE_ARENA;
+        n->data.expr = neg;
+    } else if (e->type == XON_TYPE_NUMBER) {
+        n->data.n_val = e->u.number;
+    }
+    return n;
+}
+
+// The tree of tape entries [at, entries[at].end), in arena. copy: strings are
+// copied into arena instead of pointing into the tape's buffer.
+static DataNode* tape_tree(const XonTape* tape, size_t at, XonArena* arena, int copy) {
+    const TapeEntry* entries = tape->entries;
+    size_t end = entries[at].end;
+    size_t keys = tape->keys;
+    size_t negated = tape->negated;
+    size_t i;
+    DataNode* nodes;
+    DataNode* root;
+    TapeFrame* stack = NULL;
+    size_t* ends = NULL;
+    size_t depth = 0;
+    size_t cap = 64;
+
+    if (at > 0 || end < tape->count) {
+        keys = 0;
+        negated = 0;
+        for (i = at; i < end; i++) {
+            keys += entries[i].is_key;
+            negated += entries[i].negated;
+        }
+    }
+    // A node per entry, a pair per key and a number under each negation.
+    nodes = (DataNode*)xon_arena_alloc(arena, (end - at + keys + negated) * sizeof(DataNode));
+    if (!nodes || !(root = tape_tree_node(tape, &entries[at], &nodes, arena, copy))) return NULL;
+    if (entries[at].type != XON_TYPE_OBJECT && entries[at].type != XON_TYPE_LIST) return root;
+
+    stack = (TapeFrame*)malloc(cap * sizeof(TapeFrame));
+    ends = (size_t*)malloc(cap * sizeof(size_t));
+    if (!stack || !ends) goto fail;
+    memset(&stack[0], 0, sizeof(TapeFrame));
+    stack[0].node = root;
+    stack[0].literal = 1;
+    ends[0] = end;
+    depth = 1;
+
+    for (i = at + 1; depth > 0;) {
+        TapeFrame* f = &stack[depth - 1];
+        DataNode* pair = NULL;
+        DataNode* value;
+        DataNode* item;
+
+        if (i == ends[depth - 1]) {
+            int literal = f->literal;
+            if (literal) {
+                f->node->flags |= XON_NODE_LITERAL;
+                if (f->pair) f->pair->flags |= XON_NODE_LITERAL;
+            }
+            child_index_build(arena, f->node, f->count);
+            depth--;
+            if (depth > 0) stack[depth - 1].literal &= literal;
+            continue;
+        }
+
+        if (entries[i].is_key) {
+            pair = nodes++;
+            memset(pair, 0, sizeof(DataNode));
+            pair->type = TYPE_OBJECT;
+            pair->flags = XON_NODE_ARENA;
+            if (!(pair->data.aggregate.key = tape_tree_node(tape, &entries[i], &nodes, arena, copy))) goto fail;
+            pair->data.aggregate.key->flags &= (unsigned char)~XON_NODE_LITERAL;
+            i++;
+        }
+        if (!(value = tape_tree_node(tape, &entries[i], &nodes, arena, copy))) goto fail;
+        item = value;
+        if (pair) {
+            pair->data.aggregate.value = value;
+            if (value->flags & XON_NODE_LITERAL) pair->flags |= XON_NODE_LITERAL;
+            item = pair;
+        }
+        if (f->last) {
+            f->last->next = item;
+        } else {
+            f->node->data.aggregate.value = item;
+        }
+        f->last = item;
+        f->count++;
+
+        if (value->type == TYPE_OBJECT || value->type == TYPE_LIST) {
+            if (depth == cap) {
+                TapeFrame* grown = (TapeFrame*)realloc(stack, cap * 2 * sizeof(TapeFrame));
+                size_t* grown_ends;
+                if (!grown) goto fail;
+                stack = grown;
+                grown_ends = (size_t*)realloc(ends, cap * 2 * sizeof(size_t));
+                if (!grown_ends) goto fail;
+                ends = grown_ends;
+                cap *= 2;
+            }
+            memset(&stack[depth], 0, sizeof(TapeFrame));
+            stack[depth].node = value;
+            stack[depth].pair = pair;
+            stack[depth].literal = 1;
+            ends[depth] = entries[i].end;
+            depth++;
+        } else if (!(value->flags & XON_NODE_LITERAL)) {
+            f->literal = 0;
+        }
+        i++;
+    }
+
+    free(stack);
+    free(ends);
+    return root;
+
+fail:
+    free(stack);
+    free(ends);
+    return NULL;
+}
+
+// Builds into arena, which holds garbage when this returns NULL.
+static DataNode* tape_parse(const char* data, size_t len, XonArena* arena) {
+    XonTape tape;
+    DataNode* root;
+
+    if (!tape_write(&tape, data, len, arena)) return NULL;
+    root = tape_tree(&tape, 0, arena, 0);
+    free(tape.entries);
+    return root;
+}
+
+// ============ JSON parsing ============
+
+// Plain JSON has no comments, identifiers, expressions or hex, so it needs no
+// lexer or grammar: every value is told apart by its first byte and read in
+// one pass, with strings scanned by the SIMD kernels. Trees and events come
+// out exactly as the general parsers make them (negative numbers are
+// negations, and escapes decode as the lexer decodes them). Anything else,
+// including the \b, \f and \u escapes that the lexer reads differently from
+// JSON, makes this parser give up, and the document goes the general way,
+// which also reports any errors.
+
+static XonJsonMode g_json_mode = XON_JSON_DETECT;
+
+// Whether the JSON parser goes first for filename (NULL for buffers).
+static int json_applies(const char* filename) {
+    size_t len;
+    if (g_json_mode != XON_JSON_DETECT) return g_json_mode == XON_JSON_ALWAYS;
+    if (!filename) return 0;
+    len = strlen(filename);
+    return len >= 5 && strcmp(filename + len - 5, ".json") == 0;
+}
+
+static const char* json_skip_ws(const char* p, const char* end) {
+    int lines = 0;
+    if (p < end && (unsigned char)*p > ' ') return p;
+    return xon_scan_skip_ws(p, end, &lines);
+}
+
+// Closing quote of the string whose opening quote is at p, or NULL.
+// *escaped is set if the string holds escapes.
+static const char* json_string_end(const char* p, const char* end, int* escaped) {
+    int lines = 0;
+
+    *escaped = 0;
+    for (p++;; p += 2) {
+        p = xon_scan_string(p, end, &lines);
+        if (p >= end) return NULL;
+        if (*p == '"') return p;
+        if (p + 1 >= end) return NULL;
+        switch (p[1]) {
+            case '"': case '\\': case '/': case 'n': case 't': case 'r': break;
+            default: return NULL;
+        }
+        *escaped = 1;
+    }
+}
+
+// Decodes [src, close) into dst; returns the decoded length.
+static size_t json_decode(const char* src, const char* close, char* dst) {
+    char* start = dst;
+    while (src < close) {
+        const char* slash = xon_scan_find_byte(src, close, '\\');
+        memcpy(dst, src, (size_t)(slash - src));
+        dst += slash - src;
+        if (slash >= close) break;
+        *dst++ = xon_lexer_decode_escape(slash[1]);
+        src = slash + 2;
+    }
+    return (size_t)(dst - start);
+}
+
+static int json_digit(const char* p, const char* end) {
+    return p < end && *p >= '0' && *p <= '9';
+}
+
+// End of the JSON number starting at p, or NULL if there is none.
+static const char* json_number_end(const char* p, const char* end) {
+    if (p < end && *p == '-') p++;
+    if (!json_digit(p, end)) return NULL;
+    if (*p++ != '0') {
+        while (json_digit(p, end)) p++;
+    }
+    if (p < end && *p == '.') {
+        if (!json_digit(++p, end)) return NULL;
+        while (json_digit(p, end)) p++;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        if (!json_digit(p, end)) return NULL;
+        while (json_digit(p, end)) p++;
+    }
+    return p;
+}
+
+static int json_word(const char* p, const char* end, const char* word, size_t len) {
+    return (size_t)(end - p) >= len && memcmp(p, word, len) == 0;
+}
+
+// Reads the string at *pp into n.
+static DataNode* json_string(XonArena* arena, const char** pp, const char* end, DataNode* n) {
+    int escaped;
+    const char* start = *pp + 1;
+    const char* close = json_string_end(*pp, end, &escaped);
+    size_t len;
+    char* out;
+
+    if (!n || !close) return NULL;
+    len = (size_t)(close - start);
+    out = (char*)xon_arena_alloc(arena, len + 1);
+    if (!out) return NULL;
+    if (escaped) {
+        len = json_decode(start, close, out);
+    } else {
+        memcpy(out, start, len);
+    }
+    out[len] = '\0';
+    n->data.str.s_val = out;
+    n->data.str.s_len = len;
+    *pp = close + 1;
+    return n;
+}
+
+static DataNode* json_scalar(XonArena* arena, const char** pp, const char* end) {
+    const char* p = *pp;
+    DataNode* n;
+
+    switch (*p) {
+        case '"':
+            n = new_literal_node(arena, TYPE_STRING);
+            return json_string(arena, pp, end, n);
+        case 't':
+            if (!json_word(p, end, "true", 4)) return NULL;
+            if ((n = new_literal_node(arena, TYPE_BOOL))) n->data.b_val = 1;
+            *pp = p + 4;
+            return n;
+        case 'f':
+            if (!json_word(p, end, "false", 5)) return NULL;
+            *pp = p + 5;
+            return new_literal_node(arena, TYPE_BOOL);
+        case 'n':
+            if (!json_word(p, end, "null", 4)) return NULL;
+            *pp = p + 4;
+            return new_literal_node(arena, TYPE_NULL);
+        default: {
+            const char* q = json_number_end(p, end);
+            DataNode* number;
+            double value;
+
+            if (!q || !xon_parse_decimal(p + (*p == '-'), q, &value)) return NULL;
+            number = new_literal_node(arena, TYPE_NUMBER);
+            if (!number) return NULL;
+            number->data.n_val = value;
+            *pp = q;
+            if (*p != '-') return number;
+            // As the grammar builds it.
+            return new_expr_node(arena, xon_expr_unary(arena, XON_EXPR_OP_NEG, number, 0));
+        }
+    }
+}
+
+// Builds into arena, which holds garbage when this returns NULL. Containers
+// are filled the way tape_build() fills them.
+static DataNode* json_build(const char* data, size_t len, XonArena* arena) {
+    const char* p = data;
+    const char* end = data + len;
+    TapeFrame* stack;
+    size_t depth = 0;
+    size_t cap = 64;
+    DataNode* root;
+    int after_item = 0;
+
+    p = json_skip_ws(p, end);
+    if (p >= end || (*p != '{' && *p != '[')) return NULL;
+    stack = (TapeFrame*)malloc(cap * sizeof(TapeFrame));
+    if (!stack) return NULL;
+    root = new_node_in(arena, *p++ == '{' ? TYPE_OBJECT : TYPE_LIST);
+    if (!root) goto fail;
+    stack[depth].node = root;
+    stack[depth].last = NULL;
+    stack[depth].pair = NULL;
+    stack[depth].count = 0;
+    stack[depth].literal = 1;
+    depth++;
+
+    while (depth > 0) {
+        TapeFrame* f = &stack[depth - 1];
+        int is_object = f->node->type == TYPE_OBJECT;
+        DataNode* item;
+        DataNode* pair = NULL;
+        DataNode* value;
+
+        p = json_skip_ws(p, end);
+        if (p >= end) goto fail;
+        if (*p == (is_object ? '}' : ']')) {
+            int literal = f->literal;
+            p++;
+            if (literal) {
+                f->node->flags |= XON_NODE_LITERAL;
+                if (f->pair) f->pair->flags |= XON_NODE_LITERAL;
+            }
+            child_index_build(arena, f->node, f->count);
+            depth--;
+            if (depth > 0) stack[depth - 1].literal &= literal;
+            after_item = 1;
+            continue;
+        }
+        if (after_item) {
+            if (*p++ != ',') goto fail;
+            after_item = 0;
+            continue;
+        }
+
+        if (is_object) {
+            if (*p != '"') goto fail;
+            pair = new_node_in(arena, TYPE_OBJECT);
+            if (!pair || !(pair->data.aggregate.key = json_string(arena, &p, end, new_node_in(arena, TYPE_STRING)))) {
+                goto fail;
+            }
+            p = json_skip_ws(p, end);
+            if (p >= end || *p++ != ':') goto fail;
+            p = json_skip_ws(p, end);
+            if (p >= end) goto fail;
+        }
+        item = pair;
+
+        if (*p == '{' || *p == '[') {
+            value = new_node_in(arena, *p++ == '{' ? TYPE_OBJECT : TYPE_LIST);
+            if (!value) goto fail;
+        } else {
+            value = json_scalar(arena, &p, end);
+            if (!value) goto fail;
+            after_item = 1;
+        }
+
+        if (pair) {
+            pair->data.aggregate.value = value;
+            if (value->flags & XON_NODE_LITERAL) pair->flags |= XON_NODE_LITERAL;
+        } else {
+            item = value;
+        }
+        if (f->last) {
+            f->last->next = item;
+        } else {
+            f->node->data.aggregate.value = item;
+        }
+        f->last = item;
+        f->count++;
+
+        if (!after_item) {
+            if (depth == cap) {
+                TapeFrame* grown = (TapeFrame*)realloc(stack, cap * 2 * sizeof(TapeFrame));
+                if (!grown) goto fail;
+                stack = grown;
+                cap *= 2;
+            }
+            stack[depth].node = value;
+            stack[depth].last = NULL;
+            stack[depth].pair = pair;
+            stack[depth].count = 0;
+            stack[depth].literal = 1;
+            depth++;
+        } else if (!(value->flags & XON_NODE_LITERAL)) {
+            f->literal = 0;
+        }
+    }
+
+    free(stack);
+    return json_skip_ws(p, end) == end ? root : NULL;
+
+fail:
+    free(stack);
+    return NULL;
+}
+
+// ============ Parallel parsing ============
+
+// A large document whose root is a list is cut at root-level commas, and the
+// pieces are parsed as lists of their own on worker threads, each into its own
+// arena. Their item chains are then linked in order under one root list and
+// the arenas merged into one, which gives the tree the serial parser builds.
+// If any piece fails (a bad document, or a cut inside parentheses, which
+// leaves both sides unbalanced), the document goes to the serial parser,
+// which reports the errors as usual.
+
+#define PARALLEL_MIN_BYTES (1024 * 1024)
+#define PARALLEL_MIN_PIECE (256 * 1024)
+#define PARALLEL_PIECES_PER_THREAD 4
+
+// 1 parses serially; see xon_set_parse_threads().
+static int g_parse_threads = 1;
+
+typedef struct {
+    const char* start;
+    size_t len;
+    int line;
+    int flags;
+    XonArena* arena;
+    DataNode* first; // item chain; NULL for an empty piece
+    DataNode* last;
+    int literal;
+} ParallelPiece;
+
+typedef struct {
+    ParallelPiece* pieces;
+    size_t count;
+    size_t next;
+    int failed;
+#if !defined(_WIN32)
+    pthread_mutex_t lock;
+#endif
+} ParallelJob;
+
+static int parallel_take(ParallelJob* job, size_t* index) {
+    int ok;
+#if !defined(_WIN32)
+    pthread_mutex_lock(&job->lock);
+#endif
+    ok = !job->failed && job->next < job->count;
+    if (ok) *index = job->next++;
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&job->lock);
+#endif
+    return ok;
+}
+
+static void parallel_fail(ParallelJob* job) {
+#if !defined(_WIN32)
+    pthread_mutex_lock(&job->lock);
+#endif
+    job->failed = 1;
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&job->lock);
+#endif
+}
+
+static void* parallel_worker(void* arg) {
+    ParallelJob* job = (ParallelJob*)arg;
+    void* parser = xonParserAlloc(malloc);
+    size_t i;
+
+    if (!parser) {
+        parallel_fail(job);
+        return NULL;
+    }
+    while (parallel_take(job, &i)) {
+        ParallelPiece* piece = &job->pieces[i];
+        DataNode* list = NULL;
+
+        // Pieces are written only by the thread that took them.
+        piece->arena = xon_arena_create(piece->len * 4);
+        if (piece->arena) {
+            list = parse_token_stream(parser, piece->start, piece->len, piece->arena, NULL, piece->line, piece->flags);
+        }
+        if (!list) {
+            parallel_fail(job);
+            continue;
+        }
+        piece->first = list->data.aggregate.value;
+        piece->last = piece->first;
+        while (piece->last && piece->last->next) piece->last = piece->last->next;
+        piece->literal = (list->flags & XON_NODE_LITERAL) != 0;
+    }
+    xonParserFree(parser, free);
+    return NULL;
+}
+
+static int online_cpus(void) {
+    long online = 1;
+#if !defined(_WIN32) && defined(_SC_NPROCESSORS_ONLN)
+    online = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return online > 1 ? (int)online : 1;
+}
+
+static int parallel_thread_count(void) {
+    return g_parse_threads > 0 ? g_parse_threads : online_cpus();
+}
+
+static int count_lines(const char* p, const char* end) {
+    int lines = 0;
+    while ((p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        lines++;
+        p++;
+    }
+    return lines;
+}
+
+// Returns the root list in a fresh arena, or NULL to parse serially.
+static DataNode* parallel_parse(const char* data, size_t len, XonArena** arena_out) {
+    ParallelJob job;
+    ParallelPiece* pieces;
+    size_t* splits;
+    size_t count = 0;
+    size_t wanted;
+    size_t i;
+    int threads = parallel_thread_count();
+    int line = 1;
+    const char* counted = data;
+    XonArena* arena = NULL;
+    DataNode* root = NULL;
+    DataNode* tail = NULL;
+    int literal = 1;
+#if !defined(_WIN32)
+    pthread_t* workers;
+    int started = 0;
+#endif
+
+    *arena_out = NULL;
+    if (threads < 2 || len < PARALLEL_MIN_BYTES) return NULL;
+    wanted = (size_t)threads * PARALLEL_PIECES_PER_THREAD;
+    if (wanted > len / PARALLEL_MIN_PIECE) wanted = len / PARALLEL_MIN_PIECE;
+    if (wanted < 2) return NULL;
+
+    splits = (size_t*)malloc(wanted * sizeof(size_t));
+    pieces = (ParallelPiece*)calloc(wanted, sizeof(ParallelPiece));
+    if (!splits || !pieces || !xon_structural_split(data, len, wanted, splits, &count) || count == 0) {
+        free(splits);
+        free(pieces);
+        return NULL;
+    }
+
+    // Piece k runs from the comma before it to the comma after it; the first
+    // keeps the opening bracket and the last the closing one.
+    for (i = 0; i <= count; i++) {
+        size_t start = i == 0 ? 0 : splits[i - 1] + 1;
+        size_t end = i == count ? len : splits[i];
+        line += count_lines(counted, data + start);
+        counted = data + start;
+        pieces[i].start = data + start;
+        pieces[i].len = end - start;
+        pieces[i].line = line;
+        pieces[i].flags = PARSE_QUIET | (i > 0 ? PARSE_WRAP_OPEN : 0) | (i < count ? PARSE_WRAP_CLOSE : 0);
+    }
+    free(splits);
+
+    memset(&job, 0, sizeof(job));
+    job.pieces = pieces;
+    job.count = count + 1;
+#if !defined(_WIN32)
+    pthread_mutex_init(&job.lock, NULL);
+    workers = (pthread_t*)malloc((size_t)(threads - 1) * sizeof(pthread_t));
+    // The calling thread works too; if threads cannot be started it parses
+    // every piece itself.
+    while (workers && started < threads - 1 && pthread_create(&workers[started], NULL, parallel_worker, &job) == 0) {
+        started++;
+    }
+    parallel_worker(&job);
+    while (started > 0) pthread_join(workers[--started], NULL);
+    free(workers);
+    pthread_mutex_destroy(&job.lock);
+#else
+    parallel_worker(&job);
+#endif
+
+    if (!job.failed) arena = xon_arena_create(0);
+    if (arena) root = new_node_in(arena, TYPE_LIST);
+    for (i = 0; i < job.count; i++) {
+        ParallelPiece* piece = &pieces[i];
+        if (root && piece->first) {
+            if (tail) {
+                tail->next = piece->first;
+            } else {
+                root->data.aggregate.value = piece->first;
+            }
+            tail = piece->last;
+        }
+        literal &= piece->literal;
+        if (root) {
+            xon_arena_adopt(arena, piece->arena);
+        } else {
+            xon_arena_destroy(piece->arena);
+        }
+    }
+    free(pieces);
+
+    if (!root) {
+        xon_arena_destroy(arena);
+        return NULL;
+    }
+    if (literal) root->flags |= XON_NODE_LITERAL;
+    child_index_attach(arena, root);
+    *arena_out = arena;
+    return root;
+}
+
+// Moves root into the shell that lets xon_free() find its arena.
+static DataNode* arena_document(XonArena* arena, DataNode* root) {
+    ArenaDocument* doc = (ArenaDocument*)xon_arena_alloc(arena, sizeof(ArenaDocument));
+    if (!doc) {
+        xon_log_error("parser", "Out of memory while finishing arena document");
+        xon_arena_destroy(arena);
+        return NULL;
+    }
+    doc->arena = arena;
+    doc->root = *root;
+    doc->root.flags |= XON_NODE_ARENA_ROOT;
+    return &doc->root;
+}
+
+// json: try the JSON parser first (see json_applies()).
+static DataNode* parse_buffer(const char* data, size_t len, int json) {
+    void* parser;
+    DataNode* root;
+    XonArena* arena = NULL;
+
+    // Parse trees take roughly 4x the source size; start the arena there.
+    if (json) {
+        arena = xon_arena_create(len * 4);
+        if (!arena) return NULL;
+        root = json_build(data, len, arena);
+        if (root) {
+            xon_log_info("parser", "Parsing completed successfully (json: %zu bytes)", xon_arena_reserved(arena));
+            return arena_document(arena, root);
+        }
+        xon_arena_destroy(arena);
+        arena = NULL;
+    }
+    root = parallel_parse(data, len, &arena);
+    if (root) {
+        xon_log_info("parser", "Parsing completed successfully (parallel: %zu bytes)", xon_arena_reserved(arena));
+        return arena_document(arena, root);
+    }
+    if (g_use_tape || g_use_arena) {
+        arena = xon_arena_create(len * 4);
+        if (!arena) return NULL;
+    }
+    if (g_use_tape) {
+        root = tape_parse(data, len, arena);
+        if (root) {
+            xon_log_info("parser", "Parsing completed successfully (tape: %zu bytes)", xon_arena_reserved(arena));
+            return arena_document(arena, root);
+        }
+        if (g_use_arena) {
+            xon_arena_reset(arena);
+        } else {
+            xon_arena_destroy(arena);
+            arena = NULL;
+        }
+    }
+    parser = xonParserAlloc(malloc);
+    if (!parser) {
+        xon_arena_destroy(arena);
+        return NULL;
+    }
+    root = parse_tokens(parser, data, len, arena, NULL, 1);
+    xonParserFree(parser, free);
+
+    if (!root) {
+        xon_arena_destroy(arena);
+        return NULL;
+    }
+    if (arena) {
+        xon_log_info("parser", "Parsing completed successfully (arena: %zu bytes)", xon_arena_reserved(arena));
+        return arena_document(arena, root);
+    }
+    xon_log_info("parser", "Parsing completed successfully");
+    return root;
+}
+
+static int sb_init(StringBuilder* sb) {
+    sb->cap = 256;
+    sb->len = 0;
+    sb->data = (char*)malloc(sb->cap);
+    if (!sb->data) return 0;
+    sb->data[0] = '\0';
+    return 1;
+}
+
+static int sb_reserve(StringBuilder* sb, size_t add_len) {
+    size_t required = sb->len + add_len + 1;
+    if (required <= sb->cap) return 1;
+
+    while (sb->cap < required) {
+        sb->cap *= 2;
+    }
+    sb->data = (char*)realloc(sb->data, sb->cap);
+    return sb->data != NULL;
+}
+
+static int sb_append_char(StringBuilder* sb, char c) {
+    if (!sb_reserve(sb, 1)) return 0;
+    sb->data[sb->len++] = c;
+    sb->data[sb->len] = '\0';
+    return 1;
+}
+
+static int sb_append_len(StringBuilder* sb, const char* str, size_t len) {
+    if (!str) return 1;
+    if (!sb_reserve(sb, len)) return 0;
+    memcpy(sb->data + sb->len, str, len);
+    sb->len += len;
+    sb->data[sb->len] = '\0';
+    return 1;
+}
+
+static int sb_append_str(StringBuilder* sb, const char* str) {
+    return str ? sb_append_len(sb, str, strlen(str)) : 1;
+}
+
+static int sb_append_indent(StringBuilder* sb, int depth) {
+    int i;
+    for (i = 0; i < depth; i++) {
+        if (!sb_append_str(sb, "    ")) return 0;
+    }
+    return 1;
+}
+
+// Runs of bytes that need no escaping are copied with one memcpy each.
+static int sb_append_escaped_string(StringBuilder* sb, const char* str, size_t len) {
+    const unsigned char* p = (const unsigned char*)str;
+    const unsigned char* end = p + len;
+    if (!sb_reserve(sb, len + 2)) return 0;
+    if (!sb_append_char(sb, '"')) return 0;
+    while (p < end) {
+        const unsigned char* run = p;
+        while (p < end && *p >= 0x20 && *p != '"' && *p != '\\') p++;
+        if (p > run && !sb_append_len(sb, (const char*)run, (size_t)(p - run))) return 0;
+        if (p >= end) break;
+        switch (*p) {
+            case '\\': if (!sb_append_str(sb, "\\\\")) return 0; break;
+            case '"': if (!sb_append_str(sb, "\\\"")) return 0; break;
+            case '\n': if (!sb_append_str(sb, "\\n")) return 0; break;
+            case '\r': if (!sb_append_str(sb, "\\r")) return 0; break;
+            case '\t': if (!sb_append_str(sb, "\\t")) return 0; break;
+            default: {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", *p);
+                if (!sb_append_str(sb, escaped)) return 0;
+                break;
+            }
+        }
+        p++;
+    }
+    return sb_append_char(sb, '"');
+}
+
+static int is_identifier_key(const char* key, size_t len) {
+    size_t i;
+    if (!key || len == 0) return 0;
+    if (!(isalpha((unsigned char)key[0]) || key[0] == '_')) return 0;
+    for (i = 1; i < len; i++) {
+        if (!(isalnum((unsigned char)key[i]) || key[i] == '_')) return 0;
+    }
+    return 1;
+}
+
+// Same text as "%.17g", but whole numbers, which is most numbers in data,
+// are written without going through snprintf(). Returns the length.
+static size_t format_number(char* buf, size_t size, double value) {
+    if (value > -1e17 && value < 1e17 && value == (double)(long long)value && !(value == 0 && signbit(value))) {
+        char digits[24];
+        unsigned long long n = (unsigned long long)(value < 0 ? -value : value);
+        size_t count = 0;
+        size_t len = 0;
+
+        do {
+            digits[count++] = (char)('0' + n % 10);
+            n /= 10;
+        } while (n > 0);
+        if (value < 0) buf[len++] = '-';
+        while (count > 0) buf[len++] = digits[--count];
+        buf[len] = '\0';
+        return len;
+    }
+    return (size_t)snprintf(buf, size, "%.17g", value);
+}
+
+static int serialize_value(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json);
+static int serialize_expr(const XonExpr* expr, StringBuilder* sb, int pretty, int depth, int as_json);
+static int serialize_params(const DataNode* params, StringBuilder* sb) {
+    const DataNode* current = params ? params->data.aggregate.value : NULL;
+    if (!sb_append_char(sb, '(')) return 0;
+    while (current) {
+        if (current->type == TYPE_STRING) {
+            if (!sb_append_len(sb, current->data.str.s_val, current->data.str.s_len)) return 0;
+        }
+            if (current->next && !sb_append_str(sb, ", ")) return 0;
+            current = current->next;
+    }
+    return sb_append_char(sb, ')');
+}
+
+static int serialize_expr(const XonExpr* expr, StringBuilder* sb, int pretty, int depth, int as_json) {
+    (void)pretty;
+    (void)depth;
+    if (!expr) return 0;
+
+    switch (expr->kind) {
+        case XON_EXPR_IDENTIFIER:
+            return sb_append_str(sb, expr->u.identifier_name ? expr->u.identifier_name : "");
+        case XON_EXPR_BINARY: {
+            const char* op = "";
+            switch (expr->u.binary.op) {
+                case XON_EXPR_OP_OR: op = "||"; break;
+                case XON_EXPR_OP_AND: op = "&&"; break;
+                case XON_EXPR_OP_EQ: op = "=="; break;
+                case XON_EXPR_OP_NEQ: op = "!="; break;
+                case XON_EXPR_OP_LT: op = "<"; break;
+                case XON_EXPR_OP_LTE: op = "<="; break;
+                case XON_EXPR_OP_GT: op = ">"; break;
+                case XON_EXPR_OP_GTE: op = ">="; break;
+                case XON_EXPR_OP_ADD: op = "+"; break;
+                case XON_EXPR_OP_SUB: op = "-"; break;
+                case XON_EXPR_OP_MUL: op = "*"; break;
+                case XON_EXPR_OP_DIV: op = "/"; break;
+                case XON_EXPR_OP_MOD: op = "%"; break;
+                case XON_EXPR_OP_NULLISH: op = "??"; break;
+                default: op = "?"; break;
+            }
+            if (!serialize_value(expr->u.binary.left, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_char(sb, ' ')) return 0;
+            if (!sb_append_str(sb, op)) return 0;
+            if (!sb_append_char(sb, ' ')) return 0;
+            return serialize_value(expr->u.binary.right, sb, pretty, depth, as_json);
+        }
+        case XON_EXPR_UNARY: {
+            const char* op = expr->u.unary.op == XON_EXPR_OP_NOT ? "!" : (expr->u.unary.op == XON_EXPR_OP_NEG ? "-" : "+");
+            if (!sb_append_str(sb, op)) return 0;
+            return serialize_value(expr->u.unary.operand, sb, pretty, depth, as_json);
+        }
+        case XON_EXPR_MEMBER:
+            if (!serialize_value(expr->u.member.object, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_char(sb, '.')) return 0;
+            return sb_append_str(sb, expr->u.member.member ? expr->u.member.member : "");
+        case XON_EXPR_TERNARY:
+            if (!serialize_value(expr->u.ternary.cond, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_str(sb, " ? ")) return 0;
+            if (!serialize_value(expr->u.ternary.then_expr, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_str(sb, " : ")) return 0;
+            return serialize_value(expr->u.ternary.else_expr, sb, pretty, depth, as_json);
+        case XON_EXPR_IF:
+            if (!sb_append_str(sb, "if (")) return 0;
+            if (!serialize_value(expr->u.ternary.cond, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_str(sb, ") ")) return 0;
+            if (!serialize_value(expr->u.ternary.then_expr, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_str(sb, " else ")) return 0;
+            return serialize_value(expr->u.ternary.else_expr, sb, pretty, depth, as_json);
+        case XON_EXPR_CALL:
+            if (!serialize_value(expr->u.call.callee, sb, pretty, depth, as_json)) return 0;
+            if (!sb_append_char(sb, '(')) return 0;
+            if (expr->u.call.args) {
+                const DataNode* arg = expr->u.call.args;
+                while (arg) {
+                    if (!serialize_value(arg, sb, pretty, depth, as_json)) return 0;
+                    arg = arg->next;
+                    if (arg && !sb_append_str(sb, ", ")) return 0;
+                }
+            }
+            return sb_append_char(sb, ')');
+        case XON_EXPR_FUNCTION:
+            if (!serialize_params(expr->u.function.params, sb)) return 0;
+            if (!sb_append_str(sb, " => ")) return 0;
+            return serialize_value(expr->u.function.body, sb, pretty, depth, as_json);
+        default:
+            return sb_append_str(sb, "<expr>");
+    }
+}
+
+static int serialize_object(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
+    const DataNode* pair = node->data.aggregate.value;
+    if (!sb_append_char(sb, '{')) return 0;
+
+    if (pair) {
+        if (pretty && !sb_append_char(sb, '\n')) return 0;
+        while (pair) {
+            if (pair->type == TYPE_DECL) {
                 if (as_json) {
                     pair = pair->next;
                     continue;
                 }
 
-                if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
-                if (!sb_append_str(sb, pair->data.declaration.is_const ? "const " : "let ")) return 0;
-                if (!sb_append_str(sb, pair->data.declaration.name ? pair->data.declaration.name : "")) return 0;
-                if (!sb_append_str(sb, " = ")) return 0;
-                if (!serialize_value(pair->data.declaration.init_expr, sb, pretty, depth + 1, as_json)) return 0;
-            } else if (pair->type == TYPE_OBJECT) {
-                const char* key = NULL;
+                if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
+                if (!sb_append_str(sb, pair->data.declaration.is_const ? "const " : "let ")) return 0;
+                if (!sb_append_str(sb, pair->data.declaration.name ? pair->data.declaration.name : "")) return 0;
+                if (!sb_append_str(sb, " = ")) return 0;
+                if (!serialize_value(pair->data.declaration.init_expr, sb, pretty, depth + 1, as_json)) return 0;
+            } else if (pair->type == TYPE_OBJECT) {
+                const char* key = NULL;
+                size_t key_len = 0;
+
+                if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
+
+                if (pair->data.aggregate.key && pair->data.aggregate.key->type == TYPE_STRING) {
+                    key = pair->data.aggregate.key->data.str.s_val;
+                    key_len = pair->data.aggregate.key->data.str.s_len;
+                }
+                if (!key) key = "";
+
+                if (as_json || !is_identifier_key(key, key_len)) {
+                    if (!sb_append_escaped_string(sb, key, key_len)) return 0;
+                } else {
+                    if (!sb_append_len(sb, key, key_len)) return 0;
+                }
+
+                if (!sb_append_str(sb, pretty ? ": " : ":")) return 0;
+                if (!serialize_value(pair->data.aggregate.value, sb, pretty, depth + 1, as_json)) return 0;
+
+            } else {
+                pair = pair->next;
+                continue;
+            }
+
+            if (pair->next && !sb_append_char(sb, ',')) return 0;
+            if (pretty && !sb_append_char(sb, '\n')) return 0;
+            pair = pair->next;
+        }
+        if (pretty && !sb_append_indent(sb, depth)) return 0;
+    }
+
+    return sb_append_char(sb, '}');
+}
+
+static int serialize_list(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
+    const DataNode* item = node->data.aggregate.value;
+    if (!sb_append_char(sb, '[')) return 0;
+
+    if (item) {
+        if (pretty && !sb_append_char(sb, '\n')) return 0;
+        while (item) {
+            if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
+            if (!serialize_value(item, sb, pretty, depth + 1, as_json)) return 0;
+            if (item->next && !sb_append_char(sb, ',')) return 0;
+            if (pretty && !sb_append_char(sb, '\n')) return 0;
+            item = item->next;
+        }
+        if (pretty && !sb_append_indent(sb, depth)) return 0;
+    }
+
+    return sb_append_char(sb, ']');
+}
+
+static int serialize_value(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
+    char numbuf[64];
+    if (!node) return sb_append_str(sb, "null");
+
+    switch (node->type) {
+        case TYPE_OBJECT:
+            return serialize_object(node, sb, pretty, depth, as_json);
+        case TYPE_LIST:
+            return serialize_list(node, sb, pretty, depth, as_json);
+        case TYPE_EXPR:
+            if (as_json) return sb_append_str(sb, "null");
+            return serialize_expr(node->data.expr, sb, pretty, depth, as_json);
+        case TYPE_FUNCTION:
+            if (as_json) return sb_append_str(sb, "null");
+            return sb_append_str(sb, "<function>");
+        case TYPE_DECL:
+            if (as_json) return sb_append_str(sb, "null");
+            if (node->data.declaration.is_const) {
+                if (!sb_append_str(sb, "const ")) return 0;
+            } else {
+                if (!sb_append_str(sb, "let ")) return 0;
+            }
+            if (!sb_append_str(sb, node->data.declaration.name ? node->data.declaration.name : "")) return 0;
+            if (!sb_append_str(sb, " = ")) return 0;
+            return serialize_value(node->data.declaration.init_expr, sb, pretty, depth, as_json);
+        case TYPE_STRING:
+            return sb_append_escaped_string(sb, node->data.str.s_val ? node->data.str.s_val : "", node->data.str.s_len);
+        case TYPE_NUMBER:
+            return sb_append_len(sb, numbuf, format_number(numbuf, sizeof(numbuf), node->data.n_val));
+        case TYPE_BOOL:
+            return sb_append_str(sb, node->data.b_val ? "true" : "false");
+        case TYPE_NULL:
+            return sb_append_str(sb, "null");
+    }
+    return 0;
+}
+
+static DataNode* object_pair_at(const XonValue* obj, size_t index) {
+    if (!obj || obj->type != TYPE_OBJECT) return NULL;
+    return container_item_at(obj, index);
+}
+
+XonValue* xonify(const char* filename) {
+    XonInput input;
+    DataNode* root;
+
+    if (!filename) return NULL;
+    xon_logger_init("xon");
+    xon_log_info("api", "Parsing file: %s", filename);
+    if (!xon_input_open(&input, filename)) {
+        xon_log_error("api", "Failed to open file: %s", filename);
+        return NULL;
+    }
+
+    root = parse_buffer(input.data, input.len, json_applies(filename));
+    xon_input_close(&input);
+    return root;
+}
+
+XonValue* xonify_string(const char* str) {
+    if (!str) return NULL;
+    return xonify_buffer(str, strlen(str));
+}
+
+XonValue* xonify_buffer(const char* data, size_t len) {
+    if (!data && len > 0) return NULL;
+
+    xon_logger_init("xon");
+    xon_log_info("api", "Parsing input buffer (%zu bytes)", len);
+    return parse_buffer(data ? data : "", len, json_applies(NULL));
+}
+
+void xon_free(XonValue* value) {
+    free_xon_ast(value);
+}
+
+XonParser* xon_parser_new(void) {
+    XonParser* ctx = (XonParser*)calloc(1, sizeof(XonParser));
+    if (!ctx) return NULL;
+
+    xon_logger_init("xon");
+    ctx->lemon = xonParserAlloc(malloc);
+    ctx->arena = xon_arena_create(0);
+    ctx->intern = xon_intern_create();
+    if (!ctx->lemon || !ctx->arena || !ctx->intern) {
+        xon_log_error("api", "Out of memory creating parser context");
+        xon_parser_free(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+XonValue* xon_parser_parse(XonParser* ctx, const char* data, size_t len) {
+    DataNode* root;
+    if (!ctx || (!data && len > 0)) return NULL;
+
+    root = parse_tokens(ctx->lemon, data ? data : "", len, ctx->arena, ctx->intern, 1);
+    if (!root) {
+        // Start the next document from a freshly initialized parser.
+        xonParserFinalize(ctx->lemon);
+        xonParserInit(ctx->lemon);
+    }
+    return root;
+}
+
+void xon_parser_reset(XonParser* ctx) {
+    if (ctx) xon_arena_reset(ctx->arena);
+}
+
+void xon_parser_free(XonParser* ctx) {
+    if (!ctx) return;
+    if (ctx->lemon) xonParserFree(ctx->lemon, free);
+    xon_arena_destroy(ctx->arena);
+    xon_intern_destroy(ctx->intern);
+    free(ctx);
+}
+
+// ============ Push parsing ============
+
+// Input arrives in chunks of any size. Complete tokens go straight to the
+// Lemon parser. A token that runs to the end of the input seen so far may
+// continue in the next chunk (a string, comment, number or identifier cut in
+// two), so lexing stops before it and its bytes are kept; they are lexed
+// again from the start once more input is there. Only that tail is buffered,
+// never the document. A tail that is still incomplete is not retried until it
+// has doubled, so a value spread over many chunks is rescanned O(1) times per
+// byte.
+
+struct XonStream {
+    void* lemon;
+    ParserState state;
+    DataNode* root;
+    XonArena* arena; // document arena; NULL when nodes go on the heap
+    XonArena* spans; // identifier text, which would otherwise point into chunks
+    char* pending;   // input not lexed yet
+    size_t pending_len;
+    size_t pending_cap;
+    size_t retry_len; // lex again once pending_len reaches this
+    int line;         // line number at pending[0]
+    int failed;
+};
+
+static int stream_append(XonStream* stream, const char* chunk, size_t len) {
+    if (stream->pending_len + len > stream->pending_cap) {
+        size_t cap = stream->pending_cap ? stream->pending_cap * 2 : 4096;
+        char* grown;
+        while (cap < stream->pending_len + len) cap *= 2;
+        grown = (char*)realloc(stream->pending, cap);
+        if (!grown) return 0;
+        stream->pending = grown;
+        stream->pending_cap = cap;
+    }
+    memcpy(stream->pending + stream->pending_len, chunk, len);
+    stream->pending_len += len;
+    return 1;
+}
+
+// Feeds every complete token in pending to the parser. Unless final, the last
+// token (or trailing whitespace and comments) is left in pending.
+static void stream_lex(XonStream* stream, int final) {
+    XonLexer lexer;
+    size_t kept;
+
+    xon_lexer_init(&lexer, stream->pending, stream->pending_len);
+    lexer.line = stream->line;
+    lexer.arena = stream->arena;
+
+    while (!stream->failed) {
+        const char* before = lexer.cursor;
+        int before_line = lexer.line;
+        XonTokenData token_data;
+        Token parser_token;
+        char* err_msg = NULL;
+        int token_id = xon_lexer_next(&lexer, &token_data, &err_msg);
+
+        if (!final && (token_id == 0 || lexer.cursor == lexer.end)) {
+            if (token_id > 0 && !stream->arena) free(token_data.sVal);
+            free(err_msg);
+            lexer.cursor = before;
+            lexer.line = before_line;
+            break;
+        }
+        if (token_id == 0) break;
+        if (token_id == -1) {
+            report_lexer_error(lexer.line, err_msg);
+            stream->failed = 1;
+            break;
+        }
+        if (token_id == IDENTIFIER) {
+            char* copy = (char*)xon_arena_alloc(stream->spans, token_data.sLen);
+            if (!copy) {
+                xon_log_error("parser", "Out of memory while streaming");
+                stream->failed = 1;
+                break;
+            }
+            memcpy(copy, token_data.span, token_data.sLen);
+            token_data.span = copy;
+        }
+
+        memset(&parser_token, 0, sizeof(parser_token));
+        parser_token.s_val = token_data.sVal;
+        parser_token.span = token_data.span;
+        parser_token.s_len = token_data.sLen;
+        parser_token.n_val = token_data.nVal;
+        parser_token.line = lexer.line;
+        xonParser(stream->lemon, token_id, parser_token, &stream->state);
+        if (stream->state.had_error) stream->failed = 1;
+    }
+
+    kept = (size_t)(lexer.end - lexer.cursor);
+    if (kept > 0) memmove(stream->pending, lexer.cursor, kept);
+    stream->pending_len = kept;
+    stream->retry_len = kept * 2;
+    stream->line = lexer.line;
+}
+
+XonStream* xon_stream_new(void) {
+    XonStream* stream = (XonStream*)calloc(1, sizeof(XonStream));
+    if (!stream) return NULL;
+
+    xon_logger_init("xon");
+    stream->lemon = xonParserAlloc(malloc);
+    stream->spans = xon_arena_create(0);
+    if (g_use_arena) stream->arena = xon_arena_create(0);
+    if (!stream->lemon || !stream->spans || (g_use_arena && !stream->arena)) {
+        xon_log_error("api", "Out of memory creating stream parser");
+        xon_stream_free(stream);
+        return NULL;
+    }
+    parse_begin(&stream->state, &stream->root, stream->arena, NULL);
+    stream->line = 1;
+    return stream;
+}
+
+int xon_stream_feed(XonStream* stream, const char* chunk, size_t len) {
+    if (!stream || (!chunk && len > 0) || stream->failed) return 0;
+    if (!stream_append(stream, chunk, len)) {
+        xon_log_error("parser", "Out of memory while streaming");
+        stream->failed = 1;
+        return 0;
+    }
+    if (stream->pending_len >= stream->retry_len) stream_lex(stream, 0);
+    return !stream->failed;
+}
+
+XonValue* xon_stream_finish(XonStream* stream) {
+    DataNode* root = NULL;
+
+    if (!stream) return NULL;
+    if (!stream->failed) {
+        Token end_token;
+        stream_lex(stream, 1);
+        memset(&end_token, 0, sizeof(end_token));
+        end_token.line = stream->line;
+        if (!stream->failed) xonParser(stream->lemon, 0, end_token, &stream->state);
+    }
+
+    if (!stream->failed && !stream->state.had_error && stream->root) {
+        root = stream->root;
+        stream->root = NULL;
+        if (stream->arena) {
+            root = arena_document(stream->arena, root);
+            stream->arena = NULL;
+        }
+        xon_log_info("parser", "Parsing completed successfully (stream)");
+    } else {
+        xon_log_error("parser", "Parsing failed due to syntax errors");
+    }
+    xon_stream_free(stream);
+    return root;
+}
+
+void xon_stream_free(XonStream* stream) {
+    if (!stream) return;
+    if (stream->lemon) xonParserFree(stream->lemon, free);
+    if (stream->root && !stream->arena) free_xon_ast(stream->root);
+    xon_arena_destroy(stream->arena);
+    xon_arena_destroy(stream->spans);
+    free(stream->pending);
+    free(stream);
+}
+
+// ============ Record streams ============
+
+// A stream of independent documents (XON lines, NDJSON) is cut into records
+// on the calling thread. Records are parsed, and evaluated if asked, by a pool
+// of workers, and handed back in input order through a ring of window slots.
+// The reader blocks when the ring is full, so memory is bounded by the window
+// and the largest record. Workers parse quietly: a failed record is parsed
+// again on the calling thread when its turn comes, so diagnostics come out in
+// input order too.
+
+#define RECORD_READ_SIZE (64 * 1024)
+#define RECORD_WINDOW_PER_THREAD 4
+
+enum { SLOT_FREE, SLOT_QUEUED, SLOT_DONE };
+
+typedef struct {
+    char* data;
+    size_t len;
+    int line; // line of the record's first byte in the stream
+    int state;
+    XonArena* arena;     // holds value; kept and reset between records
+    XonValue* value;     // parse tree
+    XonValue* evaluated; // xon_eval() result, when evaluating
+    EvalError eval_error;
+} RecordSlot;
+
+typedef struct {
+    RecordSlot* slots;
+    size_t window;
+    size_t head;      // next record to deliver
+    size_t next_work; // next record for a worker
+    size_t tail;      // next record to read
+    int evaluate;
+    int stop;
+    int workers;
+    void* lemon; // parser for records handled on the calling thread
+#if !defined(_WIN32)
+    pthread_mutex_t lock;
+    pthread_cond_t queued;
+    pthread_cond_t done;
+#endif
+} RecordJob;
+
+static void records_lock(RecordJob* job) {
+#if !defined(_WIN32)
+    pthread_mutex_lock(&job->lock);
+#else
+    (void)job;
+#endif
+}
+
+static void records_unlock(RecordJob* job) {
+#if !defined(_WIN32)
+    pthread_mutex_unlock(&job->lock);
+#else
+    (void)job;
+#endif
+}
+
+// Parses (and evaluates) one record with parser, without reporting errors.
+// The tree goes into the slot's arena, so xon_free() on it is a no-op.
+static void record_process(RecordSlot* slot, void* parser, int evaluate) {
+    DataNode* root = NULL;
+
+    if (!slot->arena) slot->arena = xon_arena_create(slot->len * 4);
+    if (!slot->arena) return;
+    if (g_use_tape) {
+        root = tape_parse(slot->data, slot->len, slot->arena);
+        if (!root) xon_arena_reset(slot->arena);
+    }
+    if (!root) {
+        root = parse_token_stream(parser, slot->data, slot->len, slot->arena, NULL, slot->line, PARSE_QUIET);
+        if (!root) {
+            xonParserFinalize(parser);
+            xonParserInit(parser);
+        }
+    }
+    slot->value = root;
+    if (root && evaluate) slot->evaluated = eval_document(root, &slot->eval_error);
+}
+
+#if !defined(_WIN32)
+static void* record_worker(void* arg) {
+    RecordJob* job = (RecordJob*)arg;
+    void* parser = xonParserAlloc(malloc);
+
+    // The calling thread picks up the records this worker would have taken.
+    if (!parser) return NULL;
+    records_lock(job);
+    for (;;) {
+        RecordSlot* slot;
+        while (!job->stop && job->next_work == job->tail) pthread_cond_wait(&job->queued, &job->lock);
+        if (job->stop) break;
+        slot = &job->slots[job->next_work++ % job->window];
+        records_unlock(job);
+
+        record_process(slot, parser, job->evaluate);
+
+        records_lock(job);
+        slot->state = SLOT_DONE;
+        pthread_cond_broadcast(&job->done);
+    }
+    records_unlock(job);
+    xonParserFree(parser, free);
+    return NULL;
+}
+#endif
+
+// Waits for the head record, reports it and passes it to the callback.
+// Returns the callback's result, or 1 if the record failed (*failed is set).
+static int record_deliver(RecordJob* job, XonRecordCallback callback, void* user_data, int* failed) {
+    RecordSlot* slot = &job->slots[job->head % job->window];
+    const XonValue* result;
+    int keep_going = 1;
+
+    records_lock(job);
+    // Rather than wait for a worker to start on it, parse it here.
+    if (job->next_work == job->head) {
+        job->next_work++;
+        records_unlock(job);
+        record_process(slot, job->lemon, job->evaluate);
+        records_lock(job);
+        slot->state = SLOT_DONE;
+    }
+#if !defined(_WIN32)
+    while (slot->state != SLOT_DONE) pthread_cond_wait(&job->done, &job->lock);
+#endif
+    records_unlock(job);
+
+    if (!slot->value && slot->arena) {
+        // Parse again, loudly, for the diagnostics.
+        xon_arena_reset(slot->arena);
+        if (!parse_tokens(job->lemon, slot->data, slot->len, slot->arena, NULL, slot->line)) {
+            xonParserFinalize(job->lemon);
+            xonParserInit(job->lemon);
+        }
+    } else if (job->evaluate && !slot->evaluated && slot->eval_error.active) {
+        fprintf(stderr, "Xon Eval Error: %s\n", slot->eval_error.message);
+        xon_log_error("eval", "Record at line %d: evaluation failed: %s", slot->line, slot->eval_error.message);
+    }
+
+    result = job->evaluate ? slot->evaluated : slot->value;
+    if (!result) *failed = 1;
+    if (callback) keep_going = callback(user_data, job->head, result);
+
+    xon_free(slot->evaluated);
+    xon_arena_reset(slot->arena);
+    free(slot->data);
+    slot->data = NULL;
+    slot->value = NULL;
+    slot->evaluated = NULL;
+    memset(&slot->eval_error, 0, sizeof(slot->eval_error));
+    slot->state = SLOT_FREE;
+    records_lock(job);
+    job->head++;
+    records_unlock(job);
+    return keep_going;
+}
+
+typedef struct {
+    int one_per_line;
+    int depth;
+    int in_string;
+    int escaped;
+    int comment; // 0 none, 1 line, 2 block
+    int started; // inside a record
+} RecordScanner;
+
+// Scans buf[*pos, len) for the end of the record that started at or after
+// *pos. Returns 1 with *pos just past it, or 0 with *pos == len when more
+// input is needed. Lines are counted into *line as bytes are consumed.
+static int record_scan(RecordScanner* sc, const char* buf, size_t len, size_t* pos, int* line) {
+    size_t i = *pos;
+
+    while (i < len) {
+        char c = buf[i++];
+        if (c == '\n') (*line)++;
+        if (sc->one_per_line) {
+            if (c == '\n') {
+                *pos = i;
+                return 1;
+            }
+            continue;
+        }
+        if (sc->comment == 1) {
+            if (c == '\n') sc->comment = 0;
+        } else if (sc->comment == 2) {
+            if (c == '*' && i < len && buf[i] == '/') {
+                sc->comment = 0;
+                i++;
+            } else if (c == '*' && i == len) {
+                // The '/' may be in the next read.
+                i--;
+                break;
+            }
+        } else if (sc->in_string) {
+            if (sc->escaped) {
+                sc->escaped = 0;
+            } else if (c == '\\') {
+                sc->escaped = 1;
+            } else if (c == '"') {
+                sc->in_string = 0;
+            }
+        } else if (c == '"') {
+            sc->in_string = 1;
+            sc->started = 1;
+        } else if (c == '#') {
+            sc->comment = 1;
+        } else if (c == '/' && i == len) {
+            i--;
+            break;
+        } else if (c == '/' && (buf[i] == '/' || buf[i] == '*')) {
+            sc->comment = buf[i] == '/' ? 1 : 2;
+            i++;
+        } else if (c == '{' || c == '[') {
+            sc->depth++;
+            sc->started = 1;
+        } else if (c == '}' || c == ']') {
+            sc->depth--;
+            if (sc->depth <= 0 && sc->started) {
+                sc->depth = 0;
+                sc->started = 0;
+                *pos = i;
+                return 1;
+            }
+        } else if (sc->depth == 0 && c == '\n' && sc->started) {
+            // Not a container: the record is the rest of the line.
+            sc->started = 0;
+            *pos = i;
+            return 1;
+        } else if (!isspace((unsigned char)c)) {
+            sc->started = 1;
+        }
+    }
+    *pos = i;
+    return 0;
+}
+
+// Queues data[0, len) as the next record unless it is blank. While the window
+// is full, delivers the oldest record first. Returns 0 if the callback stopped.
+static int record_submit(RecordJob* job, const char* data, size_t len, int line, XonRecordCallback callback,
+                         void* user_data, int* failed) {
+    RecordSlot* slot;
+    size_t i;
+
+    for (i = 0; i < len && isspace((unsigned char)data[i]); i++) {
+        if (data[i] == '\n') line++;
+    }
+    if (i == len) return 1;
+
+    while (job->tail - job->head == job->window) {
+        if (!record_deliver(job, callback, user_data, failed)) return 0;
+    }
+    slot = &job->slots[job->tail % job->window];
+    slot->data = (char*)malloc(len - i);
+    if (!slot->data) {
+        xon_log_error("parser", "Out of memory while reading records");
+        *failed = 1;
+        return 1;
+    }
+    memcpy(slot->data, data + i, len - i);
+    slot->len = len - i;
+    slot->line = line;
+    records_lock(job);
+    slot->state = SLOT_QUEUED;
+    job->tail++;
+#if !defined(_WIN32)
+    pthread_cond_signal(&job->queued);
+#endif
+    records_unlock(job);
+    return 1;
+}
+
+int xon_records_parse(FILE* in, const XonRecordOptions* options, XonRecordCallback callback, void* user_data) {
+    XonRecordOptions defaults;
+    RecordJob job;
+    RecordScanner scanner;
+    char* buf = NULL;
+    size_t cap = 0;
+    size_t len = 0;
+    size_t start = 0; // first byte of the current record
+    size_t pos = 0;   // scan position
+    size_t got;
+    int line = 1;
+    int record_line = 1;
+    int failed = 0;
+    int stopped = 0;
+    int threads;
+    int at_eof = 0;
+    size_t i;
+#if !defined(_WIN32)
+    pthread_t* workers = NULL;
+#endif
+
+    if (!in) return 0;
+    if (!options) {
+        memset(&defaults, 0, sizeof(defaults));
+        options = &defaults;
+    }
+    xon_logger_init("xon");
+    threads = options->threads > 0 ? options->threads : online_cpus();
+
+    memset(&job, 0, sizeof(job));
+    job.window = options->window ? options->window : (size_t)threads * RECORD_WINDOW_PER_THREAD;
+    job.evaluate = options->evaluate;
+    job.slots = (RecordSlot*)calloc(job.window, sizeof(RecordSlot));
+    job.lemon = xonParserAlloc(malloc);
+    if (!job.slots || !job.lemon) {
+        free(job.slots);
+        if (job.lemon) xonParserFree(job.lemon, free);
+        return 0;
+    }
+#if !defined(_WIN32)
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.queued, NULL);
+    pthread_cond_init(&job.done, NULL);
+    // With one thread, records are parsed on the calling thread as they are
+    // delivered.
+    if (threads > 1) workers = (pthread_t*)malloc((size_t)threads * sizeof(pthread_t));
+    while (workers && job.workers < threads &&
+           pthread_create(&workers[job.workers], NULL, record_worker, &job) == 0) {
+        job.workers++;
+    }
+#endif
+
+    memset(&scanner, 0, sizeof(scanner));
+    scanner.one_per_line = options->one_per_line;
+    while (!stopped) {
+        if (record_scan(&scanner, buf, len, &pos, &line)) {
+            if (!record_submit(&job, buf + start, pos - start, record_line, callback, user_data, &failed)) {
+                stopped = 1;
+            }
+            start = pos;
+            record_line = line;
+            continue;
+        }
+        if (at_eof) {
+            // Whatever is left is a last record, unless it is only whitespace
+            // and comments.
+            if ((scanner.one_per_line || scanner.started || scanner.comment == 2) &&
+                !record_submit(&job, buf + start, len - start, record_line, callback, user_data, &failed)) {
+                stopped = 1;
+            }
+            break;
+        }
+
+        // Keep the partial record and read more behind it.
+        if (start > 0) {
+            memmove(buf, buf + start, len - start);
+            len -= start;
+            pos -= start;
+            start = 0;
+        }
+        if (cap - len < RECORD_READ_SIZE) {
+            char* grown = (char*)realloc(buf, cap + RECORD_READ_SIZE + cap / 2);
+            if (!grown) {
+                xon_log_error("parser", "Out of memory while reading records");
+                failed = 1;
+                break;
+            }
+            buf = grown;
+            cap += RECORD_READ_SIZE + cap / 2;
+        }
+        got = fread(buf + len, 1, cap - len, in);
+        len += got;
+        if (got == 0) {
+            if (ferror(in)) {
+                xon_log_error("parser", "Read error while reading records");
+                failed = 1;
+            }
+            at_eof = 1;
+        }
+    }
+
+    while (!stopped && job.head < job.tail) {
+        if (!record_deliver(&job, callback, user_data, &failed)) stopped = 1;
+    }
+
+    records_lock(&job);
+    job.stop = 1;
+#if !defined(_WIN32)
+    pthread_cond_broadcast(&job.queued);
+#endif
+    records_unlock(&job);
+#if !defined(_WIN32)
+    while (job.workers > 0) pthread_join(workers[--job.workers], NULL);
+    free(workers);
+    pthread_cond_destroy(&job.done);
+    pthread_cond_destroy(&job.queued);
+    pthread_mutex_destroy(&job.lock);
+#endif
+    // Records still in the ring after a stop are dropped unread.
+    while (job.head < job.tail) {
+        RecordSlot* slot = &job.slots[job.head++ % job.window];
+        xon_free(slot->evaluated);
+        free(slot->data);
+    }
+    for (i = 0; i < job.window; i++) xon_arena_destroy(job.slots[i].arena);
+    free(job.slots);
+    xonParserFree(job.lemon, free);
+    free(buf);
+
+    if (stopped) return -1;
+    return failed ? 0 : 1;
+}
+
+// ============ Diagnostics ============
+
+// The grammar recovers from errors by dropping the broken member or item up
+// to the next `,`, `}` or `]` (see the error rules in xon.lemon), and lexer
+// errors skip the bad token, so one pass finds every error. The check runs
+// the grammar with no-op actions, like check_tokens(). Positions come from
+// the lexer; lines are counted incrementally since errors arrive in order.
+
+typedef struct {
+    const char* data;
+    const XonLexer* lexer;
+    XonDiagnostic* items;
+    size_t count;
+    size_t cap;
+    const char* counted; // lines are counted up to here
+    int counted_line;
+    int failed;
+} DiagnosticList;
+
+static void diagnostic_add(DiagnosticList* list, const char* at, const char* message) {
+    XonDiagnostic* d;
+    const char* line_start = at;
+
+    if (list->failed) return;
+    if (list->count == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 8;
+        XonDiagnostic* items = (XonDiagnostic*)realloc(list->items, cap * sizeof(XonDiagnostic));
+        if (!items) {
+            list->failed = 1;
+            return;
+        }
+        list->items = items;
+        list->cap = cap;
+    }
+    if (at < list->counted) {
+        list->counted = list->data;
+        list->counted_line = 1;
+    }
+    while ((list->counted = memchr(list->counted, '\n', (size_t)(at - list->counted))) != NULL) {
+        list->counted++;
+        list->counted_line++;
+    }
+    list->counted = at;
+    while (line_start > list->data && line_start[-1] != '\n') line_start--;
+
+    d = &list->items[list->count];
+    d->line = list->counted_line;
+    d->column = (int)(at - line_start) + 1;
+    d->message = (char*)malloc(strlen(message) + 1);
+    if (!d->message) {
+        list->failed = 1;
+        return;
+    }
+    strcpy(d->message, message);
+    list->count++;
+}
+
+static void diagnostic_syntax_error(int line, const char* token, void* user_data) {
+    DiagnosticList* list = (DiagnosticList*)user_data;
+    const XonLexer* lexer = list->lexer;
+    size_t len = (size_t)(lexer->cursor - lexer->token_start);
+    char message[64];
+
+    (void)line;
+    (void)token;
+    if (len == 0) {
+        snprintf(message, sizeof(message), "Unexpected end of input");
+    } else {
+        snprintf(message, sizeof(message), "Unexpected '%.*s'", (int)(len < 32 ? len : 32), lexer->token_start);
+    }
+    diagnostic_add(list, lexer->token_start, message);
+}
+
+static void diagnostic_lexer_error(int line, const char* message, void* user_data) {
+    DiagnosticList* list = (DiagnosticList*)user_data;
+    (void)line;
+    diagnostic_add(list, list->lexer->token_start, message);
+}
+
+static int diagnose_buffer(const char* data, size_t len, XonDiagnostic** out, size_t* count) {
+    yyParser parser;
+    ParserState state;
+    DataNode* root = NULL;
+    XonLexer lexer;
+    DiagnosticList list;
+    int ok;
+
+    memset(&list, 0, sizeof(list));
+    list.data = data;
+    list.lexer = &lexer;
+    list.counted = data;
+    list.counted_line = 1;
+
+    xonParserInit(&parser);
+    parse_begin(&state, &root, XON_NO_NODES, NULL);
+    state.on_syntax_error = diagnostic_syntax_error;
+    state.on_lexer_error = diagnostic_lexer_error;
+    state.user_data = &list;
+    xon_lexer_init(&lexer, data, len);
+    lexer.raw_strings = 1;
+    ok = feed_tokens(&parser, &state, &lexer, PARSE_RECOVER);
+    xonParserFinalize(&parser);
+
+    if (list.failed) xon_log_error("parser", "Out of memory while collecting diagnostics");
+    if (!ok) xon_log_info("parser", "Diagnosed %zu syntax errors", list.count);
+    if (out) {
+        *out = list.items;
+    } else {
+        xon_diagnostics_free(list.items, list.count);
+    }
+    if (count) *count = list.count;
+    return ok;
+}
+
+int xon_diagnose_buffer(const char* data, size_t len, XonDiagnostic** out, size_t* count) {
+    if (out) *out = NULL;
+    if (count) *count = 0;
+    if (!data && len > 0) return 0;
+
+    xon_logger_init("xon");
+    xon_log_info("api", "Diagnosing input buffer (%zu bytes)", len);
+    return diagnose_buffer(data ? data : "", len, out, count);
+}
+
+int xon_diagnose_file(const char* filename, XonDiagnostic** out, size_t* count) {
+    XonInput input;
+    int ok;
+
+    if (out) *out = NULL;
+    if (count) *count = 0;
+    if (!filename) return 0;
+    xon_logger_init("xon");
+    xon_log_info("api", "Diagnosing file: %s", filename);
+    if (!xon_input_open(&input, filename)) {
+        xon_log_error("api", "Failed to open file: %s", filename);
+        return 0;
+    }
+
+    ok = diagnose_buffer(input.data, input.len, out, count);
+    xon_input_close(&input);
+    return ok;
+}
+
+void xon_diagnostics_free(XonDiagnostic* diagnostics, size_t count) {
+    size_t i;
+    if (!diagnostics) return;
+    for (i = 0; i < count; i++) free(diagnostics[i].message);
+    free(diagnostics);
+}
+
+// ============ Tape documents ============
+
+static const TapeEntry* tape_value_entry(const XonTapeValue* value) {
+    if (!value || !value->tape || value->index >= value->tape->count) return NULL;
+    return &value->tape->entries[value->index];
+}
+
+XonTape* xon_tape_parse(const char* data, size_t len) {
+    XonTape* tape;
+
+    if (!data && len > 0) return NULL;
+    xon_logger_init("xon");
+    tape = (XonTape*)malloc(sizeof(XonTape));
+    if (!tape) return NULL;
+    if (!tape_write(tape, data ? data : "", len, NULL)) {
+        xon_log_info("api", "Not a plain-data document; no tape built (%zu bytes)", len);
+        free(tape);
+        return NULL;
+    }
+    xon_log_info("api", "Tape document (%zu bytes, %zu entries)", len, tape->count);
+    return tape;
+}
+
+void xon_tape_free(XonTape* tape) {
+    if (!tape) return;
+    free(tape->entries);
+    if (tape->strings_on_heap) free(tape->strings);
+    free(tape);
+}
+
+int xon_tape_root(const XonTape* tape, XonTapeValue* out) {
+    if (!tape || !out || tape->count == 0) return 0;
+    out->tape = tape;
+    out->index = 0;
+    return 1;
+}
+
+XonType xon_tape_type(const XonTapeValue* value) {
+    const TapeEntry* e = tape_value_entry(value);
+    return e ? (XonType)e->type : XON_TYPE_NULL;
+}
+
+int xon_tape_find_field(const XonTapeValue* object, const char* key, XonTapeValue* out) {
+    const TapeEntry* e = tape_value_entry(object);
+    const TapeEntry* entries;
+    size_t len;
+    size_t i;
+
+    if (!e || e->type != XON_TYPE_OBJECT || !key || !out) return 0;
+    entries = object->tape->entries;
+    len = strlen(key);
+    // Key, value, key, ...; each value's end is where the next key starts.
+    for (i = object->index + 1; i < e->end; i = entries[i + 1].end) {
+        if (entries[i].u.str.len == len && memcmp(object->tape->strings + entries[i].u.str.offset, key, len) == 0) {
+            out->tape = object->tape;
+            out->index = i + 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int xon_tape_at(const XonTapeValue* list, size_t index, XonTapeValue* out) {
+    const TapeEntry* e = tape_value_entry(list);
+    size_t i;
+
+    if (!e || e->type != XON_TYPE_LIST || index >= e->u.count || !out) return 0;
+    for (i = list->index + 1; index > 0; index--) i = list->tape->entries[i].end;
+    out->tape = list->tape;
+    out->index = i;
+    return 1;
+}
+
+size_t xon_tape_size(const XonTapeValue* value) {
+    const TapeEntry* e = tape_value_entry(value);
+    return e && (e->type == XON_TYPE_OBJECT || e->type == XON_TYPE_LIST) ? e->u.count : 0;
+}
+
+int xon_tape_is_null(const XonTapeValue* value) {
+    const TapeEntry* e = tape_value_entry(value);
+    return e && e->type == XON_TYPE_NULL;
+}
+
+int xon_tape_get_bool(const XonTapeValue* value, int* out) {
+    const TapeEntry* e = tape_value_entry(value);
+    if (!e || e->type != XON_TYPE_BOOL || !out) return 0;
+    *out = e->u.boolean;
+    return 1;
+}
+
+int xon_tape_get_number(const XonTapeValue* value, double* out) {
+    const TapeEntry* e = tape_value_entry(value);
+    if (!e || e->type != XON_TYPE_NUMBER || !out) return 0;
+    *out = e->u.number;
+    return 1;
+}
+
+int xon_tape_get_string(const XonTapeValue* value, const char** out, size_t* len) {
+    const TapeEntry* e = tape_value_entry(value);
+    if (!e || e->type != XON_TYPE_STRING || !out) return 0;
+    *out = value->tape->strings + e->u.str.offset;
+    if (len) *len = e->u.str.len;
+    return 1;
+}
+
+int xon_tape_iter_begin(const XonTapeValue* container, XonTapeIter* it) {
+    const TapeEntry* e = tape_value_entry(container);
+
+    if (!it) return 0;
+    memset(it, 0, sizeof(*it));
+    if (!e || (e->type != XON_TYPE_OBJECT && e->type != XON_TYPE_LIST)) return 0;
+    it->tape = container->tape;
+    it->next = container->index + 1;
+    it->end = e->end;
+    return 1;
+}
+
+int xon_tape_iter_next(XonTapeIter* it, const char** key, XonTapeValue* value) {
+    const TapeEntry* entries;
+    size_t at;
+
+    if (!it || !it->tape || it->next >= it->end) return 0;
+    entries = it->tape->entries;
+    at = it->next;
+    if (key) *key = entries[at].is_key ? it->tape->strings + entries[at].u.str.offset : NULL;
+    if (entries[at].is_key) at++;
+    if (value) {
+        value->tape = it->tape;
+        value->index = at;
+    }
+    it->next = entries[at].end;
+    return 1;
+}
+
+XonValue* xon_tape_to_value(const XonTapeValue* value) {
+    const TapeEntry* e = tape_value_entry(value);
+    XonArena* arena;
+    DataNode* root;
+
+    if (!e) return NULL;
+    arena = xon_arena_create((e->end - value->index) * 2 * sizeof(DataNode));
+    if (!arena) return NULL;
+    root = tape_tree(value->tape, value->index, arena, 1);
+    if (!root) {
+        xon_log_error("api", "Out of memory while building a tree from a tape");
+        xon_arena_destroy(arena);
+        return NULL;
+    }
+    return arena_document(arena, root);
+}
+
+// ============ Incremental parsing ============
+
+// The grammar reports the span of every object and list as it reduces them
+// (container_span() in xon.lemon), and the document keeps those spans in an
+// unordered table that is shifted as the text changes. An edit reparses the
+// smallest container that strictly encloses everything changed since the
+// tree was last valid. If that text parses on its own, the lexer is in the
+// same state at both of its brackets as before, so the rest of the document
+// is unaffected and the new subtree replaces the old one in place. The
+// container's node is reused, so pointers into the tree outside it stay valid.
+
+typedef struct {
+    DataNode* node;
+    size_t start; // offset of the opening bracket
+    size_t end;   // offset just past the closing bracket
+    int line;     // line of the opening bracket
+} ContainerSpan;
+
+typedef struct {
+    ContainerSpan* items;
+    size_t count;
+    size_t cap;
+    const char* base; // offsets are relative to this
+    int failed;
+} SpanTable;
+
+struct XonIncremental {
+    char* text;
+    size_t len;
+    size_t cap;
+    yyParser lemon;
+    DataNode* root; // last valid tree
+    SpanTable spans;
+    int valid;
+    size_t dirty_start; // while invalid, every edit since the tree was last
+    size_t dirty_end;   // valid lies in [dirty_start, dirty_end)
+};
+
+static void span_record(DataNode* node, const char* start, const char* end, int line, void* user_data) {
+    SpanTable* table = (SpanTable*)user_data;
+    ContainerSpan* span;
+
+    if (table->failed) return;
+    if (table->count == table->cap) {
+        size_t cap = table->cap ? table->cap * 2 : 64;
+        ContainerSpan* items = (ContainerSpan*)realloc(table->items, cap * sizeof(ContainerSpan));
+        if (!items) {
+            table->failed = 1;
+            return;
+        }
+        table->items = items;
+        table->cap = cap;
+    }
+    span = &table->items[table->count++];
+    span->node = node;
+    span->start = (size_t)(start - table->base);
+    span->end = (size_t)(end - table->base);
+    span->line = line;
+}
+
+// Parses text[start, end) on the heap, quietly, recording container spans
+// into table. Returns the root or NULL.
+static DataNode* incremental_parse(XonIncremental* doc, size_t start, size_t end, int line, SpanTable* table) {
+    ParserState state;
+    DataNode* root = NULL;
+    XonLexer lexer;
+
+    memset(table, 0, sizeof(*table));
+    table->base = doc->text;
+    parse_begin(&state, &root, NULL, NULL);
+    state.on_syntax_error = quiet_syntax_error;
+    state.on_container = span_record;
+    state.user_data = table;
+    xon_lexer_init(&lexer, doc->text + start, end - start);
+    lexer.line = line;
+
+    if (!feed_tokens(&doc->lemon, &state, &lexer, PARSE_QUIET) || table->failed) {
+        // Otherwise the next parse would recover from its first error
+        // silently.
+        xonParserFinalize(&doc->lemon);
+        xonParserInit(&doc->lemon);
+        if (root) free_xon_ast(root);
+        free(table->items);
+        memset(table, 0, sizeof(*table));
+        return NULL;
+    }
+    return root;
+}
+
+// Items, pair values and the literal flag of a container after one of its
+// descendants changed.
+static void refresh_literal(DataNode* container) {
+    DataNode* item;
+    int literal = 1;
+
+    for (item = container->data.aggregate.value; item; item = item->next) {
+        if (container->type == TYPE_OBJECT && item->type == TYPE_OBJECT && item->data.aggregate.key) {
+            DataNode* value = item->data.aggregate.value;
+            item->flags &= (unsigned char)~XON_NODE_LITERAL;
+            if (value && (value->flags & XON_NODE_LITERAL)) item->flags |= XON_NODE_LITERAL;
+        }
+        if (!(item->flags & XON_NODE_LITERAL)) literal = 0;
+    }
+    container->flags &= (unsigned char)~XON_NODE_LITERAL;
+    if (literal) container->flags |= XON_NODE_LITERAL;
+}
+
+// Reparses the container spans[index]. Returns 1 if its text is valid.
+static int incremental_splice(XonIncremental* doc, size_t index) {
+    ContainerSpan target = doc->spans.items[index];
+    DataNode* node = target.node;
+    DataNode* next = node->next;
+    DataNode* fresh;
+    SpanTable table;
+    ContainerSpan* items = doc->spans.items;
+    size_t kept = 0;
+    size_t i;
+
+    fresh = incremental_parse(doc, target.start, target.end, target.line, &table);
+    if (!fresh) return 0;
+    if (doc->spans.count + table.count > doc->spans.cap) {
+        size_t cap = doc->spans.count + table.count;
+        items = (ContainerSpan*)realloc(doc->spans.items, cap * sizeof(ContainerSpan));
+        if (!items) {
+            free_xon_ast(fresh);
+            free(table.items);
+            return 0;
+        }
+        doc->spans.items = items;
+        doc->spans.cap = cap;
+    }
+
+    // Drop the old subtree's spans (including stale ones inside it), then add
+    // the new ones, with the fresh root's pointing at the reused node.
+    for (i = 0; i < doc->spans.count; i++) {
+        if (items[i].start >= target.start && items[i].end <= target.end) continue;
+        items[kept++] = items[i];
+    }
+    for (i = 0; i < table.count; i++) {
+        if (table.items[i].node == fresh) table.items[i].node = node;
+        items[kept++] = table.items[i];
+    }
+    doc->spans.count = kept;
+    free(table.items);
+
+    free_xon_ast(node->data.aggregate.value);
+    free(node->data.aggregate.cache.index);
+    *node = *fresh;
+    node->next = next;
+    free(fresh);
+
+    // Literal flags of the enclosing containers, innermost first. Each one
+    // strictly encloses the next, so they order by size.
+    for (;;) {
+        ContainerSpan* parent = NULL;
+        for (i = 0; i < doc->spans.count; i++) {
+            ContainerSpan* s = &items[i];
+            if (s->start < target.start && s->end > target.end &&
+                (!parent || s->end - s->start < parent->end - parent->start)) {
+                parent = s;
+            }
+        }
+        if (!parent) break;
+        refresh_literal(parent->node);
+        target = *parent;
+    }
+    return 1;
+}
+
+static int incremental_full_parse(XonIncremental* doc) {
+    SpanTable table;
+    DataNode* root = incremental_parse(doc, 0, doc->len, 1, &table);
+
+    if (!root) return 0;
+    free_xon_ast(doc->root);
+    free(doc->spans.items);
+    doc->root = root;
+    doc->spans = table;
+    return 1;
+}
+
+XonIncremental* xon_incremental_new(const char* data, size_t len) {
+    XonIncremental* doc;
+
+    if (!data && len > 0) return NULL;
+    xon_logger_init("xon");
+    doc = (XonIncremental*)calloc(1, sizeof(XonIncremental));
+    if (!doc) return NULL;
+    doc->cap = len + 1;
+    doc->text = (char*)malloc(doc->cap);
+    if (!doc->text) {
+        free(doc);
+        return NULL;
+    }
+    if (len > 0) memcpy(doc->text, data, len);
+    doc->len = len;
+    xonParserInit(&doc->lemon);
+    doc->valid = incremental_full_parse(doc);
+    if (!doc->valid) doc->dirty_end = len;
+    xon_log_info("api", "Incremental document (%zu bytes, %zu containers)", len, doc->spans.count);
+    return doc;
+}
+
+static size_t count_newlines(const char* p, size_t len) {
+    const char* end = p + len;
+    size_t n = 0;
+    while ((p = memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+int xon_incremental_edit(XonIncremental* doc, size_t offset, size_t removed, const char* text, size_t len) {
+    size_t old_end = offset + removed;
+    size_t new_end = offset + len;
+    int delta_lines;
+    size_t best = SIZE_MAX;
+    size_t i;
+
+    if (!doc || offset > doc->len || removed > doc->len - offset || (!text && len > 0)) return 0;
+    if (doc->len - removed + len >= doc->cap) {
+        size_t cap = doc->cap * 2;
+        char* grown;
+        if (cap <= doc->len - removed + len) cap = doc->len - removed + len + 1;
+        grown = (char*)realloc(doc->text, cap);
+        if (!grown) {
+            xon_log_error("api", "Out of memory while editing an incremental document");
+            return 0;
+        }
+        doc->text = grown;
+        doc->cap = cap;
+    }
+    delta_lines = (int)count_newlines(text ? text : "", len) - (int)count_newlines(doc->text + offset, removed);
+    memmove(doc->text + new_end, doc->text + old_end, doc->len - old_end);
+    if (len > 0) memcpy(doc->text + offset, text, len);
+    doc->len = doc->len - removed + len;
+
+    // Shift spans after the edit and stretch the ones around it. A span the
+    // edit cuts into is emptied so that it never encloses anything again; it
+    // goes away with the next splice around it or the next full parse.
+    for (i = 0; i < doc->spans.count; i++) {
+        ContainerSpan* s = &doc->spans.items[i];
+        if (s->start >= old_end) {
+            s->start = s->start - removed + len;
+            s->end = s->end - removed + len;
+            s->line += delta_lines;
+        } else if (s->end <= offset) {
+            continue;
+        } else if (s->start < offset && s->end > old_end) {
+            s->end = s->end - removed + len;
+        } else {
+            s->start = offset;
+            s->end = offset;
+        }
+    }
+
+    if (doc->valid) {
+        doc->dirty_start = offset;
+        doc->dirty_end = new_end;
+    } else {
+        size_t end = doc->dirty_end >= old_end ? doc->dirty_end - removed + len : offset;
+        if (doc->dirty_start > offset) doc->dirty_start = offset;
+        doc->dirty_end = end > new_end ? end : new_end;
+    }
+
+    for (i = 0; i < doc->spans.count; i++) {
+        const ContainerSpan* s = &doc->spans.items[i];
+        if (s->start < doc->dirty_start && s->end > doc->dirty_end &&
+            (best == SIZE_MAX || s->end - s->start < doc->spans.items[best].end - doc->spans.items[best].start)) {
+            best = i;
+        }
+    }
+
+    // A container that no longer parses on its own may still be fine as part
+    // of the whole (a quote it gained can pair with one outside it), so only
+    // a full parse can say the document is invalid.
+    doc->valid = (best != SIZE_MAX && incremental_splice(doc, best)) || incremental_full_parse(doc);
+    return doc->valid;
+}
+
+const XonValue* xon_incremental_root(const XonIncremental* doc) {
+    return doc && doc->valid ? doc->root : NULL;
+}
+
+const char* xon_incremental_text(const XonIncremental* doc, size_t* len) {
+    if (len) *len = doc ? doc->len : 0;
+    return doc ? doc->text : NULL;
+}
+
+void xon_incremental_free(XonIncremental* doc) {
+    if (!doc) return;
+    xonParserFinalize(&doc->lemon);
+    free_xon_ast(doc->root);
+    free(doc->spans.items);
+    free(doc->text);
+    free(doc);
+}
+
+// ============ Event parsing ============
+
+// Data-layer tokens are turned into events as they are lexed; the only state
+// is one byte per open container and a few tokens of lookahead. Expressions
+// are scanned to the end of their value and then checked with the full
+// grammar, so event mode accepts the same documents as xonify().
+
+#define SAX_LOOKAHEAD 3
+
+typedef struct {
+    int id;
+    XonTokenData data;
+    const char* start;
+    const char* end;
+    int line;
+} SaxToken;
+
+// Handler used when the caller passes none, i.e. for syntax checks.
+static const XonSaxHandler sax_no_events;
+
+typedef struct {
+    XonLexer lexer;
+    const XonSaxHandler* handler;
+    void* user_data;
+    SaxToken ahead[SAX_LOOKAHEAD];
+    int ahead_count;
+    unsigned char* closers; // closing token id of each open container
+    size_t depth;
+    size_t closers_cap;
+    void* lemon; // expression checks; created on first use
+    int status;
+    int needs_grammar; // syntax check only: the grammar decides instead
+    int needs_tree;    // tree_fallback: the caller redoes it with a tree
+    int tree_fallback; // the caller can redo the document through a tree
+} SaxState;
+
+static int sax_lex(SaxState* s, SaxToken* t) {
+    char* err_msg = NULL;
+    t->id = xon_lexer_next(&s->lexer, &t->data, &err_msg);
+    t->start = t->id > 0 ? s->lexer.token_start : s->lexer.cursor;
+    t->end = s->lexer.cursor;
+    t->line = s->lexer.line;
+    if (t->id == -1) {
+        report_lexer_error(s->lexer.line, err_msg);
+        return 0;
+    }
+    return 1;
+}
+
+static const SaxToken* sax_peek(SaxState* s, int k) {
+    while (s->ahead_count <= k) {
+        if (!sax_lex(s, &s->ahead[s->ahead_count])) return NULL;
+        s->ahead_count++;
+    }
+    return &s->ahead[k];
+}
+
+// The caller owns t->data.sVal afterwards.
+static int sax_next(SaxState* s, SaxToken* t) {
+    if (!sax_peek(s, 0)) return 0;
+    *t = s->ahead[0];
+    s->ahead_count--;
+    memmove(&s->ahead[0], &s->ahead[1], (size_t)s->ahead_count * sizeof(SaxToken));
+    return 1;
+}
+
+static int sax_stop(SaxState* s) {
+    s->status = -1;
+    return 0;
+}
+
+// Reports t and releases its text.
+static int sax_syntax_error(SaxToken* t, const char* detail) {
+    char token_text[64];
+    size_t len = (size_t)(t->end - t->start);
+    if (t->id == 0) {
+        snprintf(token_text, sizeof(token_text), "end of input");
+    } else {
+        snprintf(token_text, sizeof(token_text), "%.*s", (int)(len < 63 ? len : 63), t->start);
+    }
+    fprintf(stderr, "Syntax Error at line %d near token '%s'%s\n", t->line, token_text, detail ? detail : "");
+    xon_log_error("parser", "Syntax Error at line %d near token '%s'%s", t->line, token_text, detail ? detail : "");
+    free(t->data.sVal);
+    t->data.sVal = NULL;
+    return 0;
+}
+
+static int sax_expect(SaxState* s, int id) {
+    SaxToken t;
+    if (!sax_next(s, &t)) return 0;
+    if (t.id != id) return sax_syntax_error(&t, NULL);
+    free(t.data.sVal);
+    return 1;
+}
+
+static int sax_ends_value(int id) {
+    return id == 0 || id == COMMA || id == RBRACE || id == RBRACKET;
+}
+
+static int sax_nesting(int id) {
+    if (id == LPAREN || id == LBRACKET || id == LBRACE) return 1;
+    if (id == RPAREN || id == RBRACKET || id == RBRACE) return -1;
+    return 0;
+}
+
+static int sax_open(SaxState* s, int id) {
+    const XonSaxHandler* h = s->handler;
+    int ok;
+    if (s->depth == s->closers_cap) {
+        size_t cap = s->closers_cap ? s->closers_cap * 2 : 64;
+        unsigned char* closers = (unsigned char*)realloc(s->closers, cap);
+        if (!closers) {
+            xon_log_error("parser", "Out of memory while tracking nesting");
+            return 0;
+        }
+        s->closers = closers;
+        s->closers_cap = cap;
+    }
+    s->closers[s->depth++] = (unsigned char)(id == LBRACE ? RBRACE : RBRACKET);
+    if (id == LBRACE) {
+        ok = !h->on_object_start || h->on_object_start(s->user_data);
+    } else {
+        ok = !h->on_list_start || h->on_list_start(s->user_data);
+    }
+    return ok ? 1 : sax_stop(s);
+}
+
+static int sax_close(SaxState* s) {
+    const XonSaxHandler* h = s->handler;
+    int ok;
+    if (s->closers[--s->depth] == RBRACE) {
+        ok = !h->on_object_end || h->on_object_end(s->user_data);
+    } else {
+        ok = !h->on_list_end || h->on_list_end(s->user_data);
+    }
+    return ok ? 1 : sax_stop(s);
+}
+
+// Consumes the separator or closers that follow a complete value. Once the
+// root closes, only the end of input may follow.
+static int sax_after_value(SaxState* s, int closed) {
+    SaxToken t;
+    while (s->depth > 0) {
+        if (!sax_next(s, &t)) return 0;
+        if (t.id == COMMA) return 1;
+        if (t.id != s->closers[s->depth - 1]) {
+            if (closed && !sax_ends_value(t.id)) {
+                // Without a handler there are no events to get wrong.
+                if (s->handler == &sax_no_events) {
+                    free(t.data.sVal);
+                    s->needs_grammar = 1;
+                    return 0;
+                }
+                if (s->tree_fallback) {
+                    free(t.data.sVal);
+                    s->needs_tree = 1;
+                    return 0;
+                }
+                return sax_syntax_error(&t, " (operators on container literals are not supported in event mode)");
+            }
+            return sax_syntax_error(&t, NULL);
+        }
+        if (!sax_close(s)) return 0;
+        closed = 1;
+    }
+    if (!sax_next(s, &t)) return 0;
+    if (t.id != 0) return sax_syntax_error(&t, NULL);
+    return 1;
+}
+
+// The expression is checked as the only item of a list, the smallest
+// document that holds one; the brackets are fed as edge tokens.
+static int sax_check_expression(SaxState* s, const char* text, size_t len, int line) {
+    if (!s->lemon) {
+        s->lemon = xonParserAlloc(malloc);
+        if (!s->lemon) {
+            xon_log_error("parser", "Out of memory while checking expression");
+            return 0;
+        }
+    }
+    if (!check_tokens(s->lemon, text, len, line, PARSE_WRAP_OPEN | PARSE_WRAP_CLOSE)) {
+        xonParserFinalize(s->lemon);
+        xonParserInit(s->lemon);
+        return 0;
+    }
+    return 1;
+}
+
+static int sax_expression(SaxState* s, const SaxToken* first) {
+    const XonSaxHandler* h = s->handler;
+    const char* end = first->end;
+    int nesting = sax_nesting(first->id);
+    size_t len;
+
+    for (;;) {
+        const SaxToken* next = sax_peek(s, 0);
+        SaxToken t;
+        if (!next) return 0;
+        if (next->id == 0 || (nesting == 0 && sax_ends_value(next->id))) break;
+        if (!sax_next(s, &t)) return 0;
+        nesting += sax_nesting(t.id);
+        end = t.end;
+        free(t.data.sVal);
+    }
+
+    len = (size_t)(end - first->start);
+    if (!sax_check_expression(s, first->start, len, first->line)) return 0;
+    if (h->on_expression && !h->on_expression(s->user_data, first->start, len)) return sax_stop(s);
+    return 1;
+}
+
+static int sax_literal(SaxState* s, const SaxToken* t, int negate) {
+    const XonSaxHandler* h = s->handler;
+    int ok = 1;
+    switch (t->id) {
+        case STRING:
+            if (h->on_string) ok = h->on_string(s->user_data, t->data.sVal, t->data.sLen);
+            break;
+        case NUMBER:
+            if (h->on_number) ok = h->on_number(s->user_data, negate ? -t->data.nVal : t->data.nVal);
+            break;
+        case TRUE:
+        case FALSE:
+            if (h->on_bool) ok = h->on_bool(s->user_data, t->id == TRUE);
+            break;
+        default:
+            if (h->on_null) ok = h->on_null(s->user_data);
+            break;
+    }
+    return ok ? 1 : sax_stop(s);
+}
+
+static int sax_is_literal(int id) {
+    return id == STRING || id == NUMBER || id == TRUE || id == FALSE || id == NULL_VAL;
+}
+
+// Takes ownership of t. A literal is only reported as such when the value
+// ends right after it (or after "-NUMBER"); anything longer is an expression.
+static int sax_value(SaxState* s, SaxToken* t) {
+    const SaxToken* next;
+    int ok;
+
+    if (t->id == LBRACE || t->id == LBRACKET) return sax_open(s, t->id);
+    if (sax_ends_value(t->id)) return sax_syntax_error(t, NULL);
+    if (!(next = sax_peek(s, 0))) {
+        free(t->data.sVal);
+        return 0;
+    }
+
+    if (t->id == MINUS && next->id == NUMBER && !sax_peek(s, 1)) {
+        ok = 0;
+    } else if (sax_is_literal(t->id) && sax_ends_value(next->id)) {
+        ok = sax_literal(s, t, 0);
+    } else if (t->id == MINUS && next->id == NUMBER && sax_ends_value(s->ahead[1].id)) {
+        SaxToken number;
+        sax_next(s, &number);
+        ok = sax_literal(s, &number, 1);
+    } else if (s->handler == &sax_no_events) {
+        // A syntax check hands documents with expressions to the grammar
+        // whole: one pass is cheaper than scanning each expression and then
+        // parsing it again.
+        s->needs_grammar = 1;
+        ok = 0;
+    } else {
+        ok = sax_expression(s, t);
+    }
+    free(t->data.sVal);
+    return ok && sax_after_value(s, 0);
+}
+
+static int sax_member(SaxState* s, SaxToken* head) {
+    const XonSaxHandler* h = s->handler;
+    SaxToken t;
+    int ok;
+
+    if (head->id == STRING || head->id == IDENTIFIER) {
+        const char* key = head->id == STRING ? head->data.sVal : head->data.span;
+        if (!sax_expect(s, COLON)) {
+            free(head->data.sVal);
+            return 0;
+        }
+        ok = !h->on_key || h->on_key(s->user_data, key, head->data.sLen);
+        free(head->data.sVal);
+    } else if (head->id == LET || head->id == CONST) {
+        SaxToken name;
+        if (!sax_next(s, &name)) return 0;
+        if (name.id != IDENTIFIER) return sax_syntax_error(&name, NULL);
+        if (!sax_expect(s, ASSIGN)) return 0;
+        ok = !h->on_declaration ||
+             h->on_declaration(s->user_data, name.data.span, name.data.sLen, head->id == CONST);
+    } else {
+        return sax_syntax_error(head, NULL);
+    }
+    if (!ok) return sax_stop(s);
+
+    if (!sax_next(s, &t)) return 0;
+    return sax_value(s, &t);
+}
+
+static int sax_run(SaxState* s) {
+    SaxToken t;
+
+    if (!sax_next(s, &t)) return 0;
+    if (t.id != LBRACE && t.id != LBRACKET) return sax_syntax_error(&t, NULL);
+    if (!sax_open(s, t.id)) return 0;
+
+    while (s->depth > 0) {
+        unsigned char closer = s->closers[s->depth - 1];
+        if (!sax_next(s, &t)) return 0;
+        if (t.id == closer) {
+            if (!sax_close(s) || !sax_after_value(s, 1)) return 0;
+        } else if (closer == RBRACKET) {
+            if (!sax_value(s, &t)) return 0;
+        } else if (!sax_member(s, &t)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// needs_tree: if not NULL, an operator after a container literal, whose
+// events were already sent, stops the parse quietly and sets *needs_tree
+// instead of being reported as an error.
+static int sax_parse_events(const char* data, size_t len, const XonSaxHandler* handler, void* user_data,
+                            int* needs_tree) {
+    SaxState s;
+    int i;
 
-                if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
+    memset(&s, 0, sizeof(s));
+    xon_lexer_init(&s.lexer, data, len);
+    s.handler = handler ? handler : &sax_no_events;
+    s.user_data = user_data;
+    s.tree_fallback = needs_tree != NULL;
+    // Nobody sees the strings when there is no handler, so they are not copied.
+    s.lexer.raw_strings = handler == NULL;
+    if (sax_run(&s)) s.status = 1;
+
+    for (i = 0; i < s.ahead_count; i++) free(s.ahead[i].data.sVal);
+    free(s.closers);
+    if (s.needs_grammar) {
+        if (!s.lemon) s.lemon = xonParserAlloc(malloc);
+        if (s.lemon && check_tokens(s.lemon, data, len, 1, 0)) s.status = 1;
+    }
+    if (s.lemon) xonParserFree(s.lemon, free);
+
+    if (needs_tree) *needs_tree = s.needs_tree;
+    if (s.status == 1) {
+        xon_log_info("parser", "Event parsing completed successfully");
+    } else if (s.needs_tree) {
+        xon_log_info("parser", "Event parsing stopped at an operator after a container literal");
+    } else if (s.status == 0) {
+        xon_log_error("parser", "Event parsing failed");
+    }
+    return s.status;
+}
 
-                if (pair->data.aggregate.key && pair->data.aggregate.key->type == TYPE_STRING) {
-                    key = pair->data.aggregate.key->data.s_val;
-                }
-                if (!key) key = "";
+static int sax_parse(const char* data, size_t len, const XonSaxHandler* handler, void* user_data) {
+    return sax_parse_events(data, len, handler, user_data, NULL);
+}
 
-                if (as_json || !is_identifier_key(key)) {
-                    if (!sb_append_escaped_string(sb, key)) return 0;
-                } else {
-                    if (!sb_append_str(sb, key)) return 0;
-                }
+typedef struct {
+    const XonSaxHandler* handler;
+    void* user_data;
+    char* scratch; // decoded strings with escapes
+    size_t scratch_cap;
+} JsonEvents;
+
+// Reports the string at *pp through callback (may be NULL). Returns 1, 0 if
+// it is malformed or memory ran out, or -1 if the callback stopped.
+static int json_emit_string(JsonEvents* ev, int (*callback)(void*, const char*, size_t), const char** pp,
+                            const char* end) {
+    int escaped;
+    const char* start = *pp + 1;
+    const char* close = json_string_end(*pp, end, &escaped);
+    size_t len;
 
-                if (!sb_append_str(sb, pretty ? ": " : ":")) return 0;
-                if (!serialize_value(pair->data.aggregate.value, sb, pretty, depth + 1, as_json)) return 0;
+    if (!close) return 0;
+    *pp = close + 1;
+    if (!callback) return 1;
+    len = (size_t)(close - start);
+    if (escaped) {
+        if (len > ev->scratch_cap) {
+            char* grown = (char*)realloc(ev->scratch, len);
+            if (!grown) return 0;
+            ev->scratch = grown;
+            ev->scratch_cap = len;
+        }
+        len = json_decode(start, close, ev->scratch);
+        start = ev->scratch;
+    }
+    return callback(ev->user_data, start, len) ? 1 : -1;
+}
 
-            } else {
-                pair = pair->next;
+static int json_emit_scalar(JsonEvents* ev, const char** pp, const char* end) {
+    const XonSaxHandler* h = ev->handler;
+    const char* p = *pp;
+    int ok = 1;
+
+    switch (*p) {
+        case '"':
+            return json_emit_string(ev, h->on_string, pp, end);
+        case 't':
+        case 'f':
+            if (!json_word(p, end, *p == 't' ? "true" : "false", *p == 't' ? 4 : 5)) return 0;
+            *pp = p + (*p == 't' ? 4 : 5);
+            if (h->on_bool) ok = h->on_bool(ev->user_data, *p == 't');
+            break;
+        case 'n':
+            if (!json_word(p, end, "null", 4)) return 0;
+            *pp = p + 4;
+            if (h->on_null) ok = h->on_null(ev->user_data);
+            break;
+        default: {
+            const char* q = json_number_end(p, end);
+            double value;
+            if (!q || !xon_parse_decimal(p + (*p == '-'), q, &value)) return 0;
+            *pp = q;
+            if (h->on_number) ok = h->on_number(ev->user_data, *p == '-' ? -value : value);
+        }
+    }
+    return ok ? 1 : -1;
+}
+
+// Event parsing for plain JSON; see json_build(). Returns 1 when done, 0 if
+// the input is not plain JSON (nothing is reported) and -1 if a callback
+// stopped. Events already delivered cannot be taken back for a fallback, so
+// sax_parse_json() checks the input with sax_no_events before the real run.
+static int json_events(const char* data, size_t len, const XonSaxHandler* h, void* user_data) {
+    const char* p = data;
+    const char* end = data + len;
+    JsonEvents ev;
+    unsigned char* objects; // per open container: 1 for an object, 0 for a list
+    size_t depth = 0;
+    size_t cap = 64;
+    int after_item = 0;
+    int rc = 0;
+
+    p = json_skip_ws(p, end);
+    if (p >= end || (*p != '{' && *p != '[')) return 0;
+    objects = (unsigned char*)malloc(cap);
+    if (!objects) return 0;
+    memset(&ev, 0, sizeof(ev));
+    ev.handler = h;
+    ev.user_data = user_data;
+
+    // Containers are walked the way json_build() walks them.
+    for (;;) {
+        int is_object;
+        int status = 1;
+
+        if (*p == '{' || *p == '[') {
+            if (depth == cap) {
+                unsigned char* grown = (unsigned char*)realloc(objects, cap * 2);
+                if (!grown) goto done;
+                objects = grown;
+                cap *= 2;
+            }
+            objects[depth++] = *p == '{';
+            if (*p++ == '{') {
+                if (h->on_object_start) status = h->on_object_start(user_data);
+            } else if (h->on_list_start) {
+                status = h->on_list_start(user_data);
+            }
+            if (!status) goto stopped;
+            after_item = 0;
+        } else {
+            status = json_emit_scalar(&ev, &p, end);
+            if (status < 0) goto stopped;
+            if (status == 0) goto done;
+            after_item = 1;
+        }
+
+        // Closers and commas up to the next member or item.
+        for (;;) {
+            p = json_skip_ws(p, end);
+            if (p >= end) goto done;
+            is_object = objects[depth - 1];
+            if (*p == (is_object ? '}' : ']')) {
+                p++;
+                depth--;
+                if (is_object) {
+                    if (h->on_object_end) status = h->on_object_end(user_data);
+                } else if (h->on_list_end) {
+                    status = h->on_list_end(user_data);
+                }
+                if (!status) goto stopped;
+                if (depth == 0) goto finish;
+                after_item = 1;
                 continue;
             }
+            if (!after_item) break;
+            if (*p++ != ',') goto done;
+            after_item = 0;
+        }
 
-            if (pair->next && !sb_append_char(sb, ',')) return 0;
-            if (pretty && !sb_append_char(sb, '\n')) return 0;
-            pair = pair->next;
+        if (is_object) {
+            if (*p != '"') goto done;
+            status = json_emit_string(&ev, h->on_key, &p, end);
+            if (status < 0) goto stopped;
+            if (status == 0) goto done;
+            p = json_skip_ws(p, end);
+            if (p >= end || *p++ != ':') goto done;
+            p = json_skip_ws(p, end);
+            if (p >= end) goto done;
         }
-        if (pretty && !sb_append_indent(sb, depth)) return 0;
     }
 
-    return sb_append_char(sb, '}');
+finish:
+    rc = json_skip_ws(p, end) == end;
+    goto done;
+
+stopped:
+    rc = -1;
+done:
+    free(objects);
+    free(ev.scratch);
+    return rc;
 }
 
-static int serialize_list(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
-    const DataNode* item = node->data.aggregate.value;
-    if (!sb_append_char(sb, '[')) return 0;
+// JSON first when it is plain JSON, the general event parser otherwise.
+// needs_tree: as for sax_parse_events().
+static int sax_parse_json(const char* data, size_t len, const XonSaxHandler* handler, void* user_data,
+                          int* needs_tree) {
+    if (needs_tree) *needs_tree = 0;
+    if (json_events(data, len, &sax_no_events, NULL) != 1) {
+        return sax_parse_events(data, len, handler, user_data, needs_tree);
+    }
+    xon_log_info("parser", "Event parsing plain JSON");
+    return handler ? json_events(data, len, handler, user_data) : 1;
+}
 
-    if (item) {
-        if (pretty && !sb_append_char(sb, '\n')) return 0;
-        while (item) {
-            if (pretty && !sb_append_indent(sb, depth + 1)) return 0;
-            if (!serialize_value(item, sb, pretty, depth + 1, as_json)) return 0;
-            if (item->next && !sb_append_char(sb, ',')) return 0;
-            if (pretty && !sb_append_char(sb, '\n')) return 0;
-            item = item->next;
-        }
-        if (pretty && !sb_append_indent(sb, depth)) return 0;
+int xon_sax_parse_buffer(const char* data, size_t len, const XonSaxHandler* handler, void* user_data) {
+    if (!data && len > 0) return 0;
+
+    xon_logger_init("xon");
+    xon_log_info("api", "Event parsing input buffer (%zu bytes)", len);
+    if (json_applies(NULL)) return sax_parse_json(data ? data : "", len, handler, user_data, NULL);
+    return sax_parse(data ? data : "", len, handler, user_data);
+}
+
+int xon_sax_parse_file(const char* filename, const XonSaxHandler* handler, void* user_data) {
+    XonInput input;
+    int rc;
+
+    if (!filename) return 0;
+    xon_logger_init("xon");
+    xon_log_info("api", "Event parsing file: %s", filename);
+    if (!xon_input_open(&input, filename)) {
+        xon_log_error("api", "Failed to open file: %s", filename);
+        return 0;
     }
 
-    return sb_append_char(sb, ']');
+    if (json_applies(filename)) {
+        rc = sax_parse_json(input.data, input.len, handler, user_data, NULL);
+    } else {
+        rc = sax_parse(input.data, input.len, handler, user_data);
+    }
+    xon_input_close(&input);
+    return rc;
 }
 
-static int serialize_value(const DataNode* node, StringBuilder* sb, int pretty, int depth, int as_json) {
+int xon_validate_buffer(const char* data, size_t len) {
+    if (!data && len > 0) return 0;
+
+    xon_logger_init("xon");
+    xon_log_info("api", "Validating input buffer (%zu bytes)", len);
+    if (json_applies(NULL)) return sax_parse_json(data ? data : "", len, NULL, NULL, NULL) == 1;
+    return sax_parse(data ? data : "", len, NULL, NULL) == 1;
+}
+
+int xon_validate_file(const char* filename) {
+    return xon_sax_parse_file(filename, NULL, NULL) == 1;
+}
+
+// Writes events in the same layout as serialize_value(). Output is buffered
+// and flushed in blocks, so memory stays flat however large the input is.
+#define SAX_WRITER_FLUSH (64 * 1024)
+
+typedef struct {
+    FILE* out;
+    StringBuilder sb;
+    int as_json;
+    int pretty;
+    unsigned char* has_items; // per open container
+    size_t depth;
+    size_t cap;
+    size_t skip_depth; // containers open inside a dropped declaration
+    int skip_next;     // JSON output drops the next value (a declaration's)
+    int after_head;    // a key or declaration head is waiting for its value
+    size_t written;    // bytes flushed to out so far
+} SaxWriter;
+
+static int writer_flush(SaxWriter* w) {
+    if (w->sb.len > 0 && fwrite(w->sb.data, 1, w->sb.len, w->out) != w->sb.len) return 0;
+    w->written += w->sb.len;
+    w->sb.len = 0;
+    w->sb.data[0] = '\0';
+    return 1;
+}
+
+static int writer_done(SaxWriter* w, int ok) {
+    if (!ok) return 0;
+    return w->sb.len < SAX_WRITER_FLUSH || writer_flush(w);
+}
+
+// Starts an object member or list item: separator, newline and indent.
+static int writer_item(SaxWriter* w) {
+    unsigned char* has_items;
+    if (w->depth == 0) return 1;
+    has_items = &w->has_items[w->depth - 1];
+    if (*has_items && !sb_append_char(&w->sb, ',')) return 0;
+    *has_items = 1;
+    if (w->pretty) {
+        if (!sb_append_char(&w->sb, '\n')) return 0;
+        if (!sb_append_indent(&w->sb, (int)w->depth)) return 0;
+    }
+    return 1;
+}
+
+// Returns 1 if the value is dropped, 0 if it is written, -1 on error.
+static int writer_begin_value(SaxWriter* w, int opens) {
+    if (w->skip_depth || w->skip_next) {
+        w->skip_next = 0;
+        if (opens) w->skip_depth++;
+        return 1;
+    }
+    if (w->after_head) {
+        w->after_head = 0;
+        return 0;
+    }
+    return writer_item(w) ? 0 : -1;
+}
+
+static int writer_open(SaxWriter* w, char c) {
+    int skipped = writer_begin_value(w, 1);
+    if (skipped) return skipped > 0;
+    if (w->depth == w->cap) {
+        size_t cap = w->cap ? w->cap * 2 : 64;
+        unsigned char* has_items = (unsigned char*)realloc(w->has_items, cap);
+        if (!has_items) return 0;
+        w->has_items = has_items;
+        w->cap = cap;
+    }
+    w->has_items[w->depth++] = 0;
+    return writer_done(w, sb_append_char(&w->sb, c));
+}
+
+static int writer_close(SaxWriter* w, char c) {
+    if (w->skip_depth) {
+        w->skip_depth--;
+        return 1;
+    }
+    if (w->has_items[--w->depth] && w->pretty) {
+        if (!sb_append_char(&w->sb, '\n')) return 0;
+        if (!sb_append_indent(&w->sb, (int)w->depth)) return 0;
+    }
+    return writer_done(w, sb_append_char(&w->sb, c));
+}
+
+static int writer_text(SaxWriter* w, const char* text, size_t len) {
+    int skipped = writer_begin_value(w, 0);
+    if (skipped) return skipped > 0;
+    return writer_done(w, sb_append_len(&w->sb, text, len));
+}
+
+static int writer_object_start(void* user_data) { return writer_open((SaxWriter*)user_data, '{'); }
+static int writer_object_end(void* user_data) { return writer_close((SaxWriter*)user_data, '}'); }
+static int writer_list_start(void* user_data) { return writer_open((SaxWriter*)user_data, '['); }
+static int writer_list_end(void* user_data) { return writer_close((SaxWriter*)user_data, ']'); }
+
+static int writer_key(void* user_data, const char* key, size_t len) {
+    SaxWriter* w = (SaxWriter*)user_data;
+    int ok;
+    if (w->skip_depth) return 1;
+    if (!writer_item(w)) return 0;
+    if (w->as_json || !is_identifier_key(key, len)) {
+        ok = sb_append_escaped_string(&w->sb, key, len);
+    } else {
+        ok = sb_append_len(&w->sb, key, len);
+    }
+    w->after_head = 1;
+    return writer_done(w, ok && sb_append_str(&w->sb, w->pretty ? ": " : ":"));
+}
+
+static int writer_declaration(void* user_data, const char* name, size_t len, int is_const) {
+    SaxWriter* w = (SaxWriter*)user_data;
+    if (w->skip_depth) return 1;
+    if (w->as_json) {
+        w->skip_next = 1;
+        return 1;
+    }
+    if (!writer_item(w)) return 0;
+    w->after_head = 1;
+    return writer_done(w, sb_append_str(&w->sb, is_const ? "const " : "let ") &&
+                              sb_append_len(&w->sb, name, len) && sb_append_str(&w->sb, " = "));
+}
+
+static int writer_string(void* user_data, const char* value, size_t len) {
+    SaxWriter* w = (SaxWriter*)user_data;
+    int skipped = writer_begin_value(w, 0);
+    if (skipped) return skipped > 0;
+    return writer_done(w, sb_append_escaped_string(&w->sb, value, len));
+}
+
+static int writer_number(void* user_data, double value) {
     char numbuf[64];
-    if (!node) return sb_append_str(sb, "null");
+    return writer_text((SaxWriter*)user_data, numbuf, format_number(numbuf, sizeof(numbuf), value));
+}
 
-    switch (node->type) {
-        case TYPE_OBJECT:
-            return serialize_object(node, sb, pretty, depth, as_json);
-        case TYPE_LIST:
-            return serialize_list(node, sb, pretty, depth, as_json);
-        case TYPE_EXPR:
-            if (as_json) return sb_append_str(sb, "null");
-            return serialize_expr(node->data.expr, sb, pretty, depth, as_json);
-        case TYPE_FUNCTION:
-            if (as_json) return sb_append_str(sb, "null");
-            return sb_append_str(sb, "<function>");
-        case TYPE_DECL:
-            if (as_json) return sb_append_str(sb, "null");
-            if (node->data.declaration.is_const) {
-                if (!sb_append_str(sb, "const ")) return 0;
-            } else {
-                if (!sb_append_str(sb, "let ")) return 0;
-            }
-            if (!sb_append_str(sb, node->data.declaration.name ? node->data.declaration.name : "")) return 0;
-            if (!sb_append_str(sb, " = ")) return 0;
-            return serialize_value(node->data.declaration.init_expr, sb, pretty, depth, as_json);
-        case TYPE_STRING:
-            return sb_append_escaped_string(sb, node->data.s_val ? node->data.s_val : "");
-        case TYPE_NUMBER:
-            snprintf(numbuf, sizeof(numbuf), "%.17g", node->data.n_val);
-            return sb_append_str(sb, numbuf);
-        case TYPE_BOOL:
-            return sb_append_str(sb, node->data.b_val ? "true" : "false");
-        case TYPE_NULL:
-            return sb_append_str(sb, "null");
+static int writer_bool(void* user_data, int value) {
+    return writer_text((SaxWriter*)user_data, value ? "true" : "false", value ? 4 : 5);
+}
+
+static int writer_null(void* user_data) {
+    return writer_text((SaxWriter*)user_data, "null", 4);
+}
+
+// JSON has no expressions; like xon_to_json() on an unevaluated tree they
+// become null. Xon output keeps the source text.
+static int writer_expression(void* user_data, const char* text, size_t len) {
+    SaxWriter* w = (SaxWriter*)user_data;
+    if (w->as_json) return writer_text(w, "null", 4);
+    return writer_text(w, text, len);
+}
+
+// Converts input_path through a parse tree, over whatever the event run left
+// in out since start. Streams that cannot seek back only work if nothing was
+// flushed yet.
+static int convert_tree(const char* input_path, FILE* out, long start, size_t written, int as_json,
+                        int pretty) {
+    XonValue* root;
+    char* text;
+    int rc;
+
+    if (written > 0 && (start < 0 || fseek(out, start, SEEK_SET) != 0)) {
+        xon_log_error("api", "Cannot rewind the output to convert %s through a tree", input_path);
+        return 0;
+    }
+    root = xonify(input_path);
+    if (!root) return 0;
+    text = as_json ? xon_to_json(root, pretty) : xon_to_xon(root, pretty);
+    xon_free(root);
+    if (!text) return 0;
+    rc = fputs(text, out) >= 0 && fflush(out) == 0;
+#if !defined(_WIN32)
+    // The tree output may be shorter than the events already written.
+    if (rc && written > 0 && (size_t)(ftell(out) - start) < written) {
+        rc = ftruncate(fileno(out), (off_t)ftell(out)) == 0;
+    }
+#endif
+    xon_string_free(text);
+    return rc;
+}
+
+int xon_convert_file(const char* input_path, FILE* out, int as_json, int pretty) {
+    XonSaxHandler handler;
+    SaxWriter writer;
+    XonInput input;
+    long start;
+    int needs_tree = 0;
+    int rc;
+
+    if (!input_path || !out) return 0;
+    memset(&handler, 0, sizeof(handler));
+    handler.on_object_start = writer_object_start;
+    handler.on_object_end = writer_object_end;
+    handler.on_list_start = writer_list_start;
+    handler.on_list_end = writer_list_end;
+    handler.on_key = writer_key;
+    handler.on_string = writer_string;
+    handler.on_number = writer_number;
+    handler.on_bool = writer_bool;
+    handler.on_null = writer_null;
+    handler.on_declaration = writer_declaration;
+    handler.on_expression = writer_expression;
+
+    memset(&writer, 0, sizeof(writer));
+    writer.out = out;
+    writer.as_json = as_json ? 1 : 0;
+    writer.pretty = pretty ? 1 : 0;
+    if (!sb_init(&writer.sb)) return 0;
+    if (!xon_input_open(&input, input_path)) {
+        xon_log_error("api", "Failed to open file: %s", input_path);
+        free(writer.sb.data);
+        return 0;
+    }
+
+    // An operator after a container literal ({a: {b: 1}.b}, [1] + [2]) comes
+    // after the container's events were written; such documents are redone
+    // through a tree, as the events cannot take them back.
+    start = ftell(out);
+    if (json_applies(input_path)) {
+        rc = sax_parse_json(input.data, input.len, &handler, &writer, &needs_tree);
+    } else {
+        rc = sax_parse_events(input.data, input.len, &handler, &writer, &needs_tree);
+    }
+    xon_input_close(&input);
+    if (needs_tree) {
+        rc = convert_tree(input_path, out, start, writer.written, as_json, pretty);
+    } else {
+        rc = rc == 1 && writer_flush(&writer);
+    }
+    if (!rc) xon_log_error("api", "Streaming conversion failed for %s", input_path);
+    free(writer.sb.data);
+    free(writer.has_items);
+    return rc;
+}
+
+// ============ On-demand access ============
+
+// Cursors read the input in place. Only the path to a requested value is
+// looked at token by token; every other value is passed over by matching
+// brackets, skipping strings and comments whole.
+
+struct XonDoc {
+    const char* data;
+    const char* end;
+    XonArena* strings; // decoded string values; created on first use
+};
+
+static const unsigned char CURSOR_STOP[256] = {
+    ['"'] = 1, ['#'] = 1, ['/'] = 1, [','] = 1,
+    ['{'] = 1, ['}'] = 1, ['['] = 1, [']'] = 1, ['('] = 1, [')'] = 1,
+};
+
+// First significant byte at or after p; end if there is none or a block
+// comment is unterminated.
+static const char* cursor_skip_ws(const char* p, const char* end) {
+    int lines = 0;
+    for (;;) {
+        p = xon_scan_skip_ws(p, end, &lines);
+        if (p >= end) return end;
+        if (*p == '#' || (*p == '/' && p + 1 < end && p[1] == '/')) {
+            p = xon_scan_find_byte(p + 1, end, '\n');
+            continue;
+        }
+        if (*p == '/' && p + 1 < end && p[1] == '*') {
+            p = xon_scan_block_comment(p + 2, end, &lines);
+            if (!p) return end;
+            continue;
+        }
+        return p;
+    }
+}
+
+// p points just past an opening quote. Returns the closing quote, or NULL.
+static const char* cursor_string_end(const char* p, const char* end) {
+    int lines = 0;
+    for (;;) {
+        p = xon_scan_string(p, end, &lines);
+        if (p >= end) return NULL;
+        if (*p == '"') return p;
+        if (p + 1 >= end) return NULL;
+        p += 2;
+    }
+}
+
+// Passes over one value. Returns the ',' or closer that ends it (or end), or
+// NULL if a string or comment inside it is unterminated.
+static const char* cursor_skip_value(const char* p, const char* end) {
+    int depth = 0;
+    int lines = 0;
+    while (p < end) {
+        unsigned char c = (unsigned char)*p;
+        if (!CURSOR_STOP[c]) {
+            p++;
+            continue;
+        }
+        switch (c) {
+            case '"':
+                p = cursor_string_end(p + 1, end);
+                if (!p) return NULL;
+                break;
+            case '#':
+                p = xon_scan_find_byte(p + 1, end, '\n');
+                continue;
+            case '/':
+                if (p + 1 < end && p[1] == '/') {
+                    p = xon_scan_find_byte(p + 2, end, '\n');
+                    continue;
+                }
+                if (p + 1 < end && p[1] == '*') {
+                    p = xon_scan_block_comment(p + 2, end, &lines);
+                    if (!p) return NULL;
+                    continue;
+                }
+                break;
+            case '{':
+            case '[':
+            case '(':
+                depth++;
+                break;
+            case ',':
+                if (depth == 0) return p;
+                break;
+            default:
+                if (depth == 0) return p;
+                depth--;
+                break;
+        }
+        p++;
+    }
+    return p;
+}
+
+// From the start of a value to the start of the next item in its container.
+// NULL when the container ends instead (or the input is malformed).
+static const char* cursor_next_item(const char* p, const char* end) {
+    p = cursor_skip_value(p, end);
+    if (!p || p >= end || *p != ',') return NULL;
+    return cursor_skip_ws(p + 1, end);
+}
+
+static int cursor_is_ident(unsigned char c) {
+    return isalnum(c) || c == '_';
+}
+
+static int cursor_key_equals(const char* raw, const char* raw_end, const char* key, size_t key_len) {
+    size_t i = 0;
+    if ((size_t)(raw_end - raw) == key_len && memcmp(raw, key, key_len) == 0) return 1;
+    if (xon_scan_find_byte(raw, raw_end, '\\') == raw_end) return 0;
+    while (raw < raw_end) {
+        char c = *raw++;
+        if (c == '\\') c = xon_lexer_decode_escape(*raw++);
+        if (i >= key_len || key[i++] != c) return 0;
+    }
+    return i == key_len;
+}
+
+// Reads the member head at p and returns the first byte of its value, or NULL
+// if it is malformed. *matches is set when the key equals key; `let`/`const`
+// declarations never match.
+static const char* cursor_member(const char* p, const char* end, const char* key, size_t key_len, int* matches) {
+    *matches = 0;
+    if (*p == '"') {
+        const char* close = cursor_string_end(p + 1, end);
+        if (!close) return NULL;
+        *matches = key && cursor_key_equals(p + 1, close, key, key_len);
+        p = close + 1;
+    } else if (isalpha((unsigned char)*p) || *p == '_') {
+        const char* word = p;
+        size_t len;
+        while (p < end && cursor_is_ident((unsigned char)*p)) p++;
+        len = (size_t)(p - word);
+        if ((len == 3 && memcmp(word, "let", 3) == 0) || (len == 5 && memcmp(word, "const", 5) == 0)) {
+            p = cursor_skip_ws(p, end);
+            while (p < end && cursor_is_ident((unsigned char)*p)) p++;
+            p = cursor_skip_ws(p, end);
+            if (p >= end || *p != '=') return NULL;
+            return cursor_skip_ws(p + 1, end);
+        }
+        *matches = key && len == key_len && memcmp(word, key, len) == 0;
+    } else {
+        return NULL;
+    }
+    p = cursor_skip_ws(p, end);
+    if (p >= end || *p != ':') return NULL;
+    return cursor_skip_ws(p + 1, end);
+}
+
+// Lexes the value at cur as a literal. Returns STRING, NUMBER (with a leading
+// '-' folded in), TRUE, FALSE or NULL_VAL, or 0 if the value is anything
+// else. String text is kept in the document's arena only when keep is set.
+static int cursor_literal(const XonCursor* cur, XonTokenData* data, int keep) {
+    XonDoc* doc = cur->doc;
+    XonLexer lexer;
+    char* err_msg = NULL;
+    const char* after;
+    int negate = 0;
+    int id;
+
+    xon_lexer_init(&lexer, cur->pos, (size_t)(doc->end - cur->pos));
+    if (keep) {
+        if (!doc->strings) doc->strings = xon_arena_create(0);
+        if (!doc->strings) return 0;
+        lexer.arena = doc->strings;
+    }
+    id = xon_lexer_next(&lexer, data, &err_msg);
+    if (id == MINUS) {
+        negate = 1;
+        id = xon_lexer_next(&lexer, data, &err_msg);
+        if (id != NUMBER) id = 0;
+    }
+    free(err_msg);
+    if (!keep) {
+        free(data->sVal);
+        data->sVal = NULL;
+    }
+    if (id != STRING && id != NUMBER && id != TRUE && id != FALSE && id != NULL_VAL) id = 0;
+
+    // "1 + x" starts with a literal but is an expression.
+    after = cursor_skip_ws(lexer.cursor, doc->end);
+    if (id && after < doc->end && *after != ',' && *after != '}' && *after != ']') id = 0;
+    if (negate) data->nVal = -data->nVal;
+    return id;
+}
+
+XonDoc* xon_doc_open(const char* data, size_t len) {
+    XonDoc* doc;
+    if (!data && len > 0) return NULL;
+    doc = (XonDoc*)calloc(1, sizeof(XonDoc));
+    if (!doc) return NULL;
+    doc->data = data ? data : "";
+    doc->end = doc->data + len;
+    return doc;
+}
+
+void xon_doc_close(XonDoc* doc) {
+    if (!doc) return;
+    xon_arena_destroy(doc->strings);
+    free(doc);
+}
+
+int xon_doc_root(XonDoc* doc, XonCursor* out) {
+    const char* p;
+    if (!doc || !out) return 0;
+    p = cursor_skip_ws(doc->data, doc->end);
+    if (p >= doc->end || (*p != '{' && *p != '[')) return 0;
+    out->doc = doc;
+    out->pos = p;
+    return 1;
+}
+
+XonType xon_cursor_type(const XonCursor* cursor) {
+    XonTokenData data;
+    if (!cursor || !cursor->doc || cursor->pos >= cursor->doc->end) return XON_TYPE_NULL;
+    if (*cursor->pos == '{') return XON_TYPE_OBJECT;
+    if (*cursor->pos == '[') return XON_TYPE_LIST;
+    switch (cursor_literal(cursor, &data, 0)) {
+        case STRING: return XON_TYPE_STRING;
+        case NUMBER: return XON_TYPE_NUMBER;
+        case TRUE:
+        case FALSE: return XON_TYPE_BOOL;
+        default: return XON_TYPE_NULL;
+    }
+}
+
+int xon_cursor_find_field(const XonCursor* object, const char* key, XonCursor* out) {
+    const char* end;
+    const char* p;
+    size_t key_len;
+
+    if (!object || !object->doc || !key || !out) return 0;
+    end = object->doc->end;
+    if (object->pos >= end || *object->pos != '{') return 0;
+
+    key_len = strlen(key);
+    p = cursor_skip_ws(object->pos + 1, end);
+    while (p && p < end && *p != '}') {
+        int matches;
+        p = cursor_member(p, end, key, key_len, &matches);
+        if (!p || p >= end) return 0;
+        if (matches) {
+            out->doc = object->doc;
+            out->pos = p;
+            return 1;
+        }
+        p = cursor_next_item(p, end);
     }
     return 0;
 }
 
-static DataNode* object_pair_at(const XonValue* obj, size_t index) {
-    DataNode* pair;
+int xon_cursor_at(const XonCursor* list, size_t index, XonCursor* out) {
+    const char* end;
+    const char* p;
     size_t i = 0;
-    if (!obj || obj->type != TYPE_OBJECT) return NULL;
 
-    pair = obj->data.aggregate.value;
-    while (pair) {
-        if (i == index) return pair;
-        pair = pair->next;
+    if (!list || !list->doc || !out) return 0;
+    end = list->doc->end;
+    if (list->pos >= end || *list->pos != '[') return 0;
+
+    p = cursor_skip_ws(list->pos + 1, end);
+    while (p && p < end && *p != ']') {
+        if (i == index) {
+            out->doc = list->doc;
+            out->pos = p;
+            return 1;
+        }
+        p = cursor_next_item(p, end);
         i++;
     }
-    return NULL;
+    return 0;
 }
 
-XonValue* xonify(const char* filename) {
-    FILE* f;
-    DataNode* root;
+size_t xon_cursor_size(const XonCursor* cursor) {
+    const char* end;
+    const char* p;
+    size_t count = 0;
+    int is_object;
 
-    if (!filename) return NULL;
-    xon_logger_init("xon");
-    xon_log_info("api", "Parsing file: %s", filename);
-    f = fopen(filename, "r");
-    if (!f) {
-        xon_log_error("api", "Failed to open file: %s", filename);
-        return NULL;
-    }
+    if (!cursor || !cursor->doc) return 0;
+    end = cursor->doc->end;
+    if (cursor->pos >= end || (*cursor->pos != '{' && *cursor->pos != '[')) return 0;
 
-    root = parse_stream(f);
-    fclose(f);
-    return root;
+    is_object = *cursor->pos == '{';
+    p = cursor_skip_ws(cursor->pos + 1, end);
+    while (p && p < end && *p != (is_object ? '}' : ']')) {
+        int matches;
+        if (is_object && !(p = cursor_member(p, end, NULL, 0, &matches))) break;
+        count++;
+        p = cursor_next_item(p, end);
+    }
+    return count;
 }
 
-XonValue* xonify_string(const char* str) {
-    FILE* tmp;
-    DataNode* root;
-    if (!str) return NULL;
+int xon_cursor_is_null(const XonCursor* cursor) {
+    XonTokenData data;
+    if (!cursor || !cursor->doc || cursor->pos >= cursor->doc->end) return 0;
+    return cursor_literal(cursor, &data, 0) == NULL_VAL;
+}
 
-    xon_logger_init("xon");
-    xon_log_info("api", "Parsing input string");
-    tmp = tmpfile();
-    if (!tmp) {
-        xon_log_error("api", "Failed to allocate temporary file for string parsing");
-        return NULL;
-    }
-    fputs(str, tmp);
-    rewind(tmp);
+int xon_cursor_get_bool(const XonCursor* cursor, int* out) {
+    XonTokenData data;
+    int id;
+    if (!cursor || !cursor->doc || !out || cursor->pos >= cursor->doc->end) return 0;
+    id = cursor_literal(cursor, &data, 0);
+    if (id != TRUE && id != FALSE) return 0;
+    *out = id == TRUE;
+    return 1;
+}
 
-    root = parse_stream(tmp);
-    fclose(tmp);
-    return root;
+int xon_cursor_get_number(const XonCursor* cursor, double* out) {
+    XonTokenData data;
+    if (!cursor || !cursor->doc || !out || cursor->pos >= cursor->doc->end) return 0;
+    if (cursor_literal(cursor, &data, 0) != NUMBER) return 0;
+    *out = data.nVal;
+    return 1;
 }
 
-void xon_free(XonValue* value) {
-    free_xon_ast(value);
+int xon_cursor_get_string(const XonCursor* cursor, const char** out, size_t* len) {
+    XonTokenData data;
+    if (!cursor || !cursor->doc || !out || cursor->pos >= cursor->doc->end) return 0;
+    if (*cursor->pos != '"' || cursor_literal(cursor, &data, 1) != STRING) return 0;
+    *out = data.sVal;
+    if (len) *len = data.sLen;
+    return 1;
 }
 
 XonType xon_get_type(const XonValue* value) {
@@ -2130,7 +5910,11 @@ double xon_get_number(const XonValue* value) {
 }
 
 const char* xon_get_string(const XonValue* value) {
-    return (value && value->type == TYPE_STRING) ? value->data.s_val : NULL;
+    return (value && value->type == TYPE_STRING) ? value->data.str.s_val : NULL;
+}
+
+size_t xon_get_string_length(const XonValue* value) {
+    return (value && value->type == TYPE_STRING) ? value->data.str.s_len : 0;
 }
 
 XonValue* xon_object_get(const XonValue* obj, const char* key) {
@@ -2142,21 +5926,14 @@ int xon_object_has(const XonValue* obj, const char* key) {
 }
 
 size_t xon_object_size(const XonValue* obj) {
-    DataNode* current;
-    size_t count = 0;
     if (!obj || obj->type != TYPE_OBJECT) return 0;
-    current = obj->data.aggregate.value;
-    while (current) {
-        count++;
-        current = current->next;
-    }
-    return count;
+    return container_size(obj);
 }
 
 const char* xon_object_key_at(const XonValue* obj, size_t index) {
     DataNode* pair = object_pair_at(obj, index);
     if (!pair || !pair->data.aggregate.key || pair->data.aggregate.key->type != TYPE_STRING) return NULL;
-    return pair->data.aggregate.key->data.s_val;
+    return pair->data.aggregate.key->data.str.s_val;
 }
 
 XonValue* xon_object_value_at(const XonValue* obj, size_t index) {
@@ -2166,28 +5943,715 @@ XonValue* xon_object_value_at(const XonValue* obj, size_t index) {
 }
 
 XonValue* xon_list_get(const XonValue* list, size_t index) {
-    DataNode* current;
-    size_t i = 0;
     if (!list || list->type != TYPE_LIST) return NULL;
-    current = list->data.aggregate.value;
-    while (current) {
-        if (i == index) return current;
-        current = current->next;
-        i++;
-    }
-    return NULL;
+    return container_item_at(list, index);
 }
 
 size_t xon_list_size(const XonValue* list) {
-    DataNode* current;
-    size_t count = 0;
     if (!list || list->type != TYPE_LIST) return 0;
-    current = list->data.aggregate.value;
-    while (current) {
-        count++;
-        current = current->next;
+    return container_size(list);
+}
+
+int xon_iter_begin(const XonValue* container, XonIter* it) {
+    if (!it) return 0;
+    it->next = NULL;
+    it->is_object = 0;
+    if (!container || (container->type != TYPE_OBJECT && container->type != TYPE_LIST)) return 0;
+    it->next = container->data.aggregate.value;
+    it->is_object = container->type == TYPE_OBJECT;
+    return 1;
+}
+
+int xon_iter_next(XonIter* it, const char** key, XonValue** value) {
+    const DataNode* item;
+
+    if (!it) return 0;
+    item = it->next;
+    if (it->is_object) {
+        while (item && (item->type != TYPE_OBJECT || !item->data.aggregate.key)) item = item->next;
     }
-    return count;
+    if (!item) {
+        it->next = NULL;
+        return 0;
+    }
+    it->next = item->next;
+    if (it->is_object) {
+        const DataNode* k = item->data.aggregate.key;
+        if (key) *key = k->type == TYPE_STRING ? k->data.str.s_val : NULL;
+        if (value) *value = item->data.aggregate.value;
+    } else {
+        if (key) *key = NULL;
+        if (value) *value = (XonValue*)item;
+    }
+    return 1;
+}
+
+// ============ Path queries ============
+
+// A path is compiled once into steps: member names (decoded, with their hash
+// precomputed for indexed objects), list indexes, wildcards and filters.
+// Evaluation walks the tree step by step and allocates nothing; wildcards and
+// filters recurse once per step, so the C stack bounds the path length, not
+// the document.
+//
+//   services.api.limits[3].burst   $.a["key with spaces"][-1]
+//   items[*].name   items[?port >= 8000].host   tags[?@ == "x"]
+//   /services/api/limits/3/burst  (JSON Pointer, with ~0 and ~1)
+
+enum { PATH_KEY, PATH_INDEX, PATH_WILDCARD, PATH_FILTER };
+enum { PATH_TRUTHY, PATH_EQ, PATH_NE, PATH_LT, PATH_LE, PATH_GT, PATH_GE };
+
+typedef struct {
+    int kind;
+    const char* key; // PATH_KEY
+    size_t key_len;
+    size_t hash;
+    long index;    // PATH_INDEX: negative counts from the end; PATH_KEY: -1 if not a number
+    size_t field;  // PATH_FILTER: the tested field is the key steps
+    size_t fields; // [field, field + fields)
+    int op;
+    DataNode literal;
+} PathStep;
+
+struct XonPath {
+    size_t count; // steps of the path itself; filter fields follow at the end
+    PathStep* steps;
+};
+
+typedef struct {
+    const char* p;
+    const char* start;
+    char* text; // decoded keys and strings
+    PathStep* steps;
+    size_t front;
+    size_t back; // filter fields are laid out downwards from the end
+} PathCompiler;
+
+static void path_error(const PathCompiler* c, const char* message) {
+    fprintf(stderr, "Path Error at offset %zu: %s\n", (size_t)(c->p - c->start), message);
+    xon_log_error("path", "Offset %zu: %s", (size_t)(c->p - c->start), message);
+}
+
+static int path_name_byte(char ch) {
+    return ch != '\0' && ch != '.' && ch != '[' && ch != ']' && ch != '/' && !isspace((unsigned char)ch) &&
+           ch != '"' && ch != '\'' && ch != '=' && ch != '!' && ch != '<' && ch != '>';
+}
+
+static void path_skip_ws(PathCompiler* c) {
+    while (isspace((unsigned char)*c->p)) c->p++;
+}
+
+// Numbers in names ("limits.3", "/limits/3") also index lists.
+static long path_name_index(const char* s, size_t len) {
+    long value = 0;
+    size_t i;
+    if (len == 0 || len > 9 || (len > 1 && s[0] == '0')) return -1;
+    for (i = 0; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        value = value * 10 + (s[i] - '0');
+    }
+    return value;
+}
+
+static void path_key(PathStep* step, char* key, size_t len) {
+    memset(step, 0, sizeof(*step));
+    step->kind = PATH_KEY;
+    step->key = key;
+    step->key_len = len;
+    step->hash = index_key_hash(key, len);
+    step->index = path_name_index(key, len);
+}
+
+static char* path_name(PathCompiler* c, size_t* len) {
+    char* out = c->text;
+    while (path_name_byte(*c->p)) *c->text++ = *c->p++;
+    *len = (size_t)(c->text - out);
+    *c->text++ = '\0';
+    return out;
+}
+
+// A quoted string with \" \' \\ escapes; c->p is on the opening quote.
+static char* path_string(PathCompiler* c, size_t* len) {
+    char quote = *c->p++;
+    char* out = c->text;
+    while (*c->p && *c->p != quote) {
+        if (*c->p == '\\' && c->p[1]) c->p++;
+        *c->text++ = *c->p++;
+    }
+    if (*c->p != quote) {
+        path_error(c, "unterminated string");
+        return NULL;
+    }
+    c->p++;
+    *len = (size_t)(c->text - out);
+    *c->text++ = '\0';
+    return out;
+}
+
+static int path_literal(PathCompiler* c, DataNode* literal) {
+    memset(literal, 0, sizeof(*literal));
+    if (*c->p == '"' || *c->p == '\'') {
+        size_t len;
+        literal->type = TYPE_STRING;
+        literal->data.str.s_val = path_string(c, &len);
+        literal->data.str.s_len = len;
+        return literal->data.str.s_val != NULL;
+    }
+    if (strncmp(c->p, "true", 4) == 0 || strncmp(c->p, "false", 5) == 0) {
+        literal->type = TYPE_BOOL;
+        literal->data.b_val = *c->p == 't';
+        c->p += literal->data.b_val ? 4 : 5;
+        return 1;
+    }
+    if (strncmp(c->p, "null", 4) == 0) {
+        literal->type = TYPE_NULL;
+        c->p += 4;
+        return 1;
+    }
+    if (*c->p == '-' || isdigit((unsigned char)*c->p)) {
+        char* end;
+        literal->type = TYPE_NUMBER;
+        literal->data.n_val = strtod(c->p, &end);
+        if (end != c->p) {
+            c->p = end;
+            return 1;
+        }
+    }
+    path_error(c, "expected a string, number, true, false or null");
+    return 0;
+}
+
+// [?field op literal] or [?field]; c->p is past the '?'.
+static int path_filter(PathCompiler* c, PathStep* step) {
+    static const struct {
+        const char* text;
+        int op;
+    } ops[] = {{"==", PATH_EQ}, {"!=", PATH_NE}, {"<=", PATH_LE}, {">=", PATH_GE}, {"<", PATH_LT}, {">", PATH_GT}};
+    size_t i;
+
+    memset(step, 0, sizeof(*step));
+    step->kind = PATH_FILTER;
+    path_skip_ws(c);
+    if (*c->p == '@') {
+        c->p++;
+        if (*c->p == '.') c->p++;
+        else if (path_name_byte(*c->p)) {
+            path_error(c, "expected '.' after '@'");
+            return 0;
+        }
+    }
+    // Field names go below the previous ones, so collect them and reverse.
+    while (path_name_byte(*c->p)) {
+        size_t len;
+        char* name = path_name(c, &len);
+        path_key(&c->steps[--c->back], name, len);
+        step->fields++;
+        if (*c->p != '.') break;
+        c->p++;
+        if (!path_name_byte(*c->p)) {
+            path_error(c, "expected a field name");
+            return 0;
+        }
+    }
+    step->field = c->back;
+    for (i = 0; i < step->fields / 2; i++) {
+        PathStep swap = c->steps[step->field + i];
+        c->steps[step->field + i] = c->steps[step->field + step->fields - 1 - i];
+        c->steps[step->field + step->fields - 1 - i] = swap;
+    }
+
+    path_skip_ws(c);
+    step->op = PATH_TRUTHY;
+    for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        size_t len = strlen(ops[i].text);
+        if (strncmp(c->p, ops[i].text, len) == 0) {
+            step->op = ops[i].op;
+            c->p += len;
+            path_skip_ws(c);
+            return path_literal(c, &step->literal);
+        }
+    }
+    return 1;
+}
+
+// One [...] step; c->p is past the '['.
+static int path_bracket(PathCompiler* c, PathStep* step) {
+    path_skip_ws(c);
+    if (*c->p == '*') {
+        c->p++;
+        memset(step, 0, sizeof(*step));
+        step->kind = PATH_WILDCARD;
+    } else if (*c->p == '"' || *c->p == '\'') {
+        size_t len;
+        char* key = path_string(c, &len);
+        if (!key) return 0;
+        path_key(step, key, len);
+        step->index = -1;
+    } else if (*c->p == '?') {
+        c->p++;
+        if (!path_filter(c, step)) return 0;
+    } else if (*c->p == '-' || isdigit((unsigned char)*c->p)) {
+        char* end;
+        long index = strtol(c->p, &end, 10);
+        if (end == c->p || (end - c->p) > 10) {
+            path_error(c, "invalid index");
+            return 0;
+        }
+        c->p = end;
+        memset(step, 0, sizeof(*step));
+        step->kind = PATH_INDEX;
+        step->index = index;
+    } else {
+        path_error(c, "expected an index, a quoted key, '*' or '?'");
+        return 0;
+    }
+    path_skip_ws(c);
+    if (*c->p != ']') {
+        path_error(c, "expected ']'");
+        return 0;
+    }
+    c->p++;
+    return 1;
+}
+
+// RFC 6901: /a/b~1c/0 names "a", "b/c", then item 0.
+static int path_pointer(PathCompiler* c) {
+    while (*c->p == '/') {
+        char* key = c->text;
+        c->p++;
+        while (*c->p && *c->p != '/') {
+            if (*c->p == '~') {
+                if (c->p[1] != '0' && c->p[1] != '1') {
+                    path_error(c, "'~' must be followed by 0 or 1");
+                    return 0;
+                }
+                *c->text++ = c->p[1] == '0' ? '~' : '/';
+                c->p += 2;
+            } else {
+                *c->text++ = *c->p++;
+            }
+        }
+        *c->text = '\0';
+        path_key(&c->steps[c->front++], key, (size_t)(c->text - key));
+        c->text++;
+    }
+    return 1;
+}
+
+XonPath* xon_path_compile(const char* expr) {
+    PathCompiler c;
+    XonPath* path;
+    size_t len;
+    size_t cap;
+    int first = 1;
+
+    if (!expr) return NULL;
+    xon_logger_init("xon");
+    len = strlen(expr);
+    // Every step takes at least one byte of the expression.
+    cap = len + 1;
+    path = (XonPath*)malloc(sizeof(XonPath) + cap * sizeof(PathStep) + len * 2 + 2);
+    if (!path) return NULL;
+    memset(&c, 0, sizeof(c));
+    c.p = c.start = expr;
+    c.steps = (PathStep*)(path + 1);
+    c.text = (char*)(c.steps + cap);
+    c.back = cap;
+
+    if (*c.p == '/') {
+        if (!path_pointer(&c)) goto fail;
+    } else {
+        if (*c.p == '$') c.p++;
+        while (*c.p) {
+            PathStep* step = &c.steps[c.front];
+            if (*c.p == '.' || (first && *c.p == '*')) {
+                if (*c.p == '.') c.p++;
+                if (*c.p == '*') {
+                    c.p++;
+                    memset(step, 0, sizeof(*step));
+                    step->kind = PATH_WILDCARD;
+                } else if (path_name_byte(*c.p)) {
+                    size_t key_len;
+                    char* key = path_name(&c, &key_len);
+                    path_key(step, key, key_len);
+                } else {
+                    path_error(&c, "expected a name or '*' after '.'");
+                    goto fail;
+                }
+            } else if (*c.p == '[') {
+                c.p++;
+                if (!path_bracket(&c, step)) goto fail;
+            } else if (first && path_name_byte(*c.p)) {
+                size_t key_len;
+                char* key = path_name(&c, &key_len);
+                path_key(step, key, key_len);
+            } else {
+                path_error(&c, "unexpected character");
+                goto fail;
+            }
+            c.front++;
+            first = 0;
+        }
+    }
+
+    // Filter fields move down to follow the path's own steps.
+    if (c.back < cap) {
+        size_t i;
+        memmove(&c.steps[c.front], &c.steps[c.back], (cap - c.back) * sizeof(PathStep));
+        for (i = 0; i < c.front; i++) {
+            if (c.steps[i].kind == PATH_FILTER) c.steps[i].field -= c.back - c.front;
+        }
+    }
+    path->count = c.front;
+    path->steps = c.steps;
+    return path;
+
+fail:
+    free(path);
+    return NULL;
+}
+
+void xon_path_free(XonPath* path) {
+    free(path);
+}
+
+static const DataNode* path_step_key(const PathStep* step, const DataNode* node) {
+    if (!node) return NULL;
+    if (node->type == TYPE_OBJECT && !node->data.aggregate.key) {
+        return object_member(node, step->key, step->key_len, step->hash);
+    }
+    if (node->type == TYPE_LIST && step->index >= 0) return container_item_at(node, (size_t)step->index);
+    return NULL;
+}
+
+static int path_compare(const DataNode* value, const PathStep* step) {
+    const DataNode* literal = &step->literal;
+    int order;
+
+    if (step->op == PATH_TRUTHY) {
+        return value->type != TYPE_NULL && !(value->type == TYPE_BOOL && !value->data.b_val);
+    }
+    if (step->op == PATH_EQ) return values_equal(value, literal);
+    if (step->op == PATH_NE) return !values_equal(value, literal);
+    if (value->type == TYPE_NUMBER && literal->type == TYPE_NUMBER) {
+        if (value->data.n_val != value->data.n_val) return 0;
+        order = value->data.n_val < literal->data.n_val ? -1 : value->data.n_val > literal->data.n_val;
+    } else if (value->type == TYPE_STRING && literal->type == TYPE_STRING && value->data.str.s_val) {
+        size_t len = value->data.str.s_len < literal->data.str.s_len ? value->data.str.s_len : literal->data.str.s_len;
+        order = memcmp(value->data.str.s_val, literal->data.str.s_val, len);
+        if (order == 0) order = (value->data.str.s_len > len) - (literal->data.str.s_len > len);
+    } else {
+        return 0;
+    }
+    switch (step->op) {
+        case PATH_LT: return order < 0;
+        case PATH_LE: return order <= 0;
+        case PATH_GT: return order > 0;
+        default: return order >= 0;
+    }
+}
+
+static int path_filter_match(const XonPath* path, const PathStep* step, const DataNode* item) {
+    size_t i;
+    for (i = 0; i < step->fields && item; i++) item = path_step_key(&path->steps[step->field + i], item);
+    return item && path_compare(item, step);
+}
+
+// Returns 0 once the callback has asked to stop.
+static int path_walk(const XonPath* path, size_t at, const DataNode* node, XonPathCallback on_match,
+                     void* user_data, size_t* matches) {
+    while (node && at < path->count) {
+        const PathStep* step = &path->steps[at];
+
+        if (step->kind == PATH_KEY) {
+            node = path_step_key(step, node);
+        } else if (step->kind == PATH_INDEX) {
+            long index = step->index;
+            if (node->type != TYPE_LIST) return 1;
+            if (index < 0) index += (long)container_size(node);
+            if (index < 0) return 1;
+            node = container_item_at(node, (size_t)index);
+        } else {
+            // Wildcards and filters branch over the members or items.
+            XonIter it;
+            XonValue* child;
+            if (!xon_iter_begin(node, &it)) return 1;
+            while (xon_iter_next(&it, NULL, &child)) {
+                if (step->kind == PATH_FILTER && (!child || !path_filter_match(path, step, child))) continue;
+                if (!path_walk(path, at + 1, child, on_match, user_data, matches)) return 0;
+            }
+            return 1;
+        }
+        at++;
+    }
+    if (!node) return 1;
+    (*matches)++;
+    return on_match ? on_match(user_data, node) : 1;
+}
+
+size_t xon_path_each(const XonPath* path, const XonValue* root, XonPathCallback on_match, void* user_data) {
+    size_t matches = 0;
+    if (!path || !root) return 0;
+    path_walk(path, 0, root, on_match, user_data, &matches);
+    return matches;
+}
+
+static int path_first(void* user_data, const XonValue* value) {
+    *(const XonValue**)user_data = value;
+    return 0;
+}
+
+XonValue* xon_path_eval(const XonPath* path, const XonValue* root) {
+    const XonValue* first = NULL;
+    xon_path_each(path, root, path_first, (void*)&first);
+    return (XonValue*)first;
+}
+
+// ============ Struct extraction ============
+
+// Members are matched against the descriptor after the previous match, so
+// objects written in descriptor order never hash a key. The first miss hashes
+// the descriptors (once per call, once per list for xon_extract_list) into a
+// small open-addressing table, probed with the hash an indexed object already
+// cached on the pair.
+#define EXTRACT_INLINE_FIELDS 32
+
+typedef struct {
+    const XonFieldDesc* fields;
+    size_t count;
+    size_t mask; // 0 until the table is built
+    size_t* hashes;
+    uint32_t* slots; // descriptor positions + 1
+    unsigned char* seen;
+    void* table_heap;
+    void* seen_heap;
+    size_t hash_buf[EXTRACT_INLINE_FIELDS];
+    uint32_t slot_buf[EXTRACT_INLINE_FIELDS * 2];
+    unsigned char seen_buf[EXTRACT_INLINE_FIELDS];
+} ExtractPlan;
+
+static void extract_error(const char* key, const char* message) {
+    fprintf(stderr, "Xon Extract Error: field '%s': %s\n", key, message);
+    xon_log_error("extract", "Field '%s': %s", key, message);
+}
+
+static int extract_plan_init(ExtractPlan* plan, const XonFieldDesc* fields, size_t n) {
+    size_t i;
+
+    memset(plan, 0, offsetof(ExtractPlan, hash_buf));
+    if (n > UINT32_MAX / 2) return 0;
+    for (i = 0; i < n; i++) {
+        if (!fields[i].key) return 0;
+    }
+    plan->fields = fields;
+    plan->count = n;
+    if (n <= EXTRACT_INLINE_FIELDS) {
+        plan->seen = plan->seen_buf;
+    } else {
+        plan->seen_heap = malloc(n);
+        if (!plan->seen_heap) return 0;
+        plan->seen = (unsigned char*)plan->seen_heap;
+    }
+    return 1;
+}
+
+static void extract_plan_free(ExtractPlan* plan) {
+    free(plan->table_heap);
+    free(plan->seen_heap);
+}
+
+static int extract_plan_build_table(ExtractPlan* plan) {
+    size_t slots = 2;
+    size_t i;
+
+    while (slots < plan->count * 2) slots <<= 1;
+    if (plan->count <= EXTRACT_INLINE_FIELDS) {
+        plan->hashes = plan->hash_buf;
+        plan->slots = plan->slot_buf;
+    } else {
+        plan->table_heap = malloc(plan->count * sizeof(size_t) + slots * sizeof(uint32_t));
+        if (!plan->table_heap) return 0;
+        plan->hashes = (size_t*)plan->table_heap;
+        plan->slots = (uint32_t*)(plan->hashes + plan->count);
+    }
+    memset(plan->slots, 0, slots * sizeof(uint32_t));
+    plan->mask = slots - 1;
+    for (i = 0; i < plan->count; i++) {
+        size_t at;
+        plan->hashes[i] = index_key_hash(plan->fields[i].key, strlen(plan->fields[i].key));
+        at = plan->hashes[i] & plan->mask;
+        while (plan->slots[at]) at = (at + 1) & plan->mask;
+        plan->slots[at] = (uint32_t)(i + 1);
+    }
+    return 1;
+}
+
+static int extract_key_is(const XonFieldDesc* field, const DataNode* key) {
+    return strncmp(field->key, key->data.str.s_val, key->data.str.s_len) == 0 &&
+           field->key[key->data.str.s_len] == '\0';
+}
+
+// *found is NULL for members no descriptor names; returns 0 only when the
+// table cannot be allocated.
+static int extract_plan_find(ExtractPlan* plan, const DataNode* pair, size_t cursor, const XonFieldDesc** found) {
+    const DataNode* key = pair->data.aggregate.key;
+    size_t hash;
+    size_t at;
+    uint32_t slot;
+
+    *found = NULL;
+    if (cursor < plan->count && extract_key_is(&plan->fields[cursor], key)) {
+        *found = &plan->fields[cursor];
+        return 1;
+    }
+    if (!plan->mask && !extract_plan_build_table(plan)) return 0;
+    hash = pair->data.aggregate.cache.key_hash;
+    if (!hash) hash = index_key_hash(key->data.str.s_val, key->data.str.s_len);
+    for (at = hash & plan->mask; (slot = plan->slots[at]) != 0; at = (at + 1) & plan->mask) {
+        if (plan->hashes[slot - 1] == hash && extract_key_is(&plan->fields[slot - 1], key)) {
+            *found = &plan->fields[slot - 1];
+            break;
+        }
+    }
+    return 1;
+}
+
+// Numbers, including -N as the grammar leaves it before evaluation.
+static int extract_number(const DataNode* node, double* out) {
+    if (node->type == TYPE_NUMBER) {
+        *out = node->data.n_val;
+        return 1;
+    }
+    if (node->type == TYPE_EXPR && node->data.expr && node->data.expr->kind == XON_EXPR_UNARY &&
+        node->data.expr->u.unary.op == XON_EXPR_OP_NEG && node->data.expr->u.unary.operand &&
+        node->data.expr->u.unary.operand->type == TYPE_NUMBER) {
+        *out = -node->data.expr->u.unary.operand->data.n_val;
+        return 1;
+    }
+    return 0;
+}
+
+// node NULL stores the field's default.
+static int extract_store(const XonFieldDesc* field, const DataNode* node, void* out) {
+    char* at = (char*)out + field->offset;
+    double number = field->default_number;
+
+    switch (field->type) {
+        case XON_FIELD_BOOL:
+            if (node && node->type != TYPE_BOOL) break;
+            *(int*)at = node ? node->data.b_val != 0 : number != 0.0;
+            return 1;
+        case XON_FIELD_INT:
+            if (node && !extract_number(node, &number)) break;
+            if (!(number >= (double)INT_MIN && number <= (double)INT_MAX) || number != (double)(int)number) {
+                extract_error(field->key, "expected a whole number that fits in an int");
+                return 0;
+            }
+            *(int*)at = (int)number;
+            return 1;
+        case XON_FIELD_DOUBLE:
+            if (node && !extract_number(node, &number)) break;
+            *(double*)at = number;
+            return 1;
+        case XON_FIELD_STRING:
+            if (node && node->type != TYPE_STRING) break;
+            *(const char**)at = node ? node->data.str.s_val : field->default_string;
+            return 1;
+        case XON_FIELD_VALUE:
+            *(const XonValue**)at = node;
+            return 1;
+    }
+    if (field->type == XON_FIELD_BOOL) {
+        extract_error(field->key, "expected a boolean");
+    } else if (field->type == XON_FIELD_STRING) {
+        extract_error(field->key, "expected a string");
+    } else {
+        extract_error(field->key, "expected a number");
+    }
+    return 0;
+}
+
+static int extract_object(ExtractPlan* plan, const DataNode* object, void* out) {
+    const DataNode* pair;
+    size_t cursor = 0;
+    size_t i;
+
+    if (!object || object->type != TYPE_OBJECT || object->data.aggregate.key) {
+        fprintf(stderr, "Xon Extract Error: expected an object\n");
+        xon_log_error("extract", "Expected an object");
+        return 0;
+    }
+    memset(plan->seen, 0, plan->count);
+    for (pair = object->data.aggregate.value; pair; pair = pair->next) {
+        const XonFieldDesc* field;
+
+        if (!pair_has_key(pair) || !pair->data.aggregate.value || pair->data.aggregate.value->type == TYPE_NULL) {
+            continue;
+        }
+        if (!extract_plan_find(plan, pair, cursor, &field)) return 0;
+        if (!field) continue;
+        cursor = (size_t)(field - plan->fields) + 1;
+        // The first of duplicate keys wins, as in xon_object_get().
+        if (plan->seen[field - plan->fields]) continue;
+        if (!extract_store(field, pair->data.aggregate.value, out)) return 0;
+        plan->seen[field - plan->fields] = 1;
+    }
+
+    for (i = 0; i < plan->count; i++) {
+        if (plan->seen[i]) continue;
+        if (plan->fields[i].required) {
+            extract_error(plan->fields[i].key, "required field is missing");
+            return 0;
+        }
+        if (!extract_store(&plan->fields[i], NULL, out)) return 0;
+    }
+    return 1;
+}
+
+int xon_extract(const XonValue* value, const XonFieldDesc* fields, size_t n, void* out_struct) {
+    ExtractPlan plan;
+    int ok;
+
+    if ((!fields && n > 0) || !out_struct) return 0;
+    xon_logger_init("xon");
+    if (!extract_plan_init(&plan, fields, n)) return 0;
+    ok = extract_object(&plan, value, out_struct);
+    extract_plan_free(&plan);
+    return ok;
+}
+
+int xon_extract_list(const XonValue* value, const XonFieldDesc* fields, size_t n, void* out_array, size_t stride,
+                     size_t capacity, size_t* count) {
+    ExtractPlan plan;
+    const DataNode* item;
+    size_t written = 0;
+    int ok = 1;
+
+    if (count) *count = 0;
+    if ((!fields && n > 0) || (!out_array && capacity > 0)) return 0;
+    xon_logger_init("xon");
+    if (!value || value->type != TYPE_LIST) {
+        fprintf(stderr, "Xon Extract Error: expected a list\n");
+        xon_log_error("extract", "Expected a list");
+        return 0;
+    }
+    if (!extract_plan_init(&plan, fields, n)) return 0;
+    for (item = value->data.aggregate.value; item; item = item->next) {
+        if (written == capacity) {
+            fprintf(stderr, "Xon Extract Error: list has more than %zu items\n", capacity);
+            xon_log_error("extract", "List has more than %zu items", capacity);
+            ok = 0;
+            break;
+        }
+        if (!extract_object(&plan, item, (char*)out_array + written * stride)) {
+            ok = 0;
+            break;
+        }
+        written++;
+    }
+    extract_plan_free(&plan);
+    if (count) *count = written;
+    return ok;
 }
 
 char* xon_to_json(const XonValue* value, int pretty) {
@@ -2230,6 +6694,22 @@ void xon_enable_stderr_logging(int enabled) {
     xon_logger_enable_stderr(enabled);
 }
 
+void xon_enable_arena(int enabled) {
+    g_use_arena = enabled ? 1 : 0;
+}
+
+void xon_enable_tape(int enabled) {
+    g_use_tape = enabled ? 1 : 0;
+}
+
+void xon_set_json_mode(XonJsonMode mode) {
+    g_json_mode = mode;
+}
+
+void xon_set_parse_threads(int threads) {
+    g_parse_threads = threads < 0 ? 1 : threads;
+}
+
 void xon_shutdown_logging(void) {
     xon_logger_shutdown();
 }
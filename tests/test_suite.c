@@ -2,8 +2,11 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include "../include/xon_api.h"
+#include "../src/scan.h"
+#include "../src/structural.h"
 
 static void test_parse_core_features(void) {
     const char* input =
@@ -306,16 +309,49 @@ static void test_function_arity_and_call_failures(void) {
 
 static void test_object_iteration(void) {
     XonValue* root = xonify_string("{ first: 1, second: 2, third: 3 }");
+    XonValue* value;
+    const char* key;
+    XonIter it;
+    size_t i;
+
     assert(root != NULL);
     assert(xon_object_size(root) == 3);
     assert(strcmp(xon_object_key_at(root, 0), "first") == 0);
     assert(strcmp(xon_object_key_at(root, 1), "second") == 0);
     assert((int)xon_get_number(xon_object_value_at(root, 2)) == 3);
     xon_free(root);
+
+    // Iterators visit members in order and skip declarations.
+    root = xonify_string("{ let k = 4, first: 1, \"se cond\": [2, \"x\", null], const c = 5, third: k }");
+    assert(root != NULL);
+    assert(xon_iter_begin(root, &it) == 1);
+    assert(xon_iter_next(&it, &key, &value) == 1 && strcmp(key, "first") == 0);
+    assert((int)xon_get_number(value) == 1);
+    assert(xon_iter_next(&it, &key, &value) == 1 && strcmp(key, "se cond") == 0);
+    assert(xon_iter_begin(value, &it) == 1);
+    assert(xon_iter_next(&it, &key, &value) == 1 && key == NULL && (int)xon_get_number(value) == 2);
+    assert(xon_iter_next(&it, NULL, &value) == 1 && strcmp(xon_get_string(value), "x") == 0);
+    assert(xon_iter_next(&it, NULL, NULL) == 1);
+    assert(xon_iter_next(&it, &key, &value) == 0 && xon_iter_next(&it, &key, &value) == 0);
+    assert(xon_iter_begin(root, &it) == 1);
+    for (i = 0; xon_iter_next(&it, &key, NULL); i++) {
+        assert(strcmp(key, i == 0 ? "first" : i == 1 ? "se cond" : "third") == 0);
+    }
+    assert(i == 3);
+    value = xon_eval(root);
+    assert(value != NULL && xon_iter_begin(value, &it) == 1);
+    for (i = 0; xon_iter_next(&it, NULL, NULL);) i++;
+    assert(i == 3);
+    xon_free(value);
+
+    assert(xon_iter_begin(xon_object_get(root, "first"), &it) == 0 && xon_iter_next(&it, &key, &value) == 0);
+    assert(xon_iter_begin(NULL, &it) == 0 && xon_iter_next(&it, &key, &value) == 0);
+    xon_free(root);
 }
 
 static void test_serialization(void) {
     XonValue* root = xonify_string("{ name: \"A\", list: [1, 2] }");
+    XonValue* evaluated;
     char* json;
     char* xon;
     assert(root != NULL);
@@ -330,6 +366,20 @@ static void test_serialization(void) {
     xon_string_free(json);
     xon_string_free(xon);
     xon_free(root);
+
+    // Whole numbers skip snprintf() but print as "%.17g" does.
+    root = xonify_string("[0, 42, 99999999999999984, 100000000000000000, 2.5, 1e300, 0.1]");
+    json = xon_to_json(root, 0);
+    assert(json && strcmp(json, "[0,42,99999999999999984,1e+17,2.5,1.0000000000000001e+300,0.10000000000000001]") == 0);
+    xon_string_free(json);
+    xon_free(root);
+    root = xonify_string("[-0, -7]");
+    evaluated = xon_eval(root);
+    json = xon_to_json(evaluated, 0);
+    assert(json && strcmp(json, "[-0,-7]") == 0);
+    xon_string_free(json);
+    xon_free(evaluated);
+    xon_free(root);
 }
 
 static void test_json_input_supported(void) {
@@ -340,6 +390,1618 @@ static void test_json_input_supported(void) {
     xon_free(root);
 }
 
+static void test_buffer_parse_without_terminator(void) {
+    const char input[] = "{ name: \"Span\", count: 3 }trailing-bytes-not-parsed";
+    size_t len = strlen("{ name: \"Span\", count: 3 }");
+    XonValue* root = xonify_buffer(input, len);
+    assert(root != NULL);
+    assert(strcmp(xon_get_string(xon_object_get(root, "name")), "Span") == 0);
+    assert((int)xon_get_number(xon_object_get(root, "count")) == 3);
+    xon_free(root);
+
+    assert(xonify_buffer(input, len - 1) == NULL);
+}
+
+static void test_file_input_mapped_and_piped(void) {
+    const char* doc = "{ source: \"file\", sizes: [1, 2, 3] }\n";
+    char path[] = "/tmp/xon_test_input_XXXXXX";
+    char pipe_path[64];
+    int fds[2];
+    int fd = mkstemp(path);
+    XonValue* root;
+
+    assert(fd >= 0);
+    assert(write(fd, doc, strlen(doc)) == (ssize_t)strlen(doc));
+    close(fd);
+
+    root = xonify(path);
+    assert(root != NULL);
+    assert(strcmp(xon_get_string(xon_object_get(root, "source")), "file") == 0);
+    assert(xon_list_size(xon_object_get(root, "sizes")) == 3);
+    xon_free(root);
+    unlink(path);
+
+    assert(pipe(fds) == 0);
+    assert(write(fds[1], doc, strlen(doc)) == (ssize_t)strlen(doc));
+    close(fds[1]);
+    snprintf(pipe_path, sizeof(pipe_path), "/dev/fd/%d", fds[0]);
+    root = xonify(pipe_path);
+    close(fds[0]);
+    assert(root != NULL);
+    assert(xon_list_size(xon_object_get(root, "sizes")) == 3);
+    xon_free(root);
+
+    assert(xonify("/tmp/xon_test_input_missing.xon") == NULL);
+}
+
+static void test_scan_kernels_all_levels(void) {
+    char ws[200];
+    char comment[300];
+    char doc[1024];
+    size_t doc_len;
+    int level;
+
+    // 150 whitespace bytes with 10 newlines, spanning several 16/32-byte blocks.
+    memset(ws, ' ', sizeof(ws));
+    for (level = 0; level < 10; level++) ws[level * 13 + 5] = '\n';
+    ws[17] = '\t';
+    ws[150] = 'x';
+
+    // Block comment body with 3 newlines, a decoy '*' and the close at a block edge.
+    memset(comment, 'c', sizeof(comment));
+    comment[3] = '\n';
+    comment[40] = '\n';
+    comment[62] = '*';
+    comment[95] = '\n';
+    comment[126] = '*';
+    comment[127] = '/';
+
+    doc_len = (size_t)snprintf(doc, sizeof(doc),
+        "{\n"
+        "  /* header\n   comment */   a: 1,   # trailing hash comment\n"
+        "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\tb: \"two\", // line comment ****/\n"
+        "  /**/ c: [1, /* inner ** */ 2],\n"
+        "}\n");
+
+    for (level = XON_SCAN_SCALAR; level <= XON_SCAN_AVX2; level++) {
+        int lines = 0;
+        const char* end;
+        XonValue* root;
+
+        xon_scan_set_level((XonScanLevel)level);
+
+        end = xon_scan_skip_ws(ws, ws + sizeof(ws), &lines);
+        assert(end == ws + 150);
+        assert(lines == 10);
+
+        lines = 0;
+        end = xon_scan_block_comment(comment, comment + sizeof(comment), &lines);
+        assert(end == comment + 128);
+        assert(lines == 3);
+
+        lines = 0;
+        assert(xon_scan_block_comment(comment, comment + 127, &lines) == NULL);
+        assert(lines == 3);
+
+        assert(xon_scan_find_byte(comment, comment + sizeof(comment), '/') == comment + 127);
+        assert(xon_scan_find_byte(ws, ws + 150, '#') == ws + 150);
+
+        lines = 0;
+        assert(xon_scan_string(ws, ws + sizeof(ws), &lines) == ws + sizeof(ws));
+        assert(lines == 10);
+        lines = 0;
+        comment[100] = '\\';
+        assert(xon_scan_string(comment, comment + sizeof(comment), &lines) == comment + 100);
+        assert(lines == 3);
+        comment[100] = 'c';
+
+        root = xonify_buffer(doc, doc_len);
+        assert(root != NULL);
+        assert((int)xon_get_number(xon_object_get(root, "a")) == 1);
+        assert(strcmp(xon_get_string(xon_object_get(root, "b")), "two") == 0);
+        assert(xon_list_size(xon_object_get(root, "c")) == 2);
+        xon_free(root);
+
+        assert(xonify_string("{ a: 1 /* never closed ") == NULL);
+    }
+}
+
+static void test_string_literals_scanned_with_length(void) {
+    const char* input =
+        "{\n"
+        "  plain: \"a plain string that is long enough to span several vector blocks\",\n"
+        "  escaped: \"tab\\there, quote \\\" and slash \\\\ at the end\\n\",\n"
+        "  multi: \"line one\nline two\",\n"
+        "  \"quoted key with spaces\": \"\",\n"
+        "  joined: \"abc\" + \"defg\",\n"
+        "  size: len(\"0123456789012345678901234567890123456789\"),\n"
+        "}\n";
+    XonValue* root = xonify_string(input);
+    XonValue* evaluated;
+    XonValue* value;
+    char* json;
+
+    assert(root != NULL);
+    value = xon_object_get(root, "plain");
+    assert(xon_get_string_length(value) == strlen(xon_get_string(value)));
+    assert(xon_get_string_length(value) == 64);
+
+    value = xon_object_get(root, "escaped");
+    assert(strcmp(xon_get_string(value), "tab\there, quote \" and slash \\ at the end\n") == 0);
+    assert(xon_get_string_length(value) == strlen(xon_get_string(value)));
+
+    value = xon_object_get(root, "multi");
+    assert(strcmp(xon_get_string(value), "line one\nline two") == 0);
+
+    value = xon_object_get(root, "quoted key with spaces");
+    assert(xon_is_string(value));
+    assert(xon_get_string_length(value) == 0);
+    assert(xon_get_string_length(xon_object_get(root, "size")) == 0);
+
+    json = xon_to_json(root, 0);
+    assert(json != NULL);
+    assert(strstr(json, "\"tab\\there, quote \\\" and slash \\\\ at the end\\n\"") != NULL);
+    xon_string_free(json);
+
+    evaluated = xon_eval(root);
+    assert(evaluated != NULL);
+    value = xon_object_get(evaluated, "joined");
+    assert(strcmp(xon_get_string(value), "abcdefg") == 0);
+    assert(xon_get_string_length(value) == 7);
+    assert((int)xon_get_number(xon_object_get(evaluated, "size")) == 40);
+    xon_free(evaluated);
+    xon_free(root);
+
+    assert(xonify_string("{ s: \"never closed }") == NULL);
+    assert(xonify_string("{ s: \"dangling escape \\") == NULL);
+}
+
+static void test_number_literals_correctly_rounded(void) {
+    char input[512];
+    XonValue* root;
+    int n;
+
+    // The last literal is longer than the old 128-byte token buffer.
+    n = snprintf(input, sizeof(input),
+        "[0.1, 0.3, 9007199254740993, 1.7976931348623157e308, 4.9406564584124654e-324,"
+        " 2.2250738585072011e-308, 0x1F, 12345678901234567890123, 1e23, 0e999, 7.,"
+        " 3.%s]", "1415926535897932384626433832795028841971693993751058209749445923078164062862089986280348253421170679"
+                  "8214808651328230664709384460955058223172535940812848111745028410270193852110555964462294895493038196");
+    assert(n > 0 && (size_t)n < sizeof(input));
+
+    root = xonify_string(input);
+    assert(root != NULL);
+    assert(xon_list_size(root) == 12);
+    assert(xon_get_number(xon_list_get(root, 0)) == 0.1);
+    assert(xon_get_number(xon_list_get(root, 1)) == 0.3);
+    assert(xon_get_number(xon_list_get(root, 2)) == 9007199254740992.0);
+    assert(xon_get_number(xon_list_get(root, 3)) == 1.7976931348623157e308);
+    assert(xon_get_number(xon_list_get(root, 4)) == 4.9406564584124654e-324);
+    assert(xon_get_number(xon_list_get(root, 5)) == 2.2250738585072011e-308);
+    assert(xon_get_number(xon_list_get(root, 6)) == 31.0);
+    assert(xon_get_number(xon_list_get(root, 7)) == 12345678901234567890123.0);
+    assert(xon_get_number(xon_list_get(root, 8)) == 1e23);
+    assert(xon_get_number(xon_list_get(root, 9)) == 0.0);
+    assert(xon_get_number(xon_list_get(root, 10)) == 7.0);
+    assert(xon_get_number(xon_list_get(root, 11)) == 3.141592653589793);
+    xon_free(root);
+
+    assert(xonify_string("[1e400]") == NULL);
+    assert(xonify_string("[1e-400]") == NULL);
+    assert(xonify_string("[1.2.3]") == NULL);
+    assert(xonify_string("[1e+]") == NULL);
+    assert(xonify_string("[0x]") == NULL);
+}
+
+static void test_keywords_and_identifier_spans(void) {
+    char input[1024];
+    char long_name[201];
+    XonValue* root;
+    XonValue* evaluated;
+    int n;
+
+    memset(long_name, 'k', 200);
+    long_name[200] = '\0';
+
+    // Near-misses of every keyword must lex as identifiers.
+    n = snprintf(input, sizeof(input),
+        "{\n"
+        "  let lets = 1,\n"
+        "  const iff = 2,\n"
+        "  nul: 3, nulls: 4, trues: 5, falsey: 6, elsewhere: 7, constant: 8, le: 9,\n"
+        "  _if: true, $else: false, null_: null,\n"
+        "  %s: 10,\n"
+        "  sum: lets + iff,\n"
+        "  pick: if (true) lets else iff,\n"
+        "}\n", long_name);
+    assert(n > 0 && (size_t)n < sizeof(input));
+
+    root = xonify_string(input);
+    assert(root != NULL);
+    assert((int)xon_get_number(xon_object_get(root, "nul")) == 3);
+    assert((int)xon_get_number(xon_object_get(root, "constant")) == 8);
+    assert((int)xon_get_number(xon_object_get(root, "le")) == 9);
+    assert(xon_get_bool(xon_object_get(root, "_if")) == 1);
+    assert(xon_is_bool(xon_object_get(root, "$else")));
+    assert(xon_is_null(xon_object_get(root, "null_")));
+    assert((int)xon_get_number(xon_object_get(root, long_name)) == 10);
+
+    evaluated = xon_eval(root);
+    assert(evaluated != NULL);
+    assert((int)xon_get_number(xon_object_get(evaluated, "sum")) == 3);
+    assert((int)xon_get_number(xon_object_get(evaluated, "pick")) == 1);
+    xon_free(evaluated);
+    xon_free(root);
+
+    assert(xonify_string("{ a: @ }") == NULL);
+}
+
+static void test_large_containers_linear_build(void) {
+    size_t count = 200000;
+    size_t cap = count * 24 + 64;
+    size_t len = 0;
+    size_t i;
+    char* input = (char*)malloc(cap);
+    XonValue* root;
+    XonValue* fn;
+
+    assert(input != NULL);
+    input[len++] = '[';
+    for (i = 0; i < count; i++) {
+        len += (size_t)snprintf(input + len, cap - len, "%zu,", i);
+    }
+    input[len++] = ']';
+
+    root = xonify_buffer(input, len);
+    assert(root != NULL);
+    assert(xon_list_size(root) == count);
+    // Indexed access is O(1), so a full indexed walk stays linear.
+    for (i = 0; i < count; i++) assert((size_t)xon_get_number(xon_list_get(root, i)) == i);
+    assert(xon_list_get(root, count) == NULL);
+    fn = xon_eval(root);
+    assert(fn != NULL && xon_list_size(fn) == count);
+    for (i = 0; i < count; i += 997) assert((size_t)xon_get_number(xon_list_get(fn, i)) == i);
+    assert(xon_list_get(fn, count) == NULL);
+    xon_free(fn);
+    xon_free(root);
+
+    len = 0;
+    input[len++] = '{';
+    for (i = 0; i < count; i++) {
+        len += (size_t)snprintf(input + len, cap - len, "k%zu: %zu,", i, i);
+    }
+    input[len++] = '}';
+
+    root = xonify_buffer(input, len);
+    assert(root != NULL);
+    assert(xon_object_size(root) == count);
+    assert(strcmp(xon_object_key_at(root, 0), "k0") == 0);
+    assert((size_t)xon_get_number(xon_object_get(root, "k199999")) == count - 1);
+    for (i = 0; i < count; i++) assert((size_t)xon_get_number(xon_object_value_at(root, i)) == i);
+    assert(strcmp(xon_object_key_at(root, count - 1), "k199999") == 0);
+    assert(xon_object_key_at(root, count) == NULL && xon_object_value_at(root, count) == NULL);
+    xon_free(root);
+    free(input);
+
+    // Argument and parameter lists keep their order too.
+    root = xonify_string("{ let f = (a, b, c, d) => a - b + c * d, r: f(10, 4, 2, 3) }");
+    assert(root != NULL);
+    fn = xon_eval(root);
+    assert(fn != NULL);
+    assert((int)xon_get_number(xon_object_get(fn, "r")) == 12);
+    xon_free(fn);
+    xon_free(root);
+}
+
+static void test_arena_documents(void) {
+    XonValue* root;
+    XonValue* evaluated;
+    char* json;
+
+    xon_enable_arena(1);
+    root = xonify_string(
+        "{ let base = 10, let add = (a, b) => a + b,\n"
+        "  name: \"edge\", tags: [\"a\\n\", \"b\"], port: 8080, limit: add(base, 30) }");
+    assert(root != NULL);
+    assert(strcmp(xon_get_string(xon_object_get(root, "name")), "edge") == 0);
+    assert(strcmp(xon_get_string(xon_list_get(xon_object_get(root, "tags"), 0)), "a\n") == 0);
+    assert((int)xon_get_number(xon_object_get(root, "port")) == 8080);
+
+    // Evaluated values are heap-owned and outlive the arena document.
+    evaluated = xon_eval(root);
+    xon_free(root);
+    assert(evaluated != NULL);
+    assert((int)xon_get_number(xon_object_get(evaluated, "limit")) == 40);
+    json = xon_to_json(evaluated, 0);
+    assert(json != NULL);
+    assert(strstr(json, "\"limit\":40") != NULL);
+    xon_string_free(json);
+    xon_free(evaluated);
+
+    // Failed parses release the arena without returning a root.
+    assert(xonify_string("{ a: [1, 2 }") == NULL);
+    assert(xonify_string("{ a: \"unterminated }") == NULL);
+
+    xon_enable_arena(0);
+    root = xonify_string("{ a: 1 }");
+    assert(root != NULL);
+    xon_free(root);
+}
+
+static char* nested_document(const char* open, const char* leaf, const char* close, size_t depth, size_t* out_len) {
+    size_t open_len = strlen(open);
+    size_t leaf_len = strlen(leaf);
+    size_t close_len = strlen(close);
+    size_t len = depth * (open_len + close_len) + leaf_len;
+    char* out = (char*)malloc(len);
+    char* p = out;
+    size_t i;
+
+    assert(out != NULL);
+    for (i = 0; i < depth; i++, p += open_len) memcpy(p, open, open_len);
+    memcpy(p, leaf, leaf_len);
+    p += leaf_len;
+    for (i = 0; i < depth; i++, p += close_len) memcpy(p, close, close_len);
+    *out_len = len;
+    return out;
+}
+
+static void test_long_and_deep_documents(void) {
+    size_t count = 10000000;
+    size_t depth = 100000;
+    size_t len = 0;
+    size_t i;
+    char* input;
+    XonValue* root;
+    XonValue* copy;
+    const XonValue* cursor;
+
+    // 10M-element list: built, copied by eval and freed without recursion.
+    input = (char*)malloc(count * 2 + 1);
+    assert(input != NULL);
+    input[len++] = '[';
+    for (i = 0; i < count; i++) {
+        input[len++] = (char)('0' + i % 10);
+        input[len++] = ',';
+    }
+    input[len - 1] = ']';
+    root = xonify_buffer(input, len);
+    free(input);
+    assert(root != NULL);
+    assert(xon_list_size(root) == count);
+    copy = xon_eval(root);
+    assert(copy != NULL);
+    assert(xon_list_size(copy) == count);
+    assert((int)xon_get_number(xon_list_get(copy, count - 1)) == 9);
+    xon_free(copy);
+    xon_free(root);
+
+    // 100k levels of nested lists and objects.
+    input = nested_document("[", "1", "]", depth, &len);
+    root = xonify_buffer(input, len);
+    free(input);
+    assert(root != NULL);
+    copy = xon_eval(root);
+    assert(copy != NULL);
+    cursor = copy;
+    for (i = 1; i < depth; i++) cursor = xon_list_get(cursor, 0);
+    assert(xon_get_number(xon_list_get(cursor, 0)) == 1);
+    xon_free(copy);
+    xon_free(root);
+
+    input = nested_document("{a:", "true", "}", depth, &len);
+    root = xonify_buffer(input, len);
+    free(input);
+    assert(root != NULL);
+    copy = xon_eval(root);
+    assert(copy != NULL);
+    cursor = copy;
+    for (i = 1; i < depth; i++) cursor = xon_object_get(cursor, "a");
+    assert(xon_get_bool(xon_object_get(cursor, "a")) == 1);
+    xon_free(copy);
+    xon_free(root);
+
+    // Deeply nested expressions are released iteratively too.
+    input = nested_document("-(", "1", ")", depth, &len);
+    {
+        char* wrapped = (char*)malloc(len + 2);
+        assert(wrapped != NULL);
+        wrapped[0] = '[';
+        memcpy(wrapped + 1, input, len);
+        wrapped[len + 1] = ']';
+        root = xonify_buffer(wrapped, len + 2);
+        free(wrapped);
+    }
+    free(input);
+    assert(root != NULL);
+    xon_free(root);
+}
+
+static void test_parser_context_reuse(void) {
+    const char* doc = "{ name: \"svc\", port: 8080, tags: [\"a\", \"b\"], let base = 2, scaled: base * 21 }";
+    XonParser* parser = xon_parser_new();
+    XonValue* first;
+    XonValue* second;
+    XonValue* evaluated;
+    int i;
+
+    assert(parser != NULL);
+    first = xon_parser_parse(parser, doc, strlen(doc));
+    second = xon_parser_parse(parser, doc, strlen(doc));
+    assert(first != NULL && second != NULL && first != second);
+    assert((int)xon_get_number(xon_object_get(first, "port")) == 8080);
+    assert(strcmp(xon_get_string(xon_list_get(xon_object_get(second, "tags"), 1)), "b") == 0);
+    // Repeated identifiers are interned once per context.
+    assert(xon_object_key_at(first, 0) == xon_object_key_at(second, 0));
+
+    // Context documents are released by reset; eval results are independent.
+    evaluated = xon_eval(first);
+    xon_free(first);
+    xon_parser_reset(parser);
+    assert(evaluated != NULL);
+    assert((int)xon_get_number(xon_object_get(evaluated, "scaled")) == 42);
+    xon_free(evaluated);
+
+    // A failed parse leaves the context usable.
+    assert(xon_parser_parse(parser, "{ a: [1, 2 }", 12) == NULL);
+    assert(xon_parser_parse(parser, "{ a: @ }", 8) == NULL);
+    for (i = 0; i < 1000; i++) {
+        first = xon_parser_parse(parser, doc, strlen(doc));
+        assert(first != NULL);
+        assert(strcmp(xon_get_string(xon_object_get(first, "name")), "svc") == 0);
+        if (i % 100 == 99) xon_parser_reset(parser);
+    }
+    xon_parser_free(parser);
+}
+
+typedef struct {
+    char log[512];
+    int events;
+    int stop_after;
+} SaxRecorder;
+
+static int sax_record(void* user_data, const char* fmt, const char* text, size_t len) {
+    SaxRecorder* rec = (SaxRecorder*)user_data;
+    size_t used = strlen(rec->log);
+    snprintf(rec->log + used, sizeof(rec->log) - used, fmt, (int)len, text);
+    rec->events++;
+    return rec->stop_after == 0 || rec->events < rec->stop_after;
+}
+
+static int rec_object_start(void* u) { return sax_record(u, "{%.*s", "", 0); }
+static int rec_object_end(void* u) { return sax_record(u, "}%.*s", "", 0); }
+static int rec_list_start(void* u) { return sax_record(u, "[%.*s", "", 0); }
+static int rec_list_end(void* u) { return sax_record(u, "]%.*s", "", 0); }
+static int rec_key(void* u, const char* key, size_t len) { return sax_record(u, "k:%.*s ", key, len); }
+static int rec_string(void* u, const char* s, size_t len) { return sax_record(u, "s:%.*s ", s, len); }
+static int rec_bool(void* u, int value) { return sax_record(u, "b:%.*s ", value ? "1" : "0", 1); }
+static int rec_null(void* u) { return sax_record(u, "null %.*s", "", 0); }
+static int rec_expression(void* u, const char* text, size_t len) { return sax_record(u, "e:%.*s ", text, len); }
+static int rec_number(void* u, double value) {
+    char num[32];
+    snprintf(num, sizeof(num), "%g", value);
+    return sax_record(u, "n:%.*s ", num, strlen(num));
+}
+static int rec_declaration(void* u, const char* name, size_t len, int is_const) {
+    return sax_record(u, is_const ? "const:%.*s " : "let:%.*s ", name, len);
+}
+
+static void sax_recorder_handler(XonSaxHandler* handler) {
+    memset(handler, 0, sizeof(*handler));
+    handler->on_object_start = rec_object_start;
+    handler->on_object_end = rec_object_end;
+    handler->on_list_start = rec_list_start;
+    handler->on_list_end = rec_list_end;
+    handler->on_key = rec_key;
+    handler->on_string = rec_string;
+    handler->on_number = rec_number;
+    handler->on_bool = rec_bool;
+    handler->on_null = rec_null;
+    handler->on_declaration = rec_declaration;
+    handler->on_expression = rec_expression;
+}
+
+// Converts doc through a seekable file and checks it against the tree
+// serializer, as the tree fallback may rewind over flushed output.
+static void assert_convert_matches_tree(const char* doc, int as_json) {
+    char path[] = "/tmp/xon_test_convert_XXXXXX";
+    XonValue* root;
+    char* expected;
+    char* streamed;
+    FILE* out;
+    long size;
+    int fd;
+
+    fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, doc, strlen(doc)) == (ssize_t)strlen(doc));
+    close(fd);
+    root = xonify(path);
+    assert(root != NULL);
+    expected = as_json ? xon_to_json(root, 1) : xon_to_xon(root, 1);
+    out = tmpfile();
+    assert(out != NULL);
+    assert(xon_convert_file(path, out, as_json, 1) == 1);
+    fseek(out, 0, SEEK_END);
+    size = ftell(out);
+    assert(size == (long)strlen(expected));
+    streamed = (char*)malloc((size_t)size + 1);
+    rewind(out);
+    assert(fread(streamed, 1, (size_t)size, out) == (size_t)size);
+    streamed[size] = '\0';
+    assert(strcmp(streamed, expected) == 0);
+    fclose(out);
+    free(streamed);
+    xon_string_free(expected);
+    xon_free(root);
+    unlink(path);
+}
+
+static void test_sax_events(void) {
+    const char* doc =
+        "{ let base = 2, name: \"svc\", \"port\": -8080,\n"
+        "  tags: [\"a\", true, null, {},], scaled: base * (1 + 2), f: (a, b) => { s: a + b } }";
+    const char* data_doc = "{ a: [1, 2.5, \"x\\ty\"], b: { c: null, d: false }, let hidden = 3, e: [] }";
+    XonSaxHandler handler;
+    SaxRecorder rec;
+    char path[] = "/tmp/xon_test_sax_XXXXXX";
+    char streamed[512];
+    FILE* out;
+    XonValue* root;
+    char* json;
+    char* big;
+    int i;
+    int fd;
+
+    sax_recorder_handler(&handler);
+
+    memset(&rec, 0, sizeof(rec));
+    assert(xon_sax_parse_buffer(doc, strlen(doc), &handler, &rec) == 1);
+    assert(strcmp(rec.log,
+                  "{let:base n:2 k:name s:svc k:port n:-8080 k:tags [s:a b:1 null {}]"
+                  "k:scaled e:base * (1 + 2) k:f e:(a, b) => { s: a + b } }") == 0);
+
+    // A callback can stop the parse early; syntax errors are still caught,
+    // including inside expressions.
+    memset(&rec, 0, sizeof(rec));
+    rec.stop_after = 3;
+    assert(xon_sax_parse_buffer(doc, strlen(doc), &handler, &rec) == -1);
+    assert(rec.events == 3);
+    assert(xon_sax_parse_buffer(doc, strlen(doc), NULL, NULL) == 1);
+    assert(xon_sax_parse_buffer("{ a: [1, 2 }", 12, NULL, NULL) == 0);
+    assert(xon_sax_parse_buffer("{ a: 1 + }", 10, NULL, NULL) == 0);
+    assert(xon_sax_parse_buffer("{ a: @ }", 8, NULL, NULL) == 0);
+    assert(xon_sax_parse_buffer("{} {}", 5, NULL, NULL) == 0);
+    assert(xon_sax_parse_buffer("42", 2, NULL, NULL) == 0);
+
+    // Streaming conversion matches the tree serializer on data documents.
+    fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, data_doc, strlen(data_doc)) == (ssize_t)strlen(data_doc));
+    close(fd);
+    root = xonify_string(data_doc);
+    assert(root != NULL);
+    json = xon_to_json(root, 1);
+    out = fmemopen(streamed, sizeof(streamed), "w");
+    assert(out != NULL);
+    assert(xon_convert_file(path, out, 1, 1) == 1);
+    fclose(out);
+    assert(strcmp(streamed, json) == 0);
+    xon_string_free(json);
+    xon_free(root);
+    unlink(path);
+
+    // Operators after container literals are converted through a tree, also
+    // once more than a flush of events went out before them.
+    assert_convert_matches_tree("{ a: {b: 1}.b, c: [1] + [2] }", 1);
+    assert_convert_matches_tree("{ a: {b: 1}.b, c: [1] + [2] }", 0);
+    big = (char*)malloc(200000);
+    assert(big != NULL);
+    strcpy(big, "{ a: { b: 1, pad: [0");
+    for (i = 0; i < 30000; i++) memcpy(big + 20 + 3 * i, ", 0", 3);
+    strcpy(big + 20 + 3 * 30000, "] }.b }");
+    assert_convert_matches_tree(big, 1);
+    free(big);
+
+    // Bare negative numbers stream as numbers; they used to become null.
+    strcpy(path, "/tmp/xon_test_sax_XXXXXX");
+    fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, "{ d: -5 }", 9) == 9);
+    close(fd);
+    out = fmemopen(streamed, sizeof(streamed), "w");
+    assert(out != NULL);
+    assert(xon_convert_file(path, out, 1, 0) == 1);
+    fclose(out);
+    assert(strcmp(streamed, "{\"d\":-5}") == 0);
+    unlink(path);
+}
+
+// The JSON parser gives the same tree and events as the general parsers,
+// whether it takes the document or hands it back.
+static void assert_json_path_matches(const char* doc) {
+    XonSaxHandler handler;
+    SaxRecorder general;
+    SaxRecorder json;
+    XonValue* expected;
+    XonValue* actual;
+    int general_rc;
+
+    sax_recorder_handler(&handler);
+    xon_set_json_mode(XON_JSON_OFF);
+    expected = xonify_string(doc);
+    memset(&general, 0, sizeof(general));
+    general_rc = xon_sax_parse_buffer(doc, strlen(doc), &handler, &general);
+    xon_set_json_mode(XON_JSON_ALWAYS);
+    actual = xonify_string(doc);
+    memset(&json, 0, sizeof(json));
+    assert(xon_sax_parse_buffer(doc, strlen(doc), &handler, &json) == general_rc);
+    assert(xon_validate_buffer(doc, strlen(doc)) == (general_rc == 1));
+    xon_set_json_mode(XON_JSON_DETECT);
+
+    assert((expected == NULL) == (actual == NULL));
+    if (general_rc == 1) assert(strcmp(general.log, json.log) == 0);
+    if (expected) {
+        XonValue* a_eval = xon_eval(expected);
+        XonValue* b_eval = xon_eval(actual);
+        char* a = xon_to_xon(expected, 0);
+        char* b = xon_to_xon(actual, 0);
+        assert(a && b && strcmp(a, b) == 0);
+        xon_string_free(a);
+        xon_string_free(b);
+        a = xon_to_json(a_eval, 0);
+        b = xon_to_json(b_eval, 0);
+        assert(a && b && strcmp(a, b) == 0);
+        xon_string_free(a);
+        xon_string_free(b);
+        xon_free(a_eval);
+        xon_free(b_eval);
+    }
+    xon_free(expected);
+    xon_free(actual);
+}
+
+static void test_json_fast_path(void) {
+    const char* doc = "{\"name\": \"svc\", \"port\": -8080, \"ratio\": 2.5e-3, \"tags\": [\"a\\\"b\", \"c\\\\d\\/e\\n\"],"
+                      " \"on\": true, \"off\": false, \"none\": null, \"nested\": {\"empty\": [], \"obj\": {}}}";
+    char path[] = "/tmp/xon_test_json_XXXXXX.json";
+    char streamed[512];
+    XonValue* root;
+    char* expected;
+    FILE* out;
+    int fd;
+
+    assert_json_path_matches(doc);
+    assert_json_path_matches(" [ 0, -0, 1E+2, 123456789012, [[[]]], {\"k\": [1, {\"k\": -1}]} ] \n");
+    // Handed back: XON-only syntax, escapes the lexer reads differently,
+    // non-JSON numbers, and errors.
+    assert_json_path_matches("{\"a\": 1, \"b\": [2, 3,],}");
+    assert_json_path_matches("{\"a\": 1 // note\n}");
+    assert_json_path_matches("{let a = 1, \"b\": a + 1}");
+    assert_json_path_matches("[\"\\u0041\", \"\\b\\f\"]");
+    assert_json_path_matches("[01, 0x1F, .5, 1.]");
+    assert_json_path_matches("[1 2]");
+    assert_json_path_matches("{\"a\" 1}");
+    assert_json_path_matches("[\"open]");
+    assert_json_path_matches("[1] [2]");
+    assert_json_path_matches("42");
+
+    // Files named *.json take the JSON path by default, conversion included.
+    fd = mkstemps(path, 5);
+    assert(fd >= 0);
+    assert(write(fd, doc, strlen(doc)) == (ssize_t)strlen(doc));
+    close(fd);
+    root = xonify(path);
+    assert(root != NULL);
+    expected = xon_to_xon(root, 1);
+    out = fmemopen(streamed, sizeof(streamed), "w");
+    assert(out != NULL);
+    assert(xon_convert_file(path, out, 0, 1) == 1);
+    fclose(out);
+    assert(strcmp(streamed, expected) == 0);
+    assert(xon_validate_file(path) == 1);
+    xon_string_free(expected);
+    xon_free(root);
+    unlink(path);
+}
+
+static void test_cursor_on_demand(void) {
+    const char* doc =
+        "{\n"
+        "  // skipped values may hold anything bracket-like\n"
+        "  let base = { note: \"}]\" },\n"
+        "  header: \"x{[\\\"\", /* ] */ skip: [1, (2 + 3), { a: [] }], # }\n"
+        "  \"es\\\"caped\": -2.5,\n"
+        "  total: base.n * 2,\n"
+        "  server: { host: \"edge\", port: 8443, tls: true, backup: null, tags: [\"a\", \"b\", \"c\",], },\n"
+        "}\n";
+    XonDoc* xd = xon_doc_open(doc, strlen(doc));
+    XonCursor root;
+    XonCursor server;
+    XonCursor field;
+    XonCursor item;
+    const char* text;
+    size_t len;
+    double number;
+    int flag;
+
+    assert(xon_sax_parse_buffer(doc, strlen(doc), NULL, NULL) == 1);
+    assert(xd != NULL);
+    assert(xon_doc_root(xd, &root));
+    assert(xon_cursor_type(&root) == XON_TYPE_OBJECT);
+    assert(xon_cursor_size(&root) == 6);
+
+    assert(xon_cursor_find_field(&root, "server", &server));
+    assert(xon_cursor_find_field(&server, "host", &field));
+    assert(xon_cursor_get_string(&field, &text, &len) && len == 4 && strcmp(text, "edge") == 0);
+    assert(xon_cursor_find_field(&server, "port", &field));
+    assert(xon_cursor_get_number(&field, &number) && number == 8443);
+    assert(!xon_cursor_get_string(&field, &text, &len));
+    assert(xon_cursor_find_field(&server, "tls", &field) && xon_cursor_get_bool(&field, &flag) && flag);
+    assert(xon_cursor_find_field(&server, "backup", &field) && xon_cursor_is_null(&field));
+    assert(xon_cursor_find_field(&server, "tags", &field) && xon_cursor_size(&field) == 3);
+    assert(xon_cursor_at(&field, 2, &item) && xon_cursor_get_string(&item, &text, &len) && text[0] == 'c');
+    assert(!xon_cursor_at(&field, 3, &item));
+    assert(!xon_cursor_find_field(&server, "missing", &field));
+
+    assert(xon_cursor_find_field(&root, "header", &field));
+    assert(xon_cursor_get_string(&field, &text, &len) && strcmp(text, "x{[\"") == 0);
+    assert(xon_cursor_find_field(&root, "es\"caped", &field));
+    assert(xon_cursor_get_number(&field, &number) && number == -2.5);
+    assert(xon_cursor_type(&field) == XON_TYPE_NUMBER);
+    // Declarations are not fields, and expressions are not evaluated.
+    assert(!xon_cursor_find_field(&root, "base", &field));
+    assert(xon_cursor_find_field(&root, "total", &field));
+    assert(xon_cursor_type(&field) == XON_TYPE_NULL && !xon_cursor_get_number(&field, &number));
+    xon_doc_close(xd);
+
+    xd = xon_doc_open("[1, 2", 5);
+    assert(xon_doc_root(xd, &root) && xon_cursor_at(&root, 1, &item));
+    assert(xon_cursor_get_number(&item, &number) && number == 2);
+    assert(!xon_cursor_at(&root, 2, &item));
+    xon_doc_close(xd);
+    xd = xon_doc_open("  42", 4);
+    assert(!xon_doc_root(xd, &root));
+    xon_doc_close(xd);
+}
+
+static void assert_same_as_grammar(const char* doc) {
+    XonValue* expected;
+    XonValue* actual;
+    XonValue* copied = NULL;
+    XonTape* tape;
+    XonTapeValue root;
+    char* a;
+    char* b;
+
+    xon_enable_tape(0);
+    expected = xonify_string(doc);
+    xon_enable_tape(1);
+    actual = xonify_string(doc);
+    assert((expected == NULL) == (actual == NULL));
+    tape = xon_tape_parse(doc, strlen(doc));
+    assert(!tape || expected);
+    if (tape) {
+        assert(xon_tape_root(tape, &root));
+        copied = xon_tape_to_value(&root);
+        // The tree owns its strings.
+        xon_tape_free(tape);
+    }
+    if (!expected) return;
+
+    a = xon_to_xon(expected, 0);
+    b = xon_to_xon(actual, 0);
+    assert(a && b && strcmp(a, b) == 0);
+    xon_string_free(b);
+    if (copied) {
+        b = xon_to_xon(copied, 0);
+        assert(b && strcmp(a, b) == 0);
+        xon_string_free(b);
+    }
+    xon_string_free(a);
+    xon_free(expected);
+    xon_free(actual);
+    xon_free(copied);
+}
+
+static void test_tape_reader(void) {
+    const char* doc = "{ name: \"edge\", ports: [80, [1, [2]], -443], on: true, none: null, name: \"dup\", e: {} }";
+    XonTape* tape = xon_tape_parse(doc, strlen(doc));
+    XonTapeValue root;
+    XonTapeValue ports;
+    XonTapeValue v;
+    XonTapeIter it;
+    XonValue* tree;
+    const char* key;
+    const char* s;
+    size_t len;
+    double n;
+    int b;
+    int i;
+
+    assert(tape && xon_tape_root(tape, &root));
+    assert(xon_tape_type(&root) == XON_TYPE_OBJECT && xon_tape_size(&root) == 6);
+    assert(xon_tape_find_field(&root, "name", &v) && xon_tape_get_string(&v, &s, &len));
+    assert(strcmp(s, "edge") == 0 && len == 4);
+    assert(xon_tape_find_field(&root, "on", &v) && xon_tape_get_bool(&v, &b) && b == 1);
+    assert(xon_tape_find_field(&root, "none", &v) && xon_tape_is_null(&v));
+    assert(!xon_tape_find_field(&root, "missing", &v));
+    assert(xon_tape_find_field(&root, "e", &v) && xon_tape_size(&v) == 0);
+
+    // The nested list is skipped over, not walked.
+    assert(xon_tape_find_field(&root, "ports", &ports) && xon_tape_size(&ports) == 3);
+    assert(xon_tape_at(&ports, 2, &v) && xon_tape_get_number(&v, &n) && n == -443);
+    assert(xon_tape_type(&v) == XON_TYPE_NUMBER && !xon_tape_get_string(&v, &s, &len));
+    assert(xon_tape_at(&ports, 1, &v) && xon_tape_type(&v) == XON_TYPE_LIST);
+    assert(!xon_tape_at(&ports, 3, &v));
+
+    assert(xon_tape_iter_begin(&root, &it));
+    for (i = 0; xon_tape_iter_next(&it, &key, &v); i++) {
+        if (i == 1) assert(strcmp(key, "ports") == 0 && xon_tape_type(&v) == XON_TYPE_LIST);
+        if (i == 2) assert(strcmp(key, "on") == 0);
+    }
+    assert(i == 6);
+    assert(xon_tape_iter_begin(&ports, &it));
+    assert(xon_tape_iter_next(&it, &key, &v) && key == NULL && xon_tape_get_number(&v, &n) && n == 80);
+    assert(!xon_tape_iter_begin(&v, &it) && !xon_tape_iter_next(&it, NULL, NULL));
+
+    // A subtree as a regular tree; -443 is a negation there, as parsed.
+    tree = xon_tape_to_value(&ports);
+    assert(tree && xon_list_size(tree) == 3);
+    assert(xon_get_type(xon_list_get(tree, 2)) == XON_TYPE_NULL);
+    xon_free(tree);
+    assert(xon_tape_find_field(&root, "name", &v));
+    tree = xon_tape_to_value(&v);
+    assert(tree && strcmp(xon_get_string(tree), "edge") == 0);
+    xon_free(tree);
+    xon_tape_free(tape);
+
+    assert(xon_tape_parse("{ let a = 1, b: a }", 19) == NULL);
+    assert(xon_tape_parse("[1, 2", 5) == NULL);
+    assert(xon_tape_parse("", 0) == NULL);
+}
+
+static void test_tape_parse(void) {
+    static const char* const docs[] = {
+        "{ name: \"edge\", port: 8443, ratio: -0.25, hex: 0x1F, on: true, off: false, none: null }",
+        "[1, [2, [3, []]], {}, { a: { b: [\"c\",] }, }, -7]",
+        "{ \"quoted key\": \"esc \\\"q\\\" \\\\ \\n\\t\", \"//not\": \"/* nor */ # this\", tail: [\"\\\\\"] }",
+        "{\n  // a comment\n  a: 1, /* [ ] */ b: [2, 3], # more\n  c: \"}\"\n}",
+        // Declarations and expressions are handed to the grammar.
+        "{ let base = 10, port: base + 1 }",
+        "{ a: (1 + 2), b: [-x] }",
+        // Syntax errors too, so they are reported the usual way.
+        "{ a: 1 b: 2 }",
+        "{ a: [1, 2 }",
+        "{ true: 1 }",
+        "[1, , 2]",
+        "{ a: \"unterminated }",
+    };
+    char big[4096];
+    size_t len = 0;
+    size_t i;
+    int level;
+    XonStructuralIndex index;
+    XonValue* root;
+
+    xon_enable_arena(1);
+
+    // Entries for quotes, operators and run starts; nothing inside the string
+    // or the comment.
+    assert(xon_structural_index("{ a: \"x,}\" /* , */, b: [-1] }", 29, &index));
+    assert(index.count == 12);
+    assert(index.pos[0] == 0 && index.pos[1] == 2 && index.pos[3] == 5 && index.pos[4] == 9);
+    assert(index.pos[5] == 18 && index.pos[8] == 23 && index.pos[9] == 24 && index.pos[11] == 28);
+    xon_structural_free(&index);
+    assert(!xon_structural_index("[\"open", 6, &index));
+
+    // Escapes, quotes and comments straddling 64-byte block edges.
+    len += (size_t)snprintf(big + len, sizeof(big) - len, "{ items: [");
+    for (i = 0; i < 60; i++) {
+        len += (size_t)snprintf(big + len, sizeof(big) - len,
+                                "{ id: %zu, s: \"%.*s\\\\\\\"//#\" }, %s", i, (int)(2 * (i % 6)), "\\\\\\\\\\\\\\\\\\\\\\",
+                                i % 7 == 0 ? "/* \" */ " : (i % 5 == 0 ? "# ]\n" : ""));
+    }
+    snprintf(big + len, sizeof(big) - len, "] }");
+
+    for (level = XON_SCAN_SCALAR; level <= XON_SCAN_AVX2; level++) {
+        xon_scan_set_level((XonScanLevel)level);
+        for (i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) assert_same_as_grammar(docs[i]);
+        assert_same_as_grammar(big);
+    }
+
+    root = xonify_string(docs[0]);
+    assert(root != NULL);
+    assert(strcmp(xon_get_string(xon_object_get(root, "name")), "edge") == 0);
+    assert(xon_get_number(xon_object_get(root, "hex")) == 31);
+    xon_free(root);
+    root = xonify_string(big);
+    assert(root != NULL && xon_list_size(xon_object_get(root, "items")) == 60);
+    xon_free(root);
+    xon_enable_tape(0);
+    xon_enable_arena(0);
+}
+
+static char* big_list_document(const char* item_format, size_t count, size_t* out_len) {
+    size_t cap = count * 160 + 64;
+    size_t len = 0;
+    size_t i;
+    char* out = (char*)malloc(cap);
+
+    assert(out != NULL);
+    len += (size_t)snprintf(out + len, cap - len, "// leading, comment\n[\n");
+    for (i = 0; i < count; i++) {
+        len += (size_t)snprintf(out + len, cap - len, item_format, i, i, i);
+    }
+    len += (size_t)snprintf(out + len, cap - len, "] # trailing\n");
+    *out_len = len;
+    return out;
+}
+
+static void assert_parallel_matches_serial(const char* doc, size_t len) {
+    XonValue* serial;
+    XonValue* parallel;
+    char* a;
+    char* b;
+
+    xon_set_parse_threads(1);
+    serial = xonify_buffer(doc, len);
+    xon_set_parse_threads(4);
+    parallel = xonify_buffer(doc, len);
+    xon_set_parse_threads(1);
+    assert((serial == NULL) == (parallel == NULL));
+    if (!serial) return;
+
+    a = xon_to_xon(serial, 0);
+    b = xon_to_xon(parallel, 0);
+    assert(a && b && strcmp(a, b) == 0);
+    xon_string_free(a);
+    xon_string_free(b);
+    xon_free(serial);
+    xon_free(parallel);
+}
+
+static void test_parallel_list_parse(void) {
+    size_t len = 0;
+    char* doc;
+    char* cut;
+    char* next;
+    XonValue* root;
+    XonValue* evaluated;
+
+    // Commas and brackets inside strings and comments are not cut points.
+    doc = big_list_document("  { id: %zu, name: \"a,]b\\\",[\" /* ], */, tags: [%zu, \"x\"], # ,]\n"
+                            "    next: %zu + 1 },\n",
+                            30000, &len);
+    assert(len > 2 * 1024 * 1024);
+    assert_parallel_matches_serial(doc, len);
+
+    xon_set_parse_threads(4);
+    root = xonify_buffer(doc, len);
+    assert(root != NULL && xon_list_size(root) == 30000);
+    assert((int)xon_get_number(xon_object_get(xon_list_get(root, 12345), "id")) == 12345);
+    evaluated = xon_eval(root);
+    assert(evaluated != NULL);
+    assert((int)xon_get_number(xon_object_get(xon_list_get(evaluated, 29999), "next")) == 30000);
+    xon_free(evaluated);
+    xon_free(root);
+
+    // A cut inside a call falls back to the serial parser.
+    free(doc);
+    doc = big_list_document("  [max(%zu, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, %zu, %zu)],\n", 40000, &len);
+    assert_parallel_matches_serial(doc, len);
+    // Syntax errors are reported once, by the serial parser.
+    doc[len / 2] = '}';
+    assert_parallel_matches_serial(doc, len);
+    free(doc);
+
+    // An empty item whose second comma is the first one past len / 8, where
+    // a cut is made: the piece before it must not pass for a list with a
+    // trailing comma.
+    doc = big_list_document("  1,\n", 430000, &len);
+    assert(len > 2 * 1024 * 1024 && len < 9 * 256 * 1024);
+    cut = strchr(doc + len / 8, ',');
+    assert(cut && cut[-1] == '1');
+    cut[-1] = ' ';
+    assert_parallel_matches_serial(doc, len);
+
+    // Only whitespace between the commas cut at for 2 * len / 8 and 3 * len / 8:
+    // the piece between them must not pass for an empty list.
+    cut[-1] = '1';
+    cut = strchr(doc + 2 * len / 8, ',');
+    next = strchr(doc + 3 * len / 8 + 16, ',');
+    assert(cut && next);
+    memset(cut + 1, ' ', (size_t)(next - cut - 1));
+    assert_parallel_matches_serial(doc, len);
+    xon_set_parse_threads(1);
+    free(doc);
+}
+
+static XonValue* stream_in_chunks(const char* doc, size_t chunk, int* feed_ok) {
+    XonStream* stream = xon_stream_new();
+    size_t len = strlen(doc);
+    size_t i;
+
+    assert(stream != NULL);
+    *feed_ok = 1;
+    for (i = 0; i < len; i += chunk) {
+        size_t n = len - i < chunk ? len - i : chunk;
+        if (!xon_stream_feed(stream, doc + i, n)) *feed_ok = 0;
+    }
+    return xon_stream_finish(stream);
+}
+
+static void test_stream_push_parse(void) {
+    static const size_t chunks[] = {1, 2, 3, 7, 64, 4096};
+    const char* doc =
+        "# header comment\n"
+        "{\n"
+        "  let base = 40, const name = \"edge\",\n"
+        "  /* block\n     comment */ port: base + 8403, // line comment\n"
+        "  title: \"esc \\\"q\\\" \\\\ \\n\" ?? null,\n"
+        "  ratio: 1.25e-3, hex: 0xff, flags: [true, false, null,],\n"
+        "  check: base >= 40 && !false, add: (a, b) => a + b, sum: add(1, 2),\n"
+        "  \"quoted key\": if (base == 40) \"yes\" else \"no\",\n"
+        "}\n";
+    XonValue* expected = xonify_string(doc);
+    char* expected_text;
+    size_t c;
+    int ok;
+
+    assert(expected != NULL);
+    expected_text = xon_to_xon(expected, 0);
+    for (c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        XonValue* root;
+        char* text;
+        // Alternate heap and arena trees.
+        xon_enable_arena((int)(c % 2));
+        root = stream_in_chunks(doc, chunks[c], &ok);
+        assert(root != NULL && ok);
+        text = xon_to_xon(root, 0);
+        assert(strcmp(text, expected_text) == 0);
+        xon_string_free(text);
+        xon_free(root);
+    }
+    xon_string_free(expected_text);
+    xon_free(expected);
+
+    // Errors stop the stream where they are found.
+    assert(stream_in_chunks("{ a: 1 b: 2, c: [1, 2, 3] }", 4, &ok) == NULL && !ok);
+    // A value still open when the input ends only fails at finish.
+    assert(stream_in_chunks("{ a: \"unterminated", 3, &ok) == NULL && ok);
+    assert(stream_in_chunks("{ a: [1, 2", 3, &ok) == NULL && ok);
+    assert(stream_in_chunks("", 1, &ok) == NULL);
+    xon_stream_free(xon_stream_new());
+    xon_enable_arena(0);
+}
+
+typedef struct {
+    char out[4096];
+    size_t count;
+    size_t failed_index;
+    size_t stop_after;
+} RecordSink;
+
+static int collect_record(void* user_data, size_t index, const XonValue* value) {
+    RecordSink* sink = (RecordSink*)user_data;
+    char* text;
+
+    assert(index == sink->count);
+    sink->count++;
+    if (!value) {
+        sink->failed_index = index;
+        strcat(sink->out, "!\n");
+    } else {
+        text = xon_to_json(value, 0);
+        assert(text != NULL);
+        strcat(sink->out, text);
+        strcat(sink->out, "\n");
+        xon_string_free(text);
+    }
+    return sink->count != sink->stop_after;
+}
+
+static int run_records(const char* input, int threads, int evaluate, int one_per_line, RecordSink* sink) {
+    XonRecordOptions options;
+    FILE* in = fmemopen((void*)input, strlen(input), "r");
+    int rc;
+
+    assert(in != NULL);
+    memset(&options, 0, sizeof(options));
+    options.threads = threads;
+    options.evaluate = evaluate;
+    options.one_per_line = one_per_line;
+    options.window = 2;
+    rc = xon_records_parse(in, &options, collect_record, sink);
+    fclose(in);
+    return rc;
+}
+
+static void test_record_streams(void) {
+    const char* xonl =
+        "# records may span lines\n"
+        "{ id: 1, note: \"} ]\" }\n"
+        "[1, /* ] */ 2,\n 3 + 4] // trailing\n"
+        "\n"
+        "{ id: 3, nested: { deep: [[{}]] } }{ id: 4 }\n"
+        "{ id: 5, let n = 2, twice: n * 2 }\n"
+        "# done\n";
+    const char* expected_parsed =
+        "{\"id\":1,\"note\":\"} ]\"}\n[1,2,null]\n{\"id\":3,\"nested\":{\"deep\":[[{}]]}}\n{\"id\":4}\n"
+        "{\"id\":5,\"twice\":null}\n";
+    const char* expected_evaluated =
+        "{\"id\":1,\"note\":\"} ]\"}\n[1,2,7]\n{\"id\":3,\"nested\":{\"deep\":[[{}]]}}\n{\"id\":4}\n"
+        "{\"id\":5,\"twice\":4}\n";
+    int threads;
+
+    for (threads = 1; threads <= 4; threads *= 2) {
+        RecordSink sink;
+        memset(&sink, 0, sizeof(sink));
+        assert(run_records(xonl, threads, 0, 0, &sink) == 1);
+        assert(sink.count == 5 && strcmp(sink.out, expected_parsed) == 0);
+
+        memset(&sink, 0, sizeof(sink));
+        assert(run_records(xonl, threads, 1, 0, &sink) == 1);
+        assert(strcmp(sink.out, expected_evaluated) == 0);
+
+        // NDJSON: one record per line; a bad line fails alone.
+        memset(&sink, 0, sizeof(sink));
+        assert(run_records("{\"a\":1}\n\n{\"a\":\n[true]\n{\"b\":null}", threads, 0, 1, &sink) == 0);
+        assert(sink.count == 4 && sink.failed_index == 1);
+        assert(strcmp(sink.out, "{\"a\":1}\n!\n[true]\n{\"b\":null}\n") == 0);
+
+        memset(&sink, 0, sizeof(sink));
+        sink.stop_after = 2;
+        assert(run_records(xonl, threads, 0, 0, &sink) == -1);
+        assert(sink.count == 2);
+    }
+}
+
+static void test_validate_without_tree(void) {
+    static const char* docs[] = {
+        "{ let base = 40, port: base + 1, name: \"esc \\\" \\n\", f: (a, b) => a * b, v: f(2, 3).x }",
+        "[1, -2.5e3, 0xff, true, false, null, \"\", [], {},]",
+        "{ \"a\": { \"b\": [\"c\"] } }",
+        "{ a: { b: 1 }.b }",
+        "{ a: [1, 2 }",
+        "{ a: 1 + }",
+        "{ a: @ }",
+        "{ a: \"unterminated }",
+        "{} {}",
+        "42",
+        "",
+    };
+    size_t depth = 100000;
+    size_t len;
+    size_t i;
+    char* input;
+
+    xon_enable_arena(1);
+    for (i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        XonValue* root = xonify_string(docs[i]);
+        // The first four are valid, the rest are not.
+        assert((root != NULL) == (i < 4));
+        assert(xon_validate_buffer(docs[i], strlen(docs[i])) == (root != NULL));
+        xon_free(root);
+    }
+    xon_enable_arena(0);
+
+    // The expression sends this to the grammar, and the nesting grows the
+    // parser stack past its initial size.
+    input = nested_document("{a:[", "1 + 1", "]}", depth, &len);
+    assert(xon_validate_buffer(input, len) == 1);
+    input[len - 1] = ' ';
+    assert(xon_validate_buffer(input, len) == 0);
+    free(input);
+
+    assert(xon_validate_file("/nonexistent/file.xon") == 0);
+}
+
+static void test_diagnostics_all_errors(void) {
+    const char* doc =
+        "{\n"
+        "  a: 1 b: 2,\n"
+        "  c: [1,, 2],\n"
+        "  d: @,\n"
+        "  e: { x: },\n"
+        "  ok: \"fine\"\n"
+        "}\n";
+    XonDiagnostic* diagnostics = NULL;
+    size_t count = 0;
+
+    assert(xon_diagnose_buffer(doc, strlen(doc), &diagnostics, &count) == 0);
+    assert(count == 4);
+    assert(diagnostics[0].line == 2 && diagnostics[0].column == 8);
+    assert(strcmp(diagnostics[0].message, "Unexpected 'b'") == 0);
+    assert(diagnostics[1].line == 3 && diagnostics[1].column == 9);
+    assert(diagnostics[2].line == 4 && diagnostics[2].column == 6);
+    assert(strcmp(diagnostics[2].message, "Unexpected character '@'") == 0);
+    assert(diagnostics[3].line == 5 && diagnostics[3].column == 11);
+    xon_diagnostics_free(diagnostics, count);
+
+    // A lexer error at the end is not reported again as the end of input.
+    assert(xon_diagnose_buffer("{ a: \"open", 10, &diagnostics, &count) == 0);
+    assert(count == 1 && diagnostics[0].column == 6);
+    assert(strcmp(diagnostics[0].message, "Unterminated string literal") == 0);
+    xon_diagnostics_free(diagnostics, count);
+
+    assert(xon_diagnose_buffer("{ a: [1, 2", 10, NULL, &count) == 0 && count == 1);
+    assert(xon_diagnose_buffer("{ a: 1 + 2, b: [true] }", 23, &diagnostics, &count) == 1);
+    assert(count == 0 && diagnostics == NULL);
+
+    // Recovery is only for diagnostics: parsing still stops at the first error.
+    xon_enable_arena(1);
+    assert(xonify_string(doc) == NULL);
+    xon_enable_arena(0);
+}
+
+// Applies an edit at the first occurrence of at in the current text and
+// checks the result against a fresh parse of that text.
+static int incremental_edit(XonIncremental* inc, const char* at, size_t removed, const char* text) {
+    size_t len;
+    const char* current = xon_incremental_text(inc, &len);
+    char* copy = (char*)malloc(len + 1);
+    char* found;
+    XonValue* fresh;
+    int valid;
+
+    assert(copy);
+    memcpy(copy, current, len);
+    copy[len] = '\0';
+    found = strstr(copy, at);
+    assert(found);
+    valid = xon_incremental_edit(inc, (size_t)(found - copy), removed, text, strlen(text));
+    free(copy);
+
+    current = xon_incremental_text(inc, &len);
+    assert((xon_incremental_root(inc) != NULL) == valid);
+    fresh = xonify_buffer(current, len);
+    assert((fresh != NULL) == valid);
+    if (valid) {
+        XonValue* a_eval = xon_eval(xon_incremental_root(inc));
+        XonValue* b_eval = xon_eval(fresh);
+        char* a = xon_to_xon(xon_incremental_root(inc), 0);
+        char* b = xon_to_xon(fresh, 0);
+        assert(a && b && strcmp(a, b) == 0);
+        xon_string_free(a);
+        xon_string_free(b);
+        // Literal flags were kept up to date, or evaluation would differ.
+        a = xon_to_json(a_eval, 0);
+        b = xon_to_json(b_eval, 0);
+        assert(a && b && strcmp(a, b) == 0);
+        xon_string_free(a);
+        xon_string_free(b);
+        xon_free(a_eval);
+        xon_free(b_eval);
+    }
+    xon_free(fresh);
+    return valid;
+}
+
+static void test_incremental_reparse(void) {
+    const char* doc =
+        "{\n"
+        "  name: \"demo\",\n"
+        "  items: [1, 2, 3],\n"
+        "  nested: { a: [true, null], b: \"x\" },\n"
+        "  total: 1 + 2\n"
+        "}\n";
+    XonIncremental* inc = xon_incremental_new(doc, strlen(doc));
+    const XonValue* nested;
+
+    assert(inc && xon_incremental_root(inc));
+    nested = xon_object_get(xon_incremental_root(inc), "nested");
+
+    // Edits inside one container leave the nodes around it in place.
+    assert(incremental_edit(inc, "2, 3", 1, "42") == 1);
+    assert(xon_list_size(xon_object_get(xon_incremental_root(inc), "items")) == 3);
+    assert(xon_object_get(xon_incremental_root(inc), "nested") == nested);
+    assert(incremental_edit(inc, "x\"", 0, "yz") == 1);
+    assert(strcmp(xon_get_string(xon_object_get(nested, "b")), "yzx") == 0);
+    assert(incremental_edit(inc, "1, 42", 0, "\n\n0, ") == 1);
+
+    // A literal that becomes an expression, and back.
+    assert(incremental_edit(inc, "true", 4, "1 + 1") == 1);
+    assert(incremental_edit(inc, "1 + 1", 5, "false") == 1);
+
+    // Broken while typing, then repaired: the tree comes back.
+    assert(incremental_edit(inc, "], b", 1, "") == 0);
+    assert(xon_incremental_root(inc) == NULL);
+    assert(incremental_edit(inc, ", b", 0, "]") == 1);
+    assert(incremental_edit(inc, "42", 0, "\"") == 0);
+    assert(incremental_edit(inc, "42", 2, "\"") == 1);
+    assert(xon_get_type(xon_list_get(xon_object_get(xon_incremental_root(inc), "items"), 2)) == XON_TYPE_STRING);
+
+    // Edits outside any container, and ones that change a container's brackets.
+    assert(incremental_edit(inc, "{", 0, "// header\n") == 1);
+    assert(incremental_edit(inc, "{ a:", 1, "[") == 0);
+    assert(incremental_edit(inc, "a: [", 3, "") == 0);
+    assert(incremental_edit(inc, ", b: \"yzx\" }", 12, "]") == 1);
+    assert(xon_is_list(xon_object_get(xon_incremental_root(inc), "nested")));
+
+    xon_incremental_free(inc);
+
+    inc = xon_incremental_new("{ a: ", 5);
+    assert(inc && xon_incremental_root(inc) == NULL);
+    assert(incremental_edit(inc, ": ", 2, ": 1 }") == 1);
+    xon_incremental_free(inc);
+
+    // A failed reparse must not leave the parser recovering from errors
+    // silently for the next one.
+    inc = xon_incremental_new("{a: 1}", 6);
+    assert(incremental_edit(inc, "a: 1", 4, "1") == 0);
+    assert(xon_incremental_root(inc) == NULL);
+    xon_incremental_free(inc);
+    inc = xon_incremental_new("[[1], 2]", 8);
+    assert(incremental_edit(inc, "1]", 0, ",") == 0);
+    assert(incremental_edit(inc, ",1", 1, "") == 1);
+    xon_incremental_free(inc);
+}
+
+// Objects of 100 members k0..k99 with k7 repeated at the end.
+static void assert_object_lookup(const XonValue* obj) {
+    char key[16];
+    size_t i;
+
+    assert(obj != NULL && xon_object_size(obj) == 101);
+    for (i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "k%zu", i);
+        assert((size_t)xon_get_number(xon_object_get(obj, key)) == i);
+        assert(strcmp(xon_object_key_at(obj, i), key) == 0);
+        assert((size_t)xon_get_number(xon_object_value_at(obj, i)) == i);
+    }
+    assert((int)xon_get_number(xon_object_value_at(obj, 100)) == 1000);
+    assert(xon_object_get(obj, "k100") == NULL);
+    assert(xon_object_get(obj, "k") == NULL);
+    assert(xon_object_get(obj, "") == NULL);
+}
+
+static void test_object_key_index(void) {
+    size_t cap = 2048;
+    size_t len = 0;
+    size_t i;
+    char* xon = (char*)malloc(cap);
+    char* json = (char*)malloc(cap);
+    char* member = (char*)malloc(cap * 2);
+    XonValue* root;
+    XonValue* evaluated;
+    XonIncremental* doc;
+    const char* edited = "{k0: 0, k1: 2, k2: 4}";
+
+    assert(xon != NULL && json != NULL && member != NULL);
+    len += (size_t)snprintf(xon + len, cap - len, "{");
+    for (i = 0; i < 100; i++) len += (size_t)snprintf(xon + len, cap - len, "k%zu: %zu, ", i, i);
+    snprintf(xon + len, cap - len, "k7: 1000}");
+    len = 0;
+    len += (size_t)snprintf(json + len, cap - len, "{");
+    for (i = 0; i < 100; i++) len += (size_t)snprintf(json + len, cap - len, "\"k%zu\": %zu, ", i, i);
+    snprintf(json + len, cap - len, "\"k7\": 1000}");
+
+    // Every builder indexes the object; the first of duplicate keys wins.
+    root = xonify_string(xon);
+    assert_object_lookup(root);
+    evaluated = xon_eval(root);
+    assert_object_lookup(evaluated);
+    xon_free(evaluated);
+    xon_free(root);
+    xon_enable_arena(1);
+    root = xonify_string(xon);
+    assert_object_lookup(root);
+    xon_free(root);
+    xon_enable_tape(1);
+    root = xonify_string(xon);
+    assert_object_lookup(root);
+    xon_free(root);
+    xon_enable_tape(0);
+    xon_set_json_mode(XON_JSON_ALWAYS);
+    root = xonify_string(json);
+    assert_object_lookup(root);
+    xon_free(root);
+    xon_set_json_mode(XON_JSON_DETECT);
+    xon_enable_arena(0);
+
+    // Member access goes through the index of the evaluated object.
+    snprintf(member, cap * 2, "{ let cfg = %s, a: cfg.k42, b: cfg.k7, c: cfg.k99 }", json);
+    root = xonify_string(member);
+    evaluated = xon_eval(root);
+    assert(evaluated != NULL);
+    assert((int)xon_get_number(xon_object_get(evaluated, "a")) == 42);
+    assert((int)xon_get_number(xon_object_get(evaluated, "b")) == 7);
+    assert((int)xon_get_number(xon_object_get(evaluated, "c")) == 99);
+    xon_free(evaluated);
+    xon_free(root);
+
+    // An incremental edit replaces the object and its index together.
+    doc = xon_incremental_new(xon, strlen(xon));
+    assert(doc != NULL);
+    assert_object_lookup(xon_incremental_root(doc));
+    assert(xon_incremental_edit(doc, 1, strlen("k0: 0"), "k0: 0, k100: 100", strlen("k0: 0, k100: 100")) == 1);
+    assert(xon_object_size(xon_incremental_root(doc)) == 102);
+    assert((int)xon_get_number(xon_object_get(xon_incremental_root(doc), "k100")) == 100);
+    assert((int)xon_get_number(xon_object_get(xon_incremental_root(doc), "k7")) == 7);
+    assert(xon_incremental_edit(doc, 0, strlen(xon) + strlen(", k100: 100"), edited, strlen(edited)) == 1);
+    assert(xon_object_get(xon_incremental_root(doc), "k7") == NULL);
+    assert((int)xon_get_number(xon_object_get(xon_incremental_root(doc), "k2")) == 4);
+    xon_incremental_free(doc);
+    free(xon);
+    free(json);
+    free(member);
+}
+
+static int count_path_match(void* user_data, const XonValue* value) {
+    (void)value;
+    return --*(int*)user_data > 0;
+}
+
+static void assert_path_number(const XonValue* root, const char* expr, double expected) {
+    XonPath* path = xon_path_compile(expr);
+    XonValue* match;
+    assert(path != NULL);
+    match = xon_path_eval(path, root);
+    assert(match != NULL && xon_get_number(match) == expected);
+    xon_path_free(path);
+}
+
+static size_t path_count(const XonValue* root, const char* expr) {
+    XonPath* path = xon_path_compile(expr);
+    size_t count;
+    assert(path != NULL);
+    count = xon_path_each(path, root, NULL, NULL);
+    xon_path_free(path);
+    return count;
+}
+
+static void test_path_queries(void) {
+    const char* doc =
+        "{ let base = 10,"
+        "  services: {"
+        "    api: { limits: [{burst: 1}, {burst: 2}, {burst: 3}, {burst: base * 4}], hosts: [\"a\", \"b\"] },"
+        "    \"web app\": { limits: [], port: 8080, tls: true },"
+        "    db: { port: 5432, tls: false, region: \"eu\", meta: { zone: \"eu-1\" } },"
+        "  },"
+        "  \"a/b\": { \"m~n\": 7, \"\": 8 },"
+        "}";
+    static const char* const invalid[] = {"a..b", "a[", "a[1", "a[x]", "a[\"x]", "a[?b ==]", "a b", "/a~2", "a[?@x]"};
+    XonValue* parsed = xonify_string(doc);
+    XonValue* root = xon_eval(parsed);
+    XonValue* big;
+    XonPath* path;
+    char text[64];
+    size_t i;
+    int budget = 2;
+
+    assert(root != NULL);
+    assert_path_number(root, "services.api.limits[3].burst", 40);
+    assert_path_number(root, "$.services[\"web app\"].port", 8080);
+    assert_path_number(root, "services.api.limits[-1].burst", 40);
+    assert_path_number(root, "services.api.limits.2.burst", 3);
+    assert_path_number(root, "services['db'].port", 5432);
+    assert_path_number(root, "/services/api/limits/0/burst", 1);
+    assert_path_number(root, "/a~1b/m~0n", 7);
+    assert_path_number(root, "/a~1b/", 8);
+    assert_path_number(root, "services[?tls].port", 8080);
+    assert_path_number(root, "services[?meta.zone == \"eu-1\"].port", 5432);
+    assert_path_number(root, "services.api.limits[?burst > 2][?@ >= 40]", 40);
+    assert_path_number(root, "services.api.limits[?@.burst != 1].burst", 2);
+    assert(path_count(root, "services.*.port") == 2);
+    assert(path_count(root, "services.api.limits[*].burst") == 4);
+    assert(path_count(root, "services.api.limits[?burst <= 2]") == 2);
+    assert(path_count(root, "services.api.hosts[?@ < \"b\"]") == 1);
+    assert(path_count(root, "services[?region]") == 1);
+    assert(path_count(root, "services.api.limits[4]") == 0);
+    assert(path_count(root, "services.api.limits[-5]") == 0);
+    assert(path_count(root, "services.api.port") == 0);
+    assert(path_count(root, "services[0]") == 0);
+    assert(path_count(root, "") == 1);
+
+    // Callbacks stop the walk.
+    path = xon_path_compile("services.api.limits[*]");
+    assert(xon_path_each(path, root, count_path_match, &budget) == 2 && budget == 0);
+    xon_path_free(path);
+
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) assert(xon_path_compile(invalid[i]) == NULL);
+    xon_free(root);
+    xon_free(parsed);
+
+    // Indexed objects are looked up by the precomputed hash.
+    big = xonify_string("{ k0: 0, k1: 1, k2: 2, k3: 3, k4: 4, k5: 5, k6: 6, k7: 7, k8: 8, k9: 9,"
+                        "  k10: 10, k11: 11, k12: 12, k13: 13, k14: 14, k15: 15, k16: { k16: [16] } }");
+    assert(big != NULL);
+    for (i = 0; i < 16; i++) {
+        snprintf(text, sizeof(text), "k%zu", i);
+        assert_path_number(big, text, (double)i);
+    }
+    assert_path_number(big, "k16.k16[0]", 16);
+    assert(path_count(big, "k17") == 0 && path_count(big, "*") == 17);
+    xon_free(big);
+}
+
+typedef struct {
+    const char* name;
+    int port;
+    double weight;
+    int tls;
+    const char* region;
+    const XonValue* tags;
+} ExtractedService;
+
+static void test_struct_extraction(void) {
+    static const XonFieldDesc fields[] = {
+        {"name", XON_FIELD_STRING, offsetof(ExtractedService, name), 1, 0.0, NULL},
+        {"port", XON_FIELD_INT, offsetof(ExtractedService, port), 0, 80.0, NULL},
+        XON_FIELD(ExtractedService, weight, "weight", XON_FIELD_DOUBLE),
+        XON_FIELD(ExtractedService, tls, "tls", XON_FIELD_BOOL),
+        {"region", XON_FIELD_STRING, offsetof(ExtractedService, region), 0, 0.0, "eu"},
+        XON_FIELD(ExtractedService, tags, "tags", XON_FIELD_VALUE),
+    };
+    static const char* const invalid[] = {
+        "{ port: 1 }", "{ name: 1 }", "{ name: \"a\", port: 1.5 }", "{ name: \"a\", port: 1e10 }",
+        "{ name: \"a\", tls: 1 }", "{ name: \"a\", weight: \"1\" }", "{ name: \"a\", port: 1 + 1 }", "[1]",
+    };
+    size_t n = sizeof(fields) / sizeof(fields[0]);
+    ExtractedService services[4];
+    ExtractedService one;
+    XonFieldDesc many[40];
+    double values[40];
+    char keys[40][8];
+    char doc[512];
+    size_t len = 0;
+    size_t count;
+    size_t i;
+    XonValue* root;
+
+    root = xonify_string("{ tags: [\"a\"], extra: {}, name: \"api\", port: -8080, weight: 0.5, tls: true,"
+                         "  name: \"ignored\", region: null }");
+    assert(root != NULL);
+    memset(&one, 0xff, sizeof(one));
+    assert(xon_extract(root, fields, n, &one) == 1);
+    assert(strcmp(one.name, "api") == 0 && one.port == -8080 && one.weight == 0.5 && one.tls == 1);
+    assert(strcmp(one.region, "eu") == 0 && xon_list_size(one.tags) == 1);
+    xon_free(root);
+
+    root = xonify_string("{ name: \"db\" }");
+    assert(xon_extract(root, fields, n, &one) == 1);
+    assert(one.port == 80 && one.weight == 0.0 && one.tls == 0 && strcmp(one.region, "eu") == 0 && one.tags == NULL);
+    xon_free(root);
+
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        root = xonify_string(invalid[i]);
+        assert(root != NULL && xon_extract(root, fields, n, &one) == 0);
+        xon_free(root);
+    }
+
+    // Lists of records share one descriptor table.
+    root = xonify_string("[{ name: \"a\", port: 1 }, { name: \"b\", tls: true }, { name: \"c\", weight: 2 }]");
+    assert(xon_extract_list(root, fields, n, services, sizeof(services[0]), 4, &count) == 1 && count == 3);
+    assert(strcmp(services[0].name, "a") == 0 && services[0].port == 1 && services[1].tls == 1);
+    assert(strcmp(services[2].name, "c") == 0 && services[2].weight == 2.0 && services[2].port == 80);
+    assert(xon_extract_list(root, fields, n, services, sizeof(services[0]), 2, &count) == 0 && count == 2);
+    assert(xon_extract(root, fields, n, &one) == 0);
+    xon_free(root);
+    root = xonify_string("[{ name: \"a\" }, { port: 2 }, { name: \"c\" }]");
+    assert(xon_extract_list(root, fields, n, services, sizeof(services[0]), 4, &count) == 0 && count == 1);
+    xon_free(root);
+
+    // More descriptors than the inline table, from an indexed object.
+    len += (size_t)snprintf(doc + len, sizeof(doc) - len, "{");
+    for (i = 0; i < 40; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "f%zu", i);
+        many[i].key = keys[i];
+        many[i].type = XON_FIELD_DOUBLE;
+        many[i].offset = i * sizeof(double);
+        many[i].required = i < 39;
+        many[i].default_number = -1.0;
+        many[i].default_string = NULL;
+        if (i < 39) len += (size_t)snprintf(doc + len, sizeof(doc) - len, "f%zu: %zu, ", 38 - i, i);
+    }
+    snprintf(doc + len, sizeof(doc) - len, "}");
+    root = xonify_string(doc);
+    assert(root != NULL && xon_extract(root, many, 40, values) == 1);
+    for (i = 0; i < 39; i++) assert(values[i] == (double)(38 - i));
+    assert(values[39] == -1.0);
+    xon_free(root);
+}
+
 int main(void) {
     printf("=== Xon Test Suite ===\n");
     test_parse_core_features();
@@ -354,6 +2016,30 @@ int main(void) {
     test_object_iteration();
     test_serialization();
     test_json_input_supported();
+    test_buffer_parse_without_terminator();
+    test_file_input_mapped_and_piped();
+    test_scan_kernels_all_levels();
+    test_string_literals_scanned_with_length();
+    test_number_literals_correctly_rounded();
+    test_keywords_and_identifier_spans();
+    test_large_containers_linear_build();
+    test_arena_documents();
+    test_long_and_deep_documents();
+    test_parser_context_reuse();
+    test_sax_events();
+    test_json_fast_path();
+    test_cursor_on_demand();
+    test_tape_parse();
+    test_tape_reader();
+    test_parallel_list_parse();
+    test_stream_push_parse();
+    test_record_streams();
+    test_validate_without_tree();
+    test_diagnostics_all_errors();
+    test_incremental_reparse();
+    test_object_key_index();
+    test_path_queries();
+    test_struct_extraction();
     printf("All tests passed.\n");
     return 0;
 }